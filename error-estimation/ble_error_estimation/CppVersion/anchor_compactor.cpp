@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "anchor_compactor.h"
+#include "anchor_layout.h"
+
+/*ANCHORCOMPACTOR*/
+//constructor:
+AnchorCompactor::AnchorCompactor(ProcessingContext& processing_context, size_t min_samples, float min_gain)
+    : context(processing_context), minimum_samples(min_samples), gain(min_gain) {
+}
+
+AnchorCompactor::~AnchorCompactor() {
+    if (background.joinable()) {
+        background.join();
+    }
+}
+
+//methods:
+bool AnchorCompactor::compact() {
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> samples = context.covisibility.recent();
+
+    // Current memory order of the anchors
+    std::vector<std::pair<const Anchor*, std::string>> by_address;
+    {
+        auto guard = context.anchors.read();
+        by_address.reserve(guard.size());
+        for (const auto& [mac, anchor] : guard.anchors()) {
+            by_address.emplace_back(anchor, mac);
+        }
+    }
+    std::sort(by_address.begin(), by_address.end(), [](const auto& lhs, const auto& rhs) {
+        return std::less<const Anchor*>()(lhs.first, rhs.first);
+    });
+    std::vector<std::string> nodes;
+    nodes.reserve(by_address.size());
+    for (auto& entry : by_address) {
+        nodes.push_back(std::move(entry.second));
+    }
+
+    std::vector<std::vector<size_t>> graph = covisibility_graph(samples, nodes);
+    std::vector<size_t> order = reverse_cuthill_mckee(graph);
+    std::vector<size_t> current_position(nodes.size());
+    std::vector<size_t> new_position(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        current_position[i] = i;
+        new_position[order[i]] = i;
+    }
+    double span_before = mean_edge_span(graph, current_position);
+    double span_after = mean_edge_span(graph, new_position);
+
+    bool worthwhile = samples.size() >= minimum_samples && span_after < span_before * (1.0 - gain);
+    size_t moved = 0;
+    if (worthwhile) {
+        std::vector<std::string> macs;
+        macs.reserve(order.size());
+        for (size_t node : order) {
+            macs.push_back(nodes[node]);
+        }
+        moved = context.anchors.compact(macs);
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    counters.passes++;
+    counters.compactions += worthwhile ? 1 : 0;
+    counters.anchors_moved += moved;
+    counters.span_before = span_before;
+    counters.span_after = worthwhile ? span_after : span_before;
+    counters.last_duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    return worthwhile;
+}
+
+bool AnchorCompactor::compact_async(std::function<void()> done) {
+    if (running.exchange(true)) {
+        return false;
+    }
+    if (background.joinable()) {
+        background.join();
+    }
+    background = std::thread([this, done = std::move(done)]() {
+        compact();
+        running.store(false);
+        if (done) {
+            done();
+        }
+    });
+    return true;
+}
+
+bool AnchorCompactor::in_progress() const {
+    return running.load();
+}
+
+AnchorCompactionStats AnchorCompactor::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return counters;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "processing.h"
+
+/**
+ * @brief Counters of an AnchorCompactor since construction
+ */
+struct AnchorCompactionStats {
+    size_t passes = 0;             // Completed compaction passes
+    size_t compactions = 0;        // Passes that moved the anchors
+    size_t anchors_moved = 0;
+    double span_before = 0.0;      // Mean distance, in anchors, between co-visible anchors before the last pass
+    double span_after = 0.0;       // Same in the layout the last pass chose (equal to span_before if it kept the layout)
+    double last_duration_ms = 0.0;
+};
+
+/**
+ * @brief Lays out the registry's anchors so that anchors heard together sit next to each other
+ *
+ * A pass builds the co-visibility graph of the context's CoVisibilityLog samples, orders
+ * the anchors with reverse Cuthill-McKee and, if that brings co-visible anchors at least
+ * min_gain closer than the current memory layout, calls AnchorRegistry::compact with the
+ * new order. Processing never stops: readers keep their version and updates made
+ * through old anchors are forwarded to the new copies.
+ *
+ * Passes run on a background thread of their own so the reactor and the workers are
+ * never held up by a large site.
+ *
+ * Example:
+ *     reactor.add_periodic(interval_ms, [&]() { compactor.compact_async(); });
+ */
+class AnchorCompactor {
+    public:
+        /**
+         * @param processing_context Context whose registry and co-visibility log are used
+         * @param min_samples Fewer co-visibility samples leave the layout alone
+         * @param min_gain Relative reduction of the mean edge span needed to compact
+         */
+        AnchorCompactor(ProcessingContext& processing_context,
+                        size_t min_samples = Config::ANCHOR_COMPACTION_MIN_SAMPLES,
+                        float min_gain = Config::ANCHOR_COMPACTION_MIN_GAIN);
+
+        /**
+         * @brief Wait for a running pass
+         */
+        ~AnchorCompactor();
+
+        AnchorCompactor(const AnchorCompactor&) = delete;
+        AnchorCompactor& operator=(const AnchorCompactor&) = delete;
+
+        /**
+         * @brief Run one pass on the calling thread
+         * @return bool true if the anchors were moved
+         */
+        bool compact();
+
+        /**
+         * @brief Start a pass on the background thread; ignored while one is still running
+         * @param done Called on the background thread when the pass ends, may be empty
+         * @return bool true if a pass was started
+         */
+        bool compact_async(std::function<void()> done = {});
+
+        /**
+         * @brief Check whether a background pass is running
+         */
+        bool in_progress() const;
+
+        /**
+         * @brief Gets a copy of the counters since construction (thread-safe)
+         */
+        AnchorCompactionStats stats() const;
+
+    private:
+        ProcessingContext& context;
+        size_t minimum_samples;
+        float gain;
+
+        std::thread background;
+        std::atomic<bool> running{false};
+        mutable std::mutex stats_mutex;
+        AnchorCompactionStats counters;   // Guarded by stats_mutex
+};
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "anchor_layout.h"
+
+/*COVISIBILITYLOG*/
+//constructor:
+CoVisibilityLog::CoVisibilityLog(size_t window, size_t sample_every)
+    : capacity(std::max<size_t>(window, 1)), every(std::max<size_t>(sample_every, 1)) {
+}
+
+//methods:
+void CoVisibilityLog::record(const std::vector<Anchor*>& heard) {
+    if (heard.size() < 2 || messages.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+        return;
+    }
+    std::vector<std::string> macs;
+    macs.reserve(heard.size());
+    for (const Anchor* anchor : heard) {
+        macs.push_back(anchor->get_mac_address());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ring.size() < capacity) {
+        ring.push_back(std::move(macs));
+    } else {
+        ring[next] = std::move(macs);
+    }
+    next = (next + 1) % capacity;
+    total++;
+}
+
+std::vector<std::vector<std::string>> CoVisibilityLog::recent() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ring.size() < capacity) {
+        return ring;
+    }
+    std::vector<std::vector<std::string>> ordered(ring.begin() + next, ring.end());
+    ordered.insert(ordered.end(), ring.begin(), ring.begin() + next);
+    return ordered;
+}
+
+size_t CoVisibilityLog::samples() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total;
+}
+
+
+/*ORDERING*/
+std::vector<std::vector<size_t>> covisibility_graph(const std::vector<std::vector<std::string>>& observations,
+                                                    const std::vector<std::string>& nodes) {
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        index.emplace(nodes[i], i);
+    }
+
+    std::vector<std::vector<size_t>> adjacency(nodes.size());
+    std::vector<size_t> heard;
+    for (const auto& observation : observations) {
+        heard.clear();
+        for (const auto& mac : observation) {
+            auto it = index.find(mac);
+            if (it != index.end()) {
+                heard.push_back(it->second);
+            }
+        }
+        for (size_t a = 0; a < heard.size(); a++) {
+            for (size_t b = a + 1; b < heard.size(); b++) {
+                if (heard[a] != heard[b]) {
+                    adjacency[heard[a]].push_back(heard[b]);
+                    adjacency[heard[b]].push_back(heard[a]);
+                }
+            }
+        }
+    }
+
+    for (auto& neighbours : adjacency) {
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    }
+    return adjacency;
+}
+
+std::vector<size_t> reverse_cuthill_mckee(const std::vector<std::vector<size_t>>& adjacency) {
+    size_t count = adjacency.size();
+    auto by_degree = [&adjacency](size_t lhs, size_t rhs) {
+        return adjacency[lhs].size() != adjacency[rhs].size() ? adjacency[lhs].size() < adjacency[rhs].size() : lhs < rhs;
+    };
+
+    // Component start candidates, lowest degree first
+    std::vector<size_t> starts;
+    std::vector<size_t> isolated;
+    for (size_t node = 0; node < count; node++) {
+        (adjacency[node].empty() ? isolated : starts).push_back(node);
+    }
+    std::sort(starts.begin(), starts.end(), by_degree);
+
+    std::vector<size_t> order;
+    order.reserve(count);
+    std::vector<bool> visited(count, false);
+    std::vector<size_t> neighbours;
+    for (size_t start : starts) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = true;
+        size_t head = order.size();
+        order.push_back(start);
+        while (head < order.size()) {
+            size_t node = order[head++];
+            neighbours.clear();
+            for (size_t neighbour : adjacency[node]) {
+                if (!visited[neighbour]) {
+                    visited[neighbour] = true;
+                    neighbours.push_back(neighbour);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end(), by_degree);
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    order.insert(order.end(), isolated.begin(), isolated.end());
+    return order;
+}
+
+double mean_edge_span(const std::vector<std::vector<size_t>>& adjacency, const std::vector<size_t>& position) {
+    double total = 0.0;
+    size_t edges = 0;
+    for (size_t node = 0; node < adjacency.size(); node++) {
+        for (size_t neighbour : adjacency[node]) {
+            if (neighbour > node) {
+                total += position[node] > position[neighbour] ? position[node] - position[neighbour]
+                                                               : position[neighbour] - position[node];
+                edges++;
+            }
+        }
+    }
+    return edges > 0 ? total / edges : 0.0;
+}
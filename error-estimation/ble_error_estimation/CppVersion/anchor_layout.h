@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "models.h"
+
+/**
+ * @brief Sampled record of which anchors tags hear together
+ *
+ * Every sample_every-th message's anchor list is kept (by MAC) in a ring of the last
+ * window samples. record() is called on the hot path by every worker: unsampled
+ * messages cost one relaxed atomic increment, sampled ones a short critical section.
+ */
+class CoVisibilityLog {
+    public:
+        /**
+         * @param window Sampled messages kept
+         * @param sample_every Keep one message in this many (1 keeps all)
+         */
+        explicit CoVisibilityLog(size_t window = Config::COVISIBILITY_WINDOW,
+                                 size_t sample_every = Config::COVISIBILITY_SAMPLE_EVERY);
+
+        CoVisibilityLog(const CoVisibilityLog&) = delete;
+        CoVisibilityLog& operator=(const CoVisibilityLog&) = delete;
+
+        /**
+         * @brief Note the anchors one message was heard by (thread-safe)
+         * @param heard Anchors of the message; lists of fewer than two anchors are ignored
+         */
+        void record(const std::vector<Anchor*>& heard);
+
+        /**
+         * @brief Copy of the samples in the window, oldest first (thread-safe)
+         * @return std::vector<std::vector<std::string>> MAC addresses heard together, one list per sample
+         */
+        std::vector<std::vector<std::string>> recent() const;
+
+        /**
+         * @brief Gets the number of samples kept since construction
+         * @return size_t Samples, including those that left the window
+         */
+        size_t samples() const;
+
+    private:
+        size_t capacity;
+        size_t every;
+        std::atomic<uint64_t> messages{0};
+
+        mutable std::mutex mutex;
+        std::vector<std::vector<std::string>> ring;   // Guarded by mutex
+        size_t next = 0;
+        size_t total = 0;
+};
+
+/**
+ * @brief Undirected graph with an edge between every two anchors heard by the same message
+ *
+ * Node i is nodes[i]; MACs of observations that are not nodes are ignored.
+ *
+ * @param observations Anchor MAC lists, e.g. CoVisibilityLog::recent()
+ * @param nodes MAC addresses of the graph's nodes
+ * @return std::vector<std::vector<size_t>> Sorted, duplicate-free neighbour list of every node
+ */
+std::vector<std::vector<size_t>> covisibility_graph(const std::vector<std::vector<std::string>>& observations,
+                                                    const std::vector<std::string>& nodes);
+
+/**
+ * @brief Reverse Cuthill-McKee ordering of a graph
+ *
+ * Breadth-first from a lowest-degree node of each component, neighbours by increasing
+ * degree, then reversed. Neighbours end up close to each other in the order, which
+ * keeps co-visible anchors in nearby cache lines once laid out in it. Isolated nodes
+ * come last, in index order.
+ *
+ * @param adjacency Neighbour lists (see covisibility_graph)
+ * @return std::vector<size_t> Node indices in their new order
+ */
+std::vector<size_t> reverse_cuthill_mckee(const std::vector<std::vector<size_t>>& adjacency);
+
+/**
+ * @brief Mean distance, in positions, between the ends of the graph's edges
+ *
+ * @param adjacency Neighbour lists
+ * @param position Position of every node in the layout
+ * @return double Mean |position[a] - position[b]| over edges, 0 without edges
+ */
+double mean_edge_span(const std::vector<std::vector<size_t>>& adjacency, const std::vector<size_t>& position);
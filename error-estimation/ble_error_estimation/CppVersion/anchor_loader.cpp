@@ -0,0 +1,184 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include "anchor_loader.h"
+
+namespace {
+    /**
+     * @brief SAX handler keeping macAddress, x, y and z of each element of the top-level array
+     *
+     * Depth 1 is the array, depth 2 an element; anything deeper is skipped.
+     */
+    class DongleListHandler : public nlohmann::json_sax<json> {
+        public:
+            DongleListPage page;
+            std::string error;
+
+            explicit DongleListHandler(float created_at) : timestamp(created_at) {}
+
+            bool null() override { return value_seen(); }
+            bool boolean(bool) override { return value_seen(); }
+            bool number_integer(number_integer_t value) override { return number(static_cast<float>(value)); }
+            bool number_unsigned(number_unsigned_t value) override { return number(static_cast<float>(value)); }
+            bool number_float(number_float_t value, const string_t&) override { return number(static_cast<float>(value)); }
+            bool binary(binary_t&) override { return value_seen(); }
+
+            bool string(string_t& value) override {
+                if (depth == 2 && key_name == "macAddress") {
+                    entry.mac = std::move(value);
+                }
+                return value_seen();
+            }
+
+            bool start_object(std::size_t) override {
+                if (depth == 0) {
+                    error = "Dongles list is not an array";
+                    return false;
+                }
+                if (depth == 1) {
+                    page.entries++;
+                    entry = Entry();
+                }
+                depth++;
+                return true;
+            }
+
+            bool key(string_t& name) override {
+                if (depth == 2) {
+                    key_name = std::move(name);
+                }
+                return true;
+            }
+
+            bool end_object() override {
+                depth--;
+                if (depth == 1 && !entry.mac.empty() && entry.found == 3) {
+                    page.anchors.push_back(std::make_unique<Anchor>(entry.mac, std::make_tuple(entry.x, entry.y, entry.z), timestamp));
+                }
+                return true;
+            }
+
+            bool start_array(std::size_t) override {
+                if (depth == 1) {
+                    page.entries++;
+                }
+                depth++;
+                return true;
+            }
+
+            bool end_array() override {
+                depth--;
+                return true;
+            }
+
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+                error = ex.what();
+                return false;
+            }
+
+        private:
+            struct Entry {
+                std::string mac;
+                float x = 0.0f;
+                float y = 0.0f;
+                float z = 0.0f;
+                int found = 0;                 // Coordinates seen so far
+            };
+
+            float timestamp;
+            int depth = 0;
+            std::string key_name;
+            Entry entry;
+
+            bool value_seen() {
+                if (depth == 0) {
+                    error = "Dongles list is not an array";
+                    return false;
+                }
+                if (depth == 1) {
+                    page.entries++;
+                }
+                return true;
+            }
+
+            bool number(float value) {
+                if (depth == 2) {
+                    if (key_name == "x") {
+                        entry.x = value;
+                        entry.found++;
+                    } else if (key_name == "y") {
+                        entry.y = value;
+                        entry.found++;
+                    } else if (key_name == "z") {
+                        entry.z = value;
+                        entry.found++;
+                    }
+                }
+                return value_seen();
+            }
+    };
+}
+
+/*ANCHOR LIST*/
+std::string anchor_list_page_url(const std::string& list_url, size_t page, size_t page_size) {
+    char separator = list_url.find('?') == std::string::npos ? '?' : '&';
+    return list_url + separator + "page=" + std::to_string(page) + "&size=" + std::to_string(page_size);
+}
+
+DongleListPage parse_dongle_list(const std::string& response) {
+    return parse_dongle_list(response.data(), response.size());
+}
+
+DongleListPage parse_dongle_list(const char* data, size_t size) {
+    // Same creation timestamp as anchors fetched one by one
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    DongleListHandler handler(static_cast<float>(now));
+    if (!json::sax_parse(data, data + size, &handler)) {
+        throw std::runtime_error("Invalid dongles list: " + handler.error);
+    }
+    return std::move(handler.page);
+}
+
+size_t publish_site_anchors(ProcessingContext& context, std::vector<std::unique_ptr<Anchor>> anchors) {
+    // Prefer anchors another runner already shared: they carry its calibration
+    for (auto& anchor : anchors) {
+        if (auto shared_anchor = attach_shared_anchor(context, anchor->get_mac_address())) {
+            anchor = std::move(shared_anchor);
+        } else {
+            publish_shared_anchor(context, *anchor);
+        }
+    }
+    return context.anchors.insert_all(std::move(anchors));
+}
+
+SiteLoadResult load_site_anchors(ProcessingContext& context, const AnchorPageFetcher& fetch_page,
+                                 size_t page_size, size_t max_pages) {
+    SiteLoadResult result;
+
+    try {
+        for (size_t page_number = 0; page_number < max_pages; page_number++) {
+            DongleListPage page = parse_dongle_list(fetch_page(page_number));
+            result.pages++;
+            result.entries += page.entries;
+            result.anchors_added += publish_site_anchors(context, std::move(page.anchors));
+
+            if (page.entries != page_size) {
+                result.complete = true;
+                break;
+            }
+        }
+        if (!result.complete) {
+            result.error = "Stopped after " + std::to_string(max_pages) + " pages";
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    if (context.anchors.size() > 0) {
+        context.anchors_initialized = true;
+    }
+    return result;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "processing.h"
+
+/**
+ * @brief Fetch one page of the dongles API site list
+ *
+ * Called with the zero-based page number; returns the JSON array of that page.
+ * Throws std::runtime_error if the page cannot be fetched.
+ */
+using AnchorPageFetcher = std::function<std::string(size_t page)>;
+
+/**
+ * @brief Anchors parsed from one page of the dongles list
+ */
+struct DongleListPage {
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    size_t entries = 0;            // Array elements seen, including ones skipped for missing fields
+};
+
+/**
+ * @brief Outcome of a bulk anchor load
+ */
+struct SiteLoadResult {
+    size_t pages = 0;              // Pages requested
+    size_t entries = 0;            // Dongles listed by the API
+    size_t anchors_added = 0;      // Anchors newly published in the registry
+    bool complete = false;         // false if a page failed; the remaining anchors fall back to per-MAC lookups
+    std::string error;
+};
+
+/**
+ * @brief Build the URL of one page of the dongles list
+ *
+ * @param list_url Dongles endpoint, with or without a query string
+ * @param page Zero-based page number
+ * @param page_size Dongles per page
+ * @return std::string Request URL with page and size parameters
+ */
+std::string anchor_list_page_url(const std::string& list_url, size_t page, size_t page_size);
+
+/**
+ * @brief Parse a dongles list response into anchors without building a JSON document
+ *
+ * The response is streamed through a SAX parser: only macAddress, x, y and z of each
+ * element are kept, every other field (and any nested object) is skipped. Elements
+ * missing one of them are counted but produce no anchor.
+ *
+ * @param response JSON array returned by the dongles API
+ * @return DongleListPage Anchors in response order
+ * @throws std::runtime_error If the response is not valid JSON or not an array
+ */
+DongleListPage parse_dongle_list(const std::string& response);
+
+/**
+ * @brief Parse a dongles list held in a buffer, e.g. a memory-mapped file, without copying it
+ *
+ * @param data First byte of the JSON array
+ * @param size Length of the JSON array in bytes
+ * @return DongleListPage Anchors in list order
+ * @throws std::runtime_error If the buffer is not valid JSON or not an array
+ */
+DongleListPage parse_dongle_list(const char* data, size_t size);
+
+/**
+ * @brief Publish a batch of the site's anchors in the registry as one version
+ *
+ * Anchors another runner already shared are attached from the shared-memory store,
+ * keeping their calibration; the others are shared for the next runner.
+ *
+ * @param context Processing context receiving the anchors
+ * @param anchors Anchors of the site, consumed
+ * @return size_t Anchors newly published in the registry
+ */
+size_t publish_site_anchors(ProcessingContext& context, std::vector<std::unique_ptr<Anchor>> anchors);
+
+/**
+ * @brief Load the whole site's anchors page by page and publish them in the registry
+ *
+ * Requests pages until one holds fewer than page_size dongles (or more: a server
+ * that ignores pagination answers with the full list at once). Each page is
+ * published as one registry version. Anchors another runner already shared are
+ * attached from the shared-memory store, keeping their calibration.
+ *
+ * When at least one anchor is loaded the context is marked initialized, so the
+ * first message no longer discovers anchors one MAC at a time.
+ *
+ * @param context Processing context receiving the anchors
+ * @param fetch_page Source of pages
+ * @param page_size Dongles per page
+ * @param max_pages Upper bound on requests
+ * @return SiteLoadResult Counts, and the error that stopped the load if any
+ */
+SiteLoadResult load_site_anchors(ProcessingContext& context, const AnchorPageFetcher& fetch_page,
+                                 size_t page_size = Config::ANCHOR_LIST_PAGE_SIZE,
+                                 size_t max_pages = Config::ANCHOR_LIST_MAX_PAGES);
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <iostream>
+
+#include "anchor_refresher.h"
+
+/*ANCHORREFRESHER*/
+//constructor:
+AnchorRefresher::AnchorRefresher(ProcessingContext& processing_context, HttpClient& http_client, std::string list_url,
+                                 std::string username, std::string password,
+                                 size_t list_page_size, size_t list_max_pages, float move_tolerance)
+    : context(processing_context), http(http_client), url(std::move(list_url)),
+      api_username(std::move(username)), api_password(std::move(password)),
+      page_size(list_page_size), max_pages(list_max_pages), tolerance(move_tolerance) {}
+
+//methods:
+bool AnchorRefresher::refresh(std::function<void()> done) {
+    if (running) {
+        return false;
+    }
+    running = true;
+    on_done = std::move(done);
+    request_page(0);
+    return true;
+}
+
+bool AnchorRefresher::in_progress() const {
+    return running;
+}
+
+const AnchorRefreshStats& AnchorRefresher::stats() const {
+    return counters;
+}
+
+//helpers:
+void AnchorRefresher::request_page(size_t page) {
+    HttpRequest request{anchor_list_page_url(url, page, page_size), api_username, api_password};
+    if (page < pages.size()) {
+        if (!pages[page].etag.empty()) {
+            request.headers.push_back("If-None-Match: " + pages[page].etag);
+        }
+        if (!pages[page].last_modified.empty()) {
+            request.headers.push_back("If-Modified-Since: " + pages[page].last_modified);
+        }
+    }
+    counters.pages_requested++;
+    http.get(request, [this, page](HttpResponse response) { on_page(page, std::move(response)); });
+}
+
+void AnchorRefresher::on_page(size_t page, HttpResponse response) {
+    if (!response.ok()) {
+        std::cerr << "Anchor refresh failed on page " << page << ": " << response.error << std::endl;
+        finish(true);
+        return;
+    }
+
+    if (page >= pages.size()) {
+        pages.resize(page + 1);
+    }
+    PageValidators& validators = pages[page];
+
+    if (response.not_modified()) {
+        counters.pages_not_modified++;
+    } else {
+        DongleListPage parsed;
+        try {
+            parsed = parse_dongle_list(response.body);
+        } catch (const std::exception& e) {
+            std::cerr << "Anchor refresh failed on page " << page << ": " << e.what() << std::endl;
+            finish(true);
+            return;
+        }
+        counters.bytes_received += response.body.size();
+        validators.etag = std::move(response.etag);
+        validators.last_modified = std::move(response.last_modified);
+        validators.entries = parsed.entries;
+        apply(parsed);
+    }
+
+    // Same end-of-list rule as the initial load, using the cached size of unchanged pages
+    if (validators.entries == page_size && page + 1 < max_pages) {
+        request_page(page + 1);
+    } else {
+        // Pages past a shorter list are stale
+        pages.resize(page + 1);
+        finish(false);
+    }
+}
+
+/**
+ * @brief Add new dongles and relocate moved ones, in one registry version per page
+ */
+void AnchorRefresher::apply(DongleListPage& page) {
+    std::vector<std::unique_ptr<Anchor>> changes;
+    std::vector<std::string> moved_macs;
+    {
+        // Anchor pointers stay valid while this read guard is alive
+        auto guard = context.anchors.read();
+        for (auto& listed : page.anchors) {
+            Anchor* known = guard.find(listed->get_mac_address());
+            if (!known) {
+                // Another runner may already have calibrated it
+                auto shared_anchor = attach_shared_anchor(context, listed->get_mac_address());
+                changes.push_back(shared_anchor ? std::move(shared_anchor) : std::move(listed));
+                continue;
+            }
+            PointR3 from = known->get_coord();
+            PointR3 to = listed->get_coord();
+            if (std::fabs(std::get<0>(from) - std::get<0>(to)) > tolerance ||
+                std::fabs(std::get<1>(from) - std::get<1>(to)) > tolerance ||
+                std::fabs(std::get<2>(from) - std::get<2>(to)) > tolerance) {
+                moved_macs.push_back(known->get_mac_address());
+                changes.push_back(known->relocated(to));
+            }
+        }
+    }
+    if (changes.empty()) {
+        return;
+    }
+
+    for (const auto& anchor : changes) {
+        publish_shared_anchor(context, *anchor);
+    }
+    size_t total = changes.size();
+    size_t replaced = context.anchors.replace_all(std::move(changes));
+    counters.anchors_moved += replaced;
+    counters.anchors_added += total - replaced;
+    for (const auto& mac : moved_macs) {
+        std::cout << "Anchor " << mac << " moved, coordinates refreshed" << std::endl;
+    }
+}
+
+void AnchorRefresher::finish(bool failed) {
+    running = false;
+    counters.refreshes++;
+    if (failed) {
+        counters.failures++;
+    }
+    if (context.anchors.size() > 0) {
+        context.anchors_initialized = true;
+    }
+    if (on_done) {
+        std::function<void()> done = std::move(on_done);
+        on_done = {};
+        done();
+    }
+}
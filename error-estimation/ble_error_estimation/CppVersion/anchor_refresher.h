@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "anchor_loader.h"
+#include "http_client.h"
+
+/**
+ * @brief Counters of an AnchorRefresher since construction
+ */
+struct AnchorRefreshStats {
+    size_t refreshes = 0;          // Completed refresh passes
+    size_t pages_requested = 0;
+    size_t pages_not_modified = 0; // Pages answered 304
+    size_t bytes_received = 0;     // Decompressed body bytes of pages that changed
+    size_t anchors_added = 0;      // Dongles that appeared since the previous pass
+    size_t anchors_moved = 0;      // Dongles whose coordinates changed
+    size_t failures = 0;           // Passes stopped by a failed page
+};
+
+/**
+ * @brief Periodically revalidates the site's dongles list and applies only what changed
+ *
+ * Each pass walks the paginated dongles list with conditional requests: every page is
+ * sent with the ETag (If-None-Match) and Last-Modified (If-Modified-Since) validators of
+ * its previous answer, so an unchanged page costs a 304 with no body. Requests go
+ * through the reactor's HttpClient, which reuses kept-alive connections and easy
+ * handles and asks for compressed responses.
+ *
+ * Pages that did change are diffed against the registry: new dongles are added, and
+ * dongles whose coordinates moved by more than the tolerance are replaced by a
+ * relocated copy (Anchor::relocated), bumping their version. Unchanged anchors are
+ * left alone. Dongles missing from the list are kept.
+ *
+ * All methods must be called on the reactor thread.
+ *
+ * Example:
+ *     reactor.add_periodic(interval_ms, [&]() { refresher.refresh(); });
+ */
+class AnchorRefresher {
+    public:
+        /**
+         * @param processing_context Context whose registry is kept up to date
+         * @param http_client Client driven by the reactor
+         * @param list_url Dongles endpoint (see anchor_list_page_url)
+         * @param username Basic auth user, empty for none
+         * @param password Basic auth password
+         * @param page_size Dongles per page
+         * @param max_pages Upper bound on requests per pass
+         * @param move_tolerance Smallest coordinate change, in meters, treated as a move
+         */
+        AnchorRefresher(ProcessingContext& processing_context, HttpClient& http_client, std::string list_url,
+                        std::string username, std::string password,
+                        size_t page_size = Config::ANCHOR_LIST_PAGE_SIZE,
+                        size_t max_pages = Config::ANCHOR_LIST_MAX_PAGES,
+                        float move_tolerance = Config::ANCHOR_MOVE_TOLERANCE_M);
+
+        AnchorRefresher(const AnchorRefresher&) = delete;
+        AnchorRefresher& operator=(const AnchorRefresher&) = delete;
+
+        /**
+         * @brief Start a refresh pass; ignored while one is still running
+         * @param done Called on the reactor thread when the pass ends, may be empty
+         * @return bool true if a pass was started
+         */
+        bool refresh(std::function<void()> done = {});
+
+        /**
+         * @brief Check whether a pass is running
+         */
+        bool in_progress() const;
+
+        /**
+         * @brief Gets the counters since construction
+         */
+        const AnchorRefreshStats& stats() const;
+
+    private:
+        struct PageValidators {
+            std::string etag;
+            std::string last_modified;
+            size_t entries = 0;        // Dongles on the page when it was last downloaded
+        };
+
+        ProcessingContext& context;
+        HttpClient& http;
+        std::string url;
+        std::string api_username;
+        std::string api_password;
+        size_t page_size;
+        size_t max_pages;
+        float tolerance;
+
+        std::vector<PageValidators> pages;   // Validators of each page from the previous pass
+        bool running = false;
+        std::function<void()> on_done;
+        AnchorRefreshStats counters;
+
+        void request_page(size_t page);
+        void on_page(size_t page, HttpResponse response);
+        void apply(DongleListPage& page);
+        void finish(bool failed);
+};
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include "anchor_registry.h"
+
+/*READGUARD*/
+//constructor:
+AnchorRegistry::ReadGuard::ReadGuard(const AnchorRegistry* owner, size_t reader_slot, const Version* pinned)
+    : registry(owner), slot(reader_slot), version(pinned) {
+}
+
+AnchorRegistry::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : registry(other.registry), slot(other.slot), version(other.version) {
+    other.registry = nullptr;
+}
+
+AnchorRegistry::ReadGuard::~ReadGuard() {
+    if (registry) {
+        registry->readers[slot].epoch.store(0, std::memory_order_release);
+    }
+}
+
+//methods:
+Anchor* AnchorRegistry::ReadGuard::find(const std::string& mac) const {
+    auto it = version->by_mac.find(mac);
+    return it != version->by_mac.end() ? it->second : nullptr;
+}
+
+size_t AnchorRegistry::ReadGuard::size() const {
+    return version->by_mac.size();
+}
+
+const std::unordered_map<std::string, Anchor*>& AnchorRegistry::ReadGuard::anchors() const {
+    return version->by_mac;
+}
+
+
+/*ANCHORREGISTRY*/
+//constructor:
+AnchorRegistry::AnchorRegistry() : current(new Version()) {
+}
+
+AnchorRegistry::~AnchorRegistry() {
+    delete current.load();
+}
+
+//methods:
+AnchorRegistry::ReadGuard AnchorRegistry::read() const {
+    // Pin the epoch before loading the version: a writer that retires this version
+    // afterwards will see the pinned slot and defer freeing it
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+
+    while (true) {
+        for (size_t i = 0; i < MAX_READERS; i++) {
+            size_t slot = (start + i) % MAX_READERS;
+            uint64_t expected = 0;
+            if (readers[slot].epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+                return ReadGuard(this, slot, current.load(std::memory_order_seq_cst));
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool AnchorRegistry::insert(std::unique_ptr<Anchor> anchor) {
+    std::vector<std::unique_ptr<Anchor>> single;
+    single.push_back(std::move(anchor));
+    return insert_all(std::move(single)) == 1;
+}
+
+size_t AnchorRegistry::insert_all(std::vector<std::unique_ptr<Anchor>> anchors) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto next = std::make_unique<Version>(*current.load(std::memory_order_relaxed));
+    size_t added = 0;
+
+    for (auto& anchor : anchors) {
+        if (!anchor) {
+            continue;
+        }
+        std::string mac = anchor->get_mac_address();
+        if (owned.count(mac)) {
+            continue;
+        }
+        next->by_mac[mac] = anchor.get();
+        owned[mac] = OwnedAnchor(anchor.release());
+        added++;
+    }
+
+    if (added > 0) {
+        publish(std::move(next), {});
+    }
+    return added;
+}
+
+size_t AnchorRegistry::replace_all(std::vector<std::unique_ptr<Anchor>> anchors) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto next = std::make_unique<Version>(*current.load(std::memory_order_relaxed));
+    std::vector<OwnedAnchor> replaced;
+    bool changed = false;
+
+    for (auto& anchor : anchors) {
+        if (!anchor) {
+            continue;
+        }
+        std::string mac = anchor->get_mac_address();
+        next->by_mac[mac] = anchor.get();
+        OwnedAnchor& slot = owned[mac];
+        if (slot) {
+            replaced.push_back(std::move(slot));
+        }
+        slot = OwnedAnchor(anchor.release());
+        changed = true;
+    }
+
+    size_t replaced_count = replaced.size();
+    if (changed) {
+        publish(std::move(next), std::move(replaced));
+    }
+    return replaced_count;
+}
+
+bool AnchorRegistry::remove(const std::string& mac) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto owned_it = owned.find(mac);
+    if (owned_it == owned.end()) {
+        return false;
+    }
+
+    auto next = std::make_unique<Version>(*current.load(std::memory_order_relaxed));
+    next->by_mac.erase(mac);
+    std::vector<OwnedAnchor> removed;
+    removed.push_back(std::move(owned_it->second));
+    owned.erase(owned_it);
+
+    publish(std::move(next), std::move(removed));
+    return true;
+}
+
+size_t AnchorRegistry::compact(const std::vector<std::string>& order) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (owned.empty()) {
+        return 0;
+    }
+
+    // Requested order first, then anchors the caller did not know about in their current order
+    std::vector<std::unordered_map<std::string, OwnedAnchor>::iterator> placement;
+    placement.reserve(owned.size());
+    std::unordered_set<std::string> placed;
+    for (const auto& mac : order) {
+        auto it = owned.find(mac);
+        if (it != owned.end() && placed.insert(mac).second) {
+            placement.push_back(it);
+        }
+    }
+    std::vector<std::unordered_map<std::string, OwnedAnchor>::iterator> rest;
+    for (auto it = owned.begin(); it != owned.end(); ++it) {
+        if (!placed.count(it->first)) {
+            rest.push_back(it);
+        }
+    }
+    std::sort(rest.begin(), rest.end(), [](const auto& lhs, const auto& rhs) {
+        return std::less<const Anchor*>()(lhs->second.get(), rhs->second.get());
+    });
+    placement.insert(placement.end(), rest.begin(), rest.end());
+
+    // One block starting on a cache line; consecutive anchors are adjacent in memory
+    constexpr size_t CACHE_LINE = 64;
+    static_assert(CACHE_LINE % alignof(Anchor) == 0, "anchor alignment exceeds a cache line");
+    size_t space = placement.size() * sizeof(Anchor) + CACHE_LINE;
+    auto arena = std::make_unique<Arena>();
+    arena->storage.reset(new unsigned char[space]);
+    void* cursor = arena->storage.get();
+    std::align(CACHE_LINE, placement.size() * sizeof(Anchor), cursor, space);
+    Anchor* block = static_cast<Anchor*>(cursor);
+
+    auto next = std::make_unique<Version>(*current.load(std::memory_order_relaxed));
+    std::vector<OwnedAnchor> moved_from;
+    moved_from.reserve(placement.size());
+    for (size_t i = 0; i < placement.size(); i++) {
+        OwnedAnchor& slot = placement[i]->second;
+        Anchor* moved = slot->move_into(block + i);
+        arena->live++;
+        next->by_mac[placement[i]->first] = moved;
+        moved_from.push_back(std::move(slot));
+        slot = OwnedAnchor(moved, AnchorDeleter{arena.get()});
+    }
+    arena.release();   // Owned by its anchors from here on
+
+    size_t moved_count = moved_from.size();
+    publish(std::move(next), std::move(moved_from));
+    return moved_count;
+}
+
+size_t AnchorRegistry::size() const {
+    return read().size();
+}
+
+size_t AnchorRegistry::collect_garbage() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return reclaim();
+}
+
+size_t AnchorRegistry::pending_reclamation() const {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return retired.size();
+}
+
+//helpers:
+// Runs under writer_mutex (reclaim) or in the destructor, so the arena count needs no atomics
+void AnchorRegistry::AnchorDeleter::operator()(Anchor* anchor) const {
+    if (!arena) {
+        delete anchor;
+        return;
+    }
+    anchor->~Anchor();
+    if (--arena->live == 0) {
+        delete arena;
+    }
+}
+
+// Caller holds writer_mutex
+void AnchorRegistry::publish(std::unique_ptr<Version> next, std::vector<OwnedAnchor> removed) {
+    const Version* old = current.exchange(next.release(), std::memory_order_seq_cst);
+    // Readers pinned at or before this epoch may still hold the old version (and the removed anchors)
+    uint64_t epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    retired.push_back(Retired{epoch, std::unique_ptr<const Version>(old), std::move(removed)});
+    reclaim();
+}
+
+// Caller holds writer_mutex
+size_t AnchorRegistry::reclaim() {
+    uint64_t oldest_reader = std::numeric_limits<uint64_t>::max();
+    for (const auto& reader : readers) {
+        uint64_t pinned = reader.epoch.load(std::memory_order_seq_cst);
+        if (pinned != 0) {
+            oldest_reader = std::min(oldest_reader, pinned);
+        }
+    }
+
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+        [oldest_reader](const Retired& item) { return item.epoch < oldest_reader; }),
+        retired.end());
+    return retired.size();
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "models.h"
+
+/**
+ * @brief Read-mostly registry of anchors with lock-free lookups (RCU)
+ *
+ * The MAC → Anchor* map is immutable once published. Writers (insert, remove)
+ * copy the current map, modify the copy and publish it with a single atomic
+ * pointer swap, so a rehash never happens under a reader. Writers serialize on
+ * a private mutex; readers never take it.
+ *
+ * Memory is reclaimed with epoch-based reclamation: a ReadGuard pins the global
+ * epoch in a per-registry reader slot for its lifetime, and old maps and removed
+ * anchors are freed only once every reader that could still see them is gone.
+ * Anchor pointers obtained through a guard therefore stay valid until that guard
+ * is destroyed; they must not be kept beyond it.
+ *
+ * Anchors are allocated one by one as they are discovered. compact() copies them into
+ * one contiguous block in a given order (see anchor_layout.h), so anchors that are
+ * heard together share cache lines and pages; the old copies forward their updates
+ * (Anchor::move_into) and are retired like removed anchors.
+ *
+ * Typical reader:
+ *     auto guard = registry.read();
+ *     if (Anchor* anchor = guard.find(mac)) { ... }
+ */
+class AnchorRegistry {
+    private:
+        struct Version {
+            std::unordered_map<std::string, Anchor*> by_mac;
+        };
+
+    public:
+        static constexpr size_t MAX_READERS = 128;   // Concurrent ReadGuards; extra readers wait for a slot
+
+        /**
+         * @brief Epoch-pinned read section over one published version of the registry
+         *
+         * Lookups through a guard are plain hash-map reads with no atomics or locks.
+         * The guard sees the registry as it was when the guard was taken.
+         */
+        class ReadGuard {
+            public:
+                ReadGuard(ReadGuard&& other) noexcept;
+                ReadGuard& operator=(ReadGuard&&) = delete;
+                ReadGuard(const ReadGuard&) = delete;
+                ReadGuard& operator=(const ReadGuard&) = delete;
+                ~ReadGuard();
+
+                /**
+                 * @brief Look up an anchor by MAC address
+                 * @param mac MAC address of the anchor
+                 * @return Anchor* Anchor valid for the guard's lifetime, nullptr if unknown
+                 */
+                Anchor* find(const std::string& mac) const;
+
+                /**
+                 * @brief Gets the number of anchors in this version
+                 * @return size_t Number of anchors
+                 */
+                size_t size() const;
+
+                /**
+                 * @brief Gets the full MAC → anchor map of this version
+                 * @return const std::unordered_map<std::string, Anchor*>& Map valid for the guard's lifetime
+                 */
+                const std::unordered_map<std::string, Anchor*>& anchors() const;
+
+            private:
+                friend class AnchorRegistry;
+                ReadGuard(const AnchorRegistry* owner, size_t reader_slot, const Version* pinned);
+
+                const AnchorRegistry* registry;
+                size_t slot;
+                const Version* version;
+        };
+
+        /**
+         * @brief Construct an empty registry
+         */
+        AnchorRegistry();
+
+        /**
+         * @brief Destroy the registry and every anchor it owns; no ReadGuard may be alive
+         */
+        ~AnchorRegistry();
+
+        AnchorRegistry(const AnchorRegistry&) = delete;
+        AnchorRegistry& operator=(const AnchorRegistry&) = delete;
+
+        /**
+         * @brief Enter a read section
+         * @return ReadGuard Guard pinning the current version
+         */
+        ReadGuard read() const;
+
+        /**
+         * @brief Add one anchor, publishing a new version
+         *
+         * If an anchor with the same MAC is already registered the new one is
+         * discarded (concurrent discovery of the same anchor is harmless).
+         *
+         * @param anchor Anchor to take ownership of
+         * @return bool true if the anchor was added
+         */
+        bool insert(std::unique_ptr<Anchor> anchor);
+
+        /**
+         * @brief Add many anchors at once, publishing a single new version
+         *
+         * Prefer this when a whole site is discovered: one map copy instead of one per anchor.
+         *
+         * @param anchors Anchors to take ownership of; duplicates are discarded
+         * @return size_t Number of anchors added
+         */
+        size_t insert_all(std::vector<std::unique_ptr<Anchor>> anchors);
+
+        /**
+         * @brief Add or replace many anchors at once, publishing a single new version
+         *
+         * An anchor whose MAC is already registered takes the place of the registered
+         * one (e.g. after Anchor::relocated). Readers holding the old anchor keep using
+         * it safely; it is freed once they have all left their read sections.
+         *
+         * @param anchors Anchors to take ownership of
+         * @return size_t Number of anchors that replaced a registered one
+         */
+        size_t replace_all(std::vector<std::unique_ptr<Anchor>> anchors);
+
+        /**
+         * @brief Remove an anchor, publishing a new version
+         *
+         * Readers that already hold the anchor keep using it safely; it is freed
+         * once they have all left their read sections.
+         *
+         * @param mac MAC address of the anchor
+         * @return bool true if the anchor was registered
+         */
+        bool remove(const std::string& mac);
+
+        /**
+         * @brief Move every anchor into one contiguous block, in the given order, publishing a new version
+         *
+         * Readers keep running on the previous version; anchors they still hold forward
+         * their updates to the new copies. Registered anchors missing from order follow
+         * in their current order; unknown MACs are skipped.
+         *
+         * @param order MAC addresses in the desired memory order
+         * @return size_t Number of anchors moved
+         */
+        size_t compact(const std::vector<std::string>& order);
+
+        /**
+         * @brief Gets the number of anchors in the current version
+         * @return size_t Number of anchors
+         */
+        size_t size() const;
+
+        /**
+         * @brief Free retired versions and anchors that no reader can still see
+         * @return size_t Number of retired objects still waiting for readers
+         */
+        size_t collect_garbage();
+
+        /**
+         * @brief Gets the number of retired versions and anchors not yet freed
+         * @return size_t Objects pending reclamation
+         */
+        size_t pending_reclamation() const;
+
+    private:
+        // Block of anchors built by compact(), freed when its last anchor is destroyed
+        struct Arena {
+            std::unique_ptr<unsigned char[]> storage;
+            size_t live = 0;
+        };
+
+        // Destroys an anchor allocated on its own (arena == nullptr) or inside an arena
+        struct AnchorDeleter {
+            Arena* arena = nullptr;
+            void operator()(Anchor* anchor) const;
+        };
+        using OwnedAnchor = std::unique_ptr<Anchor, AnchorDeleter>;
+
+        struct Retired {
+            uint64_t epoch;
+            std::unique_ptr<const Version> version;
+            std::vector<OwnedAnchor> anchors;
+        };
+
+        // Reader side
+        std::atomic<const Version*> current;
+        mutable std::atomic<uint64_t> global_epoch{1};
+        struct alignas(64) ReaderSlot {
+            std::atomic<uint64_t> epoch{0};   // 0 = free, otherwise the epoch pinned by a reader
+        };
+        mutable std::array<ReaderSlot, MAX_READERS> readers;
+
+        // Writer side, guarded by writer_mutex
+        mutable std::mutex writer_mutex;
+        std::unordered_map<std::string, OwnedAnchor> owned;
+        std::vector<Retired> retired;
+
+        void publish(std::unique_ptr<Version> next, std::vector<OwnedAnchor> removed);
+        size_t reclaim();
+};
@@ -0,0 +1,366 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "anchor_source.h"
+
+namespace {
+    /**
+     * @brief Read-only private mapping of a whole file, unmapped on destruction
+     */
+    class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) {
+                int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(error));
+                }
+                length = static_cast<size_t>(info.st_size);
+                if (length > 0) {
+                    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped == MAP_FAILED) {
+                        int error = errno;
+                        ::close(fd);
+                        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+                    }
+                    // Parsed front to back exactly once
+                    ::madvise(mapped, length, MADV_SEQUENTIAL | MADV_WILLNEED);
+                    bytes = static_cast<const char*>(mapped);
+                }
+                ::close(fd);
+            }
+
+            ~MappedFile() {
+                if (bytes) {
+                    ::munmap(const_cast<char*>(bytes), length);
+                }
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const char* data() const { return bytes; }
+            size_t size() const { return length; }
+
+        private:
+            const char* bytes = nullptr;
+            size_t length = 0;
+    };
+
+    // Creation timestamp shared by every anchor of one load, as for API anchors
+    float creation_timestamp() {
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return static_cast<float>(now);
+    }
+
+    void trim(const char*& begin, const char*& end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) {
+            begin++;
+        }
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '"')) {
+            end--;
+        }
+    }
+
+    bool parse_float(const char* begin, const char* end, float& value) {
+        trim(begin, end);
+        auto result = std::from_chars(begin, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    DongleListPage parse_csv_survey(const char* data, size_t size) {
+        DongleListPage page;
+        float timestamp = creation_timestamp();
+        const char* cursor = data;
+        const char* file_end = data + size;
+        bool first_row = true;
+
+        while (cursor < file_end) {
+            const char* line_end = static_cast<const char*>(std::memchr(cursor, '\n', file_end - cursor));
+            if (!line_end) {
+                line_end = file_end;
+            }
+            const char* line = cursor;
+            cursor = line_end + 1;
+
+            const char* content_end = line_end;
+            trim(line, content_end);
+            if (line == content_end || *line == '#') {
+                continue;
+            }
+
+            // mac,x,y,z; extra columns are ignored
+            const char* fields[5];
+            fields[0] = line;
+            int found = 1;
+            for (const char* c = line; c < content_end && found < 5; c++) {
+                if (*c == ',') {
+                    fields[found++] = c + 1;
+                }
+            }
+            auto field_end = [&](int i) { return i + 1 < found ? fields[i + 1] - 1 : content_end; };
+
+            float x = 0.0f;
+            float y = 0.0f;
+            float z = 0.0f;
+            bool valid = found >= 4 &&
+                         parse_float(fields[1], field_end(1), x) &&
+                         parse_float(fields[2], field_end(2), y) &&
+                         parse_float(fields[3], field_end(3), z);
+            if (first_row) {
+                first_row = false;
+                if (!valid) {
+                    continue;              // Header
+                }
+            }
+
+            page.entries++;
+            const char* mac_begin = fields[0];
+            const char* mac_end = field_end(0);
+            trim(mac_begin, mac_end);
+            if (valid && mac_begin < mac_end) {
+                page.anchors.push_back(std::make_unique<Anchor>(std::string(mac_begin, mac_end),
+                                                                std::make_tuple(x, y, z), timestamp));
+            }
+        }
+        return page;
+    }
+
+    DongleListPage parse_binary_survey(const char* data, size_t size) {
+        SiteSurveyHeader header;
+        if (size < sizeof(header)) {
+            throw std::runtime_error("Binary site survey truncated before its header");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, SITE_SURVEY_MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Not a binary site survey");
+        }
+        if (header.version != SITE_SURVEY_VERSION) {
+            throw std::runtime_error("Unsupported binary site survey version " + std::to_string(header.version));
+        }
+        if ((size - sizeof(header)) / sizeof(SiteSurveyRecord) < header.count) {
+            throw std::runtime_error("Binary site survey truncated: " + std::to_string(header.count) + " records announced");
+        }
+
+        DongleListPage page;
+        page.entries = header.count;
+        page.anchors.reserve(header.count);
+        float timestamp = creation_timestamp();
+        const char* record_data = data + sizeof(header);
+        for (uint32_t i = 0; i < header.count; i++) {
+            SiteSurveyRecord record;
+            std::memcpy(&record, record_data + i * sizeof(record), sizeof(record));
+            if (record.mac_length == 0 || record.mac_length > sizeof(record.mac)) {
+                continue;
+            }
+            page.anchors.push_back(std::make_unique<Anchor>(std::string(record.mac, record.mac_length),
+                                                            std::make_tuple(record.x, record.y, record.z), timestamp));
+        }
+        return page;
+    }
+}
+
+/*ANCHORSOURCE*/
+//methods:
+AsyncAnchorFetcher AnchorSource::fetcher() {
+    return [this](const std::string& anch_mac, std::function<void(std::string, std::string)> done) {
+        fetch(anch_mac, std::move(done));
+    };
+}
+
+
+/*HTTPANCHORSOURCE*/
+//constructor:
+HttpAnchorSource::HttpAnchorSource(Reactor& reactor_ref, HttpClient& http_client, std::string anchor_url_template,
+                                   std::string dongles_list_url, std::string username, std::string password,
+                                   size_t list_page_size, size_t list_max_pages)
+    : reactor(reactor_ref), http(http_client), anchor_url(std::move(anchor_url_template)),
+      list_url(std::move(dongles_list_url)), api_username(std::move(username)), api_password(std::move(password)),
+      page_size(list_page_size), max_pages(list_max_pages) {}
+
+//methods:
+std::string HttpAnchorSource::name() const {
+    return list_url;
+}
+
+SiteLoadResult HttpAnchorSource::load(ProcessingContext& context) {
+    return load_site_anchors(context, [this](size_t page) {
+        HttpRequest request{anchor_list_page_url(list_url, page, page_size), api_username, api_password};
+        HttpResponse response = http.get_blocking(request);
+        if (!response.ok()) {
+            throw std::runtime_error(response.error);
+        }
+        return std::move(response.body);
+    }, page_size, max_pages);
+}
+
+void HttpAnchorSource::fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) {
+    // Sent by the reactor's HTTP client; waiting messages are suspended, not blocked
+    HttpRequest request{anchor_api_url(anchor_url, anch_mac), api_username, api_password};
+    reactor.post([this, request, done = std::move(done)]() {
+        http.get(request, [done](HttpResponse response) { done(std::move(response.body), std::move(response.error)); });
+    });
+}
+
+
+/*SITE SURVEY*/
+SiteSurveyFormat detect_site_survey_format(const char* data, size_t size) {
+    if (size >= sizeof(SITE_SURVEY_MAGIC) && std::memcmp(data, SITE_SURVEY_MAGIC, sizeof(SITE_SURVEY_MAGIC)) == 0) {
+        return SiteSurveyFormat::Binary;
+    }
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            continue;
+        }
+        return c == '[' ? SiteSurveyFormat::Json : SiteSurveyFormat::Csv;
+    }
+    return SiteSurveyFormat::Csv;
+}
+
+DongleListPage parse_site_survey(const char* data, size_t size, SiteSurveyFormat format) {
+    switch (format) {
+        case SiteSurveyFormat::Binary:
+            return parse_binary_survey(data, size);
+        case SiteSurveyFormat::Json:
+            return parse_dongle_list(data, size);
+        case SiteSurveyFormat::Csv:
+        default:
+            return parse_csv_survey(data, size);
+    }
+}
+
+void write_site_survey(const std::string& path, const std::vector<const Anchor*>& anchors) {
+    SiteSurveyHeader header;
+    std::memcpy(header.magic, SITE_SURVEY_MAGIC, sizeof(header.magic));
+    header.version = SITE_SURVEY_VERSION;
+    header.count = static_cast<uint32_t>(anchors.size());
+
+    std::vector<SiteSurveyRecord> records(anchors.size());
+    for (size_t i = 0; i < anchors.size(); i++) {
+        const std::string& mac = anchors[i]->get_mac_address();
+        if (mac.empty() || mac.size() > sizeof(records[i].mac)) {
+            throw std::runtime_error("MAC address does not fit a site survey record: " + mac);
+        }
+        SiteSurveyRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.mac_length = static_cast<uint8_t>(mac.size());
+        std::memcpy(record.mac, mac.data(), mac.size());
+        PointR3 coord = anchors[i]->get_coord();
+        record.x = std::get<0>(coord);
+        record.y = std::get<1>(coord);
+        record.z = std::get<2>(coord);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SiteSurveyRecord)));
+    if (!file) {
+        throw std::runtime_error("Cannot write site survey " + path);
+    }
+}
+
+
+/*SITESURVEYFILESOURCE*/
+//constructor:
+SiteSurveyFileSource::SiteSurveyFileSource(std::string survey_path) : path(std::move(survey_path)) {}
+
+//methods:
+std::string SiteSurveyFileSource::name() const {
+    return path;
+}
+
+SiteLoadResult SiteSurveyFileSource::load(ProcessingContext& context) {
+    SiteLoadResult result;
+    try {
+        MappedFile file(path);
+        DongleListPage survey = parse_site_survey(file.data(), file.size(),
+                                                  detect_site_survey_format(file.data(), file.size()));
+        result.pages = 1;
+        result.entries = survey.entries;
+        result.anchors_added = publish_site_anchors(context, std::move(survey.anchors));
+        result.complete = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    if (context.anchors.size() > 0) {
+        context.anchors_initialized = true;
+    }
+    return result;
+}
+
+void SiteSurveyFileSource::fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) {
+    done("", "Anchor " + anch_mac + " is not in site survey " + path);
+}
+
+
+/*MEMORYANCHORSOURCE*/
+//methods:
+void MemoryAnchorSource::add(const std::string& anch_mac, PointR3 coord) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (coords.insert_or_assign(anch_mac, coord).second) {
+        order.push_back(anch_mac);
+    }
+}
+
+size_t MemoryAnchorSource::fetches() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fetch_count;
+}
+
+std::string MemoryAnchorSource::name() const {
+    return "memory";
+}
+
+SiteLoadResult MemoryAnchorSource::load(ProcessingContext& context) {
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        float timestamp = creation_timestamp();
+        anchors.reserve(order.size());
+        for (const auto& anch_mac : order) {
+            anchors.push_back(std::make_unique<Anchor>(anch_mac, coords.at(anch_mac), timestamp));
+        }
+    }
+
+    SiteLoadResult result;
+    result.pages = 1;
+    result.entries = anchors.size();
+    result.anchors_added = publish_site_anchors(context, std::move(anchors));
+    result.complete = true;
+    if (context.anchors.size() > 0) {
+        context.anchors_initialized = true;
+    }
+    return result;
+}
+
+void MemoryAnchorSource::fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) {
+    json list = json::array();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fetch_count++;
+        auto it = coords.find(anch_mac);
+        if (it != coords.end()) {
+            list.push_back({{"macAddress", anch_mac}, {"x", std::get<0>(it->second)},
+                            {"y", std::get<1>(it->second)}, {"z", std::get<2>(it->second)}});
+        }
+    }
+    // Same answer as the API: an empty array for unknown MACs
+    done(list.dump(), "");
+}
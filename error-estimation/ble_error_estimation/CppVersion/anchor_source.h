@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "anchor_loader.h"
+#include "http_client.h"
+#include "pipeline.h"
+
+/**
+ * @brief Where the site's anchor coordinates come from
+ *
+ * A source loads the whole site into the registry at startup, and answers per-MAC
+ * lookups for anchors that messages mention later (AnchorResolver). Lookups answer
+ * with a dongles API response so every source feeds the same resolver path.
+ *
+ * Implementations: HttpAnchorSource (dongles API), SiteSurveyFileSource (local
+ * CSV/JSON/binary site survey, no network) and MemoryAnchorSource (tests, benchmarks).
+ */
+class AnchorSource {
+    public:
+        virtual ~AnchorSource() = default;
+
+        /**
+         * @brief Describe the source for logs, e.g. its URL or path
+         */
+        virtual std::string name() const = 0;
+
+        /**
+         * @brief Publish the whole site in the registry; marks the context initialized when anchors were loaded
+         * @param context Processing context receiving the anchors
+         * @return SiteLoadResult Counts, and the error that stopped the load if any
+         */
+        virtual SiteLoadResult load(ProcessingContext& context) = 0;
+
+        /**
+         * @brief Look one anchor up without blocking (AsyncAnchorFetcher contract)
+         * @param anch_mac MAC address of the anchor
+         * @param done Called exactly once, from any thread, with the dongles API response or an error
+         */
+        virtual void fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) = 0;
+
+        /**
+         * @brief Gets a fetcher for AnchorResolver calling fetch(); the source must outlive it
+         */
+        AsyncAnchorFetcher fetcher();
+};
+
+/**
+ * @brief Anchors from the remote dongles API: the paginated list at startup, one request per unknown MAC
+ *
+ * load() runs the reactor on the calling thread (HttpClient::get_blocking) and must be
+ * called before Reactor::run(); fetch() may be called from any thread.
+ */
+class HttpAnchorSource : public AnchorSource {
+    public:
+        /**
+         * @param reactor Reactor driving the client
+         * @param http_client Client sending the requests
+         * @param anchor_url Per-MAC URL template with a {} placeholder (see anchor_api_url)
+         * @param list_url Dongles list endpoint (see anchor_list_page_url)
+         * @param username Basic auth user, empty for none
+         * @param password Basic auth password
+         * @param page_size Dongles per page
+         * @param max_pages Upper bound on list requests
+         */
+        HttpAnchorSource(Reactor& reactor, HttpClient& http_client, std::string anchor_url, std::string list_url,
+                         std::string username, std::string password,
+                         size_t page_size = Config::ANCHOR_LIST_PAGE_SIZE,
+                         size_t max_pages = Config::ANCHOR_LIST_MAX_PAGES);
+
+        std::string name() const override;
+        SiteLoadResult load(ProcessingContext& context) override;
+        void fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) override;
+
+    private:
+        Reactor& reactor;
+        HttpClient& http;
+        std::string anchor_url;
+        std::string list_url;
+        std::string api_username;
+        std::string api_password;
+        size_t page_size;
+        size_t max_pages;
+};
+
+/**
+ * @brief Layout of a site survey file
+ */
+enum class SiteSurveyFormat {
+    Csv,       // "mac,x,y,z" per line; optional header, blank lines and # comments skipped
+    Json,      // Dongles list: array of objects with macAddress, x, y and z
+    Binary     // SITE_SURVEY_MAGIC header, then fixed-size SiteSurveyRecord entries
+};
+
+/**
+ * @brief Fixed-size entry of a binary site survey, little-endian floats
+ */
+struct SiteSurveyRecord {
+    uint8_t mac_length;
+    char mac[19];              // Not NUL-terminated when 19 bytes long
+    float x;
+    float y;
+    float z;
+};
+static_assert(sizeof(SiteSurveyRecord) == 32, "SiteSurveyRecord must stay 32 bytes");
+
+/**
+ * @brief Header of a binary site survey: magic, format version and record count
+ */
+struct SiteSurveyHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+static_assert(sizeof(SiteSurveyHeader) == 16, "SiteSurveyHeader must stay 16 bytes");
+
+constexpr char SITE_SURVEY_MAGIC[8] = {'B', 'L', 'E', 'S', 'I', 'T', 'E', '1'};
+constexpr uint32_t SITE_SURVEY_VERSION = 1;
+
+/**
+ * @brief Guess a survey's layout: binary by its magic, otherwise JSON if it starts with '[', else CSV
+ *
+ * @param data First bytes of the file
+ * @param size Length of the file in bytes
+ * @return SiteSurveyFormat Detected layout
+ */
+SiteSurveyFormat detect_site_survey_format(const char* data, size_t size);
+
+/**
+ * @brief Parse a site survey held in memory into anchors
+ *
+ * @param data First byte of the survey
+ * @param size Length of the survey in bytes
+ * @param format Layout of the survey
+ * @return DongleListPage Anchors in file order; entries counts every record, including malformed ones
+ * @throws std::runtime_error If the survey is malformed beyond skipping single entries
+ */
+DongleListPage parse_site_survey(const char* data, size_t size, SiteSurveyFormat format);
+
+/**
+ * @brief Write anchors' MAC addresses and coordinates as a binary site survey
+ *
+ * Lets a CSV or JSON survey be converted once into the fastest layout to load.
+ *
+ * @param path File to create or replace
+ * @param anchors Anchors to write
+ * @throws std::runtime_error If the file cannot be written or a MAC address is longer than 19 bytes
+ */
+void write_site_survey(const std::string& path, const std::vector<const Anchor*>& anchors);
+
+/**
+ * @brief Anchors from a local site-survey file; startup needs no network
+ *
+ * The file is memory-mapped and parsed in place, without reading it into a buffer.
+ * Every anchor of the site is in the file, so fetch() only reports MACs missing from it.
+ */
+class SiteSurveyFileSource : public AnchorSource {
+    public:
+        /**
+         * @param survey_path Path to a .csv, .json or binary survey; the layout is detected from its content
+         */
+        explicit SiteSurveyFileSource(std::string survey_path);
+
+        std::string name() const override;
+        SiteLoadResult load(ProcessingContext& context) override;
+        void fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) override;
+
+    private:
+        std::string path;
+};
+
+/**
+ * @brief Anchors held in memory, for tests and offline benchmarks
+ *
+ * fetch() answers from the same anchors, so the per-MAC lookup path can be exercised
+ * without calling load(). Thread-safe.
+ */
+class MemoryAnchorSource : public AnchorSource {
+    public:
+        MemoryAnchorSource() = default;
+
+        /**
+         * @brief Add or move an anchor
+         */
+        void add(const std::string& anch_mac, PointR3 coord);
+
+        /**
+         * @brief Gets the number of fetch() calls since construction
+         */
+        size_t fetches() const;
+
+        std::string name() const override;
+        SiteLoadResult load(ProcessingContext& context) override;
+        void fetch(const std::string& anch_mac, std::function<void(std::string body, std::string error)> done) override;
+
+    private:
+        mutable std::mutex mutex;
+        std::vector<std::string> order;                        // MACs in insertion order, guarded by mutex
+        std::unordered_map<std::string, PointR3> coords;       // Guarded by mutex
+        size_t fetch_count = 0;
+};
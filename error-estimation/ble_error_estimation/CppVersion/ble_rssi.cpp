@@ -0,0 +1,235 @@
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ble_rssi.h"
+#include "processing.h"
+#include "position_ring.h"
+#include "state_snapshot.h"
+
+static_assert(BLE_RSSI_MAC_BYTES == PositionRecord::MAC_BYTES, "C API MACs must fit a PositionRecord");
+
+/**
+ * @brief Engine state behind one ble_rssi_context handle
+ */
+struct ble_rssi_context {
+    ProcessingContext processing;
+    std::mutex estimates_mutex;
+    std::unordered_map<std::string, ble_rssi_estimate> estimates;   // Latest estimate per tag, guarded by estimates_mutex
+};
+
+namespace {
+    bool valid_mac(const char* mac) {
+        return mac != nullptr && mac[0] != '\0' && strnlen(mac, BLE_RSSI_MAC_BYTES) < BLE_RSSI_MAC_BYTES;
+    }
+
+    // Creation timestamp of registered anchors, as for API anchors
+    float creation_timestamp() {
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return static_cast<float>(now);
+    }
+
+    // Exceptions never cross the C ABI
+    template <typename Body>
+    int guarded(Body body) {
+        try {
+            return body();
+        } catch (const std::bad_alloc&) {
+            return BLE_RSSI_INTERNAL_ERROR;
+        } catch (const std::exception& e) {
+            DEBUG_LOG("ble_rssi: " << e.what());
+            return BLE_RSSI_INTERNAL_ERROR;
+        }
+    }
+
+    ble_rssi_estimate estimate_observation(ble_rssi_context& context, const ble_rssi_observation& observation,
+                                           std::vector<PositionProducer::Reading>& readings, PositionRecord& record) {
+        ble_rssi_estimate estimate{};
+        estimate.timestamp = observation.timestamp;
+        if (!valid_mac(observation.tag_mac) || (observation.reading_count > 0 && observation.readings == nullptr)) {
+            estimate.status = BLE_RSSI_INVALID_ARGUMENT;
+            return estimate;
+        }
+        std::strcpy(estimate.tag_mac, observation.tag_mac);
+
+        readings.clear();
+        for (size_t i = 0; i < observation.reading_count; i++) {
+            const ble_rssi_reading& reading = observation.readings[i];
+            if (!valid_mac(reading.anchor_mac)) {
+                estimate.status = BLE_RSSI_INVALID_ARGUMENT;
+                return estimate;
+            }
+            readings.push_back({reading.anchor_mac, reading.rssi});
+        }
+        PositionProducer::fill_record(record, observation.tag_mac, observation.x, observation.y, observation.z,
+                                      observation.timestamp, readings.data(), readings.size());
+
+        // Anchors come from ble_rssi_register_anchors only: unknown ones are ignored
+        TagMessage message = parse_position_record(context.processing, record);
+        std::optional<json> output = evaluate_tag_message(context.processing, message);
+        if (!output) {
+            estimate.status = BLE_RSSI_NO_KNOWN_ANCHORS;
+            return estimate;
+        }
+
+        estimate.status = BLE_RSSI_OK;
+        estimate.error_estimate = (*output)["error_estimate"].get<float>();
+        estimate.anchor_count = static_cast<uint32_t>((*output)["anchors_selected_for_estimation"].size());
+        estimate.warning_anchors = static_cast<uint32_t>((*output)["warning_anchors"].size());
+        estimate.faulty_anchors = static_cast<uint32_t>((*output)["faulty_anchors"].size());
+
+        std::lock_guard<std::mutex> lock(context.estimates_mutex);
+        context.estimates[observation.tag_mac] = estimate;
+        return estimate;
+    }
+}
+
+/*CAPI*/
+uint32_t ble_rssi_abi_version(void) {
+    return BLE_RSSI_ABI_VERSION;
+}
+
+const char* ble_rssi_status_message(int status) {
+    switch (status) {
+        case BLE_RSSI_OK: return "ok";
+        case BLE_RSSI_INVALID_ARGUMENT: return "invalid argument";
+        case BLE_RSSI_NO_KNOWN_ANCHORS: return "no registered anchor in the observation";
+        case BLE_RSSI_NOT_FOUND: return "not found";
+        case BLE_RSSI_BUFFER_TOO_SMALL: return "buffer too small";
+        case BLE_RSSI_BAD_SNAPSHOT: return "malformed state snapshot";
+        case BLE_RSSI_INTERNAL_ERROR: return "internal error";
+        default: return "unknown status";
+    }
+}
+
+ble_rssi_context* ble_rssi_create(void) {
+    ble_rssi_context* context = new (std::nothrow) ble_rssi_context();
+    if (context) {
+        // Anchors are registered by the caller: no discovery on the first observation
+        context->processing.anchors_initialized = true;
+    }
+    return context;
+}
+
+void ble_rssi_destroy(ble_rssi_context* context) {
+    delete context;
+}
+
+int ble_rssi_register_anchors(ble_rssi_context* context, const ble_rssi_anchor* anchors, size_t count, size_t* added) {
+    if (!context || (count > 0 && !anchors)) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!valid_mac(anchors[i].mac)) {
+            return BLE_RSSI_INVALID_ARGUMENT;
+        }
+    }
+    return guarded([&]() {
+        float timestamp = creation_timestamp();
+        std::vector<std::unique_ptr<Anchor>> created;
+        created.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            created.push_back(std::make_unique<Anchor>(anchors[i].mac,
+                                                       std::make_tuple(anchors[i].x, anchors[i].y, anchors[i].z),
+                                                       timestamp));
+        }
+        size_t inserted = context->processing.anchors.insert_all(std::move(created));
+        if (added) {
+            *added = inserted;
+        }
+        return BLE_RSSI_OK;
+    });
+}
+
+size_t ble_rssi_anchor_count(const ble_rssi_context* context) {
+    return context ? context->processing.anchors.size() : 0;
+}
+
+int ble_rssi_submit(ble_rssi_context* context, const ble_rssi_observation* observations, size_t count,
+                    ble_rssi_estimate* estimates) {
+    if (!context || (count > 0 && !observations)) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        std::vector<PositionProducer::Reading> readings;
+        PositionRecord record{};
+        for (size_t i = 0; i < count; i++) {
+            ble_rssi_estimate estimate = estimate_observation(*context, observations[i], readings, record);
+            if (estimates) {
+                estimates[i] = estimate;
+            }
+        }
+        return BLE_RSSI_OK;
+    });
+}
+
+int ble_rssi_get_estimate(ble_rssi_context* context, const char* tag_mac, ble_rssi_estimate* estimate) {
+    if (!context || !valid_mac(tag_mac) || !estimate) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        std::lock_guard<std::mutex> lock(context->estimates_mutex);
+        auto it = context->estimates.find(tag_mac);
+        if (it == context->estimates.end()) {
+            return BLE_RSSI_NOT_FOUND;
+        }
+        *estimate = it->second;
+        return BLE_RSSI_OK;
+    });
+}
+
+int ble_rssi_get_anchor_state(ble_rssi_context* context, const char* anchor_mac, ble_rssi_anchor_state* state) {
+    if (!context || !anchor_mac || !state) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        auto guard = context->processing.anchors.read();
+        Anchor* anchor = guard.find(anchor_mac);
+        if (!anchor) {
+            return BLE_RSSI_NOT_FOUND;
+        }
+        AnchorState current = anchor->snapshot();
+        *state = ble_rssi_anchor_state{current.RSSI_0, current.n, current.ewma, current.last_seen, current.version};
+        return BLE_RSSI_OK;
+    });
+}
+
+int ble_rssi_export_state(ble_rssi_context* context, void* buffer, size_t capacity, size_t* size) {
+    if (!context || !size) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        std::string snapshot = export_state_snapshot(context->processing.anchors);
+        *size = snapshot.size();
+        if (!buffer || capacity < snapshot.size()) {
+            return BLE_RSSI_BUFFER_TOO_SMALL;
+        }
+        std::memcpy(buffer, snapshot.data(), snapshot.size());
+        return BLE_RSSI_OK;
+    });
+}
+
+int ble_rssi_import_state(ble_rssi_context* context, const void* snapshot, size_t size, size_t* anchors) {
+    if (!context || (size > 0 && !snapshot)) {
+        return BLE_RSSI_INVALID_ARGUMENT;
+    }
+    StateSnapshotImport imported;
+    try {
+        imported = import_state_snapshot(context->processing.anchors, static_cast<const char*>(snapshot), size);
+    } catch (const std::bad_alloc&) {
+        return BLE_RSSI_INTERNAL_ERROR;
+    } catch (const std::exception& e) {
+        DEBUG_LOG("ble_rssi: " << e.what());
+        return BLE_RSSI_BAD_SNAPSHOT;
+    }
+    if (anchors) {
+        *anchors = imported.added + imported.restored;
+    }
+    return BLE_RSSI_OK;
+}
@@ -0,0 +1,151 @@
+#ifndef BLE_RSSI_H
+#define BLE_RSSI_H
+
+/*
+ * Embeddable error estimation: the engine's core (anchor registry, path loss model,
+ * health and Kalman calibration) behind a plain C ABI, for positioning engines that
+ * link it in-process instead of exchanging MQTT messages with ble_rssi_runner.
+ *
+ * No MQTT, HTTP or threads: the caller registers the site's anchors, submits
+ * observation batches and reads the estimates back. A context may be used from
+ * several threads at once; calls never throw and report failures as ble_rssi_status.
+ *
+ * Typical use:
+ *     ble_rssi_context* ctx = ble_rssi_create();
+ *     ble_rssi_register_anchors(ctx, anchors, anchor_count, NULL);
+ *     ble_rssi_submit(ctx, observations, count, estimates);
+ *     ...
+ *     ble_rssi_destroy(ctx);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define BLE_RSSI_API __attribute__((visibility("default")))
+#else
+#define BLE_RSSI_API
+#endif
+
+/* Bumped whenever a struct layout or a function signature changes */
+#define BLE_RSSI_ABI_VERSION 1
+
+#define BLE_RSSI_MAC_BYTES 16      /* MAC addresses are NUL-terminated, up to 15 characters */
+
+typedef enum ble_rssi_status {
+    BLE_RSSI_OK = 0,
+    BLE_RSSI_INVALID_ARGUMENT = 1,  /* NULL pointer, or a MAC address too long */
+    BLE_RSSI_NO_KNOWN_ANCHORS = 2,  /* None of the observation's anchors are registered */
+    BLE_RSSI_NOT_FOUND = 3,         /* No estimate for this tag yet */
+    BLE_RSSI_BUFFER_TOO_SMALL = 4,  /* The required size was stored, nothing else written */
+    BLE_RSSI_BAD_SNAPSHOT = 5,      /* Not a state snapshot, or a truncated one */
+    BLE_RSSI_INTERNAL_ERROR = 6
+} ble_rssi_status;
+
+typedef struct ble_rssi_context ble_rssi_context;
+
+/* Anchor (BLE dongle) of the site, position in meters */
+typedef struct ble_rssi_anchor {
+    const char* mac;
+    float x;
+    float y;
+    float z;
+} ble_rssi_anchor;
+
+typedef struct ble_rssi_reading {
+    const char* anchor_mac;
+    float rssi;                     /* dBm */
+} ble_rssi_reading;
+
+/* One tag position computed by the positioning engine and the readings it used */
+typedef struct ble_rssi_observation {
+    const char* tag_mac;
+    float x;
+    float y;
+    float z;
+    double timestamp;               /* Seconds since the epoch */
+    const ble_rssi_reading* readings;
+    size_t reading_count;           /* Readings over 10 dB below the strongest are ignored, as in the engine */
+} ble_rssi_observation;
+
+typedef struct ble_rssi_estimate {
+    char tag_mac[BLE_RSSI_MAC_BYTES];
+    int32_t status;                 /* BLE_RSSI_OK, or why this observation has no estimate */
+    float error_estimate;           /* CEP95 radius in meters */
+    double timestamp;               /* Of the observation */
+    uint32_t anchor_count;          /* Registered anchors the estimate used */
+    uint32_t warning_anchors;       /* Of those, anchors with degraded health */
+    uint32_t faulty_anchors;        /* Of those, anchors considered faulty */
+} ble_rssi_estimate;
+
+/* Calibration and health of one anchor */
+typedef struct ble_rssi_anchor_state {
+    float rssi_0;                   /* RSSI at 1 meter, dBm */
+    float n;                        /* Path loss exponent */
+    float ewma;                     /* Health metric, >= 4 warning, >= 8 faulty */
+    float last_seen;
+    uint32_t version;               /* Updates applied to the anchor */
+} ble_rssi_anchor_state;
+
+/* BLE_RSSI_ABI_VERSION the library was built with; compare it with the header's */
+BLE_RSSI_API uint32_t ble_rssi_abi_version(void);
+
+/* Short English description of a status */
+BLE_RSSI_API const char* ble_rssi_status_message(int status);
+
+/* New context with no anchors, NULL if out of memory */
+BLE_RSSI_API ble_rssi_context* ble_rssi_create(void);
+
+/* Free a context; no other call may be using it. NULL is ignored. */
+BLE_RSSI_API void ble_rssi_destroy(ble_rssi_context* context);
+
+/*
+ * Register anchors, all published at once. Anchors already registered keep their
+ * position and calibration. added (optional) receives the number of new anchors.
+ * Nothing is registered if any entry is invalid.
+ */
+BLE_RSSI_API int ble_rssi_register_anchors(ble_rssi_context* context, const ble_rssi_anchor* anchors, size_t count,
+                                           size_t* added);
+
+/* Number of registered anchors */
+BLE_RSSI_API size_t ble_rssi_anchor_count(const ble_rssi_context* context);
+
+/*
+ * Estimate the error of each observation, in order, and update the calibration and
+ * health of the anchors involved. estimates (optional) receives one entry per
+ * observation, each with its own status; readings of unregistered anchors are ignored.
+ * Returns BLE_RSSI_OK once the whole batch was processed.
+ */
+BLE_RSSI_API int ble_rssi_submit(ble_rssi_context* context, const ble_rssi_observation* observations, size_t count,
+                                 ble_rssi_estimate* estimates);
+
+/* Latest estimate submitted for a tag, BLE_RSSI_NOT_FOUND if none */
+BLE_RSSI_API int ble_rssi_get_estimate(ble_rssi_context* context, const char* tag_mac, ble_rssi_estimate* estimate);
+
+/* Current calibration and health of an anchor, BLE_RSSI_NOT_FOUND if not registered */
+BLE_RSSI_API int ble_rssi_get_anchor_state(ble_rssi_context* context, const char* anchor_mac,
+                                           ble_rssi_anchor_state* state);
+
+/*
+ * Write every anchor's position, calibration, health and Kalman filter to buffer.
+ * size receives the snapshot length; with a NULL or too small buffer, only size is
+ * written and BLE_RSSI_BUFFER_TOO_SMALL returned. The snapshot is in host byte order.
+ */
+BLE_RSSI_API int ble_rssi_export_state(ble_rssi_context* context, void* buffer, size_t capacity, size_t* size);
+
+/*
+ * Adopt a snapshot from ble_rssi_export_state, e.g. saved before a restart. Unknown
+ * anchors are registered; registered ones keep their position and continue from the
+ * snapshot's calibration. anchors (optional) receives the number of anchors imported.
+ */
+BLE_RSSI_API int ble_rssi_import_state(ble_rssi_context* context, const void* snapshot, size_t size, size_t* anchors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLE_RSSI_H */
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include "cluster_sync.h"
+
+// Deltas travel between hosts: the fixed layout is only read back as is on little-endian ones
+static_assert(std::endian::native == std::endian::little, "anchor delta messages are little-endian");
+
+std::string shared_subscription_topic(const std::string& group, const std::string& topic) {
+    return "$share/" + group + "/" + topic;
+}
+
+/*CLUSTERSYNC*/
+//constructor:
+ClusterSync::ClusterSync(AnchorRegistry& anchors, std::string instance)
+    : registry(anchors), instance_id(std::move(instance)) {
+    if (instance_id.empty() || instance_id.size() > UINT8_MAX) {
+        throw std::invalid_argument("Cluster instance id must be 1 to 255 bytes long");
+    }
+}
+
+//methods:
+std::vector<std::string> ClusterSync::collect() {
+    std::vector<AnchorDeltaRecord> changed;
+    {
+        auto guard = registry.read();
+        std::lock_guard<std::mutex> lock(sent_mutex);
+        for (const auto& [mac, anchor] : guard.anchors()) {
+            if (mac.empty() || mac.size() > sizeof(AnchorDeltaRecord::mac)) {
+                continue;
+            }
+            AnchorState state = anchor->snapshot();
+            auto sent = sent_versions.find(mac);
+            if (sent != sent_versions.end() && sent->second == state.version) {
+                continue;
+            }
+
+            AnchorDeltaRecord record;
+            std::memset(&record, 0, sizeof(record));
+            record.mac_length = static_cast<uint8_t>(mac.size());
+            std::memcpy(record.mac, mac.data(), mac.size());
+            record.RSSI_0 = state.RSSI_0;
+            record.n = state.n;
+            record.ewma = state.ewma;
+            record.last_seen = state.last_seen;
+            record.version = state.version;
+            changed.push_back(record);
+        }
+    }
+
+    std::vector<std::string> messages;
+    for (size_t begin = 0; begin < changed.size(); begin += MAX_DELTAS_PER_MESSAGE) {
+        size_t end = std::min(changed.size(), begin + MAX_DELTAS_PER_MESSAGE);
+        messages.push_back(encode(changed, begin, end));
+    }
+    return messages;
+}
+
+void ClusterSync::confirm(std::string_view message) {
+    AnchorDeltaHeader header;
+    if (!decode_header(message, header)) {
+        return;
+    }
+    size_t records_offset = sizeof(header) + header.instance_length;
+    std::lock_guard<std::mutex> lock(sent_mutex);
+    for (uint16_t i = 0; i < header.count; i++) {
+        AnchorDeltaRecord record;
+        std::memcpy(&record, message.data() + records_offset + i * sizeof(record), sizeof(record));
+        sent_versions[std::string(record.mac, record.mac_length)] = record.version;
+    }
+    messages_sent.fetch_add(1, std::memory_order_relaxed);
+    deltas_sent.fetch_add(header.count, std::memory_order_relaxed);
+}
+
+void ClusterSync::resync() {
+    std::lock_guard<std::mutex> lock(sent_mutex);
+    sent_versions.clear();
+}
+
+size_t ClusterSync::apply(std::string_view payload) {
+    AnchorDeltaHeader header;
+    if (!decode_header(payload, header)) {
+        messages_rejected.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    size_t records_offset = sizeof(header) + header.instance_length;
+    if (payload.substr(sizeof(header), header.instance_length) == instance_id) {
+        return 0;   // Our own deltas, echoed by the broker
+    }
+    messages_received.fetch_add(1, std::memory_order_relaxed);
+    deltas_received.fetch_add(header.count, std::memory_order_relaxed);
+
+    size_t adopted = 0;
+    auto guard = registry.read();
+    for (uint16_t i = 0; i < header.count; i++) {
+        AnchorDeltaRecord record;
+        std::memcpy(&record, payload.data() + records_offset + i * sizeof(record), sizeof(record));
+        if (record.mac_length == 0 || record.mac_length > sizeof(record.mac)) {
+            continue;
+        }
+        std::string mac(record.mac, record.mac_length);
+        Anchor* anchor = guard.find(mac);
+        if (!anchor) {
+            continue;
+        }
+        AnchorState remote{record.RSSI_0, record.n, record.ewma, record.last_seen, record.version};
+        if (anchor->merge_calibration(remote)) {
+            // Already known cluster-wide: do not send it back
+            std::lock_guard<std::mutex> lock(sent_mutex);
+            sent_versions[mac] = record.version;
+            adopted++;
+            continue;
+        }
+        AnchorState local = anchor->snapshot();
+        if (local.version != remote.version || local.last_seen != remote.last_seen || local.RSSI_0 != remote.RSSI_0 ||
+            local.n != remote.n || local.ewma != remote.ewma) {
+            // The sender is behind on this anchor: send ours again
+            std::lock_guard<std::mutex> lock(sent_mutex);
+            sent_versions.erase(mac);
+        }
+    }
+    deltas_adopted.fetch_add(adopted, std::memory_order_relaxed);
+    return adopted;
+}
+
+const std::string& ClusterSync::instance() const {
+    return instance_id;
+}
+
+ClusterSyncStats ClusterSync::stats() const {
+    ClusterSyncStats current;
+    current.messages_sent = messages_sent.load(std::memory_order_relaxed);
+    current.deltas_sent = deltas_sent.load(std::memory_order_relaxed);
+    current.messages_received = messages_received.load(std::memory_order_relaxed);
+    current.deltas_received = deltas_received.load(std::memory_order_relaxed);
+    current.deltas_adopted = deltas_adopted.load(std::memory_order_relaxed);
+    current.messages_rejected = messages_rejected.load(std::memory_order_relaxed);
+    return current;
+}
+
+//helpers:
+bool ClusterSync::decode_header(std::string_view payload, AnchorDeltaHeader& header) const {
+    if (payload.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, payload.data(), sizeof(header));
+    return std::memcmp(header.magic, ANCHOR_DELTA_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == ANCHOR_DELTA_VERSION &&
+           payload.size() == sizeof(header) + header.instance_length + header.count * sizeof(AnchorDeltaRecord);
+}
+
+std::string ClusterSync::encode(const std::vector<AnchorDeltaRecord>& records, size_t begin, size_t end) const {
+    AnchorDeltaHeader header;
+    std::memcpy(header.magic, ANCHOR_DELTA_MAGIC, sizeof(header.magic));
+    header.version = ANCHOR_DELTA_VERSION;
+    header.instance_length = static_cast<uint8_t>(instance_id.size());
+    header.count = static_cast<uint16_t>(end - begin);
+
+    std::string message;
+    message.reserve(sizeof(header) + instance_id.size() + (end - begin) * sizeof(AnchorDeltaRecord));
+    message.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    message.append(instance_id);
+    message.append(reinterpret_cast<const char*>(records.data() + begin), (end - begin) * sizeof(AnchorDeltaRecord));
+    return message;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "anchor_registry.h"
+
+/**
+ * @brief Fixed-size entry of an anchor delta message: one anchor's calibration and health
+ */
+struct AnchorDeltaRecord {
+    uint8_t mac_length;
+    char mac[19];              // Not NUL-terminated when 19 bytes long
+    float RSSI_0;
+    float n;
+    float ewma;
+    float last_seen;
+    uint32_t version;
+};
+static_assert(sizeof(AnchorDeltaRecord) == 40, "AnchorDeltaRecord layout is part of the delta-sync format");
+
+/**
+ * @brief Header of an anchor delta message, followed by the sender's instance id and the records
+ */
+struct AnchorDeltaHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t instance_length;
+    uint16_t count;
+};
+static_assert(sizeof(AnchorDeltaHeader) == 8, "AnchorDeltaHeader must stay 8 bytes");
+
+constexpr char ANCHOR_DELTA_MAGIC[4] = {'B', 'L', 'E', 'D'};
+constexpr uint8_t ANCHOR_DELTA_VERSION = 1;
+
+/**
+ * @brief Counters of one ClusterSync
+ */
+struct ClusterSyncStats {
+    uint64_t messages_sent = 0;
+    uint64_t deltas_sent = 0;
+    uint64_t messages_received = 0;    // From other instances, well-formed
+    uint64_t deltas_received = 0;
+    uint64_t deltas_adopted = 0;       // Newer than the local state
+    uint64_t messages_rejected = 0;    // Malformed or foreign payloads
+};
+
+/**
+ * @brief Build the MQTT v5 shared-subscription filter of a topic
+ *
+ * The broker hands each message of topic to one subscriber of the group, e.g.
+ * "$share/ble_rssi/engine/+/positions".
+ *
+ * @param group Share group, the same for every instance of the cluster
+ * @param topic Topic filter to share
+ * @return std::string Shared-subscription topic filter
+ */
+std::string shared_subscription_topic(const std::string& group, const std::string& topic);
+
+/**
+ * @brief Anchor calibration exchange between engine instances that split one input stream
+ *
+ * In clustered mode every instance processes a share of the tag messages, so each sees
+ * only part of every anchor's updates. Each instance periodically collects the anchors
+ * it has not successfully sent yet into compact binary delta messages (40 bytes per
+ * anchor) and applies the deltas of the other instances with Anchor::merge_calibration:
+ * versions act as Lamport clocks. Anchors adopted from a delta are not sent back; an
+ * anchor a delta shows to be older than the local state is sent again, so an instance
+ * that missed updates or joined late catches up. Once the updates stop and every
+ * instance has sent its full state once (resync() on every connection), all instances
+ * converge on the same state for every anchor.
+ *
+ * Transport-agnostic: the runner publishes collect()'s messages on the sync topic,
+ * confirms the ones the transport accepted and feeds received ones to apply(). Records
+ * are in little-endian byte order.
+ */
+class ClusterSync {
+    public:
+        static constexpr size_t MAX_DELTAS_PER_MESSAGE = 1024;
+
+        /**
+         * @param anchors Registry whose anchors are exchanged
+         * @param instance_id Unique name of this instance, at most 255 bytes
+         * @throws std::invalid_argument If instance_id is empty or too long
+         */
+        ClusterSync(AnchorRegistry& anchors, std::string instance_id);
+
+        /**
+         * @brief Encode the anchors whose current state has not been confirmed as sent
+         *
+         * Messages that are not confirmed are collected again by the next call.
+         *
+         * @return std::vector<std::string> Delta messages, empty if nothing changed
+         */
+        std::vector<std::string> collect();
+
+        /**
+         * @brief Record that a message from collect() was handed to the transport
+         * @param message Message returned by collect() on this instance
+         */
+        void confirm(std::string_view message);
+
+        /**
+         * @brief Send the full state again with the next collect(), e.g. after (re)connecting
+         */
+        void resync();
+
+        /**
+         * @brief Merge a delta message from another instance
+         *
+         * Messages sent by this instance and anchors this instance does not know are ignored.
+         * Anchors whose local state is newer than the delta's are sent again by the next
+         * collect().
+         *
+         * @param payload Message from collect() of any instance
+         * @return size_t Number of anchors whose state was adopted
+         */
+        size_t apply(std::string_view payload);
+
+        /**
+         * @brief Gets this instance's id
+         */
+        const std::string& instance() const;
+
+        /**
+         * @brief Gets a copy of the counters
+         */
+        ClusterSyncStats stats() const;
+
+    private:
+        AnchorRegistry& registry;
+        std::string instance_id;
+
+        std::mutex sent_mutex;
+        std::unordered_map<std::string, uint32_t> sent_versions;   // Last version confirmed or adopted per anchor, guarded by sent_mutex
+
+        std::atomic<uint64_t> messages_sent{0};
+        std::atomic<uint64_t> deltas_sent{0};
+        std::atomic<uint64_t> messages_received{0};
+        std::atomic<uint64_t> deltas_received{0};
+        std::atomic<uint64_t> deltas_adopted{0};
+        std::atomic<uint64_t> messages_rejected{0};
+
+        std::string encode(const std::vector<AnchorDeltaRecord>& records, size_t begin, size_t end) const;
+        bool decode_header(std::string_view payload, AnchorDeltaHeader& header) const;
+};
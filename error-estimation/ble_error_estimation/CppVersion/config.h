@@ -2,6 +2,8 @@
 
 #include <string>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @brief Configuration constants for the BLE RSSI positioning system
@@ -18,8 +20,11 @@ namespace ConfigInput {
     const std::string CLIENT_ID = "ble_rssi_probability_model_cpp_input";
     // API for input (SHE)
     const std::string ANCHOR_INIT_BASE = "https://ils-she.ubudu.com/confv1/api/dongles?macAddress={}";
+    const std::string ANCHOR_LIST_URL = "https://ils-she.ubudu.com/confv1/api/dongles";   // Full site list, paginated
     const std::string API_USERNAME = "admin";
     const std::string API_PASSWORD = "ubudu_rocks";
+    // Site-survey file (.csv, .json or .bin) used instead of the API, empty to use the API
+    const std::string ANCHOR_SURVEY_FILE = "";
 }
 
 // Output (Paris) environment
@@ -28,6 +33,7 @@ namespace ConfigOutput {
     const int PORT = 1883;
     const std::string TOPIC = "engine/6ba4a2a3-0/error_estimates";
     const std::string CLIENT_ID = "ble_rssi_probability_model_cpp_output";
+    const std::string METRICS_TOPIC = "engine/6ba4a2a3-0/error_estimates/metrics";
 }
 
 // Legacy config for compatibility (can be removed after refactor)
@@ -48,9 +54,65 @@ namespace Config {
     const bool ENABLE_MQTT_LOGGING = false;
     const int MAX_ANCHORS_PER_TAG = 10;
     const int HTTP_TIMEOUT_SEC = 30;
+    const size_t HTTP_IDLE_HANDLES = 4;                   // Finished curl easy handles kept for reuse
     // Performance logging
     const bool ENABLE_PERFORMANCE_LOGGING = true;
     const int MAX_PROCESSING_TIME_MS = 2;
+    // Outbound spill queue (output broker outages)
+    const std::string SPILL_DIR = "spill";
+    const size_t OUTBOUND_MEMORY_CAPACITY = 10000;        // Messages kept in RAM before spilling to disk
+    const size_t SPILL_SEGMENT_BYTES = 4 * 1024 * 1024;   // Size of one on-disk spill segment
+    const size_t OUTBOUND_MAX_INFLIGHT = 100;             // Unacknowledged publishes allowed in libmosquitto
+    const int OUTBOUND_QOS = 1;                           // QoS 1 so messages survive reconnects
+    const int OUTBOUND_SHUTDOWN_DRAIN_MS = 5000;          // Publishing time on shutdown before the rest is spilled
+    const int QUEUE_METRICS_INTERVAL_SEC = 10;
+    // Shared-memory anchor store (several runners on one host)
+    const bool ENABLE_SHM_ANCHOR_STORE = true;
+    const std::string SHM_ANCHOR_STORE_NAME = "/ble_rssi_anchors";
+    const uint32_t SHM_ANCHOR_CAPACITY = 8192;
+    // Reactor event loop (MQTT sockets, HTTP and timers on one thread)
+    const uint32_t REACTOR_TICK_MS = 10;                  // Timer wheel resolution
+    const size_t TIMER_WHEEL_SLOTS = 512;                 // One wheel revolution = 5.12s at 10ms ticks
+    const uint32_t MQTT_MISC_INTERVAL_MS = 1000;          // Keepalive pings and retries (mosquitto_loop_misc)
+    const uint32_t MQTT_RECONNECT_DELAY_MS = 2000;        // Delay before reconnecting a dropped client
+    const size_t WORKER_THREADS = 2;                      // Message processing workers
+    // Bulk anchor load at startup (per-MAC requests remain the fallback)
+    const bool ENABLE_BULK_ANCHOR_LOAD = true;
+    const size_t ANCHOR_LIST_PAGE_SIZE = 1000;            // Dongles per page request
+    const size_t ANCHOR_LIST_MAX_PAGES = 100;             // Stops a server that ignores pagination
+    // Background anchor refresh (conditional requests, near-zero traffic when nothing changed)
+    const int ANCHOR_REFRESH_INTERVAL_SEC = 300;          // 0 disables the refresh
+    const float ANCHOR_MOVE_TOLERANCE_M = 0.01f;          // Smaller coordinate changes are ignored
+    // Anchor memory layout (co-visible anchors placed next to each other)
+    const int ANCHOR_COMPACTION_INTERVAL_SEC = 600;       // 0 disables the background compaction
+    const size_t COVISIBILITY_SAMPLE_EVERY = 8;           // Messages per co-visibility sample
+    const size_t COVISIBILITY_WINDOW = 4096;              // Samples the anchor ordering is built from
+    const size_t ANCHOR_COMPACTION_MIN_SAMPLES = 256;     // Fewer samples leave the layout alone
+    const float ANCHOR_COMPACTION_MIN_GAIN = 0.2f;        // Relative edge-span reduction worth a compaction
+    // Numeric kernels ("" = best the CPU supports; "scalar", "avx2", "avx512" force one)
+    const std::string NUMERIC_ISA = "";
+    // Built-in MQTT 3.1.1 subscriber for the input stream (libmosquitto remains the default)
+    const bool ENABLE_BUILTIN_MQTT_SUBSCRIBER = false;
+    const int INPUT_QOS = 0;                              // QoS of the input subscription, 0 or 1
+    const size_t MQTT_SUBSCRIBER_BUFFER_BYTES = 256 * 1024;     // Receive buffer, refilled in place
+    const size_t MQTT_SUBSCRIBER_MAX_PACKET_BYTES = 16 * 1024 * 1024;   // Larger packets drop the connection
+    // Shared-memory position ring (positioning engines on the same host, instead of MQTT)
+    const bool ENABLE_POSITION_RING = false;
+    const std::string POSITION_RING_NAME = "/ble_rssi_positions";
+    const uint32_t POSITION_RING_CAPACITY = 65536;        // Records; a full ring rejects pushes
+    const int POSITION_RING_WAIT_MS = 100;                // Longest consumer sleep between stop checks
+    const int POSITION_RING_STALL_MS = 1000;              // Claimed slot left unpublished this long is skipped (producer died)
+    // Clustered mode (instances split the input stream through an MQTT v5 shared subscription)
+    const bool ENABLE_CLUSTER_MODE = false;
+    const std::string CLUSTER_GROUP = "ble_rssi";         // Share group, the same on every instance
+    const std::string CLUSTER_INSTANCE_ID = "";           // "" = hostname-pid, unique per process
+    const std::string CLUSTER_SYNC_TOPIC = "engine/6ba4a2a3-0/anchor_sync";   // Anchor deltas, on the INPUT broker
+    const uint32_t CLUSTER_SYNC_INTERVAL_MS = 250;        // Changed anchors are sent this often
+    // Hot upgrade (a new runner takes the anchor state over from the running one on this host)
+    const bool ENABLE_STATE_HANDOFF = false;
+    const std::string HANDOFF_SOCKET_PATH = "/tmp/ble_rssi_runner.sock";
+    const int HANDOFF_TIMEOUT_MS = 10000;                 // Longest wait for the old runner to drain and send its state
+    const uint32_t HANDOFF_MAX_ANCHORS = 65536;           // Larger snapshots are refused (496 bytes per anchor)
 }
 
 // Calibration Constants
@@ -0,0 +1,275 @@
+#include <optional>
+#include <stdexcept>
+
+#include <strings.h>
+#include <sys/epoll.h>
+
+#include "http_client.h"
+
+struct HttpClient::Transfer {
+    CURL* easy = nullptr;
+    std::string auth;              // "username:password" for basic auth
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+    struct curl_slist* headers = nullptr;
+    Callback callback;
+
+    ~Transfer() {
+        curl_slist_free_all(headers);
+    }
+};
+
+namespace {
+    size_t write_body(void* contents, size_t size, size_t nmemb, std::string* body) {
+        size_t total_size = size * nmemb;
+        body->append(static_cast<char*>(contents), total_size);
+        return total_size;
+    }
+
+    // Value of a "Name: value" header line if its name matches (case-insensitive), without the line break
+    bool header_value(const std::string& line, const std::string& name, std::string& value) {
+        if (line.size() <= name.size() || line[name.size()] != ':' ||
+            strncasecmp(line.c_str(), name.c_str(), name.size()) != 0) {
+            return false;
+        }
+        size_t start = line.find_first_not_of(' ', name.size() + 1);
+        size_t end = line.find_last_not_of("\r\n");
+        value = start == std::string::npos || end < start ? "" : line.substr(start, end - start + 1);
+        return true;
+    }
+}
+
+/*HTTPCLIENT*/
+//constructor:
+HttpClient::HttpClient(Reactor& event_loop) : reactor(event_loop) {
+    multi = curl_multi_init();
+    if (!multi) {
+        throw std::runtime_error("Failed to initialize CURL multi handle");
+    }
+    curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, socket_callback);
+    curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, timer_callback);
+    curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+}
+
+HttpClient::~HttpClient() {
+    for (auto& [easy, transfer] : transfers) {
+        curl_multi_remove_handle(multi, easy);
+        curl_easy_cleanup(easy);
+    }
+    transfers.clear();
+    for (CURL* easy : idle_handles) {
+        curl_easy_cleanup(easy);
+    }
+    if (timeout_timer != 0) {
+        reactor.cancel_timer(timeout_timer);
+    }
+    curl_multi_cleanup(multi);
+}
+
+//methods:
+void HttpClient::get(const HttpRequest& request, Callback callback) {
+    CURL* easy = nullptr;
+    if (!idle_handles.empty()) {
+        easy = idle_handles.back();
+        idle_handles.pop_back();
+    } else {
+        easy = curl_easy_init();
+    }
+    if (!easy) {
+        callback(HttpResponse{0, "", "Failed to initialize CURL"});
+        return;
+    }
+
+    auto transfer = std::make_unique<Transfer>();
+    transfer->easy = easy;
+    transfer->callback = std::move(callback);
+
+    curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+    if (!request.username.empty()) {
+        transfer->auth = request.username + ":" + request.password;
+        curl_easy_setopt(easy, CURLOPT_USERPWD, transfer->auth.c_str());
+    }
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_body);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->body);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, read_header);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.get());
+    for (const auto& header : request.headers) {
+        transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+    }
+    if (transfer->headers) {
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    }
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, request.timeout_sec);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+
+    transfers[easy] = std::move(transfer);
+    CURLMcode added = curl_multi_add_handle(multi, easy);
+    if (added != CURLM_OK) {
+        Callback failed = std::move(transfers[easy]->callback);
+        transfers.erase(easy);
+        release_handle(easy);
+        failed(HttpResponse{0, "", std::string("CURL request failed: ") + curl_multi_strerror(added)});
+    }
+}
+
+std::future<HttpResponse> HttpClient::fetch(const HttpRequest& request) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> result = promise->get_future();
+    reactor.post([this, request, promise]() {
+        get(request, [promise](HttpResponse response) {
+            promise->set_value(std::move(response));
+        });
+    });
+    return result;
+}
+
+HttpResponse HttpClient::get_blocking(const HttpRequest& request) {
+    std::optional<HttpResponse> result;
+    get(request, [&result](HttpResponse response) { result = std::move(response); });
+    while (!result) {
+        reactor.run_once(static_cast<int>(Config::REACTOR_TICK_MS));
+    }
+    return std::move(*result);
+}
+
+size_t HttpClient::active() const {
+    return transfers.size();
+}
+
+//helpers:
+size_t HttpClient::read_header(char* buffer, size_t size, size_t nitems, void* transfer_ptr) {
+    Transfer* transfer = static_cast<Transfer*>(transfer_ptr);
+    std::string line(buffer, size * nitems);
+    if (line.rfind("HTTP/", 0) == 0) {
+        // Status line: headers of an earlier response (e.g. a redirect) no longer apply
+        transfer->etag.clear();
+        transfer->last_modified.clear();
+    } else if (!header_value(line, "ETag", transfer->etag)) {
+        header_value(line, "Last-Modified", transfer->last_modified);
+    }
+    return size * nitems;
+}
+
+int HttpClient::socket_callback(CURL* easy, curl_socket_t socket, int what, void* client_ptr, void* socket_ptr) {
+    (void)easy; // Suppress unused parameter warning
+    (void)socket_ptr; // Suppress unused parameter warning
+    HttpClient* client = static_cast<HttpClient*>(client_ptr);
+
+    if (what == CURL_POLL_REMOVE) {
+        client->reactor.remove_fd(socket);
+        return 0;
+    }
+
+    uint32_t events = 0;
+    if (what & CURL_POLL_IN) {
+        events |= EPOLLIN;
+    }
+    if (what & CURL_POLL_OUT) {
+        events |= EPOLLOUT;
+    }
+
+    if (client->reactor.has_fd(socket)) {
+        client->reactor.modify_fd(socket, events);
+    } else {
+        client->reactor.add_fd(socket, events, [client, socket](uint32_t ready) {
+            client->on_socket_ready(socket, ready);
+        });
+    }
+    return 0;
+}
+
+int HttpClient::timer_callback(CURLM* multi_handle, long timeout_ms, void* client_ptr) {
+    (void)multi_handle; // Suppress unused parameter warning
+    HttpClient* client = static_cast<HttpClient*>(client_ptr);
+
+    if (client->timeout_timer != 0) {
+        client->reactor.cancel_timer(client->timeout_timer);
+        client->timeout_timer = 0;
+    }
+
+    if (timeout_ms == 0) {
+        // Act right after libcurl returns rather than waiting a wheel tick
+        client->reactor.post([client]() { client->on_timeout(); });
+    } else if (timeout_ms > 0) {
+        client->timeout_timer = client->reactor.add_timer(static_cast<uint32_t>(timeout_ms), [client]() {
+            client->timeout_timer = 0;
+            client->on_timeout();
+        });
+    }
+    return 0;
+}
+
+void HttpClient::on_socket_ready(curl_socket_t socket, uint32_t events) {
+    int flags = 0;
+    if (events & EPOLLIN) {
+        flags |= CURL_CSELECT_IN;
+    }
+    if (events & EPOLLOUT) {
+        flags |= CURL_CSELECT_OUT;
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        flags |= CURL_CSELECT_ERR;
+    }
+
+    int still_running = 0;
+    curl_multi_socket_action(multi, socket, flags, &still_running);
+    complete_transfers();
+}
+
+void HttpClient::on_timeout() {
+    int still_running = 0;
+    curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &still_running);
+    complete_transfers();
+}
+
+void HttpClient::complete_transfers() {
+    CURLMsg* message = nullptr;
+    int remaining = 0;
+    while ((message = curl_multi_info_read(multi, &remaining)) != nullptr) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+        auto it = transfers.find(easy);
+        if (it == transfers.end()) {
+            continue;
+        }
+
+        HttpResponse response;
+        if (result != CURLE_OK) {
+            response.error = "CURL request failed: " + std::string(curl_easy_strerror(result));
+        } else {
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &response.status);
+            response.body = std::move(it->second->body);
+            response.etag = std::move(it->second->etag);
+            response.last_modified = std::move(it->second->last_modified);
+            if (response.status != 200 && response.status != 304) {
+                response.error = "HTTP request failed with status: " + std::to_string(response.status);
+            }
+        }
+
+        Callback callback = std::move(it->second->callback);
+        curl_multi_remove_handle(multi, easy);
+        transfers.erase(it);
+        release_handle(easy);
+        callback(std::move(response));
+    }
+}
+
+/**
+ * @brief Keep a finished easy handle for the next request, or free it if enough are idle
+ */
+void HttpClient::release_handle(CURL* easy) {
+    if (idle_handles.size() < Config::HTTP_IDLE_HANDLES) {
+        curl_easy_reset(easy);
+        idle_handles.push_back(easy);
+    } else {
+        curl_easy_cleanup(easy);
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "config.h"
+#include "reactor.h"
+
+/**
+ * @brief One HTTP GET request
+ */
+struct HttpRequest {
+    std::string url;
+    std::string username;          // Basic auth, empty for none
+    std::string password;
+    long timeout_sec = Config::HTTP_TIMEOUT_SEC;
+    std::vector<std::string> headers = {};   // Extra request headers, e.g. "If-None-Match: \"abc\""
+};
+
+/**
+ * @brief Result of an HTTP request
+ */
+struct HttpResponse {
+    long status = 0;               // HTTP status code, 0 if the transfer failed
+    std::string body;              // Decompressed body
+    std::string error;             // Transport or status error, empty on success
+    std::string etag = {};            // ETag response header, empty if absent
+    std::string last_modified = {};   // Last-Modified response header, empty if absent
+
+    bool ok() const { return error.empty(); }
+    bool not_modified() const { return status == 304; }
+};
+
+/**
+ * @brief Non-blocking HTTP client driven by the reactor through a libcurl multi handle
+ *
+ * Sockets and timeouts requested by libcurl are registered with the reactor, so any
+ * number of requests progress on the reactor thread without blocking it. Connections
+ * are kept alive and reused between requests to the same host, and finished easy handles
+ * are kept for the next request so their DNS and TLS session caches survive too.
+ * Responses are requested compressed (every encoding libcurl supports).
+ */
+class HttpClient {
+    public:
+        using Callback = std::function<void(HttpResponse)>;
+
+        /**
+         * @brief Create the multi handle; curl_global_init must have been called
+         * @throws std::runtime_error If libcurl cannot create the multi handle
+         */
+        explicit HttpClient(Reactor& reactor);
+
+        /**
+         * @brief Abort pending transfers without calling their callbacks
+         */
+        ~HttpClient();
+
+        HttpClient(const HttpClient&) = delete;
+        HttpClient& operator=(const HttpClient&) = delete;
+
+        /**
+         * @brief Start a GET request; must be called on the reactor thread
+         * @param request Request to send
+         * @param callback Called on the reactor thread with the response; statuses other than
+         *                 200 and 304 (answer to a conditional request) are errors
+         */
+        void get(const HttpRequest& request, Callback callback);
+
+        /**
+         * @brief Start a GET request from any thread other than the reactor's
+         *
+         * Lets a worker wait for an HTTP result while the reactor keeps serving
+         * every other socket. Waiting on the future from the reactor thread deadlocks.
+         *
+         * @param request Request to send
+         * @return std::future<HttpResponse> Response once the transfer completes
+         */
+        std::future<HttpResponse> fetch(const HttpRequest& request);
+
+        /**
+         * @brief Send a GET request and run the reactor on the calling thread until it completes
+         *
+         * For startup work done before Reactor::run(), e.g. loading the site's anchors
+         * before subscribing. Other transfers and timers progress meanwhile.
+         *
+         * @param request Request to send
+         * @return HttpResponse Response once the transfer completes
+         */
+        HttpResponse get_blocking(const HttpRequest& request);
+
+        /**
+         * @brief Gets the number of transfers in progress
+         */
+        size_t active() const;
+
+    private:
+        struct Transfer;
+
+        Reactor& reactor;
+        CURLM* multi = nullptr;
+        Reactor::TimerId timeout_timer = 0;
+        std::unordered_map<CURL*, std::unique_ptr<Transfer>> transfers;
+        std::vector<CURL*> idle_handles;   // Reset easy handles kept for reuse, at most Config::HTTP_IDLE_HANDLES
+
+        static size_t read_header(char* buffer, size_t size, size_t nitems, void* transfer_ptr);
+        static int socket_callback(CURL* easy, curl_socket_t socket, int what, void* client_ptr, void* socket_ptr);
+        static int timer_callback(CURLM* multi_handle, long timeout_ms, void* client_ptr);
+        void on_socket_ready(curl_socket_t socket, uint32_t events);
+        void on_timeout();
+        void complete_transfers();
+        void release_handle(CURL* easy);
+};
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include "kalman.h"
@@ -28,40 +29,16 @@ std::tuple<float, float> KalmanFilter::sequence_step(float RSSI0_i, float n_i,
     // x_ji designates x{i+1|i},  x{i+1|i+1} is designated by x_jj
     std::array<float, 2> x_ji = {RSSI0_i, n_i}; 
 
-    // Store RSSI and trim
-    rssi_vals.push_back(r_val);
-    if (rssi_vals.size() > max_buffer) rssi_vals.erase(rssi_vals.begin());
-    
-    // Update sigma based on RSSI std dev (adaptive) - only if we have enough data
-    if (rssi_vals.size() >= min_required_points) {
-        sigma = beta * computeRSSIStdDev();
-    }
-
-    // Update Q based on residual variance (adaptive) - only if we have enough data
-    if (residuals.size() >= min_required_points) {
-        float resid_var = computeResidualVariance();
-        Q[0][0] = alpha * resid_var;      // process noise for RSSI0
-        Q[1][1] = alpha * (resid_var / 100.0f); // smaller scale for n
-    }
-
-    //P{i+1|i} = P{i|i} + Q
-    P[0][0] += Q[0][0];
-    P[0][1] += Q[0][1]; 
-    P[1][0] += Q[1][0];
-    P[1][1] += Q[1][1];
+    predict(r_val);
 
     //vect H = [1 X] in R^{1*2}
     float safe_d_val = std::max(d_val, 1e-6f); 
-    float X = (-10) * std::log10(safe_d_val / d_0);
+    float X = (-10) * std::log10(safe_d_val / D_0);
     std::array<float, 2> H = {1.0f, X};
 
     //predicted r_val & residual
     float r_predict = H[0] * x_ji[0] + H[1] * x_ji[1];
     float resid = r_val - r_predict;
-    
-    // Store residual and trim buffer
-    residuals.push_back(resid);
-    if (residuals.size() > max_buffer) residuals.erase(residuals.begin());
 
     //S val & K matrices
     float S = 
@@ -96,8 +73,69 @@ std::tuple<float, float> KalmanFilter::sequence_step(float RSSI0_i, float n_i,
     newP[0][1] = I_minus_KH[0][0]*P[0][1] + I_minus_KH[0][1]*P[1][1];
     newP[1][0] = I_minus_KH[1][0]*P[0][0] + I_minus_KH[1][1]*P[1][0];
     newP[1][1] = I_minus_KH[1][0]*P[0][1] + I_minus_KH[1][1]*P[1][1];
-    P = newP;
+    correct(newP, resid);
 
     //output
     return std::make_tuple(x_jj[0], x_jj[1]);
-}
\ No newline at end of file
+}
+
+void KalmanFilter::predict(float r_val) {
+    // Store RSSI and trim
+    rssi_vals.push_back(r_val);
+    if (rssi_vals.size() > max_buffer) rssi_vals.erase(rssi_vals.begin());
+    
+    // Update sigma based on RSSI std dev (adaptive) - only if we have enough data
+    if (rssi_vals.size() >= min_required_points) {
+        sigma = beta * computeRSSIStdDev();
+    }
+
+    // Update Q based on residual variance (adaptive) - only if we have enough data
+    if (residuals.size() >= min_required_points) {
+        float resid_var = computeResidualVariance();
+        Q[0][0] = alpha * resid_var;      // process noise for RSSI0
+        Q[1][1] = alpha * (resid_var / 100.0f); // smaller scale for n
+    }
+
+    //P{i+1|i} = P{i|i} + Q
+    P[0][0] += Q[0][0];
+    P[0][1] += Q[0][1]; 
+    P[1][0] += Q[1][0];
+    P[1][1] += Q[1][1];
+}
+
+void KalmanFilter::correct(const std::array<std::array<float, 2>, 2>& updated_P, float resid) {
+    // Store residual and trim buffer
+    residuals.push_back(resid);
+    if (residuals.size() > max_buffer) residuals.erase(residuals.begin());
+    P = updated_P;
+}
+
+KalmanState KalmanFilter::get_state() const {
+    KalmanState state{};
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 2; j++) {
+            state.Q[i][j] = Q[i][j];
+            state.P[i][j] = P[i][j];
+        }
+    }
+    state.sigma = sigma;
+    state.residual_count = static_cast<uint32_t>(std::min(residuals.size(), KalmanState::HISTORY));
+    state.rssi_count = static_cast<uint32_t>(std::min(rssi_vals.size(), KalmanState::HISTORY));
+    std::copy(residuals.end() - state.residual_count, residuals.end(), state.residuals);
+    std::copy(rssi_vals.end() - state.rssi_count, rssi_vals.end(), state.rssi_vals);
+    return state;
+}
+
+void KalmanFilter::set_state(const KalmanState& state) {
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 2; j++) {
+            Q[i][j] = state.Q[i][j];
+            P[i][j] = state.P[i][j];
+        }
+    }
+    sigma = state.sigma;
+    size_t residual_count = std::min<size_t>(state.residual_count, KalmanState::HISTORY);
+    size_t rssi_count = std::min<size_t>(state.rssi_count, KalmanState::HISTORY);
+    residuals.assign(state.residuals, state.residuals + residual_count);
+    rssi_vals.assign(state.rssi_vals, state.rssi_vals + rssi_count);
+}
@@ -2,9 +2,28 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <tuple>
 #include <vector>
 
+/**
+ * @brief Adaptive state of a KalmanFilter, with a fixed layout for state snapshots
+ *
+ * Holds the covariances, the measurement noise and the residual and RSSI histories
+ * (oldest first), so a restored filter continues exactly where the saved one stopped.
+ */
+struct KalmanState {
+    static constexpr size_t HISTORY = 50;
+
+    float Q[2][2];
+    float P[2][2];
+    float sigma;
+    uint32_t residual_count;
+    uint32_t rssi_count;
+    float residuals[HISTORY];
+    float rssi_vals[HISTORY];
+};
 
 class KalmanFilter {
     private:
@@ -16,23 +35,24 @@ class KalmanFilter {
             {1.0f, 0.0f}, 
             {0.0f, 0.1f}
         }};
-        float d_0 = 1.0;
         float sigma = 4.0;
         
         // Adaptive filtering parameters
         std::vector<float> residuals;           // Store residuals for variance computation
         std::vector<float> rssi_vals;           // Store RSSI values for std dev computation
         const size_t min_required_points = 5;  // Minimum points needed for statistics
-        const size_t max_buffer = 50;          // Maximum buffer size for stored values
+        const size_t max_buffer = KalmanState::HISTORY;   // Maximum buffer size for stored values
         const float alpha = 0.1f;              // Process noise adaptation factor
         const float beta = 0.8f;               // RSSI std dev scaling factor
     
     public:
+        static constexpr float D_0 = 1.0f;     // Reference distance of the path loss model (meters)
+
         /**
          * @brief Default constructor for KalmanFilter
          * 
          * Initializes the Kalman filter with default process noise matrix Q,
-         * initial covariance matrix P, reference distance d_0, and measurement noise sigma.
+         * initial covariance matrix P and measurement noise sigma.
          */
         KalmanFilter();
 
@@ -64,6 +84,35 @@ class KalmanFilter {
          * @return std::tuple<float, float> Updated (RSSI0, n) estimates
          */
         std::tuple<float, float> sequence_step(float RSSI0_i, float n_i, float r_val, float d_val);
+
+        /**
+         * @brief First half of sequence_step(): record r_val, adapt sigma and Q, then P += Q
+         *
+         * With correct() it lets the update half of many filters run as one batched kernel
+         * (NumericKernels::kalman_update) between the two calls.
+         *
+         * @param r_val Measured RSSI value (dBm)
+         */
+        void predict(float r_val);
+
+        /**
+         * @brief Second half of sequence_step(): adopt the updated covariance and record the residual
+         * @param updated_P Covariance P{i+1|i+1} computed from the predicted one
+         * @param resid Measurement residual of the step
+         */
+        void correct(const std::array<std::array<float, 2>, 2>& updated_P, float resid);
+
+        /**
+         * @brief Copy the adaptive state (Q, P, sigma and both histories)
+         * @return KalmanState State to restore later with set_state()
+         */
+        KalmanState get_state() const;
+
+        /**
+         * @brief Replace the adaptive state with a saved one
+         * @param state State from get_state(); history counts above HISTORY are clamped
+         */
+        void set_state(const KalmanState& state);
         
         // getters
         /**
@@ -83,6 +132,12 @@ class KalmanFilter {
          * @return float Current sigma value
          */
         float get_sigma() const { return sigma; }
+
+        /**
+         * @brief Get the covariance matrix P (predicted between predict() and correct())
+         * @return const std::array<std::array<float, 2>, 2>& Current P
+         */
+        const std::array<std::array<float, 2>, 2>& get_P() const { return P; }
         
         /**
          * @brief Get number of stored residuals
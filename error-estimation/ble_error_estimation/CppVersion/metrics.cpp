@@ -8,6 +8,24 @@
 
 #include "metrics.h"
 #include "config.h"
+#include "numeric_kernels.h"
+
+namespace {
+    // Anchors per kernel call; messages rarely have more, longer lists are processed in chunks
+    constexpr size_t KERNEL_BATCH = 16;
+
+    // Distances from count (<= KERNEL_BATCH) anchors to the tag's estimated position
+    void batch_distances(const NumericKernels& kernels, Anchor* const* anchors, size_t count, const PointR3& tag_coord, float* out) {
+        float ax[KERNEL_BATCH], ay[KERNEL_BATCH], az[KERNEL_BATCH];
+        for (size_t i = 0; i < count; i++) {
+            PointR3 coord = anchors[i]->get_coord();
+            ax[i] = std::get<0>(coord);
+            ay[i] = std::get<1>(coord);
+            az[i] = std::get<2>(coord);
+        }
+        kernels.distances(ax, ay, az, count, std::get<0>(tag_coord), std::get<1>(tag_coord), std::get<2>(tag_coord), out);
+    }
+}
 
 /*TAGSYSTEM*/
 //constructor:
@@ -45,7 +63,7 @@ std::vector<Anchor*> TagSystem::get_significant_anchors(std::vector<Anchor*>& an
         auto rssi_it = rssi_dict.find(anchor_mac);
         
         if (rssi_it != rssi_dict.end() && 
-            rssi_it->second >= (max_rssi - 10) && 
+            rssi_it->second >= (max_rssi - Calibration::RSSI_SIGNAL_STRENGTH_THRESHOLD) && 
             anchor->get_ewma() < Calibration::EWMA_THRESHOLD) {
             keep.push_back(anchor);
         }
@@ -67,41 +85,78 @@ std::vector<Anchor*> TagSystem::get_significant_anchors(std::vector<Anchor*>& an
 std::unordered_map<Anchor*, float> TagSystem::distances(std::vector<Anchor*>& anch_list) {
     std::unordered_map<Anchor*, float> result;
     std::vector<Anchor*> significant_anchors = get_significant_anchors(anch_list);
-
-    for (const auto& anchor : significant_anchors) {
-        float dist = R3_distance(anchor->get_coord(), tag.get_est_coord());
-        result[anchor] = dist;
+    const NumericKernels& kernels = numeric_kernels();
+
+    for (size_t first = 0; first < significant_anchors.size(); first += KERNEL_BATCH) {
+        size_t count = std::min(KERNEL_BATCH, significant_anchors.size() - first);
+        float dist[KERNEL_BATCH];
+        batch_distances(kernels, &significant_anchors[first], count, tag.get_est_coord(), dist);
+        for (size_t i = 0; i < count; i++) {
+            result[significant_anchors[first + i]] = dist[i];
+        }
     }
     return result;
 }
 
 std::unordered_map<Anchor*, float> TagSystem::z_vals(std::vector<Anchor*>& anch_list) {
     std::unordered_map<Anchor*, float> result;
-    std::unordered_map<Anchor*, float> dist_dict = distances(anch_list);
+    std::vector<Anchor*> significant_anchors = get_significant_anchors(anch_list);
     const std::unordered_map<std::string, float>& rssi_dict = tag.get_rssi_readings();
-
-    for (const auto& pair : dist_dict) {
-        float rssi_value = rssi_dict.at(pair.first->get_mac_address());
-        result[pair.first] = model.z(rssi_value, pair.first->get_RSSI_0(), pair.first->get_n(), pair.second);
+    const NumericKernels& kernels = numeric_kernels();
+
+    for (size_t first = 0; first < significant_anchors.size(); first += KERNEL_BATCH) {
+        size_t count = std::min(KERNEL_BATCH, significant_anchors.size() - first);
+        Anchor** batch = &significant_anchors[first];
+        float dist[KERNEL_BATCH], rssi[KERNEL_BATCH], rssi_0[KERNEL_BATCH], n[KERNEL_BATCH], z[KERNEL_BATCH];
+        batch_distances(kernels, batch, count, tag.get_est_coord(), dist);
+        for (size_t i = 0; i < count; i++) {
+            AnchorState state = batch[i]->snapshot();
+            rssi[i] = rssi_dict.at(batch[i]->get_mac_address());
+            rssi_0[i] = state.RSSI_0;
+            n[i] = state.n;
+        }
+        kernels.path_loss_z(rssi, rssi_0, n, dist, count, model.get_d_0(), model.get_sigma(), z);
+        for (size_t i = 0; i < count; i++) {
+            result[batch[i]] = z[i];
+        }
     }
-    
     return result;
 }
 
 float TagSystem::confidence_score(std::vector<Anchor*>& anch_list, int v, float scale) {
-    std::unordered_map<Anchor*, float> z_dict = z_vals(anch_list);
-    if (z_dict.empty()) {
+    std::vector<Anchor*> significant_anchors = get_significant_anchors(anch_list);
+    if (significant_anchors.empty()) {
         return 0.0;
     }
+    const std::unordered_map<std::string, float>& rssi_dict = tag.get_rssi_readings();
+    const NumericKernels& kernels = numeric_kernels();
 
     float weighted_sig = 0.0f;
     float total_weight = 0.0f;
 
-    for (const auto& [anchor, z_val] : z_dict){    
-        float anchor_ewma = anchor->get_ewma();
-        float anchor_weight = 1.0f / (1.0f + anchor_ewma + std::pow(z_val, 2));
-        weighted_sig += anchor_weight * logpdf_student_t(z_val, v);
-        total_weight += anchor_weight;
+    for (size_t first = 0; first < significant_anchors.size(); first += KERNEL_BATCH) {
+        size_t count = std::min(KERNEL_BATCH, significant_anchors.size() - first);
+        Anchor** batch = &significant_anchors[first];
+        float dist[KERNEL_BATCH], rssi[KERNEL_BATCH], rssi_0[KERNEL_BATCH], n[KERNEL_BATCH], ewma[KERNEL_BATCH];
+        float z[KERNEL_BATCH], logpdf[KERNEL_BATCH], weight[KERNEL_BATCH];
+        batch_distances(kernels, batch, count, tag.get_est_coord(), dist);
+        for (size_t i = 0; i < count; i++) {
+            // z-value and weight come from one lock-free snapshot, so they never mix two updates
+            AnchorState state = batch[i]->snapshot();
+            rssi[i] = rssi_dict.at(batch[i]->get_mac_address());
+            rssi_0[i] = state.RSSI_0;
+            n[i] = state.n;
+            ewma[i] = state.ewma;
+        }
+        kernels.path_loss_z(rssi, rssi_0, n, dist, count, model.get_d_0(), model.get_sigma(), z);
+        kernels.student_t_logpdf(z, count, v, logpdf);
+        kernels.confidence_weights(z, ewma, count, weight);
+
+        // Summed in anchor order, so every instruction set gives the same result
+        for (size_t i = 0; i < count; i++) {
+            weighted_sig += weight[i] * logpdf[i];
+            total_weight += weight[i];
+        }
     }
 
     float l = weighted_sig / total_weight;
@@ -131,14 +186,19 @@ void update_anchors_from_tag_data(
         return;
     }
     
-    // Parameter updates - work directly with pointers to original anchors
+    // Parameter updates - work directly with pointers to original anchors, a batch per kernel call
     std::vector<Anchor*> significant_anchors = moment_system.get_significant_anchors(anch_list);
     std::unordered_map<Anchor*, float> distance_dict = moment_system.distances(anch_list);
     
-    for (const auto& sign_anchor : significant_anchors) {
-        float sign_anchor_rssi = rssi_dict.at(sign_anchor->get_mac_address());
-        float sign_anchor_dist = distance_dict.at(sign_anchor);
-        sign_anchor->update_parameters(sign_anchor_rssi, sign_anchor_dist);
+    for (size_t first = 0; first < significant_anchors.size(); first += KERNEL_BATCH) {
+        size_t count = std::min(KERNEL_BATCH, significant_anchors.size() - first);
+        Anchor** batch = &significant_anchors[first];
+        float rssi[KERNEL_BATCH], dist[KERNEL_BATCH];
+        for (size_t i = 0; i < count; i++) {
+            rssi[i] = rssi_dict.at(batch[i]->get_mac_address());
+            dist[i] = distance_dict.at(batch[i]);
+        }
+        Anchor::update_parameters_batch(batch, rssi, dist, count);
     }
 
     //health update
@@ -151,6 +211,9 @@ void update_anchors_from_tag_data(
         }
     }
 
+    Anchor* healthy[KERNEL_BATCH];
+    float healthy_z[KERNEL_BATCH];
+    size_t pending = 0;
     for (const auto& pair : z_dict) {
         Anchor* sign_anchor = pair.first;
         float sign_anchor_rssi = rssi_dict.at(sign_anchor->get_mac_address());
@@ -166,7 +229,12 @@ void update_anchors_from_tag_data(
             continue;
         }
         
-        // Directly update the anchor via pointer - no find_if needed!
-        sign_anchor->update_health(sign_anchor_z_val, now);
+        healthy[pending] = sign_anchor;
+        healthy_z[pending] = sign_anchor_z_val;
+        if (++pending == KERNEL_BATCH) {
+            Anchor::update_health_batch(healthy, healthy_z, pending, now);
+            pending = 0;
+        }
     }
+    Anchor::update_health_batch(healthy, healthy_z, pending, now);
 }
\ No newline at end of file
@@ -64,7 +64,8 @@ class TagSystem {
         /**
          * @brief Calculates distances between significant anchors and the tag
          * 
-         * Computes 3D Euclidean distances using the R3_distance utility function.
+         * Computes 3D Euclidean distances with the selected numeric kernels (same results
+         * as R3_distance on every instruction set, see numeric_kernels.h).
          * Only processes anchors identified as significant by get_significant_anchors().
          * 
          * @param anch_list Vector of anchor pointers to process
@@ -91,6 +92,9 @@ class TagSystem {
          * based on z-values from all significant anchors. Higher scores indicate better
          * confidence in the position estimate.
          * 
+         * Reads each anchor through Anchor::snapshot(), so it needs no lock and may run
+         * concurrently with anchor updates on other threads.
+         * 
          * @param anch_list Vector of anchor pointers to process
          * @param v Degrees of freedom for Student's t-distribution (default: 5)
          * @param scale Scaling factor for the exponential transform (default: 2.0)
@@ -126,6 +130,8 @@ class TagSystem {
  *    - Time since last seen must be ≤ T_vis
  * 
  * Uses efficient pointer-based operations to modify original anchor objects directly.
+ * Both phases gather the anchors in batches and run the arithmetic as numeric kernels
+ * (Anchor::update_parameters_batch, Anchor::update_health_batch).
  * 
  * @param anch_list Reference to vector of anchor pointers to update (modified in-place)
  * @param inpt_tag Constant reference to tag providing RSSI measurements and position
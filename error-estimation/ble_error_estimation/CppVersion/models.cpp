@@ -1,12 +1,27 @@
+#include <algorithm>
 #include <iostream>
+#include <new>
 
 #include "models.h"
+#include "numeric_kernels.h"
 
 /*ANCHOR:*/
 Anchor::Anchor(std::string mac, PointR3 coordinate, float timestamp) {
     mac_address = mac; 
     coord = coordinate;
-    last_seen = timestamp;
+    last_seen.store(timestamp, std::memory_order_relaxed);
+}
+
+Anchor::Anchor(const Anchor& other) : mac_address(other.mac_address), coord(other.coord), kalman(other.kalman) {
+    AnchorState state = other.snapshot();
+    store_state(state.RSSI_0, state.n, state.ewma, state.last_seen);
+    version.store(state.version, std::memory_order_relaxed);
+}
+
+Anchor::Anchor(const Anchor& source, PointR3 coordinate)
+    : mac_address(source.mac_address), coord(coordinate), kalman(source.kalman) {
+    version.store(source.get_version(), std::memory_order_relaxed);
+    store_state(source.get_RSSI_0(), source.get_n(), 1.0f, source.get_last_seen());
 }
 
 //getters:
@@ -19,43 +34,264 @@ PointR3 Anchor::get_coord() const {
 }
 
 float Anchor::get_ewma() const {
-    return ewma;
+    return ewma.load(std::memory_order_relaxed);
 }
 
 float Anchor::get_last_seen() const {
-    return last_seen;
+    return last_seen.load(std::memory_order_relaxed);
 }
 
 float Anchor::get_RSSI_0() const {
-    return RSSI_0;
+    return RSSI_0.load(std::memory_order_relaxed);
 }
 
 float Anchor::get_n() const {
-    return n;
+    return n.load(std::memory_order_relaxed);
+}
+
+uint32_t Anchor::get_version() const {
+    return version.load(std::memory_order_relaxed);
 }
 
 const KalmanFilter& Anchor::get_kalman() const {
     return kalman;
 }
 
+AnchorState Anchor::snapshot() const {
+    AnchorState state;
+    uint32_t start;
+    do {
+        start = seqlock_read_begin(seq);
+        state.RSSI_0 = RSSI_0.load(std::memory_order_relaxed);
+        state.n = n.load(std::memory_order_relaxed);
+        state.ewma = ewma.load(std::memory_order_relaxed);
+        state.last_seen = last_seen.load(std::memory_order_relaxed);
+        state.version = version.load(std::memory_order_relaxed);
+    } while (seqlock_read_retry(seq, start));
+    return state;
+}
+
 //methods:
 void Anchor::update_health(float z, float now, float LAMBDA) {
-    ewma = LAMBDA * std::pow(z, 2) + (1 - LAMBDA) * ewma;
-    last_seen = now;
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        moved->update_health(z, now, LAMBDA);
+        return;
+    }
+    float current = ewma.load(std::memory_order_relaxed);
+    store_state(get_RSSI_0(), get_n(), LAMBDA * std::pow(z, 2) + (1 - LAMBDA) * current, now);
+    seqlock_write_unlock(seq);
 }
 
 void Anchor::update_parameters(float measured_rssi, float estimated_distance){
-    std::tuple<float, float> kaloutpt = kalman.sequence_step(RSSI_0, n, measured_rssi, estimated_distance);
-    RSSI_0 = std::get<0>(kaloutpt);
-    n = std::get<1>(kaloutpt);
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        moved->update_parameters(measured_rssi, estimated_distance);
+        return;
+    }
+    std::tuple<float, float> kaloutpt = kalman.sequence_step(get_RSSI_0(), get_n(), measured_rssi, estimated_distance);
+    store_state(std::get<0>(kaloutpt), std::get<1>(kaloutpt), get_ewma(), get_last_seen());
+    seqlock_write_unlock(seq);
 }
 
-bool Anchor::is_warning() {
-    return ewma >= 4 && ewma < 8;
+void Anchor::update_health_batch(Anchor* const* anchors, const float* z, size_t count, float now, float LAMBDA) {
+    const NumericKernels& kernels = numeric_kernels();
+    for (size_t first = 0; first < count; first += UPDATE_BATCH) {
+        size_t batch = std::min(UPDATE_BATCH, count - first);
+        Anchor* live[UPDATE_BATCH];
+        if (!lock_batch(anchors + first, batch, live)) {
+            // The same anchor twice: its updates depend on each other, apply them in turn
+            for (size_t i = 0; i < batch; i++) {
+                anchors[first + i]->update_health(z[first + i], now, LAMBDA);
+            }
+            continue;
+        }
+        float current[UPDATE_BATCH], updated[UPDATE_BATCH];
+        for (size_t i = 0; i < batch; i++) {
+            current[i] = live[i]->get_ewma();
+        }
+        kernels.health_ewma(z + first, current, batch, LAMBDA, updated);
+        for (size_t i = 0; i < batch; i++) {
+            live[i]->store_state(live[i]->get_RSSI_0(), live[i]->get_n(), updated[i], now);
+        }
+        unlock_batch(live, batch);
+    }
 }
 
-bool Anchor::is_faulty() {
-    return ewma >= 8;
+void Anchor::update_parameters_batch(Anchor* const* anchors, const float* measured_rssi,
+                                     const float* estimated_distance, size_t count) {
+    const NumericKernels& kernels = numeric_kernels();
+    for (size_t first = 0; first < count; first += UPDATE_BATCH) {
+        size_t batch = std::min(UPDATE_BATCH, count - first);
+        Anchor* live[UPDATE_BATCH];
+        if (!lock_batch(anchors + first, batch, live)) {
+            for (size_t i = 0; i < batch; i++) {
+                anchors[first + i]->update_parameters(measured_rssi[first + i], estimated_distance[first + i]);
+            }
+            continue;
+        }
+
+        // Gather: predict every filter and collect its state
+        float rssi_0[UPDATE_BATCH], n_val[UPDATE_BATCH], sigma[UPDATE_BATCH], residual[UPDATE_BATCH];
+        float p00[UPDATE_BATCH], p01[UPDATE_BATCH], p10[UPDATE_BATCH], p11[UPDATE_BATCH];
+        for (size_t i = 0; i < batch; i++) {
+            KalmanFilter& filter = live[i]->kalman;
+            filter.predict(measured_rssi[first + i]);
+            const std::array<std::array<float, 2>, 2>& P = filter.get_P();
+            rssi_0[i] = live[i]->get_RSSI_0();
+            n_val[i] = live[i]->get_n();
+            sigma[i] = filter.get_sigma();
+            p00[i] = P[0][0];
+            p01[i] = P[0][1];
+            p10[i] = P[1][0];
+            p11[i] = P[1][1];
+        }
+
+        kernels.kalman_update(measured_rssi + first, estimated_distance + first, sigma, batch, KalmanFilter::D_0,
+                              rssi_0, n_val, p00, p01, p10, p11, residual);
+
+        // Write back
+        for (size_t i = 0; i < batch; i++) {
+            live[i]->kalman.correct({{{p00[i], p01[i]}, {p10[i], p11[i]}}}, residual[i]);
+            live[i]->store_state(rssi_0[i], n_val[i], live[i]->get_ewma(), live[i]->get_last_seen());
+        }
+        unlock_batch(live, batch);
+    }
+}
+
+void Anchor::restore_calibration(float rssi_0, float n_val, float ewma_val, float last_seen_val) {
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        moved->restore_calibration(rssi_0, n_val, ewma_val, last_seen_val);
+        return;
+    }
+    store_state(rssi_0, n_val, ewma_val, last_seen_val);
+    seqlock_write_unlock(seq);
+}
+
+bool Anchor::merge_calibration(const AnchorState& remote) {
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        return moved->merge_calibration(remote);
+    }
+    auto order = [](const AnchorState& state) {
+        return std::make_tuple(state.version, state.last_seen, state.RSSI_0, state.n, state.ewma);
+    };
+    AnchorState local{get_RSSI_0(), get_n(), get_ewma(), get_last_seen(), get_version()};
+    bool adopt = order(remote) > order(local);
+    if (adopt) {
+        store_state(remote.RSSI_0, remote.n, remote.ewma, remote.last_seen);
+        version.store(remote.version, std::memory_order_relaxed);
+    }
+    seqlock_write_unlock(seq);
+    return adopt;
+}
+
+void Anchor::save_state(AnchorState& state, KalmanState& kalman_state) {
+    // Hold the write side so the Kalman filter is not copied mid-update
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        moved->save_state(state, kalman_state);
+        return;
+    }
+    state = AnchorState{get_RSSI_0(), get_n(), get_ewma(), get_last_seen(), get_version()};
+    kalman_state = kalman.get_state();
+    seqlock_write_unlock(seq);
+}
+
+void Anchor::restore_state(const AnchorState& state, const KalmanState& kalman_state) {
+    seqlock_write_lock(seq);
+    if (Anchor* moved = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        moved->restore_state(state, kalman_state);
+        return;
+    }
+    kalman.set_state(kalman_state);
+    store_state(state.RSSI_0, state.n, state.ewma, state.last_seen);
+    version.store(state.version, std::memory_order_relaxed);
+    seqlock_write_unlock(seq);
+}
+
+std::unique_ptr<Anchor> Anchor::relocated(PointR3 coordinate) {
+    // Hold the write side so the Kalman filter is not copied mid-update
+    seqlock_write_lock(seq);
+    if (Anchor* compacted = forward.load(std::memory_order_acquire)) {
+        seqlock_write_unlock(seq);
+        return compacted->relocated(coordinate);
+    }
+    std::unique_ptr<Anchor> moved(new Anchor(*this, coordinate));
+    seqlock_write_unlock(seq);
+    return moved;
+}
+
+Anchor* Anchor::move_into(void* storage) {
+    // Hold the write side so no update lands between the copy and setting forward
+    seqlock_write_lock(seq);
+    Anchor* moved = new (storage) Anchor(*this, coord);
+    moved->ewma.store(get_ewma(), std::memory_order_relaxed);
+    moved->version.store(get_version(), std::memory_order_relaxed);
+    forward.store(moved, std::memory_order_release);
+    seqlock_write_unlock(seq);
+    return moved;
+}
+
+bool Anchor::is_warning() const {
+    float current = get_ewma();
+    return current >= 4 && current < 8;
+}
+
+bool Anchor::is_faulty() const {
+    return get_ewma() >= 8;
+}
+
+//helpers:
+// Caller holds the write side of seq
+void Anchor::store_state(float rssi_0, float n_val, float ewma_val, float last_seen_val) {
+    RSSI_0.store(rssi_0, std::memory_order_relaxed);
+    n.store(n_val, std::memory_order_relaxed);
+    ewma.store(ewma_val, std::memory_order_relaxed);
+    last_seen.store(last_seen_val, std::memory_order_relaxed);
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+bool Anchor::lock_batch(Anchor* const* anchors, size_t count, Anchor** live) {
+    std::copy(anchors, anchors + count, live);
+    while (true) {
+        for (size_t i = 0; i < count; i++) {
+            while (Anchor* moved = live[i]->forward.load(std::memory_order_acquire)) {
+                live[i] = moved;
+            }
+        }
+        // A single address order for every batch, so two batches never wait on each other
+        Anchor* order[UPDATE_BATCH];
+        std::copy(live, live + count, order);
+        std::sort(order, order + count);
+        if (std::adjacent_find(order, order + count) != order + count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            seqlock_write_lock(order[i]->seq);
+        }
+        // forward is only set under the lock: once locked and unset, it stays unset
+        bool forwarded = std::any_of(order, order + count, [](const Anchor* anchor) {
+            return anchor->forward.load(std::memory_order_acquire) != nullptr;
+        });
+        if (!forwarded) {
+            return true;
+        }
+        unlock_batch(order, count);
+    }
+}
+
+void Anchor::unlock_batch(Anchor* const* live, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        seqlock_write_unlock(live[i]->seq);
+    }
 }
 
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -9,18 +12,49 @@
 #include "utils.h"
 #include "kalman.h"
 #include "config.h"
+#include "seqlock.h"
+
+/**
+ * @brief Consistent copy of an anchor's hot state
+ * 
+ * Taken with Anchor::snapshot(), so all fields belong to the same update.
+ * version counts the updates applied to the anchor since construction.
+ */
+struct AnchorState {
+    float RSSI_0;
+    float n;
+    float ewma;
+    float last_seen;
+    uint32_t version;
+};
 
 //Anchor class
 class Anchor {
     private:
         std::string mac_address;
         PointR3 coord;
-        float ewma = 1.0;
-        float last_seen = 0.0;
-        float RSSI_0 = -59.0;
-        float n = 2.0;
+        // Hot state, guarded by the seq sequence lock (see seqlock.h)
+        std::atomic<uint32_t> seq{0};
+        std::atomic<float> ewma{1.0f};
+        std::atomic<float> last_seen{0.0f};
+        std::atomic<float> RSSI_0{-59.0f};
+        std::atomic<float> n{2.0f};
+        std::atomic<uint32_t> version{0};
+        // Set once by move_into(); updates arriving here afterwards go to that copy
+        std::atomic<Anchor*> forward{nullptr};
+        // Only touched by writers holding the sequence lock
         KalmanFilter kalman = KalmanFilter();
 
+        void store_state(float rssi_0, float n_val, float ewma_val, float last_seen_val);
+
+        // Write-lock count (<= UPDATE_BATCH) anchors in address order, following forwards; live
+        // receives the locked anchors in input order. false, with nothing locked, if two are the same
+        static bool lock_batch(Anchor* const* anchors, size_t count, Anchor** live);
+        static void unlock_batch(Anchor* const* live, size_t count);
+
+        // Relocated copy of source, see relocated(); caller holds the write side of source.seq
+        Anchor(const Anchor& source, PointR3 coordinate);
+
     public:
         /**
          * @brief Construct a new Anchor object representing a BLE beacon
@@ -35,6 +69,16 @@ class Anchor {
          */
         Anchor(std::string mac, PointR3 coordinate, float timestamp);
 
+        /**
+         * @brief Copy an anchor, taking a consistent snapshot of its hot state
+         * 
+         * The Kalman filter is copied as is, so the source must not be updated concurrently.
+         * 
+         * @param other Anchor to copy
+         */
+        Anchor(const Anchor& other);
+        Anchor& operator=(const Anchor&) = delete;
+
         /**
          * @brief Gets the MAC address identifier of the anchor
          * @return std::string MAC address string
@@ -71,18 +115,35 @@ class Anchor {
          */
         float get_n() const;
         
+        /**
+         * @brief Gets the number of updates applied to the anchor
+         * @return uint32_t Version counter, bumped by every health, parameter or restore update
+         */
+        uint32_t get_version() const;
+        
         /**
          * @brief Gets a constant reference to the Kalman filter
          * @return const KalmanFilter& Reference to the internal Kalman filter
          */
         const KalmanFilter& get_kalman() const;
 
+        /**
+         * @brief Read RSSI_0, n, ewma, last_seen and version as one consistent snapshot
+         * 
+         * Lock-free: retries while a writer is updating the anchor, never blocks it.
+         * Use this instead of several getters whenever values must belong together.
+         * 
+         * @return AnchorState Consistent copy of the hot state
+         */
+        AnchorState snapshot() const;
+
         /**
          * @brief Update the health monitoring metrics for this anchor
          * 
          * Uses an Exponentially Weighted Moving Average (EWMA) to track the health
          * of the anchor based on measurement residuals. Higher residuals indicate
          * potential anchor issues (movement, interference, failure).
+         * Concurrent writers to the same anchor serialize on its sequence lock.
          * 
          * @param z Measurement residual (difference between predicted and observed RSSI)
          * @param now Current timestamp (epoch time)
@@ -96,11 +157,125 @@ class Anchor {
          * Uses the anchor's Kalman filter to refine estimates of RSSI_0 (signal strength
          * at 1 meter) and n (path loss exponent) based on new RSSI and distance measurements.
          * This enables adaptive calibration as environmental conditions change.
+         * The Kalman step runs under the anchor's sequence lock, so concurrent
+         * writers to the same anchor serialize while readers stay lock-free.
          * 
          * @param measured_rssi Observed RSSI value in dBm
          * @param estimated_distance Estimated distance to the measurement point in meters
          */
         void update_parameters(float measured_rssi, float estimated_distance);
+
+        // Anchors gathered into one kernel call by the batch updates below
+        static constexpr size_t UPDATE_BATCH = 16;
+
+        /**
+         * @brief update_health() for many anchors, with the EWMA computed by one batched kernel
+         *
+         * Gathers the anchors' EWMAs under their sequence locks, runs NumericKernels::health_ewma
+         * and writes each result back before releasing the locks. Same results as calling
+         * update_health() on each anchor in turn. The locks of up to UPDATE_BATCH anchors are
+         * held together, taken in address order so concurrent batches cannot deadlock.
+         *
+         * @param anchors Anchors to update
+         * @param z Measurement residual of each anchor
+         * @param count Number of anchors
+         * @param now Current timestamp (epoch time)
+         * @param LAMBDA Smoothing factor for EWMA
+         */
+        static void update_health_batch(Anchor* const* anchors, const float* z, size_t count, float now,
+                                        float LAMBDA = Calibration::LAMBDA_EWMA);
+
+        /**
+         * @brief update_parameters() for many anchors, with the Kalman arithmetic run as one batched kernel
+         *
+         * Each filter is predicted under its anchor's sequence lock (KalmanFilter::predict), the
+         * update half runs for the whole batch in NumericKernels::kalman_update, and the results
+         * are written back (KalmanFilter::correct and the hot state) before the locks are
+         * released. Same results as calling update_parameters() on each anchor in turn; locking
+         * works as in update_health_batch().
+         *
+         * @param anchors Anchors to update
+         * @param measured_rssi Observed RSSI of each anchor in dBm
+         * @param estimated_distance Estimated distance of each anchor in meters
+         * @param count Number of anchors
+         */
+        static void update_parameters_batch(Anchor* const* anchors, const float* measured_rssi,
+                                            const float* estimated_distance, size_t count);
+        
+        /**
+         * @brief Restore calibration and health state computed elsewhere
+         * 
+         * Used to adopt state shared by another process through the shared-memory
+         * anchor store. The Kalman filter history is kept as is.
+         * 
+         * @param rssi_0 RSSI at 1 meter in dBm
+         * @param n_val Path loss exponent
+         * @param ewma_val EWMA health metric
+         * @param last_seen_val Timestamp when the anchor was last seen
+         */
+        void restore_calibration(float rssi_0, float n_val, float ewma_val, float last_seen_val);
+
+        /**
+         * @brief Adopt calibration and health from another engine instance if it is newer
+         *
+         * Versions act as Lamport clocks between instances: the remote state wins when
+         * its version is higher; equal versions are ordered by last_seen, then by value, so
+         * every instance picks the same winner. The adopted version replaces the local one,
+         * so updates applied here afterwards outrank the adopted state. The Kalman filter
+         * history is kept as is.
+         *
+         * @param remote State received from another instance
+         * @return bool true if the remote state was adopted
+         */
+        bool merge_calibration(const AnchorState& remote);
+
+        /**
+         * @brief Copy the hot state and the Kalman filter state as one consistent pair
+         *
+         * Takes the write side of the sequence lock while copying, so it briefly serializes
+         * with updates to this anchor. Used to export state snapshots.
+         *
+         * @param state Receives RSSI_0, n, ewma, last_seen and version
+         * @param kalman_state Receives the Kalman filter state
+         */
+        void save_state(AnchorState& state, KalmanState& kalman_state);
+
+        /**
+         * @brief Restore state saved with save_state(), including the Kalman filter and version
+         *
+         * Unlike restore_calibration() the anchor continues exactly as the saved one would,
+         * e.g. in another process that imported a state snapshot.
+         *
+         * @param state Hot state to adopt; version is taken as is
+         * @param kalman_state Kalman filter state to adopt
+         */
+        void restore_state(const AnchorState& state, const KalmanState& kalman_state);
+
+        /**
+         * @brief Create a copy of this anchor at a new position
+         *
+         * Used when the site configuration reports that the dongle was moved. Calibration
+         * (RSSI_0, n and the Kalman filter) carries over; health restarts from its initial
+         * value since past residuals were measured against the old position. The copy's
+         * version is one past this anchor's. Updates applied to this anchor afterwards are
+         * not carried over.
+         *
+         * @param coordinate New 3D position (x, y, z) in meters
+         * @return std::unique_ptr<Anchor> Relocated anchor, to be published in place of this one
+         */
+        std::unique_ptr<Anchor> relocated(PointR3 coordinate);
+        /**
+         * @brief Copy this anchor into caller-provided storage and forward later updates there
+         *
+         * Used by AnchorRegistry::compact to lay anchors out contiguously. The copy has the
+         * same state, Kalman filter and version. Health, parameter and calibration updates
+         * applied to this anchor afterwards (by readers still holding it) are applied to the
+         * copy instead, so none are lost; snapshots of this anchor stop following them.
+         *
+         * @param storage Uninitialized memory of sizeof(Anchor) bytes, aligned for Anchor
+         * @return Anchor* The copy, constructed in storage
+         */
+        Anchor* move_into(void* storage);
         
         /**
          * @brief Check if anchor is in warning state based on health metrics
@@ -110,7 +285,7 @@ class Anchor {
          * 
          * @return bool true if EWMA is between 4 and 8 (exclusive), false otherwise
          */
-        bool is_warning();
+        bool is_warning() const;
         
         /**
          * @brief Check if anchor is in faulty state based on health metrics
@@ -120,7 +295,7 @@ class Anchor {
          * 
          * @return bool true if EWMA is 8 or higher, false otherwise
          */
-        bool is_faulty();
+        bool is_faulty() const;
         
         // Equality operator for use as map key
         bool operator==(const Anchor& other) const {
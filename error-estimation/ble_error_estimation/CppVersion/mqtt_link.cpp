@@ -0,0 +1,131 @@
+#include <iostream>
+
+#include <sys/epoll.h>
+
+#include "mqtt_link.h"
+
+namespace {
+    // Always readable; writable only while libmosquitto has packets waiting to be sent
+    uint32_t interest_for(struct mosquitto* mosq) {
+        return static_cast<uint32_t>(EPOLLIN) | (mosquitto_want_write(mosq) ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    }
+}
+
+/*MQTTLINK*/
+//constructor:
+MqttLink::MqttLink(Reactor& event_loop, struct mosquitto* client, std::string name,
+                   uint32_t misc_interval_ms, uint32_t reconnect_delay)
+    : reactor(event_loop), mosq(client), link_name(std::move(name)), reconnect_delay_ms(reconnect_delay) {
+    // Keepalive pings and QoS retries normally done by the mosquitto loop thread
+    misc_timer = reactor.add_periodic(misc_interval_ms, [this]() {
+        mosquitto_loop_misc(mosq);
+        update_interest();
+    });
+}
+
+MqttLink::~MqttLink() {
+    reactor.cancel_timer(misc_timer);
+    if (reconnect_timer != 0) {
+        reactor.cancel_timer(reconnect_timer);
+    }
+    if (watched_fd >= 0) {
+        reactor.remove_fd(watched_fd);
+    }
+}
+
+//methods:
+int MqttLink::connect(const std::string& host, int port, int keepalive) {
+    closing = false;
+    int result = mosquitto_connect_async(mosq, host.c_str(), port, keepalive);
+    if (result == MOSQ_ERR_SUCCESS) {
+        update_interest();
+    }
+    return result;
+}
+
+int MqttLink::disconnect() {
+    closing = true;
+    if (reconnect_timer != 0) {
+        reactor.cancel_timer(reconnect_timer);
+        reconnect_timer = 0;
+    }
+    int result = mosquitto_disconnect(mosq);
+    update_interest();
+    return result;
+}
+
+void MqttLink::update_interest() {
+    int fd = mosquitto_socket(mosq);
+
+    if (fd != watched_fd) {
+        // The socket was closed (connection lost) or replaced (reconnected)
+        if (watched_fd >= 0) {
+            reactor.remove_fd(watched_fd);
+        }
+        watched_fd = -1;
+        watched_events = 0;
+
+        if (fd < 0) {
+            if (!closing) {
+                schedule_reconnect();
+            }
+            return;
+        }
+        watched_events = interest_for(mosq);
+        reactor.add_fd(fd, watched_events, [this](uint32_t events) { on_ready(events); });
+        watched_fd = fd;
+        return;
+    }
+
+    if (fd < 0) {
+        return; // Still disconnected, a reconnect is pending
+    }
+
+    uint32_t events = interest_for(mosq);
+    if (events != watched_events) {
+        reactor.modify_fd(fd, events);
+        watched_events = events;
+    }
+}
+
+//helpers:
+void MqttLink::on_ready(uint32_t events) {
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        int result = mosquitto_loop_read(mosq, 1);
+        if (result != MOSQ_ERR_SUCCESS) {
+            handle_error(result);
+            return;
+        }
+    }
+    if (events & EPOLLOUT) {
+        int result = mosquitto_loop_write(mosq, 1);
+        if (result != MOSQ_ERR_SUCCESS) {
+            handle_error(result);
+            return;
+        }
+    }
+    update_interest();
+}
+
+void MqttLink::handle_error(int result) {
+    // libmosquitto has already closed the socket and called the disconnect callback
+    std::cerr << link_name << " MQTT connection error: " << mosquitto_strerror(result) << std::endl;
+    update_interest();
+}
+
+void MqttLink::schedule_reconnect() {
+    if (reconnect_timer != 0) {
+        return;
+    }
+    reconnect_timer = reactor.add_timer(reconnect_delay_ms, [this]() {
+        reconnect_timer = 0;
+        std::cout << "Reconnecting to " << link_name << " MQTT broker..." << std::endl;
+        int result = mosquitto_reconnect_async(mosq);
+        if (result != MOSQ_ERR_SUCCESS) {
+            std::cerr << "Failed to reconnect to " << link_name << " MQTT broker: " << mosquitto_strerror(result) << std::endl;
+            schedule_reconnect();
+            return;
+        }
+        update_interest();
+    });
+}
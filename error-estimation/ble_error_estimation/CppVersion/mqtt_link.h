@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+
+#include <mosquitto.h>
+
+#include "config.h"
+#include "reactor.h"
+
+/**
+ * @brief Drives one libmosquitto client from the reactor instead of a mosquitto loop thread
+ *
+ * The client's socket is watched for reads (and for writes while libmosquitto has
+ * queued packets), keepalives run from a periodic timer, and dropped connections
+ * are re-established after a delay. All calls into the client, including
+ * mosquitto_publish, must happen on the reactor thread.
+ */
+class MqttLink {
+    public:
+        /**
+         * @brief Bind a client to the reactor; the client stays owned by the caller
+         * @param reactor Event loop driving the client
+         * @param client libmosquitto client, without a loop thread
+         * @param name Name used in log messages, e.g. "INPUT"
+         */
+        MqttLink(Reactor& reactor, struct mosquitto* client, std::string name,
+                 uint32_t misc_interval_ms = Config::MQTT_MISC_INTERVAL_MS,
+                 uint32_t reconnect_delay_ms = Config::MQTT_RECONNECT_DELAY_MS);
+
+        /**
+         * @brief Stop watching the client socket and cancel the link's timers
+         */
+        ~MqttLink();
+
+        MqttLink(const MqttLink&) = delete;
+        MqttLink& operator=(const MqttLink&) = delete;
+
+        /**
+         * @brief Start a non-blocking connection to the broker
+         *
+         * Also after disconnect(): dropped connections are reconnected again from then on.
+         *
+         * @return int MOSQ_ERR_SUCCESS or the libmosquitto error
+         */
+        int connect(const std::string& host, int port, int keepalive);
+
+        /**
+         * @brief Disconnect cleanly: the DISCONNECT packet is sent by the reactor and no reconnect follows
+         * @return int MOSQ_ERR_SUCCESS or the libmosquitto error
+         */
+        int disconnect();
+
+        /**
+         * @brief Refresh socket interest after queuing packets (e.g. after mosquitto_publish)
+         */
+        void update_interest();
+
+    private:
+        Reactor& reactor;
+        struct mosquitto* mosq;
+        std::string link_name;
+        uint32_t reconnect_delay_ms;
+        int watched_fd = -1;
+        uint32_t watched_events = 0;
+        Reactor::TimerId misc_timer = 0;
+        Reactor::TimerId reconnect_timer = 0;
+        bool closing = false;
+
+        void on_ready(uint32_t events);
+        void handle_error(int result);
+        void schedule_reconnect();
+};
@@ -0,0 +1,479 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mqtt_subscriber.h"
+
+namespace {
+    // MQTT 3.1.1 control packet types (high nibble of the fixed header)
+    constexpr uint8_t CONNECT = 0x10;
+    constexpr uint8_t CONNACK = 0x20;
+    constexpr uint8_t PUBLISH = 0x30;
+    constexpr uint8_t PUBACK = 0x40;
+    constexpr uint8_t SUBSCRIBE = 0x82;   // Reserved flags 0b0010 are mandatory
+    constexpr uint8_t SUBACK = 0x90;
+    constexpr uint8_t PINGREQ = 0xC0;
+    constexpr uint8_t PINGRESP = 0xD0;
+    constexpr uint8_t DISCONNECT = 0xE0;
+
+    constexpr size_t MAX_REMAINING_LENGTH = 268435455;   // Largest value of the 4-byte varint
+
+    void append_u16(std::string& out, uint16_t value) {
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    void append_string(std::string& out, std::string_view value) {
+        append_u16(out, static_cast<uint16_t>(value.size()));
+        out.append(value);
+    }
+
+    void append_remaining_length(std::string& out, size_t length) {
+        do {
+            uint8_t byte = length % 128;
+            length /= 128;
+            if (length > 0) {
+                byte |= 0x80;
+            }
+            out.push_back(static_cast<char>(byte));
+        } while (length > 0);
+    }
+
+    std::string packet(uint8_t header, const std::string& body) {
+        std::string out;
+        out.reserve(body.size() + 5);
+        out.push_back(static_cast<char>(header));
+        append_remaining_length(out, body.size());
+        out.append(body);
+        return out;
+    }
+
+    uint16_t read_u16(const char* data) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(data[0]) << 8) | static_cast<uint8_t>(data[1]));
+    }
+
+    enum class Header { Complete, Incomplete, Malformed };
+
+    /**
+     * @brief Decode the fixed header at data
+     * @param header_bytes Set to the size of the fixed header
+     * @param remaining Set to the remaining length
+     */
+    Header decode_fixed_header(const char* data, size_t available, size_t& header_bytes, size_t& remaining) {
+        remaining = 0;
+        size_t multiplier = 1;
+        for (size_t i = 1; i <= 4; i++) {
+            if (i >= available) {
+                return Header::Incomplete;
+            }
+            uint8_t byte = static_cast<uint8_t>(data[i]);
+            remaining += (byte & 0x7F) * multiplier;
+            if ((byte & 0x80) == 0) {
+                header_bytes = i + 1;
+                return Header::Complete;
+            }
+            multiplier *= 128;
+        }
+        return Header::Malformed;
+    }
+}
+
+/*MQTTSUBSCRIBER*/
+//constructor:
+MqttSubscriber::MqttSubscriber(Reactor& event_loop, std::string client_id, std::string name, MessageHandler handler,
+                               size_t buffer_bytes, size_t max_packet_bytes, uint32_t reconnect_delay)
+    : reactor(event_loop), client(std::move(client_id)), link_name(std::move(name)), on_message(std::move(handler)),
+      max_packet(std::min(std::max(max_packet_bytes, buffer_bytes), MAX_REMAINING_LENGTH + 5)),
+      reconnect_delay_ms(reconnect_delay), buffer(std::max<size_t>(buffer_bytes, 64)) {
+}
+
+MqttSubscriber::~MqttSubscriber() {
+    wanted = false;
+    if (reconnect_timer != 0) {
+        reactor.cancel_timer(reconnect_timer);
+    }
+    close_socket();
+}
+
+//methods:
+bool MqttSubscriber::connect(const std::string& host, int port, int keepalive, std::string topic, int qos) {
+    broker_host = host;
+    broker_port = port;
+    keepalive_sec = std::max(keepalive, 0);
+    topic_filter = std::move(topic);
+    requested_qos = std::clamp(qos, 0, 1);
+    wanted = true;
+    close_socket();
+    return open_socket();
+}
+
+void MqttSubscriber::disconnect() {
+    wanted = false;
+    if (reconnect_timer != 0) {
+        reactor.cancel_timer(reconnect_timer);
+        reconnect_timer = 0;
+    }
+    if (fd >= 0 && state != State::Connecting) {
+        // Best effort: a full socket buffer just loses the DISCONNECT
+        queue(std::string{static_cast<char>(DISCONNECT), 0});
+        flush();
+    }
+    close_socket();
+}
+
+bool MqttSubscriber::is_subscribed() const {
+    return state == State::Subscribed;
+}
+
+const MqttSubscriberStats& MqttSubscriber::stats() const {
+    return counters;
+}
+
+//helpers:
+bool MqttSubscriber::open_socket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    std::string service = std::to_string(broker_port);
+    int resolved = getaddrinfo(broker_host.c_str(), service.c_str(), &hints, &addresses);
+    if (resolved != 0) {
+        std::cerr << "Failed to resolve " << link_name << " MQTT broker " << broker_host << ": "
+                  << gai_strerror(resolved) << std::endl;
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        int socket_fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+        if (socket_fd < 0) {
+            continue;
+        }
+        int enable = 1;
+        setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        if (::connect(socket_fd, address->ai_addr, address->ai_addrlen) == 0 || errno == EINPROGRESS) {
+            fd = socket_fd;
+            break;
+        }
+        close(socket_fd);
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        std::cerr << "Failed to connect to " << link_name << " MQTT broker " << broker_host << ":" << broker_port
+                  << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    state = State::Connecting;
+    head = 0;
+    tail = 0;
+    outgoing.clear();
+    watched_events = EPOLLIN | EPOLLOUT;
+    reactor.add_fd(fd, watched_events, [this](uint32_t events) { on_ready(events); });
+    return true;
+}
+
+void MqttSubscriber::on_ready(uint32_t events) {
+    if (state == State::Connecting) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+            error = errno;
+        }
+        if (error != 0) {
+            drop(std::strerror(error));
+            return;
+        }
+        if (!(events & (EPOLLOUT | EPOLLIN))) {
+            return;
+        }
+        on_connected();
+        if (fd < 0) {
+            return;
+        }
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        if (!read_available()) {
+            return;
+        }
+    }
+    if (!flush()) {
+        return;
+    }
+    update_interest();
+}
+
+void MqttSubscriber::on_connected() {
+    std::string body;
+    append_string(body, "MQTT");
+    body.push_back(4);                               // Protocol level 3.1.1
+    body.push_back(0x02);                            // Clean session, no will, no credentials
+    append_u16(body, static_cast<uint16_t>(keepalive_sec));
+    append_string(body, client);
+    queue(packet(CONNECT, body));
+    state = State::AwaitingConnack;
+    last_received = std::chrono::steady_clock::now();
+
+    if (keepalive_sec > 0 && keepalive_timer == 0) {
+        uint32_t interval_ms = static_cast<uint32_t>(keepalive_sec) * 1000 / 4;
+        keepalive_timer = reactor.add_periodic(std::max<uint32_t>(interval_ms, 1), [this]() { check_keepalive(); });
+    }
+}
+
+bool MqttSubscriber::read_available() {
+    size_t batch = 0;
+    while (true) {
+        if (tail == buffer.size()) {
+            if (head > 0) {
+                // A packet split across reads: move its first part to the front
+                std::memmove(buffer.data(), buffer.data() + head, tail - head);
+                tail -= head;
+                head = 0;
+            } else if (buffer.size() < max_packet) {
+                buffer.resize(std::min(buffer.size() * 2, max_packet));
+            } else {
+                drop("packet larger than " + std::to_string(max_packet) + " bytes");
+                return false;
+            }
+        }
+
+        ssize_t received = recv(fd, buffer.data() + tail, buffer.size() - tail, 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            drop(std::strerror(errno));
+            return false;
+        }
+        if (received == 0) {
+            drop("connection closed by broker");
+            return false;
+        }
+        counters.reads++;
+        counters.bytes_received += static_cast<size_t>(received);
+        tail += static_cast<size_t>(received);
+        last_received = std::chrono::steady_clock::now();
+
+        size_t before = counters.messages;
+        if (!decode_packets()) {
+            return false;
+        }
+        batch += counters.messages - before;
+        if (head == tail) {
+            head = 0;
+            tail = 0;
+        }
+    }
+    counters.max_batch = std::max(counters.max_batch, batch);
+    return true;
+}
+
+bool MqttSubscriber::decode_packets() {
+    while (head < tail) {
+        size_t header_bytes = 0;
+        size_t remaining = 0;
+        Header header = decode_fixed_header(buffer.data() + head, tail - head, header_bytes, remaining);
+        if (header == Header::Malformed) {
+            drop("malformed remaining length");
+            return false;
+        }
+        if (header == Header::Incomplete || tail - head < header_bytes + remaining) {
+            if (header == Header::Complete && header_bytes + remaining > max_packet) {
+                drop("packet larger than " + std::to_string(max_packet) + " bytes");
+                return false;
+            }
+            return true;
+        }
+
+        uint8_t type = static_cast<uint8_t>(buffer[head]);
+        const char* body = buffer.data() + head + header_bytes;
+        head += header_bytes + remaining;
+        counters.packets++;
+        if (!handle_packet(type, body, remaining)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MqttSubscriber::handle_packet(uint8_t header, const char* body, size_t length) {
+    switch (header & 0xF0) {
+        case PUBLISH: {
+            int qos = (header >> 1) & 0x03;
+            if (qos > 1 || length < 2) {
+                drop(qos > 1 ? "QoS 2 PUBLISH not supported" : "truncated PUBLISH");
+                return false;
+            }
+            size_t topic_length = read_u16(body);
+            size_t offset = 2 + topic_length;
+            if (offset + (qos > 0 ? 2 : 0) > length) {
+                drop("truncated PUBLISH");
+                return false;
+            }
+            std::string_view topic(body + 2, topic_length);
+            uint16_t packet_id = 0;
+            if (qos > 0) {
+                packet_id = read_u16(body + offset);
+                offset += 2;
+            }
+            counters.messages++;
+            on_message(topic, std::string_view(body + offset, length - offset));
+            if (fd < 0) {
+                return false;   // The handler disconnected
+            }
+            if (qos > 0) {
+                // Acknowledged once handed over; sent with the rest of the batch
+                char ack[4] = {static_cast<char>(PUBACK), 2, static_cast<char>(packet_id >> 8), static_cast<char>(packet_id & 0xFF)};
+                outgoing.append(ack, sizeof(ack));
+            }
+            return true;
+        }
+        case CONNACK: {
+            if (state != State::AwaitingConnack || length < 2) {
+                drop("unexpected CONNACK");
+                return false;
+            }
+            int code = static_cast<uint8_t>(body[1]);
+            if (code != 0) {
+                drop("connection refused, code " + std::to_string(code));
+                return false;
+            }
+            std::string subscribe;
+            append_u16(subscribe, next_packet_id);
+            next_packet_id = next_packet_id == 0xFFFF ? 1 : next_packet_id + 1;
+            append_string(subscribe, topic_filter);
+            subscribe.push_back(static_cast<char>(requested_qos));
+            queue(packet(SUBSCRIBE, subscribe));
+            state = State::AwaitingSuback;
+            return true;
+        }
+        case SUBACK: {
+            if (state != State::AwaitingSuback || length < 3) {
+                drop("unexpected SUBACK");
+                return false;
+            }
+            if (static_cast<uint8_t>(body[2]) == 0x80) {
+                drop("subscription to " + topic_filter + " refused");
+                return false;
+            }
+            state = State::Subscribed;
+            counters.connects++;
+            std::cout << "Successfully subscribed to: " << topic_filter << std::endl;
+            return true;
+        }
+        case PINGRESP:
+            return true;
+        default:
+            // Nothing else is sent to a subscriber that only uses QoS 0 and 1
+            std::cerr << link_name << " MQTT: ignoring packet type 0x" << std::hex << static_cast<int>(header) << std::dec << std::endl;
+            return true;
+    }
+}
+
+void MqttSubscriber::queue(const std::string& data) {
+    outgoing.append(data);
+}
+
+bool MqttSubscriber::flush() {
+    size_t sent_total = 0;
+    while (sent_total < outgoing.size()) {
+        ssize_t sent = send(fd, outgoing.data() + sent_total, outgoing.size() - sent_total, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            drop(std::strerror(errno));
+            return false;
+        }
+        sent_total += static_cast<size_t>(sent);
+    }
+    if (sent_total > 0) {
+        outgoing.erase(0, sent_total);
+        last_sent = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+void MqttSubscriber::update_interest() {
+    uint32_t events = EPOLLIN | (outgoing.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    if (fd >= 0 && events != watched_events) {
+        reactor.modify_fd(fd, events);
+        watched_events = events;
+    }
+}
+
+void MqttSubscriber::check_keepalive() {
+    if (fd < 0 || state == State::Connecting) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto keepalive = std::chrono::seconds(keepalive_sec);
+    if (now - last_received > keepalive + keepalive / 2) {
+        drop("keepalive timeout");
+        return;
+    }
+    if (now - last_sent >= keepalive / 2) {
+        queue(std::string{static_cast<char>(PINGREQ), 0});
+        counters.pings++;
+        if (flush()) {
+            update_interest();
+        }
+    }
+}
+
+void MqttSubscriber::drop(const std::string& reason) {
+    std::cerr << link_name << " MQTT connection error: " << reason << std::endl;
+    counters.errors++;
+    close_socket();
+    schedule_reconnect();
+}
+
+void MqttSubscriber::close_socket() {
+    if (keepalive_timer != 0) {
+        reactor.cancel_timer(keepalive_timer);
+        keepalive_timer = 0;
+    }
+    if (fd >= 0) {
+        reactor.remove_fd(fd);
+        close(fd);
+        fd = -1;
+    }
+    state = State::Disconnected;
+    watched_events = 0;
+    outgoing.clear();
+    head = 0;
+    tail = 0;
+}
+
+void MqttSubscriber::schedule_reconnect() {
+    if (!wanted || reconnect_timer != 0) {
+        return;
+    }
+    reconnect_timer = reactor.add_timer(reconnect_delay_ms, [this]() {
+        reconnect_timer = 0;
+        if (!wanted || fd >= 0) {
+            return;
+        }
+        std::cout << "Reconnecting to " << link_name << " MQTT broker..." << std::endl;
+        if (!open_socket()) {
+            schedule_reconnect();
+        }
+    });
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+#include "reactor.h"
+
+/**
+ * @brief Counters of an MqttSubscriber since construction
+ */
+struct MqttSubscriberStats {
+    size_t connects = 0;           // Subscriptions acknowledged (one per successful connection)
+    size_t reads = 0;              // recv calls that returned data
+    size_t bytes_received = 0;
+    size_t packets = 0;            // Control packets decoded, all types
+    size_t messages = 0;           // PUBLISH packets handed to the handler
+    size_t max_batch = 0;          // Most PUBLISH packets decoded from one readable event
+    size_t pings = 0;              // PINGREQ sent
+    size_t errors = 0;             // Connections dropped by a socket or protocol error
+};
+
+/**
+ * @brief Minimal MQTT 3.1.1 subscriber driven by the reactor, for the ingest path
+ *
+ * Supports exactly what the engine needs: CONNECT (clean session, no credentials),
+ * one SUBSCRIBE, QoS 0 and QoS 1 PUBLISH (acknowledged with PUBACK), PINGREQ and
+ * DISCONNECT. Packets are decoded in place from a receive buffer that is refilled
+ * from the socket: every complete PUBLISH of a read is handed to the handler as a
+ * view into that buffer, without copying or allocating, and the PUBACKs of the batch
+ * go out in one write. Only a packet split across reads is moved, to the front of
+ * the buffer, before the rest arrives.
+ *
+ * Views passed to the handler are valid only during the call. Dropped connections
+ * are re-established after a delay and the subscription is renewed. All methods
+ * must be called on the reactor thread.
+ *
+ * Example:
+ *     MqttSubscriber input(reactor, "client", "INPUT", [](std::string_view topic, std::string_view payload) { ... });
+ *     input.connect("localhost", 1883, 60, "engine/+/positions", 0);
+ */
+class MqttSubscriber {
+    public:
+        using MessageHandler = std::function<void(std::string_view topic, std::string_view payload)>;
+
+        /**
+         * @param reactor Event loop driving the connection
+         * @param client_id MQTT client identifier
+         * @param name Name used in log messages, e.g. "INPUT"
+         * @param handler Called on the reactor thread for every PUBLISH
+         * @param buffer_bytes Initial receive buffer size
+         * @param max_packet_bytes Largest packet accepted; larger ones drop the connection
+         * @param reconnect_delay_ms Delay before reconnecting a dropped connection
+         */
+        MqttSubscriber(Reactor& reactor, std::string client_id, std::string name, MessageHandler handler,
+                       size_t buffer_bytes = Config::MQTT_SUBSCRIBER_BUFFER_BYTES,
+                       size_t max_packet_bytes = Config::MQTT_SUBSCRIBER_MAX_PACKET_BYTES,
+                       uint32_t reconnect_delay_ms = Config::MQTT_RECONNECT_DELAY_MS);
+
+        /**
+         * @brief Close the connection and cancel the subscriber's timers
+         */
+        ~MqttSubscriber();
+
+        MqttSubscriber(const MqttSubscriber&) = delete;
+        MqttSubscriber& operator=(const MqttSubscriber&) = delete;
+
+        /**
+         * @brief Start a non-blocking connection, then subscribe once the broker accepts it
+         * @param host Broker host name or address (resolved synchronously)
+         * @param port Broker port
+         * @param keepalive Keepalive in seconds, 0 to disable
+         * @param topic Topic filter to subscribe to
+         * @param qos Requested QoS, 0 or 1
+         * @return bool false if the host cannot be resolved or no socket can be opened
+         */
+        bool connect(const std::string& host, int port, int keepalive, std::string topic, int qos);
+
+        /**
+         * @brief Send DISCONNECT and close; no reconnection afterwards
+         */
+        void disconnect();
+
+        /**
+         * @brief Check whether the subscription is active
+         */
+        bool is_subscribed() const;
+
+        /**
+         * @brief Gets the counters since construction
+         */
+        const MqttSubscriberStats& stats() const;
+
+    private:
+        enum class State { Disconnected, Connecting, AwaitingConnack, AwaitingSuback, Subscribed };
+
+        Reactor& reactor;
+        std::string client;
+        std::string link_name;
+        MessageHandler on_message;
+        size_t max_packet;
+        uint32_t reconnect_delay_ms;
+
+        std::string broker_host;
+        int broker_port = 0;
+        int keepalive_sec = 0;
+        std::string topic_filter;
+        int requested_qos = 0;
+        bool wanted = false;           // Reconnect after a drop
+
+        State state = State::Disconnected;
+        int fd = -1;
+        uint32_t watched_events = 0;
+        std::vector<char> buffer;      // Received bytes in [head, tail)
+        size_t head = 0;
+        size_t tail = 0;
+        std::string outgoing;          // Bytes not yet accepted by the socket
+        uint16_t next_packet_id = 1;
+        std::chrono::steady_clock::time_point last_sent;
+        std::chrono::steady_clock::time_point last_received;
+        Reactor::TimerId keepalive_timer = 0;
+        Reactor::TimerId reconnect_timer = 0;
+        MqttSubscriberStats counters;
+
+        bool open_socket();
+        void on_ready(uint32_t events);
+        void on_connected();
+        bool read_available();
+        bool decode_packets();
+        bool handle_packet(uint8_t header, const char* body, size_t length);
+        void queue(const std::string& packet);
+        bool flush();
+        void update_interest();
+        void check_keepalive();
+        void drop(const std::string& reason);
+        void close_socket();
+        void schedule_reconnect();
+};
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+#include "numeric_kernels.h"
+
+// One copy of the kernels per instruction set; only the target differs. GCC contracts
+// a * b + c into an FMA whenever the target has one, which rounds once instead of twice
+// and would break bit-identity with the scalar set, so contraction is switched off. -O2
+// only vectorizes loops it can prove cheap; the dynamic cost model lets it version the
+// loops for aliasing and trip count.
+namespace kernels_scalar {
+    #include "numeric_kernels_impl.h"
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BLE_RSSI_X86_KERNELS
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#pragma GCC optimize("fp-contract=off", "tree-vectorize", "vect-cost-model=dynamic")
+namespace kernels_avx2 {
+    #include "numeric_kernels_impl.h"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl,avx2,fma")
+#pragma GCC optimize("fp-contract=off", "tree-vectorize", "vect-cost-model=dynamic")
+namespace kernels_avx512 {
+    #include "numeric_kernels_impl.h"
+}
+#pragma GCC pop_options
+#endif
+
+namespace {
+    #define BLE_RSSI_KERNEL_SET(name, space) \
+        NumericKernels{name, space::distances, space::path_loss_z, space::student_t_logpdf, space::confidence_weights, \
+                       space::kalman_update, space::health_ewma}
+
+    const NumericKernels SCALAR_KERNELS = BLE_RSSI_KERNEL_SET("scalar", kernels_scalar);
+#ifdef BLE_RSSI_X86_KERNELS
+    const NumericKernels AVX2_KERNELS = BLE_RSSI_KERNEL_SET("avx2", kernels_avx2);
+    const NumericKernels AVX512_KERNELS = BLE_RSSI_KERNEL_SET("avx512", kernels_avx512);
+#endif
+
+    // Kernel sets the CPU can run, best last
+    std::vector<const NumericKernels*> runnable_kernels() {
+        std::vector<const NumericKernels*> sets = {&SCALAR_KERNELS};
+#ifdef BLE_RSSI_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            sets.push_back(&AVX2_KERNELS);
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+                __builtin_cpu_supports("avx512vl")) {
+                sets.push_back(&AVX512_KERNELS);
+            }
+        }
+#endif
+        return sets;
+    }
+
+    std::atomic<const NumericKernels*>& selected_kernels() {
+        static std::atomic<const NumericKernels*> selected{runnable_kernels().back()};
+        return selected;
+    }
+}
+
+const NumericKernels& numeric_kernels() {
+    return *selected_kernels().load(std::memory_order_acquire);
+}
+
+bool select_numeric_kernels(const std::string& isa) {
+    std::vector<const NumericKernels*> sets = runnable_kernels();
+    if (isa.empty() || isa == "auto") {
+        selected_kernels().store(sets.back(), std::memory_order_release);
+        return true;
+    }
+    for (const NumericKernels* set : sets) {
+        if (isa == set->isa) {
+            selected_kernels().store(set, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> supported_numeric_isas() {
+    std::vector<std::string> names;
+    for (const NumericKernels* set : runnable_kernels()) {
+        names.push_back(set->isa);
+    }
+    return names;
+}
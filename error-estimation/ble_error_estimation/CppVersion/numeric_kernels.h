@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Batched numeric kernels of the estimation path, one set per instruction set
+ *
+ * Every kernel works on arrays (one entry per anchor of a message) and computes exactly
+ * what the scalar helpers compute for one entry: R3_distance, PathLossModel::z,
+ * logpdf_student_t, the confidence weight of TagSystem::confidence_score, the update
+ * half of KalmanFilter::sequence_step and the EWMA of Anchor::update_health. Variants
+ * compiled for wider instruction sets vectorize the element-wise arithmetic but keep
+ * its order and precision, so all variants give bit-identical results.
+ *
+ * The best set the CPU supports (cpuid) is chosen on first use; select_numeric_kernels
+ * forces one, e.g. to test the scalar path on an AVX-512 machine.
+ */
+struct NumericKernels {
+    const char* isa;
+
+    /**
+     * @brief Euclidean distances from anchors (ax, ay, az) to the point (tx, ty, tz)
+     */
+    void (*distances)(const float* ax, const float* ay, const float* az, size_t count,
+                      float tx, float ty, float tz, float* out);
+
+    /**
+     * @brief Path-loss z-values: (rssi - (rssi_0 - 10 n log10(max(dist, 1e-6) / d_0))) / sigma
+     */
+    void (*path_loss_z)(const float* rssi, const float* rssi_0, const float* n, const float* dist, size_t count,
+                        float d_0, float sigma, float* out);
+
+    /**
+     * @brief Student-t log pdf with v degrees of freedom at every z
+     */
+    void (*student_t_logpdf)(const float* z, size_t count, int v, float* out);
+
+    /**
+     * @brief Confidence weights 1 / (1 + ewma + z²)
+     */
+    void (*confidence_weights)(const float* z, const float* ewma, size_t count, float* out);
+
+    /**
+     * @brief Update half of KalmanFilter::sequence_step for filters already predicted
+     *
+     * rssi_0 and n hold the prior state and receive the posterior; p00..p11 hold the
+     * predicted covariance P{i+1|i} and receive P{i+1|i+1}; residual receives the
+     * measurement residuals to hand to KalmanFilter::correct.
+     */
+    void (*kalman_update)(const float* rssi, const float* dist, const float* sigma, size_t count, float d_0,
+                          float* rssi_0, float* n, float* p00, float* p01, float* p10, float* p11, float* residual);
+
+    /**
+     * @brief Health EWMAs lambda z² + (1 - lambda) ewma
+     */
+    void (*health_ewma)(const float* z, const float* ewma, size_t count, float lambda, float* out);
+};
+
+/**
+ * @brief Kernels in use: the forced set if any, otherwise the best the CPU supports
+ * @return const NumericKernels& Kernel set, valid for the program's lifetime
+ */
+const NumericKernels& numeric_kernels();
+
+/**
+ * @brief Force a kernel set by name ("scalar", "avx2", "avx512"); "" or "auto" picks the best supported
+ * @param isa Instruction set name
+ * @return bool false if the name is unknown or the CPU lacks the instruction set (selection unchanged)
+ */
+bool select_numeric_kernels(const std::string& isa);
+
+/**
+ * @brief Names of the kernel sets this binary has and this CPU can run, best last
+ * @return std::vector<std::string> Instruction set names, always starting with "scalar"
+ */
+std::vector<std::string> supported_numeric_isas();
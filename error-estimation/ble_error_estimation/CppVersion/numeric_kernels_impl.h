@@ -0,0 +1,91 @@
+// Kernel bodies, included by numeric_kernels.cpp once per instruction set inside its own
+// namespace and target pragma. No includes and no pragma once: every inclusion must
+// produce a new copy of the functions.
+//
+// Each expression mirrors its scalar counterpart operation by operation, including
+// where the scalar code goes through double (std::pow(float, 2) returns double).
+
+void distances(const float* ax, const float* ay, const float* az, size_t count,
+               float tx, float ty, float tz, float* out) {
+    for (size_t i = 0; i < count; i++) {
+        float dx = ax[i] - tx;
+        float dy = ay[i] - ty;
+        float dz = az[i] - tz;
+        float delta_0 = static_cast<float>(static_cast<double>(dx) * dx);
+        float delta_1 = static_cast<float>(static_cast<double>(dy) * dy);
+        float delta_2 = static_cast<float>(static_cast<double>(dz) * dz);
+        out[i] = delta_0 + delta_1 + delta_2;
+    }
+    // Separate pass: std::sqrt may set errno, which keeps the loop above from vectorizing
+    for (size_t i = 0; i < count; i++) {
+        out[i] = std::sqrt(out[i]);
+    }
+}
+
+void path_loss_z(const float* rssi, const float* rssi_0, const float* n, const float* dist, size_t count,
+                 float d_0, float sigma, float* out) {
+    for (size_t i = 0; i < count; i++) {
+        float safe_dist = std::max(dist[i], 1e-6f);
+        float mu = rssi_0[i] - (10 * n[i] * std::log10(safe_dist / d_0));
+        out[i] = (rssi[i] - mu) / sigma;
+    }
+}
+
+void student_t_logpdf(const float* z, size_t count, int v, float* out) {
+    float a_1 = std::lgamma((v + 1) / 2);
+    float a_2 = std::lgamma(v / 2);
+    float a_3 = 0.5 * std::log(v * 3.14159265358979323846f);
+    float half_v1 = static_cast<float>(v + 1) / 2.0f;
+    float v_f = static_cast<float>(v);
+    float constant = a_1 - a_2 - a_3;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = constant - half_v1 * std::log1p((z[i] * z[i]) / v_f);
+    }
+}
+
+void confidence_weights(const float* z, const float* ewma, size_t count, float* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<float>(1.0f / ((1.0f + ewma[i]) + static_cast<double>(z[i]) * z[i]));
+    }
+}
+
+void kalman_update(const float* rssi, const float* dist, const float* sigma, size_t count, float d_0,
+                   float* rssi_0, float* n, float* p00, float* p01, float* p10, float* p11, float* residual) {
+    // H = [1 X]; X goes through residual first so the log10 calls stay out of the arithmetic loop
+    for (size_t i = 0; i < count; i++) {
+        float safe_dist = std::max(dist[i], 1e-6f);
+        residual[i] = (-10) * std::log10(safe_dist / d_0);
+    }
+    for (size_t i = 0; i < count; i++) {
+        float H_0 = 1.0f;
+        float H_1 = residual[i];
+        float r_predict = H_0 * rssi_0[i] + H_1 * n[i];
+        float resid = rssi[i] - r_predict;
+
+        float PH_0 = p00[i] * H_0 + p01[i] * H_1;
+        float PH_1 = p10[i] * H_0 + p11[i] * H_1;
+        float S = static_cast<float>((H_0 * PH_0 + H_1 * PH_1) + static_cast<double>(sigma[i]) * sigma[i]);
+        float K_0 = PH_0 / S;
+        float K_1 = PH_1 / S;
+
+        rssi_0[i] = rssi_0[i] + K_0 * resid;
+        n[i] = n[i] + K_1 * resid;
+
+        float I_KH_00 = 1.0f - K_0 * H_0;
+        float I_KH_01 = -(K_0 * H_1);
+        float I_KH_10 = -(K_1 * H_0);
+        float I_KH_11 = 1.0f - K_1 * H_1;
+        float P_00 = p00[i], P_01 = p01[i], P_10 = p10[i], P_11 = p11[i];
+        p00[i] = I_KH_00 * P_00 + I_KH_01 * P_10;
+        p01[i] = I_KH_00 * P_01 + I_KH_01 * P_11;
+        p10[i] = I_KH_10 * P_00 + I_KH_11 * P_10;
+        p11[i] = I_KH_10 * P_01 + I_KH_11 * P_11;
+        residual[i] = resid;
+    }
+}
+
+void health_ewma(const float* z, const float* ewma, size_t count, float lambda, float* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<float>(lambda * (static_cast<double>(z[i]) * z[i]) + (1 - lambda) * ewma[i]);
+    }
+}
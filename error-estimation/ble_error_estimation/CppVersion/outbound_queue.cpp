@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "outbound_queue.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    const std::string SEGMENT_PREFIX = "spill_";
+    const std::string SEGMENT_SUFFIX = ".log";
+
+    // Parse "spill_<sequence>.log", returning 0 for foreign files
+    uint64_t parse_segment_sequence(const std::string& filename) {
+        if (filename.size() <= SEGMENT_PREFIX.size() + SEGMENT_SUFFIX.size() ||
+            filename.compare(0, SEGMENT_PREFIX.size(), SEGMENT_PREFIX) != 0 ||
+            filename.compare(filename.size() - SEGMENT_SUFFIX.size(), SEGMENT_SUFFIX.size(), SEGMENT_SUFFIX) != 0) {
+            return 0;
+        }
+        std::string digits = filename.substr(SEGMENT_PREFIX.size(),
+            filename.size() - SEGMENT_PREFIX.size() - SEGMENT_SUFFIX.size());
+        // Not ::isdigit: it is undefined for the negative chars of non-ASCII filenames
+        if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return 0;
+        }
+        return std::stoull(digits);
+    }
+
+    bool read_u32(std::istream& in, uint32_t& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    // Append one [u32 topic length][u32 payload length][topic][payload] record, returning its size
+    size_t write_record(std::ostream& out, const OutboundMessage& message) {
+        uint32_t topic_len = static_cast<uint32_t>(message.topic.size());
+        uint32_t payload_len = static_cast<uint32_t>(message.payload.size());
+        out.write(reinterpret_cast<const char*>(&topic_len), sizeof(topic_len));
+        out.write(reinterpret_cast<const char*>(&payload_len), sizeof(payload_len));
+        out.write(message.topic.data(), topic_len);
+        out.write(message.payload.data(), payload_len);
+        return sizeof(topic_len) + sizeof(payload_len) + topic_len + payload_len;
+    }
+}
+
+/*OUTBOUNDQUEUE*/
+//constructor:
+OutboundQueue::OutboundQueue(std::string dir, size_t mem_capacity, size_t seg_bytes, size_t inflight_limit)
+    : spill_dir(std::move(dir)), memory_capacity(mem_capacity), segment_bytes(seg_bytes), max_inflight(inflight_limit) {
+    fs::create_directories(spill_dir);
+    recover_segments();
+}
+
+//methods:
+void OutboundQueue::push(OutboundMessage message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.pushed++;
+
+    // Memory is the head of the stream: it only takes new messages while nothing is queued behind it on disk
+    if (connected && segments.empty() && memory.size() < memory_capacity) {
+        memory.push_back(std::move(message));
+        return;
+    }
+
+    if (!spill(message)) {
+        // Keep the message rather than lose it; RAM may exceed its bound while the disk is failing
+        counters.spill_errors++;
+        memory.push_back(std::move(message));
+    }
+}
+
+size_t OutboundQueue::drain(const PublishFn& publish, size_t max_messages) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t sent = 0;
+
+    while (sent < max_messages && connected && inflight.size() < max_inflight) {
+        if (memory.empty()) {
+            refill_from_disk();
+            if (memory.empty()) {
+                break;
+            }
+        }
+
+        std::optional<int> message_id = publish(memory.front());
+        if (!message_id) {
+            counters.publish_failures++;
+            break;
+        }
+
+        inflight.push_back(InflightMessage{*message_id, std::move(memory.front())});
+        memory.pop_front();
+        counters.published++;
+        sent++;
+    }
+
+    return sent;
+}
+
+void OutboundQueue::set_connected(bool is_up) {
+    connected = is_up;
+}
+
+void OutboundQueue::on_published(int message_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Acknowledgements mostly arrive in publishing order: the oldest is usually first
+    auto acknowledged = std::find_if(inflight.begin(), inflight.end(),
+                                     [message_id](const InflightMessage& sent) { return sent.id == message_id; });
+    if (acknowledged != inflight.end()) {
+        inflight.erase(acknowledged);
+    }
+}
+
+size_t OutboundQueue::flush_to_disk() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Unacknowledged messages were published before anything still in memory
+    while (!inflight.empty()) {
+        memory.push_front(std::move(inflight.back().message));
+        inflight.pop_back();
+    }
+    size_t flushed = memory.size();
+    if (flushed == 0) {
+        return 0;
+    }
+    if (writer.is_open()) {
+        writer.close();
+    }
+
+    if (segments.empty()) {
+        // Nothing on disk: memory becomes a segment of its own
+        while (!memory.empty() && spill(memory.front())) {
+            memory.pop_front();
+        }
+    } else {
+        // Memory precedes the unread part of the head segment: rewrite the head as memory + remainder
+        std::string head_path = segment_path(segments.front());
+        std::string temp_path = head_path + ".tmp";
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        for (const OutboundMessage& message : memory) {
+            write_record(out, message);
+        }
+        reader.clear();
+        if (!reader.is_open()) {
+            reader.open(head_path, std::ios::binary);
+        }
+        if (reader.peek() != std::char_traits<char>::eof()) {
+            out << reader.rdbuf();
+        }
+        out.flush();
+        reader.close();
+        if (!out) {
+            std::cerr << "Failed to write spill segment " << temp_path << std::endl;
+            fs::remove(temp_path);
+            counters.spill_errors++;
+            return 0;
+        }
+        out.close();
+        fs::rename(temp_path, head_path);
+        disk_messages += memory.size();
+        counters.spilled += memory.size();
+        memory.clear();
+    }
+    return flushed - memory.size();
+}
+
+bool OutboundQueue::is_connected() const {
+    return connected;
+}
+
+OutboundQueueStats OutboundQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    OutboundQueueStats snapshot = counters;
+    snapshot.memory_messages = memory.size();
+    snapshot.disk_messages = disk_messages;
+    snapshot.disk_segments = segments.size();
+    snapshot.inflight = inflight.size();
+    return snapshot;
+}
+
+//helpers:
+std::string OutboundQueue::segment_path(uint64_t sequence) const {
+    std::string digits = std::to_string(sequence);
+    if (digits.size() < 12) {
+        digits.insert(0, 12 - digits.size(), '0');
+    }
+    return (fs::path(spill_dir) / (SEGMENT_PREFIX + digits + SEGMENT_SUFFIX)).string();
+}
+
+void OutboundQueue::recover_segments() {
+    std::vector<uint64_t> found;
+    for (const auto& entry : fs::directory_iterator(spill_dir)) {
+        uint64_t sequence = parse_segment_sequence(entry.path().filename().string());
+        if (sequence > 0) {
+            found.push_back(sequence);
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    for (uint64_t sequence : found) {
+        // Count complete records; a record truncated by a crash ends the segment
+        std::ifstream in(segment_path(sequence), std::ios::binary);
+        size_t records = 0;
+        uint32_t topic_len = 0;
+        uint32_t payload_len = 0;
+        while (read_u32(in, topic_len) && read_u32(in, payload_len)) {
+            if (!in.ignore(static_cast<std::streamsize>(topic_len) + payload_len) ||
+                in.gcount() != static_cast<std::streamsize>(topic_len) + payload_len) {
+                break;
+            }
+            records++;
+        }
+
+        if (records == 0) {
+            fs::remove(segment_path(sequence));
+            continue;
+        }
+        segments.push_back(sequence);
+        disk_messages += records;
+    }
+
+    next_segment = found.empty() ? 1 : found.back() + 1;
+
+    if (disk_messages > 0) {
+        std::cout << "Recovered " << disk_messages << " spilled messages from "
+                  << segments.size() << " segments in " << spill_dir << std::endl;
+    }
+}
+
+bool OutboundQueue::spill(const OutboundMessage& message) {
+    // Never append to a recovered segment: its last record may be truncated
+    if (!writer.is_open() || writer_bytes >= segment_bytes) {
+        if (writer.is_open()) {
+            writer.close();
+        }
+        uint64_t sequence = next_segment++;
+        writer.open(segment_path(sequence), std::ios::binary | std::ios::trunc);
+        if (!writer) {
+            std::cerr << "Failed to open spill segment " << segment_path(sequence) << std::endl;
+            return false;
+        }
+        segments.push_back(sequence);
+        writer_bytes = 0;
+    }
+
+    size_t record_bytes = write_record(writer, message);
+    // Flush every record so the reader sees it and a process crash does not lose it
+    writer.flush();
+    if (!writer) {
+        return false;
+    }
+
+    writer_bytes += record_bytes;
+    disk_messages++;
+    counters.spilled++;
+    return true;
+}
+
+bool OutboundQueue::read_record(OutboundMessage& message) {
+    while (!segments.empty()) {
+        // Clear EOF left by an earlier read: the writer may have appended since
+        reader.clear();
+        if (!reader.is_open()) {
+            reader.open(segment_path(segments.front()), std::ios::binary);
+        }
+
+        uint32_t topic_len = 0;
+        uint32_t payload_len = 0;
+        if (read_u32(reader, topic_len) && read_u32(reader, payload_len)) {
+            message.topic.resize(topic_len);
+            message.payload.resize(payload_len);
+            if (reader.read(message.topic.data(), topic_len) && reader.read(message.payload.data(), payload_len)) {
+                return true;
+            }
+        }
+
+        // End of the head segment: it can go unless the writer is still appending to it
+        bool is_writer_segment = writer.is_open() && segments.size() == 1;
+        if (is_writer_segment) {
+            return false;
+        }
+        reader.close();
+        fs::remove(segment_path(segments.front()));
+        segments.pop_front();
+    }
+    return false;
+}
+
+void OutboundQueue::refill_from_disk() {
+    OutboundMessage message;
+    while (memory.size() < memory_capacity && disk_messages > 0) {
+        if (!read_record(message)) {
+            // Counted records vanished (file removed or truncated externally)
+            std::cerr << "Spill log ended early, " << disk_messages << " messages unreadable" << std::endl;
+            disk_messages = 0;
+            break;
+        }
+        memory.push_back(std::move(message));
+        disk_messages--;
+        counters.drained_from_disk++;
+    }
+
+    // Once the tail is fully read, drop the remaining files and let new messages use memory again
+    if (disk_messages == 0 && !segments.empty()) {
+        reader.close();
+        writer.close();
+        for (uint64_t sequence : segments) {
+            fs::remove(segment_path(sequence));
+        }
+        segments.clear();
+    }
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @brief A single message waiting to be published on the output broker
+ */
+struct OutboundMessage {
+    std::string topic;
+    std::string payload;
+};
+
+/**
+ * @brief Cumulative counters and current depths of an OutboundQueue
+ *
+ * Counters only ever grow, so rates are obtained by diffing two snapshots
+ * taken a known interval apart (see OutboundQueue::stats()).
+ */
+struct OutboundQueueStats {
+    uint64_t pushed = 0;              // Messages handed to the queue
+    uint64_t published = 0;           // Messages accepted by the MQTT client
+    uint64_t spilled = 0;             // Messages written to the on-disk log
+    uint64_t drained_from_disk = 0;   // Messages read back from the on-disk log
+    uint64_t publish_failures = 0;    // Publish attempts rejected by the MQTT client
+    uint64_t spill_errors = 0;        // Disk writes that failed (message kept in memory)
+    size_t memory_messages = 0;       // Messages currently held in RAM
+    size_t disk_messages = 0;         // Messages currently held on disk
+    size_t disk_segments = 0;         // Segment files currently on disk
+    size_t inflight = 0;              // Messages published but not yet acknowledged (still held)
+};
+
+/**
+ * @brief Bounded outbound queue that spills to a segmented on-disk log
+ *
+ * Messages form a single FIFO stream made of an in-memory head followed by an
+ * on-disk tail. New messages go to memory only while the client is connected,
+ * memory has room and the disk tail is empty; otherwise they are appended to
+ * the current disk segment. Draining publishes from memory and refills memory
+ * from the oldest disk segment, so delivery order is always preserved and RAM
+ * usage stays bounded during output outages.
+ *
+ * Published messages stay in the queue, keyed by the client's message id, until the
+ * client reports them acknowledged; flush_to_disk() writes those still unacknowledged
+ * back to the front of the log.
+ *
+ * Segments are files named spill_<sequence>.log in the spill directory. Each
+ * record is [u32 topic length][u32 payload length][topic][payload]. Segments
+ * left over by a previous run are picked up on construction, so an outage that
+ * spans a restart does not lose data (records of a partially drained segment
+ * may be delivered twice).
+ *
+ * All public methods are thread-safe.
+ */
+class OutboundQueue {
+    public:
+        /**
+         * @brief Callback that hands one message to the MQTT client
+         * @return std::optional<int> Message id the client acknowledges it with, std::nullopt to stop draining
+         */
+        using PublishFn = std::function<std::optional<int>(const OutboundMessage&)>;
+
+        /**
+         * @brief Construct a queue spilling into the given directory
+         *
+         * Creates the spill directory if needed and recovers any segments found in it.
+         *
+         * @param spill_dir Directory holding the on-disk segments
+         * @param memory_capacity Maximum number of messages kept in RAM
+         * @param segment_bytes Size after which the current segment is closed and a new one started
+         * @param max_inflight Maximum number of published but unacknowledged messages
+         */
+        OutboundQueue(std::string spill_dir, size_t memory_capacity, size_t segment_bytes, size_t max_inflight);
+
+        OutboundQueue(const OutboundQueue&) = delete;
+        OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+        /**
+         * @brief Append a message to the end of the stream
+         *
+         * Never blocks on the network. The message is kept in memory when possible
+         * and written to the disk tail otherwise.
+         *
+         * @param message Message to enqueue
+         */
+        void push(OutboundMessage message);
+
+        /**
+         * @brief Publish queued messages in order until the stream is empty or publishing stops
+         *
+         * Stops early when disconnected, when the in-flight limit is reached, when
+         * publish returns no message id or after max_messages messages.
+         *
+         * @param publish Callback handing a message to the MQTT client
+         * @param max_messages Maximum number of messages to publish in this call
+         * @return size_t Number of messages accepted by the client
+         */
+        size_t drain(const PublishFn& publish, size_t max_messages = SIZE_MAX);
+
+        /**
+         * @brief Record connection state changes of the output client
+         *
+         * While disconnected every pushed message is spilled to disk. The in-flight
+         * count survives a disconnect: the client keeps its unacknowledged packets and
+         * resends them once reconnected, so they still take up its buffer.
+         *
+         * @param connected true once the client is connected, false when it disconnects
+         */
+        void set_connected(bool connected);
+
+        /**
+         * @brief Forget a published message once the client reports it acknowledged
+         *
+         * Unknown ids (e.g. acknowledgements arriving after flush_to_disk()) are ignored.
+         *
+         * @param message_id Id returned by the PublishFn for that message
+         */
+        void on_published(int message_id);
+
+        /**
+         * @brief Move every message held in RAM to the front of the on-disk tail
+         *
+         * Called on shutdown so the next process delivers them first: published but
+         * unacknowledged messages, then the rest of memory. A message whose
+         * acknowledgement was lost may thus be delivered twice.
+         *
+         * @return size_t Number of messages written to disk
+         */
+        size_t flush_to_disk();
+
+        /**
+         * @brief Gets whether the output client is currently connected
+         * @return bool true if connected
+         */
+        bool is_connected() const;
+
+        /**
+         * @brief Gets a snapshot of the queue counters and depths
+         * @return OutboundQueueStats Current statistics
+         */
+        OutboundQueueStats stats() const;
+
+    private:
+        std::string spill_dir;
+        size_t memory_capacity;
+        size_t segment_bytes;
+        size_t max_inflight;
+
+        mutable std::mutex mutex;
+        std::atomic<bool> connected{false};
+        std::deque<OutboundMessage> memory;
+
+        // Published, not yet acknowledged, in publishing order
+        struct InflightMessage {
+            int id;
+            OutboundMessage message;
+        };
+        std::deque<InflightMessage> inflight;
+
+        // On-disk tail: segment sequences oldest first, read from the front and written at the back
+        std::deque<uint64_t> segments;
+        uint64_t next_segment = 1;
+        size_t disk_messages = 0;
+        std::ifstream reader;
+        std::ofstream writer;
+        size_t writer_bytes = 0;
+
+        OutboundQueueStats counters;
+
+        std::string segment_path(uint64_t sequence) const;
+        void recover_segments();
+        bool spill(const OutboundMessage& message);
+        bool read_record(OutboundMessage& message);
+        void refill_from_disk();
+};
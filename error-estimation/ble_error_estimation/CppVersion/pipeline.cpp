@@ -0,0 +1,192 @@
+#include <iostream>
+
+#include "pipeline.h"
+#include "tracepoints.h"
+
+/*ANCHORRESOLVER*/
+//constructor:
+AnchorResolver::AnchorResolver(ProcessingContext& processing_context, AsyncAnchorFetcher anchor_fetcher)
+    : context(processing_context), fetcher(std::move(anchor_fetcher)) {}
+
+//methods:
+AnchorResolver::Awaiter AnchorResolver::resolve(const std::string& anch_mac, Executor resume_on) {
+    return Awaiter(*this, anch_mac, std::move(resume_on));
+}
+
+void AnchorResolver::prefetch(const std::vector<std::string>& anch_macs) {
+    for (const auto& anch_mac : anch_macs) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (lookups.count(anch_mac) || known(anch_mac)) {
+                continue;
+            }
+            lookups[anch_mac] = std::make_unique<Lookup>();
+            started++;
+        }
+        launch(anch_mac);
+    }
+}
+
+size_t AnchorResolver::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lookups.size();
+}
+
+size_t AnchorResolver::lookups_started() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return started;
+}
+
+//helpers:
+bool AnchorResolver::known(const std::string& anch_mac) const {
+    return context.anchors.read().find(anch_mac) != nullptr;
+}
+
+/**
+ * @brief Resolve an anchor from the shared-memory store, or start its HTTP lookup (called without the lock)
+ */
+void AnchorResolver::launch(const std::string& anch_mac) {
+    if (auto shared_anchor = attach_shared_anchor(context, anch_mac)) {
+        std::cout << "Attached shared anchor for MAC: " << anch_mac << std::endl;
+        context.anchors.insert(std::move(shared_anchor));
+        finish(anch_mac, true);
+        return;
+    }
+
+    std::cout << "Creating anchor for MAC: " << anch_mac << std::endl;
+    if (!fetcher) {
+        complete(anch_mac, "", "No anchor source configured");
+        return;
+    }
+    fetcher(anch_mac, [this, anch_mac](std::string body, std::string error) {
+        complete(anch_mac, body, error);
+    });
+}
+
+/**
+ * @brief Publish the fetched anchor, then wake every message waiting for it
+ */
+void AnchorResolver::complete(const std::string& anch_mac, const std::string& body, const std::string& error) {
+    bool resolved = false;
+    try {
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+        auto anchor = anchor_from_api_response(anch_mac, body);
+        publish_shared_anchor(context, *anchor);
+        context.anchors.insert(std::move(anchor));
+        resolved = true;
+        std::cout << "Successfully created anchor: " << anch_mac << std::endl;
+    } catch (const std::exception& e) {
+        // The lookup is forgotten, so the next message needing this anchor tries again
+        std::cerr << "Failed to create anchor " << anch_mac << ": " << e.what() << std::endl;
+    }
+    finish(anch_mac, resolved);
+}
+
+void AnchorResolver::finish(const std::string& anch_mac, bool resolved) {
+    std::unique_ptr<Lookup> lookup;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = lookups.find(anch_mac);
+        if (it == lookups.end()) {
+            return;
+        }
+        lookup = std::move(it->second);
+        lookups.erase(it);
+    }
+    TRACE_ANCHOR_RESOLVED(anch_mac.c_str(), resolved ? 1 : 0);
+
+    // Resumed outside the lock: a resumed message may immediately await another anchor
+    for (Awaiter* waiter : lookup->waiters) {
+        // The waiter lives in the coroutine frame and is gone once it resumes: copy it out first
+        waiter->resolved = resolved;
+        std::coroutine_handle<> handle = waiter->handle;
+        Executor executor = waiter->resume_on;
+        if (executor) {
+            executor([handle]() { handle.resume(); });
+        } else {
+            handle.resume();
+        }
+    }
+}
+
+
+/*AWAITER*/
+//constructor:
+AnchorResolver::Awaiter::Awaiter(AnchorResolver& owner, std::string anch_mac, Executor executor)
+    : resolver(owner), mac(std::move(anch_mac)), resume_on(std::move(executor)) {}
+
+//methods:
+bool AnchorResolver::Awaiter::await_ready() {
+    // Known anchors never suspend
+    resolved = resolver.known(mac);
+    return resolved;
+}
+
+bool AnchorResolver::Awaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    handle = awaiting;
+    {
+        std::lock_guard<std::mutex> lock(resolver.mutex);
+        auto it = resolver.lookups.find(mac);
+        if (it != resolver.lookups.end()) {
+            // Join the request already in flight for this MAC
+            it->second->waiters.push_back(this);
+            return true;
+        }
+        if (resolver.known(mac)) {
+            // Resolved between await_ready and now
+            resolved = true;
+            return false;
+        }
+        auto lookup = std::make_unique<Lookup>();
+        lookup->waiters.push_back(this);
+        resolver.lookups[mac] = std::move(lookup);
+        resolver.started++;
+    }
+
+    // The lookup may complete and resume this coroutine before launch returns,
+    // destroying this awaiter: copy what is needed first and touch no member after
+    AnchorResolver& owner = resolver;
+    std::string anch_mac = mac;
+    owner.launch(anch_mac);
+    return true;
+}
+
+bool AnchorResolver::Awaiter::await_resume() const {
+    return resolved;
+}
+
+
+/*PIPELINE*/
+Task<std::optional<json>> evaluate_tag_message_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                     TagMessage message, Executor resume_on) {
+    if (!message.unresolved_anchors.empty()) {
+        // Request every missing anchor at once, then wait for each; other messages keep
+        // running on this thread while this one is suspended
+        if (!message.discovery) {
+            for (const auto& anch_mac : message.unresolved_anchors) {
+                std::cout << "Warning: Found new anchor " << anch_mac << " after initialization" << std::endl;
+            }
+        }
+        resolver.prefetch(message.unresolved_anchors);
+        for (const auto& anch_mac : message.unresolved_anchors) {
+            co_await resolver.resolve(anch_mac, resume_on);
+        }
+        if (message.discovery) {
+            std::cout << "Initialized " << context.anchors.size() << " anchors" << std::endl;
+        }
+    }
+
+    co_return evaluate_tag_message(context, message);
+}
+
+Task<std::optional<json>> process_tag_message_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                    std::string payload, Executor resume_on) {
+    co_return co_await evaluate_tag_message_async(context, resolver, parse_tag_message(context, payload), std::move(resume_on));
+}
+
+Task<std::optional<json>> process_position_record_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                        PositionRecord record, Executor resume_on) {
+    co_return co_await evaluate_tag_message_async(context, resolver, parse_position_record(context, record), std::move(resume_on));
+}
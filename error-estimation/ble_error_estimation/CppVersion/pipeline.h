@@ -0,0 +1,160 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "processing.h"
+#include "task.h"
+
+/**
+ * @brief Where a suspended coroutine continues, e.g. the worker that owns its tag
+ *
+ * An empty Executor resumes the coroutine inline, on the thread completing the lookup.
+ */
+using Executor = std::function<void(std::function<void()>)>;
+
+/**
+ * @brief Start fetching the dongles API response for one anchor without blocking
+ *
+ * done(body, error) is called exactly once, from any thread; error is empty on success.
+ */
+using AsyncAnchorFetcher = std::function<void(const std::string& anch_mac,
+                                              std::function<void(std::string body, std::string error)> done)>;
+
+/**
+ * @brief Resolves unknown anchors for suspended messages, one request per MAC address
+ *
+ * A message needing an unknown anchor co_awaits resolve() and suspends; the thread it
+ * ran on goes back to other messages. The first message asking for a MAC starts the
+ * lookup, every later one joins the same in-flight request. When the response arrives
+ * the anchor is published in the registry and all waiters resume on their executors.
+ *
+ * Example:
+ *     if (co_await resolver.resolve(mac, executor)) { ... look the anchor up in the registry ... }
+ */
+class AnchorResolver {
+    public:
+        class Awaiter;
+
+        /**
+         * @param processing_context Context whose registry receives resolved anchors
+         * @param anchor_fetcher Non-blocking source of dongles API responses
+         */
+        AnchorResolver(ProcessingContext& processing_context, AsyncAnchorFetcher anchor_fetcher);
+
+        AnchorResolver(const AnchorResolver&) = delete;
+        AnchorResolver& operator=(const AnchorResolver&) = delete;
+
+        /**
+         * @brief Await an anchor, starting its lookup unless one is already in flight
+         *
+         * @param anch_mac MAC address of the anchor
+         * @param resume_on Executor the awaiting coroutine resumes on
+         * @return Awaiter yielding true once the anchor is in the registry, false if it could not be resolved
+         */
+        Awaiter resolve(const std::string& anch_mac, Executor resume_on = {});
+
+        /**
+         * @brief Start lookups for several anchors at once without waiting for them
+         *
+         * @param anch_macs MAC addresses of anchors about to be awaited
+         */
+        void prefetch(const std::vector<std::string>& anch_macs);
+
+        /**
+         * @brief Gets the number of lookups currently in flight
+         */
+        size_t in_flight() const;
+
+        /**
+         * @brief Gets the number of lookups started since construction
+         */
+        size_t lookups_started() const;
+
+        class Awaiter {
+            public:
+                bool await_ready();
+                bool await_suspend(std::coroutine_handle<> awaiting);
+                bool await_resume() const;
+
+            private:
+                friend class AnchorResolver;
+
+                AnchorResolver& resolver;
+                std::string mac;
+                Executor resume_on;
+                std::coroutine_handle<> handle;
+                bool resolved = false;
+
+                Awaiter(AnchorResolver& owner, std::string anch_mac, Executor executor);
+        };
+
+    private:
+        struct Lookup {
+            std::vector<Awaiter*> waiters;             // Suspended messages, resumed when the lookup completes
+        };
+
+        ProcessingContext& context;
+        AsyncAnchorFetcher fetcher;
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<Lookup>> lookups;   // In-flight lookups by MAC, guarded by mutex
+        size_t started = 0;
+
+        bool known(const std::string& anch_mac) const;
+        void launch(const std::string& anch_mac);
+        void complete(const std::string& anch_mac, const std::string& body, const std::string& error);
+        void finish(const std::string& anch_mac, bool resolved);
+};
+
+/**
+ * @brief Resolve the anchors a parsed message still needs, then evaluate it, as a coroutine
+ *
+ * All missing anchors are requested at once; anchors that cannot be resolved are skipped.
+ *
+ * @param context Processing context
+ * @param resolver Resolver shared by all messages of the context
+ * @param message Message from parse_tag_message() or parse_position_record()
+ * @param resume_on Executor the coroutine resumes on after waiting for anchors
+ * @return Task yielding the output message, std::nullopt if none of the tag's anchors are known
+ */
+Task<std::optional<json>> evaluate_tag_message_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                     TagMessage message, Executor resume_on = {});
+
+/**
+ * @brief Process one tag position message as a coroutine
+ *
+ * Same result as process_tag_message(), but a message needing unknown anchors
+ * suspends until the resolver has them instead of blocking its thread. All missing
+ * anchors are requested at once; anchors that cannot be resolved are skipped.
+ *
+ * @param context Processing context
+ * @param resolver Resolver shared by all messages of the context
+ * @param payload Raw JSON tag position message
+ * @param resume_on Executor the coroutine resumes on after waiting for anchors
+ * @return Task yielding the output message, std::nullopt if none of the tag's anchors are known
+ * @throws json::exception If the message is malformed
+ */
+Task<std::optional<json>> process_tag_message_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                    std::string payload, Executor resume_on = {});
+
+/**
+ * @brief Process one shared-memory position record as a coroutine
+ *
+ * Same result as process_tag_message_async() for the equivalent JSON message, without
+ * parsing anything.
+ *
+ * @param context Processing context
+ * @param resolver Resolver shared by all messages of the context
+ * @param record Record popped from a PositionRing
+ * @param resume_on Executor the coroutine resumes on after waiting for anchors
+ * @return Task yielding the output message, std::nullopt if none of the tag's anchors are known
+ */
+Task<std::optional<json>> process_position_record_async(ProcessingContext& context, AnchorResolver& resolver,
+                                                        PositionRecord record, Executor resume_on = {});
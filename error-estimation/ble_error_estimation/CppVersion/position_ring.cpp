@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "position_ring.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory positions must be lock-free");
+
+struct PositionRing::Header {
+    std::atomic<uint32_t> magic;                      // Set last by the creator once the slots are initialized
+    uint32_t layout_version;
+    uint32_t capacity;                                // Power of two
+    uint32_t record_bytes;                            // sizeof(PositionRecord) of the creator
+    alignas(64) std::atomic<uint64_t> enqueue_position;   // Claimed by producers
+    std::atomic<uint64_t> dropped;
+    alignas(64) std::atomic<uint64_t> dequeue_position;   // Written by the consumer only
+    std::atomic<uint32_t> consumer_sleeping;          // Futex word: 1 while the consumer waits
+};
+
+struct alignas(64) PositionRing::Slot {
+    std::atomic<uint64_t> sequence;                   // position: free (claimed once enqueue_position passed it), position + 1: published
+    PositionRecord record;
+};
+
+namespace {
+    constexpr int ATTACH_TIMEOUT_MS = 5000;
+
+    uint32_t power_of_two_at_least(uint32_t value) {
+        uint32_t size = 1;
+        while (size < value) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::runtime_error shm_error(const std::string& what, const std::string& name) {
+        return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+    }
+
+    // Process-shared futex (no FUTEX_PRIVATE_FLAG): producers wake a consumer in another process
+    void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms) {
+        timespec timeout{timeout_ms / 1000, static_cast<long>(timeout_ms % 1000) * 1000000L};
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    void futex_wake(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    bool copy_mac(char (&out)[PositionRecord::MAC_BYTES], std::string_view mac) {
+        if (mac.size() >= PositionRecord::MAC_BYTES) {
+            return false;
+        }
+        std::memset(out, 0, sizeof(out));
+        std::memcpy(out, mac.data(), mac.size());
+        return true;
+    }
+}
+
+/*POSITIONRECORD*/
+std::string_view PositionRecord::tag() const {
+    return std::string_view(tag_mac, strnlen(tag_mac, MAC_BYTES));
+}
+
+std::string_view PositionRecord::anchor(size_t i) const {
+    return std::string_view(readings[i].mac, strnlen(readings[i].mac, MAC_BYTES));
+}
+
+/*POSITIONRING*/
+//constructor:
+PositionRing::PositionRing(const std::string& shm_name, uint32_t requested_capacity, int stall_timeout_ms)
+    : name(shm_name), stall_timeout(stall_timeout_ms) {
+    if (requested_capacity == 0 || requested_capacity > (1u << 31)) {
+        throw std::runtime_error("Position ring capacity must be between 1 and 2^31");
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (fd >= 0) {
+        created = true;
+        uint32_t capacity = power_of_two_at_least(requested_capacity);
+        mapped_bytes = layout_bytes(capacity);
+        if (ftruncate(fd, static_cast<off_t>(mapped_bytes)) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            throw shm_error("Failed to size position ring", name);
+        }
+        base = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw shm_error("Failed to map position ring", name);
+        }
+
+        // ftruncate zero-fills: positions, counters and the futex word start at 0
+        header = static_cast<Header*>(base);
+        header->layout_version = LAYOUT_VERSION;
+        header->capacity = capacity;
+        header->record_bytes = sizeof(PositionRecord);
+        slots = reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header));
+        mask = capacity - 1;
+        for (uint32_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        header->magic.store(MAGIC, std::memory_order_release);
+        return;
+    }
+
+    if (errno != EEXIST) {
+        throw shm_error("Failed to create position ring", name);
+    }
+
+    // Attach: wait for the creator to size the segment and publish the header
+    fd = shm_open(name.c_str(), O_RDWR, 0660);
+    if (fd < 0) {
+        throw shm_error("Failed to open position ring", name);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ATTACH_TIMEOUT_MS);
+    struct stat st {};
+    while (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            close(fd);
+            throw std::runtime_error("Timed out waiting for position ring " + name + " to be created");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    mapped_bytes = static_cast<size_t>(st.st_size);
+    base = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw shm_error("Failed to map position ring", name);
+    }
+
+    header = static_cast<Header*>(base);
+    while (header->magic.load(std::memory_order_acquire) != MAGIC) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            munmap(base, mapped_bytes);
+            throw std::runtime_error("Position ring " + name + " was never initialized");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (header->layout_version != LAYOUT_VERSION || header->record_bytes != sizeof(PositionRecord) ||
+        mapped_bytes < layout_bytes(header->capacity)) {
+        munmap(base, mapped_bytes);
+        throw std::runtime_error("Position ring " + name + " has an incompatible layout");
+    }
+
+    slots = reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header));
+    mask = header->capacity - 1;
+}
+
+PositionRing::~PositionRing() {
+    if (base != nullptr && base != MAP_FAILED) {
+        munmap(base, mapped_bytes);
+    }
+}
+
+void PositionRing::unlink(const std::string& shm_name) {
+    shm_unlink(shm_name.c_str());
+}
+
+//methods:
+bool PositionRing::push(const PositionRecord& record) {
+    uint64_t position = header->enqueue_position.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+        slot = &slots[position & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t lag = static_cast<int64_t>(sequence - position);
+        if (lag == 0) {
+            // Free slot at our position: claim it (a failed CAS reloads position)
+            if (header->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The consumer has not handed this slot back yet: full
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = header->enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    // CAS, not a store: the consumer may have skipped the slot if this push stalled (see pop())
+    uint64_t claimed = position;
+    if (!slot->sequence.compare_exchange_strong(claimed, position + 1, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        return false;
+    }
+
+    // Pairs with the fence in wait(): either the consumer sees the record or we see it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header->consumer_sleeping.load(std::memory_order_relaxed) != 0) {
+        wake();
+    }
+    return true;
+}
+
+bool PositionRing::pop(PositionRecord& out) {
+    while (true) {
+        uint64_t position = header->dequeue_position.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position + 1) {
+            out = slot.record;
+            // Hand the slot back for the producer one lap ahead
+            slot.sequence.store(position + mask + 1, std::memory_order_release);
+            header->dequeue_position.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Free slot the enqueue position has passed: claimed by a producer that has not published yet
+        if (sequence != position || header->enqueue_position.load(std::memory_order_relaxed) <= position) {
+            return false;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (stalled_position != position) {
+            stalled_position = position;
+            stalled_since = now;
+            return false;
+        }
+        if (now - stalled_since < stall_timeout) {
+            return false;
+        }
+        // Its producer presumably died: skip the slot, unless it publishes right now
+        if (slot.sequence.compare_exchange_strong(sequence, position + mask + 1, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            header->dequeue_position.store(position + 1, std::memory_order_release);
+        }
+    }
+}
+
+bool PositionRing::wait(int timeout_ms) {
+    auto ready = [this]() {
+        uint64_t position = header->dequeue_position.load(std::memory_order_relaxed);
+        return slots[position & mask].sequence.load(std::memory_order_acquire) == position + 1;
+    };
+    if (ready()) {
+        return true;
+    }
+    header->consumer_sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!ready()) {
+        futex_wait(header->consumer_sleeping, 1, timeout_ms);
+    }
+    header->consumer_sleeping.store(0, std::memory_order_relaxed);
+    return ready();
+}
+
+void PositionRing::wake() {
+    if (header->consumer_sleeping.exchange(0, std::memory_order_relaxed) != 0) {
+        futex_wake(header->consumer_sleeping);
+    }
+}
+
+size_t PositionRing::size() const {
+    uint64_t dequeued = header->dequeue_position.load(std::memory_order_acquire);
+    uint64_t enqueued = header->enqueue_position.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? static_cast<size_t>(enqueued - dequeued) : 0;
+}
+
+uint32_t PositionRing::capacity() const {
+    return header->capacity;
+}
+
+uint64_t PositionRing::dropped() const {
+    return header->dropped.load(std::memory_order_relaxed);
+}
+
+bool PositionRing::is_creator() const {
+    return created;
+}
+
+//helpers:
+size_t PositionRing::layout_bytes(uint32_t capacity) {
+    return sizeof(Header) + static_cast<size_t>(capacity) * sizeof(Slot);
+}
+
+/*POSITIONPRODUCER*/
+//constructor:
+PositionProducer::PositionProducer(const std::string& name, uint32_t capacity) : target(name, capacity) {
+}
+
+//methods:
+bool PositionProducer::fill_record(PositionRecord& record, std::string_view tag_mac, float x, float y, float z,
+                                   double timestamp, const Reading* readings, size_t count) {
+    if (!copy_mac(record.tag_mac, tag_mac)) {
+        return false;
+    }
+    record.x = x;
+    record.y = y;
+    record.z = z;
+    record.timestamp = timestamp;
+
+    // Readings the engine would drop while parsing are left out; if more than MAX_READINGS
+    // remain, the strongest are kept, in their original order (ties keep the earlier)
+    float strongest = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < count; i++) {
+        strongest = std::max(strongest, readings[i].rssi);
+    }
+    float weakest_kept = strongest - Calibration::RSSI_SIGNAL_STRENGTH_THRESHOLD;
+    size_t in_window = static_cast<size_t>(std::count_if(readings, readings + count,
+        [weakest_kept](const Reading& reading) { return reading.rssi >= weakest_kept; }));
+
+    size_t kept[PositionRecord::MAX_READINGS];
+    size_t kept_count = 0;
+    if (in_window <= PositionRecord::MAX_READINGS) {
+        for (size_t i = 0; i < count; i++) {
+            if (readings[i].rssi >= weakest_kept) {
+                kept[kept_count++] = i;
+            }
+        }
+    } else {
+        std::vector<size_t> order;
+        order.reserve(in_window);
+        for (size_t i = 0; i < count; i++) {
+            if (readings[i].rssi >= weakest_kept) {
+                order.push_back(i);
+            }
+        }
+        std::nth_element(order.begin(), order.begin() + PositionRecord::MAX_READINGS, order.end(),
+                         [readings](size_t lhs, size_t rhs) {
+            return readings[lhs].rssi != readings[rhs].rssi ? readings[lhs].rssi > readings[rhs].rssi : lhs < rhs;
+        });
+        std::sort(order.begin(), order.begin() + PositionRecord::MAX_READINGS);
+        kept_count = PositionRecord::MAX_READINGS;
+        std::copy(order.begin(), order.begin() + PositionRecord::MAX_READINGS, kept);
+    }
+
+    for (size_t i = 0; i < kept_count; i++) {
+        if (!copy_mac(record.readings[i].mac, readings[kept[i]].mac)) {
+            return false;
+        }
+        record.readings[i].rssi = readings[kept[i]].rssi;
+    }
+    record.reading_count = static_cast<uint32_t>(kept_count);
+    return true;
+}
+
+bool PositionProducer::publish(std::string_view tag_mac, float x, float y, float z, double timestamp,
+                               const Reading* readings, size_t count) {
+    return fill_record(scratch, tag_mac, x, y, z, timestamp, readings, count) && target.push(scratch);
+}
+
+bool PositionProducer::publish(std::string_view tag_mac, float x, float y, float z, double timestamp,
+                               std::initializer_list<Reading> readings) {
+    return publish(tag_mac, x, y, z, timestamp, readings.begin(), readings.size());
+}
+
+PositionRing& PositionProducer::ring() {
+    return target;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+#include "config.h"
+
+/**
+ * @brief One anchor reading of a PositionRecord
+ */
+struct PositionReading {
+    char mac[16];                  // NUL-terminated, up to 15 characters
+    float rssi;
+};
+
+/**
+ * @brief Fixed binary tag position, the shared-memory counterpart of one positions message
+ *
+ * Carries what the engine reads from a JSON message: the tag MAC, its position, the
+ * message timestamp and the used anchors' readings. Plain data with a fixed layout so
+ * that producers built separately agree on it; LAYOUT_VERSION changes with it.
+ */
+struct PositionRecord {
+    static constexpr size_t MAX_READINGS = 16;
+    static constexpr size_t MAC_BYTES = sizeof(PositionReading::mac);
+
+    char tag_mac[MAC_BYTES];
+    float x;
+    float y;
+    float z;
+    uint32_t reading_count;        // Valid entries of readings
+    double timestamp;              // Seconds, as the "timestamp" field of the JSON message
+    PositionReading readings[MAX_READINGS];
+
+    std::string_view tag() const;
+    std::string_view anchor(size_t i) const;
+};
+
+static_assert(sizeof(PositionRecord) == 360, "PositionRecord layout is shared with producers");
+
+/**
+ * @brief Bounded position queue in a named POSIX shared-memory segment
+ *
+ * Positioning engines on the same host push PositionRecords and one ble_rssi_runner
+ * pops them, with no serialization and no broker hop. Any number of producers may
+ * push concurrently (MPSC; a single producer is just the SPSC case); only one process
+ * may consume.
+ *
+ * Each slot carries a sequence number (Vyukov's bounded queue): producers claim a slot
+ * with one CAS on the enqueue position, copy the record in and publish it by bumping
+ * the slot's sequence; the consumer reads published slots in order and hands them back.
+ * Positions are 64-bit and never wrap. Producers never block: push() fails when the ring
+ * is full. The consumer can sleep on a futex in the segment, which producers only wake
+ * while it is asleep.
+ *
+ * A producer that dies between claiming and publishing a slot would stall the consumer
+ * at that slot. The consumer waits stall_timeout_ms for it, then skips the slot, hands it
+ * back and counts the record as dropped. Producers and the consumer settle the slot with
+ * a CAS on its sequence, so a producer that was only paused and publishes after the skip
+ * gets false from push() and its record is lost. If it was paused mid-copy for a full lap
+ * of the ring, its copy can tear the record of the slot's next producer.
+ *
+ * Layout: header | slot[capacity], each slot = sequence + PositionRecord on 64-byte boundaries.
+ */
+class PositionRing {
+    public:
+        static constexpr uint32_t MAGIC = 0x424C4550;   // "BLEP"
+        static constexpr uint32_t LAYOUT_VERSION = 2;
+
+        /**
+         * @brief Create the named segment, or attach to it if another process already did
+         *
+         * @param name Shared-memory object name (e.g. "/ble_rssi_positions")
+         * @param capacity Number of slots, rounded up to a power of two; used only when creating
+         * @param stall_timeout_ms How long pop() waits for a claimed slot to be published before skipping it
+         * @throws std::runtime_error if the segment cannot be created, attached or has an incompatible layout
+         */
+        PositionRing(const std::string& name, uint32_t capacity, int stall_timeout_ms = Config::POSITION_RING_STALL_MS);
+
+        /**
+         * @brief Unmap the segment; the segment itself persists for other processes
+         */
+        ~PositionRing();
+
+        PositionRing(const PositionRing&) = delete;
+        PositionRing& operator=(const PositionRing&) = delete;
+
+        /**
+         * @brief Remove the named segment from the system
+         * @param name Shared-memory object name
+         */
+        static void unlink(const std::string& name);
+
+        /**
+         * @brief Append a record (any producer, lock-free)
+         * @param record Record to copy into the ring
+         * @return bool false if the ring is full, or if the consumer skipped the slot while this push was stalled
+         */
+        bool push(const PositionRecord& record);
+
+        /**
+         * @brief Take the oldest published record (consumer only)
+         *
+         * Skips a slot whose producer claimed it but has not published it for stall_timeout_ms.
+         *
+         * @param out Receives the record
+         * @return bool false if no record is ready
+         */
+        bool pop(PositionRecord& out);
+
+        /**
+         * @brief Sleep until a record is pushed or the timeout expires (consumer only)
+         * @param timeout_ms Longest time to sleep
+         * @return bool true if a record is ready
+         */
+        bool wait(int timeout_ms);
+
+        /**
+         * @brief Wake a consumer sleeping in wait(), e.g. to make it notice a stop request
+         */
+        void wake();
+
+        /**
+         * @brief Gets the number of records pushed and not yet popped
+         */
+        size_t size() const;
+
+        /**
+         * @brief Gets the number of slots
+         */
+        uint32_t capacity() const;
+
+        /**
+         * @brief Gets the number of records lost, over all producers: pushes rejected because the
+         *        ring was full and slots skipped because their producer stalled before publishing
+         */
+        uint64_t dropped() const;
+
+        /**
+         * @brief Gets whether this process created the segment
+         */
+        bool is_creator() const;
+
+    private:
+        struct Header;
+        struct Slot;
+
+        std::string name;
+        bool created = false;
+        void* base = nullptr;
+        size_t mapped_bytes = 0;
+
+        Header* header = nullptr;
+        Slot* slots = nullptr;
+        uint64_t mask = 0;
+
+        // Consumer only: the claimed, unpublished slot pop() is waiting on, and since when
+        std::chrono::milliseconds stall_timeout;
+        uint64_t stalled_position = UINT64_MAX;
+        std::chrono::steady_clock::time_point stalled_since;
+
+        static size_t layout_bytes(uint32_t capacity);
+};
+
+/**
+ * @brief Producer side of a PositionRing, for positioning engines on the same host
+ *
+ * Fills PositionRecords from plain values so producers never touch the layout. Readings
+ * the engine would drop while parsing the JSON message (more than
+ * Calibration::RSSI_SIGNAL_STRENGTH_THRESHOLD below the strongest) are left out; if more
+ * than MAX_READINGS remain, the strongest ones are kept.
+ *
+ * Example:
+ *     PositionProducer producer("/ble_rssi_positions");
+ *     producer.publish("c00fbe457cd3", x, y, z, timestamp, {{"ce59ac2d9cc5", -61.0f}, ...});
+ */
+class PositionProducer {
+    public:
+        struct Reading {
+            std::string_view mac;
+            float rssi;
+        };
+
+        /**
+         * @param name Shared-memory object name of the ring
+         * @param capacity Number of slots if this producer is the first to open the ring
+         * @throws std::runtime_error if the ring cannot be created or attached
+         */
+        explicit PositionProducer(const std::string& name, uint32_t capacity = Config::POSITION_RING_CAPACITY);
+
+        /**
+         * @brief Fill a record from plain values, keeping at most MAX_READINGS readings the engine would use
+         * @param record Record to overwrite
+         * @return bool false if a MAC is longer than 15 characters
+         */
+        static bool fill_record(PositionRecord& record, std::string_view tag_mac, float x, float y, float z,
+                                double timestamp, const Reading* readings, size_t count);
+
+        /**
+         * @brief Push one tag position
+         * @return bool false if the ring is full or a MAC is longer than 15 characters
+         */
+        bool publish(std::string_view tag_mac, float x, float y, float z, double timestamp,
+                     const Reading* readings, size_t count);
+
+        bool publish(std::string_view tag_mac, float x, float y, float z, double timestamp,
+                     std::initializer_list<Reading> readings);
+
+        /**
+         * @brief Gets the ring written to
+         */
+        PositionRing& ring();
+
+    private:
+        PositionRing target;
+        PositionRecord scratch{};
+};
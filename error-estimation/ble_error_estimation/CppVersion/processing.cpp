@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+#include "processing.h"
+#include "tracepoints.h"
+#include "utils.h"
+
+/*ANCHORS*/
+std::string anchor_api_url(const std::string& url_template, const std::string& anch_mac) {
+    // Replace {} in URL template with actual MAC address
+    std::string api_url = url_template;
+    size_t pos = api_url.find("{}");
+    if (pos != std::string::npos) {
+        api_url.replace(pos, 2, anch_mac);
+    }
+    return api_url;
+}
+
+uint32_t publish_shared_anchor(ProcessingContext& context, const Anchor& anchor) {
+    if (!context.anchor_store) {
+        return 0;
+    }
+    int32_t slot = context.anchor_store->find_or_insert(anchor.get_mac_address());
+    if (slot < 0) {
+        return 0;
+    }
+    PointR3 coord = anchor.get_coord();
+    AnchorState anchor_state = anchor.snapshot();
+    ShmAnchorState state;
+    state.x = std::get<0>(coord);
+    state.y = std::get<1>(coord);
+    state.z = std::get<2>(coord);
+    state.RSSI_0 = anchor_state.RSSI_0;
+    state.n = anchor_state.n;
+    state.ewma = anchor_state.ewma;
+    state.last_seen = anchor_state.last_seen;
+    return context.anchor_store->write(static_cast<uint32_t>(slot), state);
+}
+
+std::unique_ptr<Anchor> attach_shared_anchor(ProcessingContext& context, const std::string& anch_mac) {
+    if (!context.anchor_store) {
+        return nullptr;
+    }
+    int32_t slot = context.anchor_store->find(anch_mac);
+    ShmAnchorState state;
+    if (slot < 0 || !context.anchor_store->read(static_cast<uint32_t>(slot), state) || state.version == 0) {
+        return nullptr;
+    }
+    auto anchor = std::make_unique<Anchor>(anch_mac, std::make_tuple(state.x, state.y, state.z), state.last_seen);
+    anchor->restore_calibration(state.RSSI_0, state.n, state.ewma, state.last_seen);
+    return anchor;
+}
+
+void sync_shared_anchors(ProcessingContext& context, const std::vector<Anchor*>& anch_list) {
+    if (!context.anchor_store) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(context.shared_versions_mutex);
+    for (Anchor* anchor : anch_list) {
+        int32_t slot = context.anchor_store->find(anchor->get_mac_address());
+        ShmAnchorState state;
+        if (slot < 0 || !context.anchor_store->read(static_cast<uint32_t>(slot), state) || state.version == 0) {
+            continue;
+        }
+        uint32_t& known_version = context.shared_versions[anchor->get_mac_address()];
+        if (state.version != known_version) {
+            anchor->restore_calibration(state.RSSI_0, state.n, state.ewma, state.last_seen);
+            known_version = state.version;
+        }
+    }
+}
+
+std::unique_ptr<Anchor> anchor_from_api_response(const std::string& anch_mac, const std::string& response) {
+    // Parse JSON response
+    json anch_data_list = json::parse(response);
+
+    if (anch_data_list.empty()) {
+        throw std::runtime_error("No anchor found for MAC address: " + anch_mac);
+    }
+
+    // Get the first (and only) anchor object
+    json anch_data = anch_data_list[0];
+
+    // Extract coordinates
+    float x = anch_data["x"].get<float>();
+    float y = anch_data["y"].get<float>();
+    float z = anch_data["z"].get<float>();
+    PointR3 coord = std::make_tuple(x, y, z);
+
+    // Create and return anchor (using current timestamp)
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    return std::make_unique<Anchor>(anch_mac, coord, static_cast<float>(now));
+}
+
+std::unique_ptr<Anchor> create_anchor_class(ProcessingContext& context, const std::string& anch_mac) {
+    if (auto shared_anchor = attach_shared_anchor(context, anch_mac)) {
+        std::cout << "Attached shared anchor for MAC: " << anch_mac << std::endl;
+        return shared_anchor;
+    }
+
+    std::cout << "Creating anchor for MAC: " << anch_mac << std::endl;
+
+    try {
+        if (!context.fetch_anchor) {
+            throw std::runtime_error("No anchor source configured");
+        }
+        auto anchor = anchor_from_api_response(anch_mac, context.fetch_anchor(anch_mac));
+        publish_shared_anchor(context, *anchor);
+        TRACE_ANCHOR_RESOLVED(anch_mac.c_str(), 1);
+        return anchor;
+
+    } catch (const std::exception& e) {
+        TRACE_ANCHOR_RESOLVED(anch_mac.c_str(), 0);
+        throw std::runtime_error("Failed to create anchor " + anch_mac + ": " + e.what());
+    }
+}
+
+std::vector<std::unique_ptr<Anchor>> create_anchor_classes(ProcessingContext& context, const std::vector<std::string>& anch_macs) {
+    std::vector<std::unique_ptr<Anchor>> anchors;
+
+    for (const auto& anch_mac : anch_macs) {
+        try {
+            anchors.push_back(create_anchor_class(context, anch_mac));
+            std::cout << "Successfully created anchor: " << anch_mac << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to create anchor " << anch_mac << ": " << e.what() << std::endl;
+            // Continue with other anchors even if one fails
+        }
+    }
+
+    return anchors;
+}
+
+
+/*MESSAGES*/
+namespace {
+    /**
+     * @brief RSSI dictionary of the readings within RSSI_SIGNAL_STRENGTH_THRESHOLD of the strongest
+     *
+     * TagSystem::get_significant_anchors never selects an anchor outside that window, so
+     * weaker readings are dropped before their MAC is copied, hashed or looked up.
+     * Readings are inserted in their original order, so a MAC listed twice keeps its last
+     * reading within the window.
+     */
+    template <typename RssiAt, typename MacAt>
+    std::unordered_map<std::string, float> readings_in_window(size_t count, RssiAt rssi_at, MacAt mac_at) {
+        float strongest = std::numeric_limits<float>::lowest();
+        for (size_t index = 0; index < count; index++) {
+            strongest = std::max(strongest, rssi_at(index));
+        }
+
+        std::unordered_map<std::string, float> tag_rssi_dict;
+        tag_rssi_dict.reserve(count);
+        for (size_t index = 0; index < count; index++) {
+            float rssi = rssi_at(index);
+            if (rssi >= strongest - Calibration::RSSI_SIGNAL_STRENGTH_THRESHOLD) {
+                tag_rssi_dict[mac_at(index)] = rssi;
+            }
+        }
+        return tag_rssi_dict;
+    }
+
+    /**
+     * @brief Fill in the anchors a parsed message still needs
+     *
+     * The first message of a context discovers every anchor it mentions; later ones
+     * only report readings whose anchor is missing from the registry.
+     */
+    template <typename AllMacs>
+    void find_unresolved_anchors(ProcessingContext& context, TagMessage& message, AllMacs all_macs) {
+        // Fetching runs outside any lock; concurrent first messages at worst fetch an anchor twice
+        if (!context.anchors_initialized.exchange(true)) {
+            std::cout << "First message received - discovering and initializing anchors..." << std::endl;
+
+            message.unresolved_anchors = all_macs();
+            message.discovery = true;
+            std::cout << "Discovered anchor MACs: ";
+            for (const auto& mac : message.unresolved_anchors) {
+                std::cout << mac << " ";
+            }
+            std::cout << std::endl;
+            DEBUG_LOG("Discovered " << message.unresolved_anchors.size() << " anchor MACs from first message");
+            TRACE_MESSAGE_PARSED(message.tag.get_mac_address().c_str(), message.tag.get_rssi_readings().size(),
+                                 message.unresolved_anchors.size());
+            return;
+        }
+
+        // Anchors discovered after initialization
+        auto guard = context.anchors.read();
+        for (const auto& [anch_mac, rssi_val] : message.tag.get_rssi_readings()) {
+            if (!guard.find(anch_mac)) {
+                message.unresolved_anchors.push_back(anch_mac);
+            }
+        }
+        TRACE_MESSAGE_PARSED(message.tag.get_mac_address().c_str(), message.tag.get_rssi_readings().size(),
+                             message.unresolved_anchors.size());
+    }
+}
+
+Tag create_tag_class(const json& tag_data) {
+    // Get MAC address
+    std::string tag_mac = tag_data["tag"]["mac"].get<std::string>();
+
+    // Get position
+    const json& position_data = tag_data["location"]["position"];
+    float x = position_data["x"].get<float>();
+    float y = position_data["y"].get<float>();
+    float z = position_data["z"].get<float>();
+    PointR3 tag_pos = std::make_tuple(x, y, z);
+
+    // Get RSSI dictionary
+    std::unordered_map<std::string, float> tag_rssi_dict;
+
+    if (position_data.contains("used_anchors")) {
+        const json& used_anchors = position_data["used_anchors"];
+        tag_rssi_dict = readings_in_window(used_anchors.size(),
+            [&used_anchors](size_t i) { return used_anchors[i]["rssi"].get<float>(); },
+            [&used_anchors](size_t i) { return used_anchors[i]["mac"].get<std::string>(); });
+    }
+
+    return Tag(tag_mac, tag_pos, tag_rssi_dict);
+}
+
+Tag create_tag_class(const PositionRecord& record) {
+    size_t count = std::min<size_t>(record.reading_count, PositionRecord::MAX_READINGS);
+    std::unordered_map<std::string, float> tag_rssi_dict = readings_in_window(count,
+        [&record](size_t i) { return record.readings[i].rssi; },
+        [&record](size_t i) { return std::string(record.anchor(i)); });
+    return Tag(std::string(record.tag()), std::make_tuple(record.x, record.y, record.z), tag_rssi_dict);
+}
+
+std::vector<std::string> extract_anchor_macs_from_message(const json& tag_data) {
+    std::vector<std::string> anchor_macs;
+    json position_data = tag_data["location"]["position"];
+
+    // Get MACs from used anchors
+    if (position_data.contains("used_anchors")) {
+        json used_anchors = position_data["used_anchors"];
+        for (const auto& anchor_dict : used_anchors) {
+            anchor_macs.push_back(anchor_dict["mac"].get<std::string>());
+        }
+    }
+
+    // Get MACs from unused anchors
+    if (position_data.contains("unused_anchors")) {
+        json unused_anchors = position_data["unused_anchors"];
+        for (const auto& anchor_dict : unused_anchors) {
+            anchor_macs.push_back(anchor_dict["mac"].get<std::string>());
+        }
+    }
+
+    // Remove duplicates
+    std::sort(anchor_macs.begin(), anchor_macs.end());
+    anchor_macs.erase(std::unique(anchor_macs.begin(), anchor_macs.end()), anchor_macs.end());
+
+    return anchor_macs;
+}
+
+json create_tag_info(const std::string& tag_mac, float error_estimate) {
+    return json{
+        {"tag_mac", tag_mac},
+        {"error_estimate", error_estimate}
+    };
+}
+
+json create_anchors_info(const std::vector<Anchor*>& anch_list) {
+    std::vector<std::string> warning_anchors;
+    std::vector<std::string> faulty_anchors;
+    json anchors_info_list = json::array();
+
+    for (const auto& anchor : anch_list) {
+        json anch_info_dict = {
+            {"mac", anchor->get_mac_address()},
+            {"n_var", anchor->get_n()},
+            {"ewma", anchor->get_ewma()}
+        };
+
+        anchors_info_list.push_back(anch_info_dict);
+
+        if (anchor->is_warning()) {
+            warning_anchors.push_back(anchor->get_mac_address());
+        }
+
+        if (anchor->is_faulty()) {
+            faulty_anchors.push_back(anchor->get_mac_address());
+        }
+    }
+
+    return json{
+        {"anchors_selected_for_estimation", anchors_info_list},
+        {"warning_anchors", warning_anchors},
+        {"faulty_anchors", faulty_anchors}
+    };
+}
+
+json create_output_info(const std::string& tag_mac, float error_estimate, const std::vector<Anchor*>& anch_list) {
+    json tag_return = create_tag_info(tag_mac, error_estimate);
+    json anchors_return = create_anchors_info(anch_list);
+
+    // Merge the two JSON objects
+    json result = tag_return;
+    for (auto& [key, value] : anchors_return.items()) {
+        result[key] = value;
+    }
+
+    return result;
+}
+
+
+/*PROCESSING*/
+TagMessage parse_tag_message(ProcessingContext& context, const std::string& payload) {
+    // Parse JSON message
+    json tag_data = json::parse(payload);
+
+    // Create Tag object from message
+    Tag message_tag = create_tag_class(tag_data);
+    float timestamp = tag_data["timestamp"].get<float>();
+    TagMessage message{std::move(tag_data), std::move(message_tag), timestamp, {}, false};
+
+    find_unresolved_anchors(context, message, [&message]() { return extract_anchor_macs_from_message(message.data); });
+    return message;
+}
+
+TagMessage parse_position_record(ProcessingContext& context, const PositionRecord& record) {
+    TagMessage message{json(), create_tag_class(record), static_cast<float>(record.timestamp), {}, false};
+
+    // A record carries no unused anchors: discovery covers every reading
+    find_unresolved_anchors(context, message, [&record]() {
+        std::vector<std::string> anchor_macs;
+        size_t count = std::min<size_t>(record.reading_count, PositionRecord::MAX_READINGS);
+        for (size_t i = 0; i < count; i++) {
+            anchor_macs.emplace_back(record.anchor(i));
+        }
+        std::sort(anchor_macs.begin(), anchor_macs.end());
+        anchor_macs.erase(std::unique(anchor_macs.begin(), anchor_macs.end()), anchor_macs.end());
+        return anchor_macs;
+    });
+    return message;
+}
+
+std::optional<json> evaluate_tag_message(ProcessingContext& context, const TagMessage& message) {
+    const Tag& message_tag = message.tag;
+    const auto& rssi_readings = message_tag.get_rssi_readings();
+
+    // Anchor pointers stay valid while this read guard is alive
+    auto anchors_guard = context.anchors.read();
+
+    // Create vector of anchor pointers for anchors that have RSSI readings
+    std::vector<Anchor*> anch_list;
+    for (const auto& [anch_mac, rssi_val] : rssi_readings) {
+        if (Anchor* anchor = anchors_guard.find(anch_mac)) {
+            anch_list.push_back(anchor);
+        }
+    }
+
+    // Only proceed if we have at least some anchors
+    if (anch_list.empty()) {
+        std::cout << "No initialized anchors found for tag " << message_tag.get_mac_address() << std::endl;
+        return std::nullopt;
+    }
+
+    // Anchors heard together are laid out next to each other (AnchorCompactor)
+    context.covisibility.record(anch_list);
+
+    // Pick up calibration published by other runners on this host
+    sync_shared_anchors(context, anch_list);
+
+    // Anchors are found without locks and read through lock-free snapshots;
+    // updates serialize per anchor, so no global lock is held at all
+    TagSystem message_system(message_tag, context.model);
+
+    // Get error estimate
+    float error_estimate = message_system.error_radius(anch_list);
+    TRACE_MESSAGE_EVALUATED(message_tag.get_mac_address().c_str(), anch_list.size(), trace_milli(error_estimate));
+
+    // Before/after snapshots only while a tracer is attached to anchor_updated
+    std::vector<AnchorState> traced_before;
+    if (TRACE_ENABLED(anchor_updated)) {
+        for (Anchor* anchor : anch_list) {
+            traced_before.push_back(anchor->snapshot());
+        }
+    }
+
+    // Update anchor health and parameters
+    update_anchors_from_tag_data(anch_list, message_tag, context.model, message.timestamp, Config::DEFAULT_DELTA_R, Config::DEFAULT_T_VIS);
+    for (size_t i = 0; i < traced_before.size(); i++) {
+        const AnchorState& before = traced_before[i];
+        AnchorState after = anch_list[i]->snapshot();
+        if (after.version != before.version) {
+            TRACE_ANCHOR_UPDATED(anch_list[i]->get_mac_address().c_str(),
+                                 trace_milli(before.RSSI_0), trace_milli(before.n), trace_milli(before.ewma),
+                                 trace_milli(after.RSSI_0), trace_milli(after.n), trace_milli(after.ewma));
+        }
+    }
+    if (context.anchor_store) {
+        std::lock_guard<std::mutex> versions_lock(context.shared_versions_mutex);
+        for (Anchor* anchor : anch_list) {
+            uint32_t version = publish_shared_anchor(context, *anchor);
+            if (version != 0) {
+                context.shared_versions[anchor->get_mac_address()] = version;
+            }
+        }
+    }
+
+    // Create output message
+    return create_output_info(message_tag.get_mac_address(), error_estimate, anch_list);
+}
+
+std::optional<json> process_tag_message(ProcessingContext& context, const std::string& payload) {
+    TagMessage message = parse_tag_message(context, payload);
+
+    if (message.discovery) {
+        // Initialize all discovered anchors, published as a single registry version
+        context.anchors.insert_all(create_anchor_classes(context, message.unresolved_anchors));
+        std::cout << "Initialized " << context.anchors.size() << " anchors" << std::endl;
+    } else {
+        // Fetch new anchors without holding any lock, then publish them;
+        // readers keep using the previous registry version
+        for (const auto& anch_mac : message.unresolved_anchors) {
+            std::cout << "Warning: Found new anchor " << anch_mac << " after initialization" << std::endl;
+            try {
+                context.anchors.insert(create_anchor_class(context, anch_mac));
+            } catch (const std::exception& e) {
+                std::cerr << "Failed to create new anchor " << anch_mac << ": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    return evaluate_tag_message(context, message);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "models.h"
+#include "metrics.h"
+#include "config.h"
+#include "anchor_registry.h"
+#include "anchor_layout.h"
+#include "shm_anchor_store.h"
+#include "position_ring.h"
+
+using json = nlohmann::json;
+
+// Debug logging macro
+#define DEBUG_LOG(msg) \
+    do { \
+        if (Config::ENABLE_DEBUG_LOGGING) { \
+            std::cout << "[DEBUG] " << msg << std::endl; \
+        } \
+    } while(0)
+
+/**
+ * @brief Fetch the dongles API response for one anchor MAC address
+ *
+ * Provided by the runner (e.g. an HTTP request driven by the reactor). Throws
+ * std::runtime_error if the anchor configuration cannot be fetched.
+ */
+using AnchorFetcher = std::function<std::string(const std::string& anch_mac)>;
+
+/**
+ * @brief State shared by every message processed by one engine
+ *
+ * Independent of MQTT and HTTP so the same core runs in the engine, the tests
+ * and the benchmarks.
+ */
+struct ProcessingContext {
+    AnchorRegistry anchors;                        // Lock-free lookups; discovery never blocks processing
+    CoVisibilityLog covisibility;                  // Sampled anchor lists, for the registry's memory layout
+    std::atomic<bool> anchors_initialized{false};
+    PathLossModel model;
+    AnchorFetcher fetch_anchor;                    // Source of anchor configurations
+    ShmAnchorStore* anchor_store = nullptr;        // Shared-memory store, nullptr when disabled or unavailable
+    std::mutex shared_versions_mutex;
+    std::unordered_map<std::string, uint32_t> shared_versions; // Last shared-store version adopted per anchor, guarded by shared_versions_mutex
+};
+
+/**
+ * @brief Build the dongles API URL for an anchor
+ *
+ * @param url_template URL with a {} placeholder for the MAC address
+ * @param anch_mac MAC address of the anchor
+ * @return std::string Request URL
+ */
+std::string anchor_api_url(const std::string& url_template, const std::string& anch_mac);
+
+/**
+ * @brief Write an anchor's coordinates, calibration and health to the shared-memory store
+ *
+ * @param context Processing context holding the store
+ * @param anchor Anchor to publish
+ * @return uint32_t New version of the anchor's slot, 0 if the store is disabled or full
+ */
+uint32_t publish_shared_anchor(ProcessingContext& context, const Anchor& anchor);
+
+/**
+ * @brief Create an Anchor from the shared-memory store if another runner already resolved it
+ *
+ * @param context Processing context holding the store
+ * @param anch_mac MAC address of the anchor
+ * @return std::unique_ptr<Anchor> Anchor with shared coordinates and calibration, nullptr if not shared yet
+ */
+std::unique_ptr<Anchor> attach_shared_anchor(ProcessingContext& context, const std::string& anch_mac);
+
+/**
+ * @brief Adopt calibration written by other runners since this process last synced
+ *
+ * @param context Processing context holding the store and the last adopted version per anchor
+ * @param anch_list Anchors about to be evaluated
+ */
+void sync_shared_anchors(ProcessingContext& context, const std::vector<Anchor*>& anch_list);
+
+/**
+ * @brief Create an Anchor from a dongles API response
+ *
+ * @param anch_mac MAC address of the anchor
+ * @param response JSON array returned by the dongles API
+ * @return std::unique_ptr<Anchor> Anchor with the position from the API
+ * @throws std::runtime_error If the response holds no anchor
+ */
+std::unique_ptr<Anchor> anchor_from_api_response(const std::string& anch_mac, const std::string& response);
+
+/**
+ * @brief Create an Anchor object by fetching anchor configuration from the Ubudu API
+ *
+ * Anchors already resolved by another runner on this host are attached from the
+ * shared-memory store instead, without any HTTP request.
+ *
+ * @param context Processing context providing the fetcher and the store
+ * @param anch_mac MAC address of the anchor to initialize
+ * @return std::unique_ptr<Anchor> Configured Anchor object with position and MAC address from API
+ * @throws std::runtime_error If API call fails
+ */
+std::unique_ptr<Anchor> create_anchor_class(ProcessingContext& context, const std::string& anch_mac);
+
+/**
+ * @brief Create multiple Anchor objects by fetching anchor configurations from the Ubudu API
+ *
+ * @param context Processing context providing the fetcher and the store
+ * @param anch_macs List of MAC addresses of anchors to initialize
+ * @return std::vector<std::unique_ptr<Anchor>> Anchors that could be created, ready for AnchorRegistry::insert_all
+ */
+std::vector<std::unique_ptr<Anchor>> create_anchor_classes(ProcessingContext& context, const std::vector<std::string>& anch_macs);
+
+/**
+ * @brief Create a Tag object from MQTT message data
+ *
+ * Only used_anchors readings within Calibration::RSSI_SIGNAL_STRENGTH_THRESHOLD of the
+ * strongest one are kept. TagSystem::get_significant_anchors measures its window from
+ * the same strongest reading, so anchor selection, calibration and health updates are
+ * the same as with every reading kept (for messages that list each anchor once), while
+ * weaker readings are never copied, hashed or looked up in the registry. Anchors heard
+ * only below the window are neither listed in the output message nor fetched.
+ *
+ * @param tag_data Parsed JSON data from MQTT message
+ * @return Tag object with position and RSSI readings
+ */
+Tag create_tag_class(const json& tag_data);
+
+/**
+ * @brief Create a Tag object from a shared-memory position record
+ *
+ * Keeps the same readings as the JSON overload.
+ *
+ * @param record Record popped from a PositionRing
+ * @return Tag object with position and RSSI readings
+ */
+Tag create_tag_class(const PositionRecord& record);
+
+/**
+ * @brief Extract all anchor MAC addresses from a tag position message
+ *
+ * @param tag_data The parsed JSON data from an MQTT tag position message
+ * @return std::vector<std::string> List of unique anchor MAC addresses found in the message
+ */
+std::vector<std::string> extract_anchor_macs_from_message(const json& tag_data);
+
+/**
+ * @brief Create tag info structure for output message
+ */
+json create_tag_info(const std::string& tag_mac, float error_estimate);
+
+/**
+ * @brief Create anchors info structure for output message
+ */
+json create_anchors_info(const std::vector<Anchor*>& anch_list);
+
+/**
+ * @brief Create complete output info combining tag and anchors data
+ */
+json create_output_info(const std::string& tag_mac, float error_estimate, const std::vector<Anchor*>& anch_list);
+
+/**
+ * @brief A parsed tag position message and the anchors it still needs
+ */
+struct TagMessage {
+    json data;                                     // Parsed message, null for a PositionRecord
+    Tag tag;
+    float timestamp;
+    std::vector<std::string> unresolved_anchors;   // Anchors to create before evaluation
+    bool discovery = false;                        // First message: unresolved_anchors lists every anchor it mentions
+};
+
+/**
+ * @brief Parse a tag position message and find the anchors it needs that are not known yet
+ *
+ * The first message processed by a context discovers every anchor it mentions (used
+ * and unused); later messages only report used anchors missing from the registry.
+ *
+ * @param context Processing context
+ * @param payload Raw JSON tag position message
+ * @return TagMessage Parsed message
+ * @throws json::exception If the message is malformed
+ */
+TagMessage parse_tag_message(ProcessingContext& context, const std::string& payload);
+
+/**
+ * @brief Build a tag message from a shared-memory position record, without any parsing
+ *
+ * Same as parse_tag_message() for the equivalent JSON message, except that data stays
+ * empty and the first message discovers only the anchors the record carries.
+ *
+ * @param context Processing context
+ * @param record Record popped from a PositionRing
+ * @return TagMessage Message ready for evaluate_tag_message()
+ */
+TagMessage parse_position_record(ProcessingContext& context, const PositionRecord& record);
+
+/**
+ * @brief Compute the error estimate of a parsed message and update anchor health and parameters
+ *
+ * Anchors still missing from the registry are ignored.
+ *
+ * @param context Processing context
+ * @param message Parsed message
+ * @return std::optional<json> Output message, std::nullopt if none of the tag's anchors are known
+ */
+std::optional<json> evaluate_tag_message(ProcessingContext& context, const TagMessage& message);
+
+/**
+ * @brief Process one tag position message - main processing logic
+ *
+ * Resolves the tag's anchors (fetching unknown ones through the context's fetcher,
+ * blocking the caller), computes the error estimate and updates anchor health and
+ * parameters. Safe to call from several threads at once.
+ *
+ * @param context Processing context
+ * @param payload Raw JSON tag position message
+ * @return std::optional<json> Output message, std::nullopt if none of the tag's anchors are known
+ * @throws json::exception If the message is malformed
+ */
+std::optional<json> process_tag_message(ProcessingContext& context, const std::string& payload);
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "reactor.h"
+
+namespace {
+    constexpr int MAX_EVENTS = 64;
+
+    std::runtime_error reactor_error(const std::string& what) {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+}
+
+/*REACTOR*/
+//constructor:
+Reactor::Reactor(uint32_t tick, size_t wheel_slots)
+    : tick_ms(std::max<uint32_t>(1, tick)),
+      start_time(std::chrono::steady_clock::now()),
+      wheel(std::max<size_t>(1, wheel_slots)) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        throw reactor_error("Failed to create epoll instance");
+    }
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        close(epoll_fd);
+        throw reactor_error("Failed to create reactor eventfd");
+    }
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event) != 0) {
+        close(wake_fd);
+        close(epoll_fd);
+        throw reactor_error("Failed to watch reactor eventfd");
+    }
+}
+
+Reactor::~Reactor() {
+    close(wake_fd);
+    close(epoll_fd);
+}
+
+//methods:
+void Reactor::add_fd(int fd, uint32_t events, IoCallback callback) {
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        throw reactor_error("Failed to watch fd " + std::to_string(fd));
+    }
+    handlers[fd] = std::make_shared<IoCallback>(std::move(callback));
+}
+
+void Reactor::modify_fd(int fd, uint32_t events) {
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void Reactor::remove_fd(int fd) {
+    if (handlers.erase(fd) > 0) {
+        // Fails harmlessly if the fd was already closed (the kernel dropped it from the set)
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+bool Reactor::has_fd(int fd) const {
+    return handlers.count(fd) > 0;
+}
+
+Reactor::TimerId Reactor::add_timer(uint32_t delay_ms, Callback callback) {
+    return schedule(delay_ms, 0, std::move(callback));
+}
+
+Reactor::TimerId Reactor::add_periodic(uint32_t interval_ms, Callback callback) {
+    return schedule(interval_ms, interval_ms, std::move(callback));
+}
+
+bool Reactor::cancel_timer(TimerId id) {
+    // The id left in its wheel slot is dropped when the slot expires
+    return timers.erase(id) > 0;
+}
+
+void Reactor::post(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        posted.push_back(std::move(callback));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written; // Counter saturation still leaves the eventfd readable
+}
+
+void Reactor::run() {
+    loop_thread = std::this_thread::get_id();
+    while (!stopping.load()) {
+        run_once(-1);
+    }
+    loop_thread = std::thread::id();
+}
+
+void Reactor::run_once(int max_wait_ms) {
+    epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, next_timeout_ms(max_wait_ms));
+    if (ready < 0 && errno != EINTR) {
+        throw reactor_error("epoll_wait failed");
+    }
+
+    for (int i = 0; i < ready; i++) {
+        int fd = events[i].data.fd;
+        if (fd == wake_fd) {
+            uint64_t count = 0;
+            ssize_t drained = read(wake_fd, &count, sizeof(count));
+            (void)drained;
+            continue;
+        }
+        // Hold the handler alive in case it removes itself
+        auto it = handlers.find(fd);
+        if (it != handlers.end()) {
+            std::shared_ptr<IoCallback> handler = it->second;
+            (*handler)(events[i].events);
+        }
+    }
+
+    run_posted();
+    advance_timers();
+}
+
+void Reactor::stop() {
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+bool Reactor::in_reactor_thread() const {
+    return loop_thread.load() == std::this_thread::get_id();
+}
+
+//helpers:
+uint64_t Reactor::now_tick() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+    return static_cast<uint64_t>(elapsed.count()) / tick_ms;
+}
+
+uint64_t Reactor::ticks_for(uint32_t ms) const {
+    return std::max<uint64_t>(1, (ms + tick_ms - 1) / tick_ms);
+}
+
+Reactor::TimerId Reactor::schedule(uint32_t delay_ms, uint32_t interval_ms, Callback callback) {
+    TimerId id = next_timer_id++;
+    uint64_t expires = std::max(now_tick(), current_tick) + ticks_for(delay_ms);
+    timers[id] = Timer{expires, interval_ms > 0 ? ticks_for(interval_ms) : 0, std::move(callback)};
+    wheel[expires % wheel.size()].push_back(id);
+    return id;
+}
+
+int Reactor::next_timeout_ms(int max_wait_ms) const {
+    if (timers.empty()) {
+        return max_wait_ms;
+    }
+
+    // First non-empty slot ahead of the current tick; entries due on a later revolution only cause an early wake-up
+    uint64_t wake_tick = current_tick + wheel.size();
+    for (uint64_t tick = current_tick + 1; tick <= current_tick + wheel.size(); tick++) {
+        if (!wheel[tick % wheel.size()].empty()) {
+            wake_tick = tick;
+            break;
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+    int64_t wait = static_cast<int64_t>(wake_tick * tick_ms) - static_cast<int64_t>(elapsed.count());
+    wait = std::max<int64_t>(0, wait);
+    if (max_wait_ms >= 0) {
+        wait = std::min<int64_t>(wait, max_wait_ms);
+    }
+    return static_cast<int>(wait);
+}
+
+void Reactor::advance_timers() {
+    uint64_t target = now_tick();
+    if (target <= current_tick) {
+        return;
+    }
+
+    std::vector<TimerId> due;
+    if (target - current_tick >= wheel.size()) {
+        for (size_t slot = 0; slot < wheel.size(); slot++) {
+            expire_slot(slot, target, due);
+        }
+    } else {
+        for (uint64_t tick = current_tick + 1; tick <= target; tick++) {
+            expire_slot(tick % wheel.size(), target, due);
+        }
+    }
+    current_tick = target;
+
+    std::sort(due.begin(), due.end(), [this](TimerId a, TimerId b) {
+        const Timer& first = timers.at(a);
+        const Timer& second = timers.at(b);
+        return first.expires_tick != second.expires_tick ? first.expires_tick < second.expires_tick : a < b;
+    });
+
+    for (TimerId id : due) {
+        auto it = timers.find(id);
+        if (it == timers.end()) {
+            continue; // Cancelled by an earlier callback
+        }
+        Callback callback = it->second.callback;
+        if (it->second.interval_ticks > 0) {
+            it->second.expires_tick = target + it->second.interval_ticks;
+            wheel[it->second.expires_tick % wheel.size()].push_back(id);
+        } else {
+            timers.erase(it);
+        }
+        callback();
+    }
+}
+
+void Reactor::expire_slot(size_t slot, uint64_t tick, std::vector<TimerId>& due) {
+    std::vector<TimerId> entries;
+    entries.swap(wheel[slot]);
+    for (TimerId id : entries) {
+        auto it = timers.find(id);
+        if (it == timers.end()) {
+            continue;
+        }
+        if (it->second.expires_tick > tick) {
+            wheel[slot].push_back(id); // Due on a later revolution
+        } else {
+            due.push_back(id);
+        }
+    }
+}
+
+void Reactor::run_posted() {
+    std::vector<Callback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        callbacks.swap(posted);
+    }
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
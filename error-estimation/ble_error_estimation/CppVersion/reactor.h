@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "config.h"
+
+/**
+ * @brief Single-threaded epoll event loop with a hashed timer wheel
+ *
+ * One reactor thread multiplexes every socket of the engine (both MQTT clients and
+ * the libcurl multi handle) together with its timers. File descriptor callbacks and
+ * timers run on the reactor thread and must never block; long work is handed to a
+ * WorkerPool and results come back through post().
+ *
+ * Only post() and stop() may be called from other threads. Everything else must be
+ * called from the reactor thread, or before run() starts.
+ */
+class Reactor {
+    public:
+        using Callback = std::function<void()>;
+        using IoCallback = std::function<void(uint32_t events)>;   // events: EPOLLIN, EPOLLOUT, EPOLLERR, ...
+        using TimerId = uint64_t;
+
+        /**
+         * @brief Construct a reactor
+         * @param tick_ms Timer wheel resolution in milliseconds
+         * @param wheel_slots Number of wheel slots; longer timers take several revolutions
+         * @throws std::runtime_error If epoll or eventfd cannot be created
+         */
+        explicit Reactor(uint32_t tick_ms = Config::REACTOR_TICK_MS, size_t wheel_slots = Config::TIMER_WHEEL_SLOTS);
+        ~Reactor();
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        /**
+         * @brief Watch a file descriptor
+         * @param fd Non-blocking file descriptor
+         * @param events epoll interest mask (EPOLLIN, EPOLLOUT)
+         * @param callback Called on the reactor thread with the ready events
+         * @throws std::runtime_error If epoll rejects the descriptor
+         */
+        void add_fd(int fd, uint32_t events, IoCallback callback);
+
+        /**
+         * @brief Change the interest mask of a watched file descriptor
+         */
+        void modify_fd(int fd, uint32_t events);
+
+        /**
+         * @brief Stop watching a file descriptor; safe to call from its own callback
+         */
+        void remove_fd(int fd);
+
+        /**
+         * @brief Check whether a file descriptor is watched
+         */
+        bool has_fd(int fd) const;
+
+        /**
+         * @brief Run a callback once after a delay, rounded up to the wheel tick
+         * @return TimerId Handle for cancel_timer
+         */
+        TimerId add_timer(uint32_t delay_ms, Callback callback);
+
+        /**
+         * @brief Run a callback every interval until cancelled
+         * @return TimerId Handle for cancel_timer
+         */
+        TimerId add_periodic(uint32_t interval_ms, Callback callback);
+
+        /**
+         * @brief Cancel a pending timer; safe to call from the timer's own callback
+         * @return bool true if the timer was pending
+         */
+        bool cancel_timer(TimerId id);
+
+        /**
+         * @brief Queue a callback to run on the reactor thread (thread-safe)
+         */
+        void post(Callback callback);
+
+        /**
+         * @brief Run the loop on the calling thread until stop() is called
+         */
+        void run();
+
+        /**
+         * @brief Wait for events once and dispatch them, including due timers and posted callbacks
+         * @param max_wait_ms Longest time to wait, -1 to wait until something happens
+         */
+        void run_once(int max_wait_ms);
+
+        /**
+         * @brief Ask run() to return after the current iteration (thread-safe)
+         */
+        void stop();
+
+        /**
+         * @brief Check whether the caller runs on the reactor thread
+         */
+        bool in_reactor_thread() const;
+
+    private:
+        struct Timer {
+            uint64_t expires_tick;
+            uint64_t interval_ticks;   // 0 for one-shot timers
+            Callback callback;
+        };
+
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        uint32_t tick_ms;
+        std::chrono::steady_clock::time_point start_time;
+
+        std::unordered_map<int, std::shared_ptr<IoCallback>> handlers;
+
+        // Timer wheel: each slot holds ids of timers expiring on ticks congruent to the slot
+        std::vector<std::vector<TimerId>> wheel;
+        std::unordered_map<TimerId, Timer> timers;
+        uint64_t current_tick = 0;
+        TimerId next_timer_id = 1;
+
+        std::mutex posted_mutex;
+        std::vector<Callback> posted;
+
+        std::atomic<bool> stopping{false};
+        std::atomic<std::thread::id> loop_thread;
+
+        uint64_t now_tick() const;
+        uint64_t ticks_for(uint32_t ms) const;
+        TimerId schedule(uint32_t delay_ms, uint32_t interval_ms, Callback callback);
+        int next_timeout_ms(int max_wait_ms) const;
+        void advance_timers();
+        void expire_slot(size_t slot, uint64_t tick, std::vector<TimerId>& due);
+        void run_posted();
+};
@@ -0,0 +1,860 @@
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include <mqtt_protocol.h>
+#include <unistd.h>
+
+#include "runner.h"
+#include "numeric_kernels.h"
+#include "state_snapshot.h"
+#include "tracepoints.h"
+
+// The new runner waits while the old one drains its outbound queue
+static_assert(Config::HANDOFF_TIMEOUT_MS > Config::OUTBOUND_SHUTDOWN_DRAIN_MS,
+              "a handoff must outlast the old runner's outbound drain");
+
+namespace {
+    /**
+     * @brief Cheap ordering key for a raw message: hash of the "tag" object's MAC
+     *
+     * Runs on the reactor thread, so the payload is scanned rather than parsed.
+     * Messages without a recognizable tag MAC all share key 0.
+     */
+    size_t tag_ordering_key(std::string_view payload) {
+        size_t tag_pos = payload.find("\"tag\"");
+        if (tag_pos == std::string_view::npos) {
+            return 0;
+        }
+        size_t mac_pos = payload.find("\"mac\"", tag_pos);
+        if (mac_pos == std::string_view::npos) {
+            return 0;
+        }
+        size_t colon = payload.find(':', mac_pos);
+        size_t open_quote = colon == std::string_view::npos ? std::string_view::npos : payload.find('"', colon);
+        size_t close_quote = open_quote == std::string_view::npos ? std::string_view::npos : payload.find('"', open_quote + 1);
+        if (close_quote == std::string_view::npos) {
+            return 0;
+        }
+        return std::hash<std::string_view>()(payload.substr(open_quote + 1, close_quote - open_quote - 1));
+    }
+
+    /**
+     * @brief Default cluster instance id: unique per process, readable in broker logs
+     */
+    std::string default_instance_id() {
+        char host[256] = {};
+        if (gethostname(host, sizeof(host) - 1) != 0) {
+            std::strcpy(host, "localhost");
+        }
+        return std::string(host) + "-" + std::to_string(getpid());
+    }
+
+    /**
+     * @brief The site-survey file when one is configured, otherwise the dongles API
+     */
+    std::unique_ptr<AnchorSource> make_anchor_source(const RunnerOptions& options, Reactor& reactor, HttpClient& http) {
+        if (!options.anchor_survey_file.empty()) {
+            return std::make_unique<SiteSurveyFileSource>(options.anchor_survey_file);
+        }
+        return std::make_unique<HttpAnchorSource>(reactor, http, options.anchor_api_url, options.anchor_list_url,
+                                                  options.api_username, options.api_password,
+                                                  options.anchor_list_page_size, options.anchor_list_max_pages);
+    }
+}
+
+/*RUNNER*/
+//constructor:
+Runner::Runner(RunnerOptions runner_options)
+    : options(std::move(runner_options)), http(reactor),
+      anchor_source(make_anchor_source(options, reactor, http)),
+      resolver(processing, anchor_source->fetcher()),
+      last_report(std::chrono::steady_clock::now()) {}
+
+Runner::~Runner() {
+    stop_position_ring();
+    handoff_server.reset();
+    input_subscriber.reset();
+    input_link.reset();
+    sync_link.reset();
+    output_link.reset();
+    if (sync_client) {
+        mosquitto_destroy(sync_client);
+    }
+    if (sub_client) {
+        mosquitto_destroy(sub_client);
+    }
+    if (pub_client) {
+        mosquitto_destroy(pub_client);
+    }
+    processing.anchor_store = nullptr;
+}
+
+//methods:
+int Runner::run() {
+    if (!start()) {
+        return 1;
+    }
+
+    std::cout << "Starting reactor loop..." << std::endl;
+    reactor.run();
+    stop_position_ring();
+
+    // Let in-progress messages finish; keep the reactor serving their HTTP requests and publishes
+    while (messages_in_progress()) {
+        reactor.run_once(10);
+    }
+    workers->stop();
+    reactor.run_once(0);
+
+    if (input_subscriber) {
+        input_subscriber->disconnect();
+    } else {
+        mosquitto_disconnect(sub_client);
+    }
+    if (sync_client) {
+        publish_anchor_deltas();
+        reactor.run_once(0);
+        mosquitto_disconnect(sync_client);
+    }
+    if (!outbound_handed_off) {
+        flush_outbound();
+    }
+    mosquitto_disconnect(pub_client);
+    reactor.run_once(0);
+    return 0;
+}
+
+void Runner::stop() {
+    reactor.stop();
+}
+
+ProcessingContext& Runner::context() {
+    return processing;
+}
+
+//helpers:
+bool Runner::start() {
+    // Widest instruction set the CPU supports, unless one is forced
+    if (!select_numeric_kernels(options.numeric_isa)) {
+        std::cerr << "Numeric kernels '" << options.numeric_isa << "' not supported on this CPU, keeping "
+                  << numeric_kernels().isa << std::endl;
+    }
+    std::cout << "Numeric kernels: " << numeric_kernels().isa << std::endl;
+
+    // Shared-memory anchor store lets runners on this host share anchors and calibration
+    if (options.enable_shm_anchor_store) {
+        try {
+            anchor_store = std::make_unique<ShmAnchorStore>(options.shm_anchor_store_name, options.shm_anchor_capacity);
+            processing.anchor_store = anchor_store.get();
+            std::cout << (anchor_store->is_creator() ? "Created" : "Attached to") << " shared anchor store "
+                      << options.shm_anchor_store_name << " (" << anchor_store->size() << "/"
+                      << anchor_store->capacity() << " anchors)" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Shared anchor store unavailable, using private anchors: " << e.what() << std::endl;
+        }
+    }
+
+    // A running engine hands its calibrated anchors over: no site load needed
+    bool taken_over = options.enable_state_handoff && take_over_state();
+
+    // Whole site from the survey file, or in a few paginated requests instead of one request per anchor
+    if (!taken_over && (!options.anchor_survey_file.empty() || (options.enable_bulk_anchor_load && !options.anchor_list_url.empty()))) {
+        load_anchors();
+    }
+
+    // Outbound queue survives output broker outages by spilling to disk. Created after a
+    // handoff: the old runner has then flushed its queue and left the spill directory to us
+    outbound = std::make_unique<OutboundQueue>(options.spill_dir, options.outbound_memory_capacity,
+                                               options.spill_segment_bytes, options.outbound_max_inflight);
+
+    workers = std::make_unique<WorkerPool>(options.worker_threads);
+
+    // Create OUTPUT MQTT client (for publishing)
+    pub_client = mosquitto_new(options.output_client_id.c_str(), true, this);
+    if (!pub_client) {
+        std::cerr << "Failed to create OUTPUT MQTT client" << std::endl;
+        return false;
+    }
+
+    // Set callbacks for OUTPUT client
+    mosquitto_connect_callback_set(pub_client, on_connect_output);
+    mosquitto_disconnect_callback_set(pub_client, on_disconnect_output);
+    mosquitto_publish_callback_set(pub_client, on_publish_output);
+    mosquitto_max_inflight_messages_set(pub_client, static_cast<unsigned int>(options.outbound_max_inflight));
+
+    // Enable MQTT logging only if configured
+    if (Config::ENABLE_MQTT_LOGGING) {
+        mosquitto_log_callback_set(pub_client, on_log);
+    }
+
+    // The output client is driven by the reactor instead of a mosquitto loop thread
+    output_link = std::make_unique<MqttLink>(reactor, pub_client, "OUTPUT");
+
+    if (options.enable_cluster_mode && !start_cluster()) {
+        return false;
+    }
+
+    if (!connect_input()) {
+        return false;
+    }
+
+    // Connect OUTPUT client to output broker
+    std::cout << "Connecting to OUTPUT MQTT broker: " << options.output_broker << ":" << options.output_port << std::endl;
+    int pub_conn_result = output_link->connect(options.output_broker, options.output_port, options.keepalive);
+    if (pub_conn_result != MOSQ_ERR_SUCCESS) {
+        std::cerr << "Failed to connect to OUTPUT MQTT broker: " << pub_conn_result << std::endl;
+        return false;
+    }
+
+    reactor.add_periodic(static_cast<uint32_t>(options.queue_metrics_interval_sec) * 1000, [this]() {
+        report_queue_metrics();
+    });
+
+    // Moved or added dongles are picked up without a restart; unchanged pages cost a 304
+    if (options.anchor_refresh_interval_sec > 0 && options.anchor_survey_file.empty() && !options.anchor_list_url.empty()) {
+        refresher = std::make_unique<AnchorRefresher>(processing, http, options.anchor_list_url,
+                                                      options.api_username, options.api_password,
+                                                      options.anchor_list_page_size, options.anchor_list_max_pages,
+                                                      options.anchor_move_tolerance_m);
+        reactor.add_periodic(static_cast<uint32_t>(options.anchor_refresh_interval_sec) * 1000, [this]() {
+            refresher->refresh([this]() {
+                const AnchorRefreshStats& stats = refresher->stats();
+                DEBUG_LOG("Anchor refresh: " << stats.anchors_added << " added, " << stats.anchors_moved
+                          << " moved, " << stats.pages_not_modified << "/" << stats.pages_requested << " pages unchanged");
+            });
+        });
+    }
+
+    // Co-visible anchors are moved next to each other in the background, processing goes on
+    if (options.anchor_compaction_interval_sec > 0) {
+        compactor = std::make_unique<AnchorCompactor>(processing);
+        reactor.add_periodic(static_cast<uint32_t>(options.anchor_compaction_interval_sec) * 1000, [this]() {
+            compactor->compact_async([this]() {
+                AnchorCompactionStats stats = compactor->stats();
+                DEBUG_LOG("Anchor layout: mean co-visible span " << stats.span_before << " -> " << stats.span_after
+                          << " (" << stats.anchors_moved << " anchors moved in total, last pass "
+                          << stats.last_duration_ms << "ms)");
+            });
+        });
+    }
+
+    if (options.enable_position_ring) {
+        start_position_ring();
+    }
+
+    if (options.enable_state_handoff) {
+        start_handoff_server();
+    }
+    return true;
+}
+
+/**
+ * @brief Open the position ring and start draining it; the engine runs without it if it cannot be opened
+ */
+void Runner::start_position_ring() {
+    try {
+        position_ring = std::make_unique<PositionRing>(options.position_ring_name, options.position_ring_capacity,
+                                                       options.position_ring_stall_ms);
+    } catch (const std::exception& e) {
+        std::cerr << "Position ring unavailable, MQTT input only: " << e.what() << std::endl;
+        return;
+    }
+    std::cout << (position_ring->is_creator() ? "Created" : "Attached to") << " position ring "
+              << options.position_ring_name << " (" << position_ring->size() << "/"
+              << position_ring->capacity() << " records waiting)" << std::endl;
+    ring_consumer = std::thread([this]() { consume_positions(); });
+}
+
+/**
+ * @brief Hand every record pushed into the position ring to its worker (ring consumer thread)
+ *
+ * Sleeps on the ring's futex while it is empty, so records are picked up as soon as a
+ * producer pushes them without polling.
+ */
+void Runner::consume_positions() {
+    PositionRecord record;
+    while (!ring_stopping.load(std::memory_order_relaxed)) {
+        if (!position_ring->pop(record)) {
+            position_ring->wait(options.position_ring_wait_ms);
+            continue;
+        }
+        // Same key as the tag's MQTT messages, so both transports keep one order per tag
+        size_t key = std::hash<std::string_view>()(record.tag());
+        TRACE_MESSAGE_RECEIVED(key, sizeof(PositionRecord));
+        dispatch(key, record);
+    }
+}
+
+void Runner::stop_position_ring() {
+    if (!ring_consumer.joinable()) {
+        return;
+    }
+    ring_stopping.store(true);
+    position_ring->wake();
+    ring_consumer.join();
+}
+
+/**
+ * @brief Create the INPUT client, libmosquitto or the built-in subscriber, and connect it
+ */
+bool Runner::connect_input() {
+    std::cout << "Connecting to INPUT MQTT broker: " << options.input_broker << ":" << options.input_port << std::endl;
+
+    if (options.builtin_mqtt_subscriber) {
+        // Payloads are viewed in the receive buffer; the only copy is the one the worker owns
+        input_subscriber = std::make_unique<MqttSubscriber>(reactor, options.input_client_id, "INPUT",
+                                                            [this](std::string_view topic, std::string_view payload) {
+            (void)topic; // Suppress unused parameter warning
+            size_t key = tag_ordering_key(payload);
+            TRACE_MESSAGE_RECEIVED(key, payload.size());
+            dispatch(key, std::string(payload));
+        });
+        if (!input_subscriber->connect(options.input_broker, options.input_port, options.keepalive,
+                                       options.input_topic, options.input_qos)) {
+            std::cerr << "Failed to connect to INPUT MQTT broker" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    sub_client = mosquitto_new(options.input_client_id.c_str(), true, this);
+    if (!sub_client) {
+        std::cerr << "Failed to create INPUT MQTT client" << std::endl;
+        return false;
+    }
+    if (options.enable_cluster_mode) {
+        // Shared subscriptions are an MQTT v5 feature
+        mosquitto_int_option(sub_client, MOSQ_OPT_PROTOCOL_VERSION, MQTT_PROTOCOL_V5);
+    }
+    mosquitto_connect_callback_set(sub_client, on_connect_input);
+    mosquitto_message_callback_set(sub_client, on_message);
+    if (Config::ENABLE_MQTT_LOGGING) {
+        mosquitto_log_callback_set(sub_client, on_log);
+    }
+
+    // Driven by the reactor instead of a mosquitto loop thread
+    input_link = std::make_unique<MqttLink>(reactor, sub_client, "INPUT");
+    int sub_conn_result = input_link->connect(options.input_broker, options.input_port, options.keepalive);
+    if (sub_conn_result != MOSQ_ERR_SUCCESS) {
+        std::cerr << "Failed to connect to INPUT MQTT broker: " << sub_conn_result << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Join the cluster: share the input subscription and start exchanging anchor deltas
+ *
+ * The input topic becomes a shared subscription, so the broker hands each message to one
+ * instance of the group. A third client on the INPUT broker publishes the anchors this
+ * instance changed and merges those of the other instances.
+ */
+bool Runner::start_cluster() {
+    if (options.cluster_instance_id.empty()) {
+        options.cluster_instance_id = default_instance_id();
+    }
+    cluster = std::make_unique<ClusterSync>(processing.anchors, options.cluster_instance_id);
+    options.input_topic = shared_subscription_topic(options.cluster_group, options.input_topic);
+    options.input_client_id += "_" + options.cluster_instance_id;   // Client ids must differ per instance
+    std::cout << "Cluster instance " << options.cluster_instance_id << " in group " << options.cluster_group
+              << ", anchor deltas on " << options.cluster_sync_topic << std::endl;
+
+    std::string sync_client_id = ConfigInput::CLIENT_ID + "_sync_" + options.cluster_instance_id;
+    sync_client = mosquitto_new(sync_client_id.c_str(), true, this);
+    if (!sync_client) {
+        std::cerr << "Failed to create SYNC MQTT client" << std::endl;
+        return false;
+    }
+    mosquitto_int_option(sync_client, MOSQ_OPT_PROTOCOL_VERSION, MQTT_PROTOCOL_V5);
+    mosquitto_connect_callback_set(sync_client, on_connect_sync);
+    mosquitto_message_callback_set(sync_client, on_sync_message);
+    if (Config::ENABLE_MQTT_LOGGING) {
+        mosquitto_log_callback_set(sync_client, on_log);
+    }
+
+    sync_link = std::make_unique<MqttLink>(reactor, sync_client, "SYNC");
+    int sync_result = sync_link->connect(options.input_broker, options.input_port, options.keepalive);
+    if (sync_result != MOSQ_ERR_SUCCESS) {
+        std::cerr << "Failed to connect SYNC client to INPUT MQTT broker: " << sync_result << std::endl;
+        return false;
+    }
+
+    reactor.add_periodic(options.cluster_sync_interval_ms, [this]() { publish_anchor_deltas(); });
+    return true;
+}
+
+/**
+ * @brief Publish the anchors not sent yet to the other instances
+ *
+ * QoS 1, and only deltas libmosquitto accepted count as sent: the rest, e.g. while
+ * SYNC is disconnected, go out with the next call.
+ */
+void Runner::publish_anchor_deltas() {
+    for (const std::string& message : cluster->collect()) {
+        int result = mosquitto_publish(sync_client, nullptr, options.cluster_sync_topic.c_str(),
+                                       static_cast<int>(message.size()), message.data(), 1, false);
+        if (result == MOSQ_ERR_SUCCESS) {
+            cluster->confirm(message);
+        } else if (result != MOSQ_ERR_NO_CONN) {
+            std::cerr << "Failed to publish anchor deltas: " << mosquitto_strerror(result) << std::endl;
+        }
+    }
+    sync_link->update_interest();
+}
+
+/**
+ * @brief Ask the engine running on this host for its state (new side of a hot upgrade)
+ *
+ * The old engine stops consuming, drains its in-flight messages and sends a state
+ * snapshot: every anchor with its calibration, health and Kalman filter. The engine
+ * keeps no per-tag state between messages, so the anchors are the whole state.
+ *
+ * @return bool true if anchors were taken over; false for a cold start
+ */
+bool Runner::take_over_state() {
+    auto start_time = std::chrono::steady_clock::now();
+    try {
+        std::optional<std::string> snapshot = request_handoff(options.handoff_socket_path, options.handoff_timeout_ms);
+        if (!snapshot) {
+            return false;
+        }
+        StateSnapshotImport imported = import_state_snapshot(processing.anchors, snapshot->data(), snapshot->size());
+        if (processing.anchors.size() > 0) {
+            processing.anchors_initialized = true;
+        }
+        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+        std::cout << "Took over " << imported.added << " calibrated anchors from the running engine in "
+                  << elapsed_ms << "ms" << std::endl;
+        return imported.added > 0;
+    } catch (const std::exception& e) {
+        std::cerr << "State handoff failed, starting cold: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+/**
+ * @brief Listen for the next upgrade; the engine runs without handoff if the socket cannot be bound
+ */
+void Runner::start_handoff_server() {
+    try {
+        handoff_server = std::make_unique<HandoffServer>(reactor, options.handoff_socket_path, [this]() { hand_off_state(); });
+        std::cout << "Accepting state handoff on " << options.handoff_socket_path << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "State handoff unavailable: " << e.what() << std::endl;
+    }
+}
+
+/**
+ * @brief Hand the engine over to a new runner (old side of a hot upgrade, reactor thread)
+ *
+ * Stops consuming and continues in continue_handoff() on every reactor tick. Records
+ * left in the position ring are consumed by the new runner.
+ */
+void Runner::hand_off_state() {
+    std::cout << "New runner requested the state: stopping input and draining..." << std::endl;
+    handoff_started = std::chrono::steady_clock::now();
+    // Clean disconnects: the reactor sends the DISCONNECT packets, and the links do not reconnect
+    if (input_subscriber) {
+        input_subscriber->disconnect();
+    } else if (input_link) {
+        input_link->disconnect();
+    }
+    stop_position_ring();
+    handoff_timer = reactor.add_periodic(Config::REACTOR_TICK_MS, [this]() { continue_handoff(); });
+}
+
+/**
+ * @brief One step of a handoff: finish the messages, then the outbound queue, then send the state
+ *
+ * In-flight messages finish first, so their anchor updates are part of the snapshot.
+ * The outbound queue is then published (up to the shutdown drain time) and its rest
+ * flushed to the spill directory, and OUTPUT disconnects: the new runner only creates
+ * its queue and connects, with the same client ids, once it has the snapshot. Sending
+ * it stops the reactor, and run() shuts down as usual; if the new runner went away
+ * instead, this runner resumes (resume_after_handoff()).
+ */
+void Runner::continue_handoff() {
+    if (messages_in_progress()) {
+        return;
+    }
+
+    if (!outbound_handed_off) {
+        auto deadline = handoff_started + std::chrono::milliseconds(options.outbound_shutdown_drain_ms);
+        if (outbound->is_connected() && std::chrono::steady_clock::now() < deadline && !outbound_drained()) {
+            return;
+        }
+        size_t spilled = outbound->flush_to_disk();
+        output_link->disconnect();
+        outbound_handed_off = true;
+        if (spilled > 0) {
+            std::cout << "Left " << spilled << " unacknowledged estimates in " << options.spill_dir << " for the new runner" << std::endl;
+        }
+        return;   // The DISCONNECT goes out before the new runner connects
+    }
+
+    reactor.cancel_timer(handoff_timer);
+    std::string snapshot = export_state_snapshot(processing.anchors);
+    bool sent = handoff_server->send(snapshot);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - handoff_started).count();
+    if (!sent) {
+        std::cerr << "New runner went away before the state handoff, resuming" << std::endl;
+        resume_after_handoff();
+        return;
+    }
+    std::cout << "Handed " << processing.anchors.size() << " anchors (" << snapshot.size() << " bytes) over in "
+              << elapsed_ms << "ms, exiting" << std::endl;
+    input_link.reset();
+    reactor.stop();
+}
+
+/**
+ * @brief Undo hand_off_state() after a failed handoff: reconnect, consume again and listen for the next one
+ *
+ * The estimates flushed to the spill directory are published from there once OUTPUT is
+ * back. Exits as a completed handoff would if a client cannot even start connecting.
+ */
+void Runner::resume_after_handoff() {
+    outbound_handed_off = false;
+    int pub_conn_result = output_link->connect(options.output_broker, options.output_port, options.keepalive);
+    bool input_connecting = input_subscriber
+        ? input_subscriber->connect(options.input_broker, options.input_port, options.keepalive,
+                                    options.input_topic, options.input_qos)
+        : input_link->connect(options.input_broker, options.input_port, options.keepalive) == MOSQ_ERR_SUCCESS;
+    if (pub_conn_result != MOSQ_ERR_SUCCESS || !input_connecting) {
+        std::cerr << "Failed to reconnect after the state handoff, exiting" << std::endl;
+        reactor.stop();
+        return;
+    }
+
+    if (options.enable_position_ring) {
+        ring_stopping.store(false);
+        start_position_ring();
+    }
+    handoff_server.reset();
+    start_handoff_server();
+}
+
+/**
+ * @brief Load every anchor of the site from the anchor source, before the reactor runs
+ *
+ * Anchors missed by a failed load are looked up one by one as messages mention them.
+ */
+void Runner::load_anchors() {
+    std::cout << "Loading site anchors from: " << anchor_source->name() << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+
+    SiteLoadResult loaded = anchor_source->load(processing);
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "Loaded " << loaded.anchors_added << " anchors (" << loaded.entries << " dongles, "
+              << loaded.pages << " pages) in " << elapsed_ms << "ms" << std::endl;
+    if (!loaded.complete) {
+        std::cerr << "Bulk anchor load incomplete, falling back to per-anchor lookups: " << loaded.error << std::endl;
+    }
+}
+
+/**
+ * @brief Start a message now, or queue it behind the message of the same tag still in progress
+ *
+ * Called on the reactor thread for MQTT messages and on the ring consumer thread for
+ * position records.
+ */
+void Runner::dispatch(size_t key, InboundMessage message) {
+    {
+        std::lock_guard<std::mutex> lock(strands_mutex);
+        auto it = strands.find(key);
+        if (it != strands.end()) {
+            it->second.push_back(std::move(message));
+            return;
+        }
+        strands[key];
+    }
+    workers->submit(key, [this, key, message = std::move(message)]() mutable {
+        handle_message(key, std::move(message));
+    });
+}
+
+/**
+ * @brief Run one message's coroutine on its worker until it finishes or suspends
+ */
+void Runner::handle_message(size_t key, InboundMessage message) {
+    spawn(process_message(key, std::move(message)), [this, key](std::exception_ptr) { finish_message(key); });
+}
+
+/**
+ * @brief Process one message and post its result to the reactor
+ *
+ * Suspends while unknown anchors are fetched and resumes on the worker owning the tag.
+ */
+Task<void> Runner::process_message(size_t key, InboundMessage message) {
+    // Start timing for performance measurement (includes time spent waiting for anchors)
+    auto perf_start = std::chrono::high_resolution_clock::now();
+    Executor resume_on = [this, key](std::function<void()> resume) { workers->submit(key, std::move(resume)); };
+
+    try {
+        std::optional<json> output_msg;
+        if (const PositionRecord* record = std::get_if<PositionRecord>(&message)) {
+            output_msg = co_await process_position_record_async(processing, resolver, *record, resume_on);
+        } else {
+            output_msg = co_await process_tag_message_async(processing, resolver, std::get<std::string>(std::move(message)), resume_on);
+        }
+        if (output_msg) {
+            std::string tag_mac = (*output_msg)["tag_mac"].get<std::string>();
+            reactor.post([this, output = output_msg->dump()]() mutable { deliver(std::move(output)); });
+            std::cout << "Queued result for tag: " << tag_mac
+                      << " with error estimate: " << (*output_msg)["error_estimate"].get<float>() << std::endl;
+        }
+    } catch (const json::parse_error& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing message: " << e.what() << std::endl;
+    }
+
+    // End timing and print performance info
+    auto perf_end = std::chrono::high_resolution_clock::now();
+    auto perf_us = std::chrono::duration_cast<std::chrono::microseconds>(perf_end - perf_start).count();
+    TRACE_MESSAGE_DONE(key, perf_us);
+    if (Config::ENABLE_PERFORMANCE_LOGGING) {
+        if (perf_us > 2000) {
+            std::cerr << "[PERF WARNING] Processing took " << perf_us << "us (>2ms)" << std::endl;
+        } else {
+            std::cout << "[PERF] Processing took " << perf_us << "us" << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Start the next queued message of a tag, or mark the tag idle
+ */
+void Runner::finish_message(size_t key) {
+    InboundMessage next;
+    {
+        std::lock_guard<std::mutex> lock(strands_mutex);
+        auto it = strands.find(key);
+        if (it == strands.end()) {
+            return;
+        }
+        if (it->second.empty()) {
+            strands.erase(it);
+            return;
+        }
+        next = std::move(it->second.front());
+        it->second.pop_front();
+    }
+    // Through the worker's queue rather than inline, so a long backlog does not nest calls
+    workers->submit(key, [this, key, next = std::move(next)]() mutable {
+        handle_message(key, std::move(next));
+    });
+}
+
+bool Runner::messages_in_progress() {
+    std::lock_guard<std::mutex> lock(strands_mutex);
+    return !strands.empty();
+}
+
+/**
+ * @brief Queue a result for the OUTPUT client and publish as much as the broker allows (reactor thread)
+ */
+void Runner::deliver(std::string payload) {
+    outbound->push(OutboundMessage{options.output_topic, std::move(payload)});
+    size_t published = outbound->drain([this](const OutboundMessage& message) { return publish_outbound(message); });
+    output_link->update_interest();
+    DEBUG_LOG("Published " << published << " queued messages to topic: " << options.output_topic);
+}
+
+/**
+ * @brief Hand one queued message to the output client
+ * @return std::optional<int> Message id on_publish_output() reports it with, std::nullopt if libmosquitto refused it
+ */
+std::optional<int> Runner::publish_outbound(const OutboundMessage& message) {
+    int mid = 0;
+    int pub_result = mosquitto_publish(pub_client, &mid, message.topic.c_str(),
+                                       static_cast<int>(message.payload.length()), message.payload.c_str(),
+                                       options.outbound_qos, false);
+    if (pub_result != MOSQ_ERR_SUCCESS) {
+        std::cerr << "Failed to publish message: " << pub_result << std::endl;
+        return std::nullopt;
+    }
+    TRACE_MESSAGE_PUBLISHED(message.payload.length(), message.topic.c_str());
+    return mid;
+}
+
+/**
+ * @brief Publish what the output client can take
+ * @return bool true once every queued estimate is published and acknowledged
+ */
+bool Runner::outbound_drained() {
+    outbound->drain([this](const OutboundMessage& message) { return publish_outbound(message); });
+    output_link->update_interest();
+    OutboundQueueStats stats = outbound->stats();
+    return stats.memory_messages == 0 && stats.disk_messages == 0 && stats.inflight == 0;
+}
+
+/**
+ * @brief Publish what is still queued before disconnecting OUTPUT (shutdown)
+ *
+ * Keeps the reactor serving the output client until every message is acknowledged
+ * or the drain deadline passes; unacknowledged messages and those still in memory
+ * then go to the front of the spill log, so the next process delivers them first.
+ */
+void Runner::flush_outbound() {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.outbound_shutdown_drain_ms);
+    while (outbound->is_connected() && std::chrono::steady_clock::now() < deadline && !outbound_drained()) {
+        reactor.run_once(10);
+    }
+
+    OutboundQueueStats stats = outbound->stats();
+    size_t spilled = outbound->flush_to_disk();
+    if (spilled > 0 || stats.disk_messages > 0) {
+        std::cout << "Kept " << stats.disk_messages + spilled << " unacknowledged estimates in " << options.spill_dir
+                  << " for the next run (" << stats.inflight << " already published)" << std::endl;
+    }
+}
+
+/**
+ * @brief Publish outbound queue spill/drain rates and depths (reactor timer)
+ *
+ * Rates are computed from the difference between two counter snapshots. Metrics are
+ * logged and, while the output broker is connected, published on the metrics topic.
+ */
+void Runner::report_queue_metrics() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_sec = std::chrono::duration<double>(now - last_report).count();
+
+    OutboundQueueStats stats = outbound->stats();
+    json metrics = {
+        {"spill_rate", (stats.spilled - last_stats.spilled) / elapsed_sec},
+        {"drain_rate", (stats.drained_from_disk - last_stats.drained_from_disk) / elapsed_sec},
+        {"publish_rate", (stats.published - last_stats.published) / elapsed_sec},
+        {"spilled_total", stats.spilled},
+        {"drained_total", stats.drained_from_disk},
+        {"publish_failures_total", stats.publish_failures},
+        {"spill_errors_total", stats.spill_errors},
+        {"memory_depth", stats.memory_messages},
+        {"disk_depth", stats.disk_messages},
+        {"disk_segments", stats.disk_segments},
+        {"inflight", stats.inflight}
+    };
+    last_stats = stats;
+    last_report = now;
+
+    std::cout << "[QUEUE] " << metrics.dump() << std::endl;
+    if (outbound->is_connected()) {
+        std::string metrics_str = metrics.dump();
+        mosquitto_publish(pub_client, nullptr, options.metrics_topic.c_str(),
+                          static_cast<int>(metrics_str.length()), metrics_str.c_str(), 0, false);
+        output_link->update_interest();
+    }
+}
+
+/*CALLBACKS*/
+/**
+ * @brief MQTT connection callback for input client
+ */
+void Runner::on_connect_input(struct mosquitto* mosq, void* userdata, int result) {
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::cout << "Connected to INPUT MQTT broker with result: " << result << std::endl;
+
+    if (result == 0) {
+        // Subscribe to tag position stream using input config
+        int sub_result = mosquitto_subscribe(mosq, nullptr, runner->options.input_topic.c_str(), runner->options.input_qos);
+        if (sub_result == MOSQ_ERR_SUCCESS) {
+            std::cout << "Successfully subscribed to: " << runner->options.input_topic << std::endl;
+        } else {
+            std::cerr << "Failed to subscribe to topic: " << sub_result << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief MQTT message callback - hands the message to the worker owning its tag
+ */
+void Runner::on_message(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* message) {
+    (void)mosq; // Suppress unused parameter warning
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::string_view payload(static_cast<const char*>(message->payload), static_cast<size_t>(message->payloadlen));
+    size_t key = tag_ordering_key(payload);
+    TRACE_MESSAGE_RECEIVED(key, payload.size());
+    runner->dispatch(key, std::string(payload));
+}
+
+/**
+ * @brief MQTT connection callback for the cluster sync client
+ */
+void Runner::on_connect_sync(struct mosquitto* mosq, void* userdata, int result) {
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::cout << "Connected SYNC client with result: " << result << std::endl;
+
+    if (result == 0) {
+        // No-local: the broker does not send our own deltas back
+        int sub_result = mosquitto_subscribe_v5(mosq, nullptr, runner->options.cluster_sync_topic.c_str(), 1,
+                                                MQTT_SUB_OPT_NO_LOCAL, nullptr);
+        if (sub_result != MOSQ_ERR_SUCCESS) {
+            std::cerr << "Failed to subscribe to anchor deltas: " << sub_result << std::endl;
+        }
+        // Full state on every connection: peers that are ahead answer with theirs, so joiners catch up
+        runner->cluster->resync();
+        runner->publish_anchor_deltas();
+    }
+}
+
+/**
+ * @brief MQTT message callback for the cluster sync client - merges another instance's anchor deltas
+ */
+void Runner::on_sync_message(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* message) {
+    (void)mosq; // Suppress unused parameter warning
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::string_view payload(static_cast<const char*>(message->payload), static_cast<size_t>(message->payloadlen));
+    size_t adopted = runner->cluster->apply(payload);
+    if (adopted > 0) {
+        DEBUG_LOG("Adopted " << adopted << " anchor states from the cluster");
+    }
+}
+
+/**
+ * @brief MQTT connection callback for output client
+ */
+void Runner::on_connect_output(struct mosquitto* mosq, void* userdata, int result) {
+    (void)mosq; // Suppress unused parameter warning
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::cout << "Connected to OUTPUT MQTT broker with result: " << result << std::endl;
+
+    if (result == 0) {
+        // Connectivity is back: flush everything buffered during the outage
+        runner->outbound->set_connected(true);
+        runner->outbound->drain([runner](const OutboundMessage& message) { return runner->publish_outbound(message); });
+    }
+}
+
+/**
+ * @brief MQTT disconnection callback for output client
+ */
+void Runner::on_disconnect_output(struct mosquitto* mosq, void* userdata, int result) {
+    (void)mosq; // Suppress unused parameter warning
+    Runner* runner = static_cast<Runner*>(userdata);
+    std::cerr << "Disconnected from OUTPUT MQTT broker with result: " << result << ", spilling results" << std::endl;
+    runner->outbound->set_connected(false);
+}
+
+/**
+ * @brief MQTT publish callback for output client, called once a message is acknowledged
+ */
+void Runner::on_publish_output(struct mosquitto* mosq, void* userdata, int mid) {
+    (void)mosq; // Suppress unused parameter warning
+    Runner* runner = static_cast<Runner*>(userdata);
+    // Each acknowledgement frees an in-flight slot, keep draining at full speed
+    runner->outbound->on_published(mid);
+    runner->outbound->drain([runner](const OutboundMessage& message) { return runner->publish_outbound(message); });
+}
+
+/**
+ * @brief MQTT logging callback
+ */
+void Runner::on_log(struct mosquitto* mosq, void* userdata, int level, const char* str) {
+    (void)mosq; // Suppress unused parameter warning
+    (void)userdata; // Suppress unused parameter warning
+    std::cout << "MQTT Log [" << level << "]: " << str << std::endl;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+
+#include <mosquitto.h>
+
+#include "config.h"
+#include "processing.h"
+#include "pipeline.h"
+#include "anchor_loader.h"
+#include "anchor_source.h"
+#include "anchor_refresher.h"
+#include "anchor_compactor.h"
+#include "reactor.h"
+#include "http_client.h"
+#include "mqtt_link.h"
+#include "mqtt_subscriber.h"
+#include "position_ring.h"
+#include "cluster_sync.h"
+#include "state_handoff.h"
+#include "worker_pool.h"
+#include "outbound_queue.h"
+#include "shm_anchor_store.h"
+
+/**
+ * @brief Settings of one engine instance; defaults come from config.h
+ */
+struct RunnerOptions {
+    // Input broker (tag positions)
+    std::string input_broker = ConfigInput::BROKER;
+    int input_port = ConfigInput::PORT;
+    std::string input_topic = ConfigInput::TOPIC;
+    std::string input_client_id = ConfigInput::CLIENT_ID;
+    int input_qos = Config::INPUT_QOS;
+    bool builtin_mqtt_subscriber = Config::ENABLE_BUILTIN_MQTT_SUBSCRIBER;   // Zero-copy subscriber instead of libmosquitto
+
+    // Output broker (error estimates)
+    std::string output_broker = ConfigOutput::BROKER;
+    int output_port = ConfigOutput::PORT;
+    std::string output_topic = ConfigOutput::TOPIC;
+    std::string metrics_topic = ConfigOutput::METRICS_TOPIC;
+    std::string output_client_id = ConfigOutput::CLIENT_ID;
+    int keepalive = Config::MQTT_KEEPALIVE;
+
+    // Anchor configuration API
+    std::string anchor_api_url = ConfigInput::ANCHOR_INIT_BASE;
+    std::string api_username = ConfigInput::API_USERNAME;
+    std::string api_password = ConfigInput::API_PASSWORD;
+    std::string anchor_survey_file = ConfigInput::ANCHOR_SURVEY_FILE;   // Replaces the API when set
+    bool enable_bulk_anchor_load = Config::ENABLE_BULK_ANCHOR_LOAD;
+    std::string anchor_list_url = ConfigInput::ANCHOR_LIST_URL;
+    size_t anchor_list_page_size = Config::ANCHOR_LIST_PAGE_SIZE;
+    size_t anchor_list_max_pages = Config::ANCHOR_LIST_MAX_PAGES;
+    int anchor_refresh_interval_sec = Config::ANCHOR_REFRESH_INTERVAL_SEC;
+    float anchor_move_tolerance_m = Config::ANCHOR_MOVE_TOLERANCE_M;
+
+    // Processing
+    size_t worker_threads = Config::WORKER_THREADS;
+    std::string numeric_isa = Config::NUMERIC_ISA;
+    int anchor_compaction_interval_sec = Config::ANCHOR_COMPACTION_INTERVAL_SEC;
+
+    // Outbound spill queue
+    std::string spill_dir = Config::SPILL_DIR;
+    size_t outbound_memory_capacity = Config::OUTBOUND_MEMORY_CAPACITY;
+    size_t spill_segment_bytes = Config::SPILL_SEGMENT_BYTES;
+    size_t outbound_max_inflight = Config::OUTBOUND_MAX_INFLIGHT;
+    int outbound_qos = Config::OUTBOUND_QOS;
+    int outbound_shutdown_drain_ms = Config::OUTBOUND_SHUTDOWN_DRAIN_MS;
+    int queue_metrics_interval_sec = Config::QUEUE_METRICS_INTERVAL_SEC;
+
+    // Shared-memory anchor store
+    bool enable_shm_anchor_store = Config::ENABLE_SHM_ANCHOR_STORE;
+    std::string shm_anchor_store_name = Config::SHM_ANCHOR_STORE_NAME;
+    uint32_t shm_anchor_capacity = Config::SHM_ANCHOR_CAPACITY;
+
+    // Shared-memory position ring (in addition to the INPUT broker)
+    bool enable_position_ring = Config::ENABLE_POSITION_RING;
+    std::string position_ring_name = Config::POSITION_RING_NAME;
+    uint32_t position_ring_capacity = Config::POSITION_RING_CAPACITY;
+    int position_ring_wait_ms = Config::POSITION_RING_WAIT_MS;
+    int position_ring_stall_ms = Config::POSITION_RING_STALL_MS;
+
+    // Clustered mode: shared input subscription and anchor delta sync between instances
+    bool enable_cluster_mode = Config::ENABLE_CLUSTER_MODE;
+    std::string cluster_group = Config::CLUSTER_GROUP;
+    std::string cluster_instance_id = Config::CLUSTER_INSTANCE_ID;
+    std::string cluster_sync_topic = Config::CLUSTER_SYNC_TOPIC;
+    uint32_t cluster_sync_interval_ms = Config::CLUSTER_SYNC_INTERVAL_MS;
+
+    // Hot upgrade: take the state over from the running engine, and hand it to the next one
+    bool enable_state_handoff = Config::ENABLE_STATE_HANDOFF;
+    std::string handoff_socket_path = Config::HANDOFF_SOCKET_PATH;
+    int handoff_timeout_ms = Config::HANDOFF_TIMEOUT_MS;
+};
+
+/**
+ * @brief A tag position waiting for its worker: raw JSON from MQTT or a record from the position ring
+ */
+using InboundMessage = std::variant<std::string, PositionRecord>;
+
+/**
+ * @brief One engine: both MQTT clients, anchor HTTP requests and timers on a single
+ * reactor thread, message processing on a worker pool
+ *
+ * The reactor never blocks: it reads messages, hands them to the workers (messages of
+ * one tag always go to the same worker, in order) and publishes the results the
+ * workers post back. Messages are coroutines: one that needs an unknown anchor
+ * suspends until its HTTP request completes, and its worker moves on to other tags.
+ * Later messages of the same tag queue behind the suspended one. The site's anchors
+ * are loaded in bulk before subscribing, so per-anchor requests are only a fallback,
+ * and revalidated periodically so moved dongles are picked up without a restart. With
+ * a site-survey file the anchors come from disk instead and no anchor API is used.
+ * Positioning engines on the same host can also push binary records through a
+ * shared-memory PositionRing, drained by a thread of its own into the same workers.
+ * In clustered mode several instances split the input stream through a shared
+ * subscription and exchange anchor calibration deltas over a sync topic (ClusterSync).
+ * With state handoff a new runner takes the calibrated anchors over from the running
+ * one through a Unix socket instead of loading them again (HandoffServer).
+ *
+ * mosquitto_lib_init and curl_global_init must be called before constructing a Runner.
+ */
+class Runner {
+    public:
+        /**
+         * @brief Set up the engine; nothing connects until run()
+         */
+        explicit Runner(RunnerOptions runner_options = RunnerOptions());
+
+        /**
+         * @brief Destroy both MQTT clients
+         */
+        ~Runner();
+
+        Runner(const Runner&) = delete;
+        Runner& operator=(const Runner&) = delete;
+
+        /**
+         * @brief Connect both clients and run the reactor on the calling thread until stop()
+         * @return int 0 on clean shutdown, 1 if startup failed
+         */
+        int run();
+
+        /**
+         * @brief Ask run() to finish in-flight messages and return (thread-safe)
+         */
+        void stop();
+
+        /**
+         * @brief Gets the processing state (anchors, model)
+         */
+        ProcessingContext& context();
+
+    private:
+        RunnerOptions options;
+        ProcessingContext processing;
+        Reactor reactor;
+        HttpClient http;
+        std::unique_ptr<AnchorSource> anchor_source;
+        AnchorResolver resolver;
+        std::unique_ptr<WorkerPool> workers;
+        std::unique_ptr<OutboundQueue> outbound;
+        std::unique_ptr<ShmAnchorStore> anchor_store;
+        std::unique_ptr<AnchorRefresher> refresher;
+        std::unique_ptr<AnchorCompactor> compactor;
+
+        struct mosquitto* sub_client = nullptr;
+        struct mosquitto* pub_client = nullptr;
+        std::unique_ptr<MqttLink> input_link;
+        std::unique_ptr<MqttSubscriber> input_subscriber;   // Replaces sub_client and input_link when enabled
+        std::unique_ptr<MqttLink> output_link;
+
+        std::mutex strands_mutex;
+        std::unordered_map<size_t, std::deque<InboundMessage>> strands;   // Tags with a message in progress, and the messages queued behind it
+
+        std::unique_ptr<ClusterSync> cluster;
+        struct mosquitto* sync_client = nullptr;
+        std::unique_ptr<MqttLink> sync_link;
+
+        std::unique_ptr<HandoffServer> handoff_server;
+        Reactor::TimerId handoff_timer = 0;
+        std::chrono::steady_clock::time_point handoff_started;
+        bool outbound_handed_off = false;
+
+        std::unique_ptr<PositionRing> position_ring;
+        std::thread ring_consumer;
+        std::atomic<bool> ring_stopping{false};
+
+        OutboundQueueStats last_stats;
+        std::chrono::steady_clock::time_point last_report;
+
+        bool start();
+        bool connect_input();
+        bool start_cluster();
+        void publish_anchor_deltas();
+        bool take_over_state();
+        void start_handoff_server();
+        void hand_off_state();
+        void continue_handoff();
+        void resume_after_handoff();
+        void load_anchors();
+        void start_position_ring();
+        void consume_positions();
+        void stop_position_ring();
+        void dispatch(size_t key, InboundMessage message);
+        void handle_message(size_t key, InboundMessage message);
+        Task<void> process_message(size_t key, InboundMessage message);
+        void finish_message(size_t key);
+        bool messages_in_progress();
+        void deliver(std::string payload);
+        std::optional<int> publish_outbound(const OutboundMessage& message);
+        bool outbound_drained();
+        void flush_outbound();
+        void report_queue_metrics();
+
+        static void on_connect_input(struct mosquitto* mosq, void* userdata, int result);
+        static void on_message(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* message);
+        static void on_connect_sync(struct mosquitto* mosq, void* userdata, int result);
+        static void on_sync_message(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* message);
+        static void on_connect_output(struct mosquitto* mosq, void* userdata, int result);
+        static void on_disconnect_output(struct mosquitto* mosq, void* userdata, int result);
+        static void on_publish_output(struct mosquitto* mosq, void* userdata, int mid);
+        static void on_log(struct mosquitto* mosq, void* userdata, int level, const char* str);
+};
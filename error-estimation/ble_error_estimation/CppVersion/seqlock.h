@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Sequence lock primitives over a single 32-bit counter
+ *
+ * The counter is even while the protected data is stable and odd while a writer
+ * is modifying it. Readers never block writers: they copy the data and retry if
+ * the counter changed or was odd. Writers take the lock with a CAS, so writers to
+ * the same data serialize while writers to different data never contend.
+ *
+ * Protected fields must themselves be atomics accessed with relaxed ordering, so
+ * that torn reads are detected by the sequence check rather than being undefined
+ * behaviour. The counter may live in shared memory (it is always lock-free).
+ *
+ * Typical reader:
+ *     uint32_t start;
+ *     do {
+ *         start = seqlock_read_begin(seq);
+ *         ... relaxed loads ...
+ *     } while (seqlock_read_retry(seq, start));
+ */
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock counter must be lock-free");
+
+inline void seqlock_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Acquire the write side, spinning while another writer holds it
+ * @param seq Sequence counter of the protected data
+ */
+inline void seqlock_write_lock(std::atomic<uint32_t>& seq) {
+    uint32_t current = seq.load(std::memory_order_relaxed);
+    while (true) {
+        if ((current & 1u) == 0 &&
+            seq.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+        seqlock_cpu_relax();
+        current = seq.load(std::memory_order_relaxed);
+    }
+    // Order the odd counter before the data stores that follow
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**
+ * @brief Release the write side, publishing the new data to readers
+ * @param seq Sequence counter of the protected data
+ */
+inline void seqlock_write_unlock(std::atomic<uint32_t>& seq) {
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Start a read, waiting for any writer in progress to finish
+ * @param seq Sequence counter of the protected data
+ * @return uint32_t Even counter value to pass to seqlock_read_retry()
+ */
+inline uint32_t seqlock_read_begin(const std::atomic<uint32_t>& seq) {
+    uint32_t start = seq.load(std::memory_order_acquire);
+    while (start & 1u) {
+        seqlock_cpu_relax();
+        start = seq.load(std::memory_order_acquire);
+    }
+    return start;
+}
+
+/**
+ * @brief Finish a read
+ * @param seq Sequence counter of the protected data
+ * @param start Value returned by seqlock_read_begin()
+ * @return bool true if a writer intervened and the copied data must be discarded
+ */
+inline bool seqlock_read_retry(const std::atomic<uint32_t>& seq, uint32_t start) {
+    // Order the relaxed data loads before re-reading the counter
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq.load(std::memory_order_relaxed) != start;
+}
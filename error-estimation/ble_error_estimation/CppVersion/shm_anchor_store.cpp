@@ -0,0 +1,329 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shm_anchor_store.h"
+#include "seqlock.h"
+
+static_assert(std::atomic<float>::is_always_lock_free, "shared-memory floats must be lock-free");
+
+struct ShmAnchorStore::Header {
+    std::atomic<uint32_t> magic;      // Set last by the creator once the layout is initialized
+    uint32_t layout_version;
+    uint32_t capacity;
+    uint32_t index_size;              // Power of two, at least 2 * capacity
+    std::atomic<uint32_t> count;      // Number of used slots
+    pthread_mutex_t insert_mutex;     // Robust, process-shared
+};
+
+namespace {
+    constexpr size_t ALIGNMENT = 64;
+    constexpr int ATTACH_TIMEOUT_MS = 5000;
+
+    size_t align_up(size_t value) {
+        return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    uint32_t index_size_for(uint32_t capacity) {
+        uint32_t size = 1;
+        while (size < 2 * capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // FNV-1a over the MAC characters
+    uint32_t hash_mac(const std::string& mac) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : mac) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    std::runtime_error shm_error(const std::string& what, const std::string& name) {
+        return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+    }
+}
+
+/*SHMANCHORSTORE*/
+//constructor:
+ShmAnchorStore::ShmAnchorStore(const std::string& shm_name, uint32_t requested_capacity) : name(shm_name) {
+    if (requested_capacity == 0) {
+        throw std::runtime_error("Shared anchor store capacity must be positive");
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (fd >= 0) {
+        created = true;
+        uint32_t index_size = index_size_for(requested_capacity);
+        mapped_bytes = layout_bytes(requested_capacity, index_size);
+        if (ftruncate(fd, static_cast<off_t>(mapped_bytes)) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            throw shm_error("Failed to size shared anchor store", name);
+        }
+        base = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw shm_error("Failed to map shared anchor store", name);
+        }
+
+        // ftruncate zero-fills: all counters, versions and index entries start at 0
+        header = static_cast<Header*>(base);
+        header->layout_version = LAYOUT_VERSION;
+        header->capacity = requested_capacity;
+        header->index_size = index_size;
+        header->count.store(0, std::memory_order_relaxed);
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->insert_mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        bind_layout(requested_capacity, index_size);
+        header->magic.store(MAGIC, std::memory_order_release);
+        return;
+    }
+
+    if (errno != EEXIST) {
+        throw shm_error("Failed to create shared anchor store", name);
+    }
+
+    // Attach: wait for the creator to size the segment and publish the header
+    fd = shm_open(name.c_str(), O_RDWR, 0660);
+    if (fd < 0) {
+        throw shm_error("Failed to open shared anchor store", name);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ATTACH_TIMEOUT_MS);
+    struct stat st {};
+    while (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            close(fd);
+            throw std::runtime_error("Timed out waiting for shared anchor store " + name + " to be created");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    mapped_bytes = static_cast<size_t>(st.st_size);
+    base = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw shm_error("Failed to map shared anchor store", name);
+    }
+
+    header = static_cast<Header*>(base);
+    while (header->magic.load(std::memory_order_acquire) != MAGIC) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            munmap(base, mapped_bytes);
+            throw std::runtime_error("Shared anchor store " + name + " was never initialized");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (header->layout_version != LAYOUT_VERSION ||
+        mapped_bytes < layout_bytes(header->capacity, header->index_size)) {
+        munmap(base, mapped_bytes);
+        throw std::runtime_error("Shared anchor store " + name + " has an incompatible layout");
+    }
+
+    bind_layout(header->capacity, header->index_size);
+}
+
+ShmAnchorStore::~ShmAnchorStore() {
+    if (base != nullptr && base != MAP_FAILED) {
+        munmap(base, mapped_bytes);
+    }
+}
+
+void ShmAnchorStore::unlink(const std::string& shm_name) {
+    shm_unlink(shm_name.c_str());
+}
+
+//methods:
+int32_t ShmAnchorStore::find(const std::string& mac) const {
+    uint32_t empty_position = 0;
+    return probe(mac, empty_position);
+}
+
+int32_t ShmAnchorStore::find_or_insert(const std::string& mac) {
+    if (mac.size() >= MAC_BYTES) {
+        return -1;
+    }
+
+    int32_t slot = find(mac);
+    if (slot >= 0) {
+        return slot;
+    }
+
+    int lock_result = pthread_mutex_lock(&header->insert_mutex);
+    if (lock_result == EOWNERDEAD) {
+        // The previous owner died mid-insert: finish its insert before making the mutex usable again
+        repair_last_insert();
+        pthread_mutex_consistent(&header->insert_mutex);
+    } else if (lock_result != 0) {
+        return -1;
+    }
+
+    uint32_t empty_position = 0;
+    slot = probe(mac, empty_position);
+    if (slot < 0) {
+        uint32_t count = header->count.load(std::memory_order_relaxed);
+        if (count < header->capacity) {
+            slot = static_cast<int32_t>(count);
+            std::memset(macs + slot * MAC_BYTES, 0, MAC_BYTES);
+            std::memcpy(macs + slot * MAC_BYTES, mac.data(), mac.size());
+            // MAC, then count, then the index entry that makes the slot findable: a slot
+            // found through the index is always below count, and an owner dying before
+            // the count store leaves the slot free for the next insert
+            header->count.store(count + 1, std::memory_order_release);
+            index[empty_position].store(static_cast<uint32_t>(slot) + 1, std::memory_order_release);
+        }
+    }
+
+    pthread_mutex_unlock(&header->insert_mutex);
+    return slot;
+}
+
+bool ShmAnchorStore::read(uint32_t slot, ShmAnchorState& out) const {
+    if (slot >= header->count.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    uint32_t start;
+    do {
+        start = seqlock_read_begin(seq[slot]);
+        out.x = xs[slot].load(std::memory_order_relaxed);
+        out.y = ys[slot].load(std::memory_order_relaxed);
+        out.z = zs[slot].load(std::memory_order_relaxed);
+        out.RSSI_0 = rssi0s[slot].load(std::memory_order_relaxed);
+        out.n = ns[slot].load(std::memory_order_relaxed);
+        out.ewma = ewmas[slot].load(std::memory_order_relaxed);
+        out.last_seen = last_seens[slot].load(std::memory_order_relaxed);
+        out.version = versions[slot].load(std::memory_order_relaxed);
+    } while (seqlock_read_retry(seq[slot], start));
+
+    return true;
+}
+
+uint32_t ShmAnchorStore::write(uint32_t slot, const ShmAnchorState& state) {
+    if (slot >= header->count.load(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    seqlock_write_lock(seq[slot]);
+    xs[slot].store(state.x, std::memory_order_relaxed);
+    ys[slot].store(state.y, std::memory_order_relaxed);
+    zs[slot].store(state.z, std::memory_order_relaxed);
+    rssi0s[slot].store(state.RSSI_0, std::memory_order_relaxed);
+    ns[slot].store(state.n, std::memory_order_relaxed);
+    ewmas[slot].store(state.ewma, std::memory_order_relaxed);
+    last_seens[slot].store(state.last_seen, std::memory_order_relaxed);
+    uint32_t version = versions[slot].load(std::memory_order_relaxed) + 1;
+    versions[slot].store(version, std::memory_order_relaxed);
+    seqlock_write_unlock(seq[slot]);
+
+    return version;
+}
+
+std::string ShmAnchorStore::mac_at(uint32_t slot) const {
+    if (slot >= header->count.load(std::memory_order_acquire)) {
+        return "";
+    }
+    return std::string(macs + slot * MAC_BYTES);
+}
+
+uint32_t ShmAnchorStore::size() const {
+    return header->count.load(std::memory_order_acquire);
+}
+
+uint32_t ShmAnchorStore::capacity() const {
+    return header->capacity;
+}
+
+bool ShmAnchorStore::is_creator() const {
+    return created;
+}
+
+//helpers:
+size_t ShmAnchorStore::layout_bytes(uint32_t capacity, uint32_t index_size) {
+    size_t bytes = align_up(sizeof(Header));
+    bytes += align_up(capacity * MAC_BYTES);
+    bytes += 9 * align_up(capacity * sizeof(uint32_t));   // seq, 7 float fields, version
+    bytes += align_up(index_size * sizeof(uint32_t));
+    return bytes;
+}
+
+void ShmAnchorStore::bind_layout(uint32_t capacity, uint32_t index_size) {
+    char* cursor = static_cast<char*>(base) + align_up(sizeof(Header));
+    auto take = [&cursor](size_t bytes) {
+        char* start = cursor;
+        cursor += align_up(bytes);
+        return start;
+    };
+
+    macs = take(capacity * MAC_BYTES);
+    seq = reinterpret_cast<std::atomic<uint32_t>*>(take(capacity * sizeof(uint32_t)));
+    xs = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    ys = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    zs = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    rssi0s = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    ns = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    ewmas = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    last_seens = reinterpret_cast<std::atomic<float>*>(take(capacity * sizeof(float)));
+    versions = reinterpret_cast<std::atomic<uint32_t>*>(take(capacity * sizeof(uint32_t)));
+    index = reinterpret_cast<std::atomic<uint32_t>*>(take(index_size * sizeof(uint32_t)));
+    index_mask = index_size - 1;
+}
+
+/**
+ * @brief Publish the index entry of the last slot if its inserter died before doing so
+ *
+ * Called with the insert mutex held. Only the last slot can be affected: inserts are
+ * serialized and the count is stored before the index entry.
+ */
+void ShmAnchorStore::repair_last_insert() {
+    uint32_t count = header->count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return;
+    }
+    std::string mac = mac_at(count - 1);
+    uint32_t empty_position = 0;
+    if (probe(mac, empty_position) < 0) {
+        index[empty_position].store(count, std::memory_order_release);
+    }
+}
+
+int32_t ShmAnchorStore::probe(const std::string& mac, uint32_t& empty_position) const {
+    if (mac.size() >= MAC_BYTES) {
+        return -1;
+    }
+
+    uint32_t position = hash_mac(mac) & index_mask;
+    for (uint32_t probes = 0; probes <= index_mask; probes++) {
+        uint32_t entry = index[position].load(std::memory_order_acquire);
+        if (entry == 0) {
+            empty_position = position;
+            return -1;
+        }
+        uint32_t slot = entry - 1;
+        if (std::strncmp(macs + slot * MAC_BYTES, mac.c_str(), MAC_BYTES) == 0) {
+            return static_cast<int32_t>(slot);
+        }
+        position = (position + 1) & index_mask;
+    }
+    return -1;
+}
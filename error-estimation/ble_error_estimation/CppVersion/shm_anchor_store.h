@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Consistent copy of one anchor's shared calibration and health state
+ *
+ * A version of 0 means the slot exists but no process has written state yet.
+ */
+struct ShmAnchorState {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float RSSI_0 = 0.0f;
+    float n = 0.0f;
+    float ewma = 0.0f;
+    float last_seen = 0.0f;
+    uint32_t version = 0;
+};
+
+/**
+ * @brief Anchor store in a named POSIX shared-memory segment
+ *
+ * Lets several ble_rssi_runner processes on one host share anchor coordinates,
+ * calibration (RSSI_0, n) and health (ewma, last_seen) without IPC copies. The
+ * segment has a fixed structure-of-arrays layout:
+ *
+ *     header | mac[cap][16] | seq[cap] | x[cap] | y[cap] | z[cap] | RSSI_0[cap]
+ *            | n[cap] | ewma[cap] | last_seen[cap] | version[cap] | index[2^k >= 2*cap]
+ *
+ * Each array starts on a 64-byte boundary. Slots are append-only and never move,
+ * so a slot number stays valid for the lifetime of the segment.
+ *
+ * Concurrency:
+ * - Lookups probe an open-addressing MAC index and never lock.
+ * - Each slot is guarded by its own sequence lock: readers are lock-free and
+ *   retry on concurrent writes, writers to one slot serialize, writers to
+ *   different slots never contend.
+ * - Inserts are rare and serialized by a robust process-shared mutex, so a
+ *   process dying mid-insert does not wedge the others; the next inserter
+ *   finishes an insert that had already claimed its slot.
+ *
+ * The segment is created by the first process and attached by later ones; it
+ * outlives all processes until unlink() is called.
+ */
+class ShmAnchorStore {
+    public:
+        static constexpr uint32_t MAGIC = 0x424C4541;   // "BLEA"
+        static constexpr uint32_t LAYOUT_VERSION = 1;
+        static constexpr size_t MAC_BYTES = 16;          // Up to 15 characters plus terminator
+
+        /**
+         * @brief Create the named segment, or attach to it if another process already did
+         *
+         * @param name Shared-memory object name (e.g. "/ble_rssi_anchors")
+         * @param capacity Maximum number of anchors, used only when creating the segment
+         * @throws std::runtime_error if the segment cannot be created, attached or has an incompatible layout
+         */
+        ShmAnchorStore(const std::string& name, uint32_t capacity);
+
+        /**
+         * @brief Unmap the segment; the segment itself persists for other processes
+         */
+        ~ShmAnchorStore();
+
+        ShmAnchorStore(const ShmAnchorStore&) = delete;
+        ShmAnchorStore& operator=(const ShmAnchorStore&) = delete;
+
+        /**
+         * @brief Remove the named segment from the system
+         * @param name Shared-memory object name
+         */
+        static void unlink(const std::string& name);
+
+        /**
+         * @brief Find the slot of an anchor without locking
+         * @param mac MAC address of the anchor
+         * @return int32_t Slot number, or -1 if the anchor is not in the store
+         */
+        int32_t find(const std::string& mac) const;
+
+        /**
+         * @brief Find the slot of an anchor, appending an empty slot if it is missing
+         * @param mac MAC address of the anchor
+         * @return int32_t Slot number, or -1 if the store is full or the MAC is too long
+         */
+        int32_t find_or_insert(const std::string& mac);
+
+        /**
+         * @brief Read a consistent snapshot of one slot
+         * @param slot Slot number returned by find()
+         * @param out Receives the snapshot
+         * @return bool false if slot is out of range
+         */
+        bool read(uint32_t slot, ShmAnchorState& out) const;
+
+        /**
+         * @brief Overwrite the state of one slot and bump its version
+         * @param slot Slot number returned by find_or_insert()
+         * @param state New state; its version field is ignored
+         * @return uint32_t New version of the slot, or 0 if slot is out of range
+         */
+        uint32_t write(uint32_t slot, const ShmAnchorState& state);
+
+        /**
+         * @brief Gets the MAC address stored in a slot
+         * @param slot Slot number
+         * @return std::string MAC address, empty if slot is out of range
+         */
+        std::string mac_at(uint32_t slot) const;
+
+        /**
+         * @brief Gets the number of anchors in the store
+         * @return uint32_t Number of used slots
+         */
+        uint32_t size() const;
+
+        /**
+         * @brief Gets the maximum number of anchors
+         * @return uint32_t Number of slots in the segment
+         */
+        uint32_t capacity() const;
+
+        /**
+         * @brief Gets whether this process created the segment
+         * @return bool true if created, false if attached
+         */
+        bool is_creator() const;
+
+    private:
+        struct Header;
+
+        std::string name;
+        bool created = false;
+        void* base = nullptr;
+        size_t mapped_bytes = 0;
+
+        Header* header = nullptr;
+        char* macs = nullptr;
+        std::atomic<uint32_t>* seq = nullptr;
+        std::atomic<float>* xs = nullptr;
+        std::atomic<float>* ys = nullptr;
+        std::atomic<float>* zs = nullptr;
+        std::atomic<float>* rssi0s = nullptr;
+        std::atomic<float>* ns = nullptr;
+        std::atomic<float>* ewmas = nullptr;
+        std::atomic<float>* last_seens = nullptr;
+        std::atomic<uint32_t>* versions = nullptr;
+        std::atomic<uint32_t>* index = nullptr;
+        uint32_t index_mask = 0;
+
+        static size_t layout_bytes(uint32_t capacity, uint32_t index_size);
+        void bind_layout(uint32_t capacity, uint32_t index_size);
+        void repair_last_insert();
+        int32_t probe(const std::string& mac, uint32_t& empty_position) const;
+};
@@ -0,0 +1,251 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "state_handoff.h"
+#include "state_snapshot.h"
+
+namespace {
+    // Largest snapshot request_handoff() accepts, so a bogus length cannot make it allocate without bound
+    constexpr uint64_t MAX_SNAPSHOT_BYTES =
+        sizeof(StateSnapshotHeader) + static_cast<uint64_t>(Config::HANDOFF_MAX_ANCHORS) * sizeof(AnchorSnapshotRecord);
+
+    // Only a process of the same user may take the state, or hand it over
+    bool peer_is_same_user(int fd) {
+        ucred peer{};
+        socklen_t size = sizeof(peer);
+        return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 && peer.uid == geteuid();
+    }
+
+    sockaddr_un socket_address(const std::string& path) {
+        sockaddr_un address{};
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Handoff socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) +
+                                     " bytes long: " + path);
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.data(), path.size());
+        return address;
+    }
+
+    std::runtime_error socket_error(const std::string& what, const std::string& path) {
+        return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    // Blocking write of the whole buffer; false if the peer went away
+    bool write_all(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // Read exactly size bytes before the deadline
+    void read_all(int fd, char* data, size_t size, std::chrono::steady_clock::time_point deadline, const std::string& path) {
+        while (size > 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                throw std::runtime_error("Timed out waiting for the state handoff on " + path);
+            }
+            pollfd ready{fd, POLLIN, 0};
+            int events = poll(&ready, 1, static_cast<int>(left.count()));
+            if (events < 0 && errno != EINTR) {
+                throw socket_error("Failed to wait for the state handoff on", path);
+            }
+            if (events <= 0) {
+                continue;
+            }
+            ssize_t received = ::recv(fd, data, size, 0);
+            if (received == 0) {
+                throw std::runtime_error("Engine on " + path + " closed the handoff before sending its state");
+            }
+            if (received < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                throw socket_error("Failed to read the state handoff on", path);
+            }
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+    }
+}
+
+/*HANDOFFSERVER*/
+//constructor:
+HandoffServer::HandoffServer(Reactor& event_loop, std::string path, std::function<void()> request_callback)
+    : reactor(event_loop), socket_path(std::move(path)), on_request(std::move(request_callback)) {
+    sockaddr_un address = socket_address(socket_path);
+
+    // A socket left behind by a process that did not shut down cleanly
+    struct stat existing {};
+    if (lstat(socket_path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        unlink(socket_path.c_str());
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        throw socket_error("Failed to create handoff socket", socket_path);
+    }
+    // Owner only, set before listen() so no other user can connect in between
+    if (bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(socket_path.c_str(), 0600) != 0 || listen(listen_fd, 1) != 0) {
+        std::runtime_error error = socket_error("Failed to listen on handoff socket", socket_path);
+        close(listen_fd);
+        throw error;
+    }
+    reactor.add_fd(listen_fd, EPOLLIN, [this](uint32_t) { on_accept(); });
+}
+
+HandoffServer::~HandoffServer() {
+    close_listener();
+    if (peer_fd >= 0) {
+        if (reactor.has_fd(peer_fd)) {
+            reactor.remove_fd(peer_fd);
+        }
+        close(peer_fd);
+    }
+}
+
+//methods:
+bool HandoffServer::send(std::string_view snapshot) {
+    if (peer_fd < 0 || request.size() < sizeof(HANDOFF_MAGIC)) {
+        return false;
+    }
+    HandoffHeader header;
+    std::memcpy(header.magic, HANDOFF_MAGIC, sizeof(header.magic));
+    header.length = snapshot.size();
+
+    fcntl(peer_fd, F_SETFL, fcntl(peer_fd, F_GETFL) & ~O_NONBLOCK);
+    bool sent = write_all(peer_fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                write_all(peer_fd, snapshot.data(), snapshot.size());
+    close(peer_fd);
+    peer_fd = -1;
+    return sent;
+}
+
+bool HandoffServer::requested() const {
+    return peer_fd >= 0 && request.size() == sizeof(HANDOFF_MAGIC);
+}
+
+//helpers:
+void HandoffServer::on_accept() {
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (peer_fd >= 0) {
+        close(fd);   // One handoff at a time
+        return;
+    }
+    if (!peer_is_same_user(fd)) {
+        std::cerr << "Rejected a handoff request from another user on " << socket_path << std::endl;
+        close(fd);
+        return;
+    }
+    peer_fd = fd;
+    request.clear();
+    reactor.add_fd(peer_fd, EPOLLIN, [this](uint32_t) { on_peer_readable(); });
+}
+
+void HandoffServer::on_peer_readable() {
+    char buffer[sizeof(HANDOFF_MAGIC)];
+    ssize_t received = ::recv(peer_fd, buffer, sizeof(HANDOFF_MAGIC) - request.size(), 0);
+    if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (received > 0) {
+        request.append(buffer, static_cast<size_t>(received));
+    }
+    bool valid_so_far = std::memcmp(request.data(), HANDOFF_MAGIC, request.size()) == 0;
+    if (received <= 0 || !valid_so_far) {
+        // The peer went away or is not an engine: wait for another one
+        reactor.remove_fd(peer_fd);
+        close(peer_fd);
+        peer_fd = -1;
+        request.clear();
+        return;
+    }
+    if (request.size() < sizeof(HANDOFF_MAGIC)) {
+        return;
+    }
+
+    reactor.remove_fd(peer_fd);
+    close_listener();
+    on_request();
+}
+
+void HandoffServer::close_listener() {
+    if (listen_fd < 0) {
+        return;
+    }
+    reactor.remove_fd(listen_fd);
+    close(listen_fd);
+    listen_fd = -1;
+    // Before the process taking over binds the path: it only listens once it has the state
+    unlink(socket_path.c_str());
+}
+
+/*HANDOFFCLIENT*/
+std::optional<std::string> request_handoff(const std::string& path, int timeout_ms) {
+    sockaddr_un address = socket_address(path);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw socket_error("Failed to create handoff socket for", path);
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        close(fd);
+        if (error == ENOENT || error == ECONNREFUSED) {
+            return std::nullopt;   // No engine running: a cold start
+        }
+        errno = error;
+        throw socket_error("Failed to connect to handoff socket", path);
+    }
+
+    try {
+        if (!peer_is_same_user(fd)) {
+            throw std::runtime_error("Handoff socket " + path + " belongs to another user");
+        }
+        if (!write_all(fd, HANDOFF_MAGIC, sizeof(HANDOFF_MAGIC))) {
+            throw socket_error("Failed to request the state handoff on", path);
+        }
+        HandoffHeader header;
+        read_all(fd, reinterpret_cast<char*>(&header), sizeof(header), deadline, path);
+        if (std::memcmp(header.magic, HANDOFF_MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Unexpected state handoff answer on " + path);
+        }
+        if (header.length > MAX_SNAPSHOT_BYTES) {
+            throw std::runtime_error("State handoff on " + path + " announced " + std::to_string(header.length) +
+                                     " bytes, more than " + std::to_string(MAX_SNAPSHOT_BYTES));
+        }
+        std::string snapshot(header.length, '\0');
+        read_all(fd, snapshot.data(), snapshot.size(), deadline, path);
+        close(fd);
+        return snapshot;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "reactor.h"
+
+/**
+ * @brief Frame of a handoff response: magic, then the length of the state snapshot that follows
+ */
+struct HandoffHeader {
+    char magic[8];
+    uint64_t length;
+};
+static_assert(sizeof(HandoffHeader) == 16, "HandoffHeader must stay 16 bytes");
+
+constexpr char HANDOFF_MAGIC[8] = {'B', 'L', 'E', 'H', 'O', 'F', 'F', '1'};
+
+/**
+ * @brief Old side of a hot upgrade: hands the engine's state to the process replacing it
+ *
+ * Listens on a Unix socket through the reactor. A new process connects and sends
+ * HANDOFF_MAGIC; on_request then runs on the reactor thread, and the engine answers
+ * with send() once it has stopped consuming and drained its in-flight messages. The
+ * listening socket is closed and its path unlinked as soon as a request arrives, so the
+ * new process can listen on the same path for the next upgrade.
+ *
+ * The socket is created with mode 0600, and connections from a process whose effective
+ * uid differs from this one's (SO_PEERCRED) are closed unanswered.
+ */
+class HandoffServer {
+    public:
+        /**
+         * @param reactor Reactor watching the socket
+         * @param path Filesystem path of the Unix socket; a stale socket there is replaced
+         * @param on_request Called once when a new process asks for the state
+         * @throws std::runtime_error If the socket cannot be created or bound
+         */
+        HandoffServer(Reactor& reactor, std::string path, std::function<void()> on_request);
+
+        /**
+         * @brief Close the sockets, and unlink the path if no request arrived
+         */
+        ~HandoffServer();
+
+        HandoffServer(const HandoffServer&) = delete;
+        HandoffServer& operator=(const HandoffServer&) = delete;
+
+        /**
+         * @brief Send the state snapshot to the waiting process and close the connection
+         *
+         * Blocks until the snapshot is written: the peer is a local process reading it.
+         *
+         * @param snapshot State snapshot (see state_snapshot.h)
+         * @return bool false if no process is waiting or it went away
+         */
+        bool send(std::string_view snapshot);
+
+        /**
+         * @brief Gets whether a process asked for the state and has not been answered yet
+         */
+        bool requested() const;
+
+    private:
+        Reactor& reactor;
+        std::string socket_path;
+        std::function<void()> on_request;
+        int listen_fd = -1;
+        int peer_fd = -1;
+        std::string request;
+
+        void on_accept();
+        void on_peer_readable();
+        void close_listener();
+};
+
+/**
+ * @brief New side of a hot upgrade: ask the running engine for its state
+ *
+ * @param path Filesystem path of the old process's HandoffServer socket
+ * @param timeout_ms Longest wait for the snapshot, including the old process's drain
+ * @return std::optional<std::string> State snapshot, std::nullopt if no engine listens on path
+ * @throws std::runtime_error If an engine answered but the transfer failed or timed out, the
+ *         socket belongs to another user, or the snapshot exceeds Config::HANDOFF_MAX_ANCHORS anchors
+ */
+std::optional<std::string> request_handoff(const std::string& path, int timeout_ms);
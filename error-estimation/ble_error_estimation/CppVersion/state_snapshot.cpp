@@ -0,0 +1,94 @@
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "state_snapshot.h"
+
+/*STATESNAPSHOT*/
+std::string export_state_snapshot(const AnchorRegistry& anchors) {
+    auto guard = anchors.read();
+
+    std::vector<AnchorSnapshotRecord> records;
+    records.reserve(guard.size());
+    for (const auto& [mac, anchor] : guard.anchors()) {
+        AnchorSnapshotRecord record;
+        std::memset(&record, 0, sizeof(record));
+        if (mac.empty() || mac.size() > sizeof(record.mac)) {
+            throw std::runtime_error("MAC address does not fit a state snapshot record: " + mac);
+        }
+        record.mac_length = static_cast<uint8_t>(mac.size());
+        std::memcpy(record.mac, mac.data(), mac.size());
+        PointR3 coord = anchor->get_coord();
+        record.x = std::get<0>(coord);
+        record.y = std::get<1>(coord);
+        record.z = std::get<2>(coord);
+
+        AnchorState state;
+        anchor->save_state(state, record.kalman);
+        record.RSSI_0 = state.RSSI_0;
+        record.n = state.n;
+        record.ewma = state.ewma;
+        record.last_seen = state.last_seen;
+        record.version = state.version;
+        records.push_back(record);
+    }
+
+    StateSnapshotHeader header;
+    std::memcpy(header.magic, STATE_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = STATE_SNAPSHOT_VERSION;
+    header.count = static_cast<uint32_t>(records.size());
+
+    std::string snapshot(sizeof(header) + records.size() * sizeof(AnchorSnapshotRecord), '\0');
+    std::memcpy(snapshot.data(), &header, sizeof(header));
+    if (!records.empty()) {
+        std::memcpy(snapshot.data() + sizeof(header), records.data(), records.size() * sizeof(AnchorSnapshotRecord));
+    }
+    return snapshot;
+}
+
+StateSnapshotImport import_state_snapshot(AnchorRegistry& anchors, const char* data, size_t size) {
+    StateSnapshotHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("State snapshot truncated before its header");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, STATE_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a state snapshot");
+    }
+    if (header.version != STATE_SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported state snapshot version " + std::to_string(header.version));
+    }
+    if ((size - sizeof(header)) / sizeof(AnchorSnapshotRecord) < header.count) {
+        throw std::runtime_error("State snapshot truncated: " + std::to_string(header.count) + " records announced");
+    }
+
+    StateSnapshotImport result;
+    std::vector<std::unique_ptr<Anchor>> created;
+    const char* record_data = data + sizeof(header);
+    {
+        auto guard = anchors.read();
+        for (uint32_t i = 0; i < header.count; i++) {
+            AnchorSnapshotRecord record;
+            std::memcpy(&record, record_data + i * sizeof(record), sizeof(record));
+            if (record.mac_length == 0 || record.mac_length > sizeof(record.mac)) {
+                result.skipped++;
+                continue;
+            }
+            std::string mac(record.mac, record.mac_length);
+            AnchorState state{record.RSSI_0, record.n, record.ewma, record.last_seen, record.version};
+
+            if (Anchor* anchor = guard.find(mac)) {
+                anchor->restore_state(state, record.kalman);
+                result.restored++;
+                continue;
+            }
+            auto anchor = std::make_unique<Anchor>(mac, std::make_tuple(record.x, record.y, record.z), record.last_seen);
+            anchor->restore_state(state, record.kalman);
+            created.push_back(std::move(anchor));
+        }
+    }
+
+    result.added = anchors.insert_all(std::move(created));
+    return result;
+}
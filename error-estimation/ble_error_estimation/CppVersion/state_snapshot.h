@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "anchor_registry.h"
+#include "kalman.h"
+
+/**
+ * @brief Fixed-size entry of a state snapshot: one anchor's position, calibration, health and Kalman filter
+ *
+ * Host byte order: snapshots move state between processes and libraries on the same
+ * kind of machine, they are not an interchange format (see SiteSurveyRecord for that).
+ */
+struct AnchorSnapshotRecord {
+    uint8_t mac_length;
+    char mac[19];              // Not NUL-terminated when 19 bytes long
+    float x;
+    float y;
+    float z;
+    float RSSI_0;
+    float n;
+    float ewma;
+    float last_seen;
+    uint32_t version;
+    KalmanState kalman;
+};
+static_assert(sizeof(AnchorSnapshotRecord) == 496, "AnchorSnapshotRecord layout is part of the snapshot format");
+
+/**
+ * @brief Header of a state snapshot: magic, format version and record count
+ */
+struct StateSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+static_assert(sizeof(StateSnapshotHeader) == 16, "StateSnapshotHeader must stay 16 bytes");
+
+constexpr char STATE_SNAPSHOT_MAGIC[8] = {'B', 'L', 'E', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t STATE_SNAPSHOT_VERSION = 1;
+
+/**
+ * @brief What import_state_snapshot() did with the snapshot's anchors
+ */
+struct StateSnapshotImport {
+    size_t added = 0;          // Anchors unknown to the registry, created from the snapshot
+    size_t restored = 0;       // Registered anchors whose state was replaced
+    size_t skipped = 0;        // Malformed records
+};
+
+/**
+ * @brief Serialize every registered anchor with its full calibration state
+ *
+ * Each anchor is copied consistently (Anchor::save_state), so the snapshot can be
+ * taken while messages are being processed; anchors updated during the export may
+ * be captured before or after those updates.
+ *
+ * @param anchors Registry to export
+ * @return std::string StateSnapshotHeader followed by one AnchorSnapshotRecord per anchor
+ * @throws std::runtime_error If a MAC address is longer than 19 bytes
+ */
+std::string export_state_snapshot(const AnchorRegistry& anchors);
+
+/**
+ * @brief Adopt the anchors of a state snapshot
+ *
+ * Unknown anchors are created with the snapshot's coordinates and published as one
+ * registry version. Registered anchors keep their coordinates (the site configuration
+ * stays authoritative) and take the snapshot's calibration, health, Kalman filter and
+ * version, so they continue exactly where the exporting process stopped.
+ *
+ * @param anchors Registry to import into
+ * @param data First byte of the snapshot
+ * @param size Length of the snapshot in bytes
+ * @return StateSnapshotImport Number of anchors added, restored and skipped
+ * @throws std::runtime_error If the header is missing, foreign or truncated
+ */
+StateSnapshotImport import_state_snapshot(AnchorRegistry& anchors, const char* data, size_t size);
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Lazily started coroutine returning a T
+ *
+ * A Task does nothing until it is awaited (co_await task) or handed to spawn().
+ * When it finishes, the awaiting coroutine resumes on the thread that completed
+ * it. Exceptions thrown inside the task are rethrown to the awaiter.
+ *
+ * Example:
+ *     Task<int> answer() { co_return 42; }
+ *     Task<void> caller() { int value = co_await answer(); ... }
+ */
+template <typename T>
+class Task;
+
+namespace task_detail {
+    // Resumes whoever awaited the finished task, or returns to the resumer if nobody did
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept {
+            std::coroutine_handle<> continuation = finished.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    template <typename T>
+    struct Promise : PromiseBase {
+        std::optional<T> value;
+
+        Task<T> get_return_object() noexcept;
+        void return_value(T result) { value = std::move(result); }
+    };
+
+    template <>
+    struct Promise<void> : PromiseBase {
+        Task<void> get_return_object() noexcept;
+        void return_void() const noexcept {}
+    };
+}
+
+template <typename T>
+class Task {
+    public:
+        using promise_type = task_detail::Promise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        explicit Task(Handle coroutine) : handle(coroutine) {}
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task() { destroy(); }
+
+        /**
+         * @brief Start the task and suspend the caller until it finishes
+         */
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                Handle task;
+
+                bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    task.promise().continuation = awaiting;
+                    return task;
+                }
+
+                T await_resume() {
+                    if (task.promise().error) {
+                        std::rethrow_exception(task.promise().error);
+                    }
+                    if constexpr (!std::is_void_v<T>) {
+                        return std::move(*task.promise().value);
+                    }
+                }
+            };
+            return Awaiter{handle};
+        }
+
+    private:
+        Handle handle;
+
+        void destroy() {
+            if (handle) {
+                handle.destroy();
+                handle = {};
+            }
+        }
+};
+
+namespace task_detail {
+    template <typename T>
+    Task<T> Promise<T>::get_return_object() noexcept {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object() noexcept {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+
+    // Fire-and-forget coroutine that owns its frame and frees it when done
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    inline Detached run_detached(Task<void> task, std::function<void(std::exception_ptr)> on_done) {
+        std::exception_ptr error;
+        try {
+            co_await std::move(task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (on_done) {
+            on_done(error);
+        }
+    }
+}
+
+/**
+ * @brief Start a task without awaiting it
+ *
+ * The task runs on the calling thread until its first suspension. on_done is
+ * called on the thread that finishes it, with the exception it threw (if any).
+ *
+ * @param task Task to run
+ * @param on_done Completion callback, may be empty
+ */
+inline void spawn(Task<void> task, std::function<void(std::exception_ptr)> on_done = {}) {
+    task_detail::run_detached(std::move(task), std::move(on_done));
+}
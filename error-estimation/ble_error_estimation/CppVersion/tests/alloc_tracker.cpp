@@ -0,0 +1,101 @@
+#include <cstdlib>
+#include <new>
+
+#include "alloc_tracker.h"
+
+namespace {
+    // Plain counters in initial-exec TLS: touching them never allocates, even from malloc
+    __attribute__((tls_model("initial-exec"))) thread_local size_t allocation_count = 0;
+    __attribute__((tls_model("initial-exec"))) thread_local size_t allocated_bytes = 0;
+
+    inline void record(size_t size) {
+        allocation_count++;
+        allocated_bytes += size;
+    }
+}
+
+#ifdef __GLIBC__
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void __libc_free(void* pointer);
+
+    void* malloc(size_t size) {
+        record(size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) {
+        record(count * size);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) {
+        record(size);
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer) {
+        __libc_free(pointer);
+    }
+}
+
+#define TRACKED_MALLOC __libc_malloc
+#define TRACKED_FREE __libc_free
+#else
+#define TRACKED_MALLOC std::malloc
+#define TRACKED_FREE std::free
+#endif
+
+/*OPERATOR NEW*/
+namespace {
+    // Goes straight to the underlying allocator, so a C++ allocation is counted once
+    void* allocate(size_t size) {
+        record(size);
+        void* pointer = TRACKED_MALLOC(size ? size : 1);
+        if (!pointer) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void* allocate_aligned(size_t size, std::align_val_t alignment) {
+        record(size);
+        void* pointer = nullptr;
+        if (posix_memalign(&pointer, static_cast<size_t>(alignment), size ? size : 1) != 0) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    record(size);
+    return TRACKED_MALLOC(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    record(size);
+    return TRACKED_MALLOC(size ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept { TRACKED_FREE(pointer); }
+void operator delete[](void* pointer) noexcept { TRACKED_FREE(pointer); }
+void operator delete(void* pointer, size_t) noexcept { TRACKED_FREE(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { TRACKED_FREE(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { TRACKED_FREE(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { TRACKED_FREE(pointer); }
+
+AllocationCount thread_allocations() {
+    return AllocationCount{allocation_count, allocated_bytes};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Heap allocations made by one thread
+ */
+struct AllocationCount {
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    AllocationCount operator-(const AllocationCount& earlier) const {
+        return AllocationCount{allocations - earlier.allocations, bytes - earlier.bytes};
+    }
+};
+
+/**
+ * @brief Allocations made by the calling thread since it started
+ *
+ * Counted by alloc_tracker.cpp, which replaces the global operator new/delete and,
+ * on glibc, malloc/calloc/realloc/free: link it into a test binary to enable tracking.
+ * Counters are per thread, so workers and servers running beside the measured code do
+ * not disturb the numbers.
+ */
+AllocationCount thread_allocations();
+
+/**
+ * @brief Counts the allocations of the calling thread during its lifetime
+ *
+ * Example:
+ *     AllocationScope scope;
+ *     work();
+ *     size_t allocations = scope.count().allocations;
+ */
+class AllocationScope {
+    public:
+        AllocationScope() : start(thread_allocations()) {}
+
+        AllocationCount count() const { return thread_allocations() - start; }
+
+    private:
+        AllocationCount start;
+};
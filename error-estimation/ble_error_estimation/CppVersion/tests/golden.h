@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../processing.h"
+#include "../anchor_source.h"
+#include "test_support.h"
+
+/**
+ * @brief One way of running the processing core, compared against the scalar reference
+ *
+ * An engine owns its ProcessingContext: the harness loads the site into it, feeds it
+ * the workload one message at a time and reads the anchors' state after each message.
+ * A SIMD, batched or fast-math implementation plugs in by implementing process().
+ */
+class GoldenEngine {
+    public:
+        virtual ~GoldenEngine() = default;
+
+        virtual std::string name() const = 0;
+
+        /**
+         * @brief Run one message to completion
+         * @return std::optional<json> Output message, as process_tag_message returns it
+         */
+        virtual std::optional<json> process(const std::string& payload) = 0;
+
+        /**
+         * @brief Whether the harness should load the whole site before the first message
+         */
+        virtual bool preload() const { return true; }
+
+        ProcessingContext& context() { return processing; }
+
+    protected:
+        ProcessingContext processing;
+};
+
+/**
+ * @brief The current scalar implementation: process_tag_message
+ */
+class ScalarEngine : public GoldenEngine {
+    public:
+        std::string name() const override { return "scalar"; }
+
+        std::optional<json> process(const std::string& payload) override {
+            return process_tag_message(processing, payload);
+        }
+};
+
+/**
+ * @brief Allowed difference between reference and candidate values: |a - b| <= absolute + relative * max(|a|, |b|)
+ */
+struct GoldenTolerance {
+    double absolute = 1e-6;
+    double relative = 1e-6;
+
+    bool within(double expected, double actual) const {
+        if (std::isnan(expected) || std::isnan(actual)) {
+            return std::isnan(expected) && std::isnan(actual);
+        }
+        return std::fabs(expected - actual) <= absolute + relative * std::max(std::fabs(expected), std::fabs(actual));
+    }
+};
+
+/**
+ * @brief First place where a candidate engine left the reference
+ */
+struct GoldenDivergence {
+    size_t message = 0;       // Index in the workload
+    std::string tag_mac;
+    std::string field;        // e.g. "error_estimate" or "anchor ce59.../n"
+    std::string expected;
+    std::string actual;
+};
+
+struct GoldenReport {
+    std::string engine;
+    size_t messages = 0;
+    size_t diverging_messages = 0;
+    std::optional<GoldenDivergence> first;
+
+    bool equivalent() const { return diverging_messages == 0; }
+};
+
+namespace golden_detail {
+    inline std::string number(double value) {
+        std::ostringstream text;
+        text.precision(9);
+        text << value;
+        return text.str();
+    }
+
+    inline std::vector<std::string> selected_macs(const json& output) {
+        std::vector<std::string> macs;
+        for (const auto& anchor : output["anchors_selected_for_estimation"]) {
+            macs.push_back(anchor["mac"].get<std::string>());
+        }
+        return macs;
+    }
+
+    // Differences between two outputs of one message, estimates and the selected anchors' state
+    inline std::vector<GoldenDivergence> compare_step(const std::optional<json>& expected, const std::optional<json>& actual,
+                                                      ProcessingContext& reference, ProcessingContext& candidate,
+                                                      const GoldenTolerance& tolerance) {
+        std::vector<GoldenDivergence> found;
+        auto differ = [&found](std::string field, std::string want, std::string got) {
+            found.push_back(GoldenDivergence{0, "", std::move(field), std::move(want), std::move(got)});
+        };
+        if (expected.has_value() != actual.has_value()) {
+            differ("output", expected ? "estimate" : "none", actual ? "estimate" : "none");
+            return found;
+        }
+        if (!expected) {
+            return found;
+        }
+        double want = (*expected)["error_estimate"].get<double>();
+        double got = (*actual)["error_estimate"].get<double>();
+        if (!tolerance.within(want, got)) {
+            differ("error_estimate", number(want), number(got));
+        }
+        for (const char* list : {"warning_anchors", "faulty_anchors"}) {
+            if ((*expected)[list] != (*actual)[list]) {
+                differ(list, (*expected)[list].dump(), (*actual)[list].dump());
+            }
+        }
+        std::vector<std::string> macs = selected_macs(*expected);
+        std::vector<std::string> candidate_macs = selected_macs(*actual);
+        if (macs != candidate_macs) {
+            differ("anchors_selected_for_estimation", json(macs).dump(), json(candidate_macs).dump());
+            return found;
+        }
+
+        // Anchor state trajectory: every selected anchor after this message
+        auto reference_guard = reference.anchors.read();
+        auto candidate_guard = candidate.anchors.read();
+        for (const auto& mac : macs) {
+            Anchor* want_anchor = reference_guard.find(mac);
+            Anchor* got_anchor = candidate_guard.find(mac);
+            if (!want_anchor || !got_anchor) {
+                differ("anchor " + mac, want_anchor ? "known" : "unknown", got_anchor ? "known" : "unknown");
+                continue;
+            }
+            AnchorState want_state = want_anchor->snapshot();
+            AnchorState got_state = got_anchor->snapshot();
+            const std::pair<const char*, std::pair<double, double>> fields[] = {
+                {"RSSI_0", {want_state.RSSI_0, got_state.RSSI_0}},
+                {"n", {want_state.n, got_state.n}},
+                {"ewma", {want_state.ewma, got_state.ewma}},
+                {"last_seen", {want_state.last_seen, got_state.last_seen}},
+            };
+            for (const auto& [field, values] : fields) {
+                if (!tolerance.within(values.first, values.second)) {
+                    differ("anchor " + mac + "/" + field, number(values.first), number(values.second));
+                }
+            }
+            if (want_state.version != got_state.version) {
+                differ("anchor " + mac + "/version", std::to_string(want_state.version), std::to_string(got_state.version));
+            }
+        }
+        return found;
+    }
+}
+
+/**
+ * @brief Run a workload through the reference and a candidate engine and compare them message by message
+ *
+ * Both engines get the site first (unless the candidate discovers anchors on its own),
+ * then every message in order. After each message the error estimate, the warning and
+ * faulty lists, the selected anchors and each selected anchor's RSSI_0, n, ewma,
+ * last_seen and version are compared.
+ *
+ * @param reference Engine giving the expected results, normally ScalarEngine
+ * @param candidate Engine under test
+ * @param site Anchors of the site
+ * @param workload Message payloads in arrival order
+ * @param tolerance Allowed numeric difference
+ * @return GoldenReport Number of diverging messages and the first divergence
+ */
+inline GoldenReport compare_engines(GoldenEngine& reference, GoldenEngine& candidate, AnchorSource& site,
+                                    const std::vector<std::string>& workload, const GoldenTolerance& tolerance = GoldenTolerance()) {
+    site.load(reference.context());
+    if (candidate.preload()) {
+        site.load(candidate.context());
+    }
+
+    GoldenReport report;
+    report.engine = candidate.name();
+    for (size_t i = 0; i < workload.size(); i++) {
+        std::optional<json> expected = reference.process(workload[i]);
+        std::optional<json> actual = candidate.process(workload[i]);
+        std::vector<GoldenDivergence> found = golden_detail::compare_step(expected, actual, reference.context(),
+                                                                          candidate.context(), tolerance);
+        report.messages++;
+        if (found.empty()) {
+            continue;
+        }
+        report.diverging_messages++;
+        if (!report.first) {
+            report.first = found.front();
+            report.first->message = i;
+            report.first->tag_mac = json::parse(workload[i])["tag"]["mac"].get<std::string>();
+        }
+    }
+    return report;
+}
+
+/**
+ * @brief Read a recorded workload: one message payload per line, blank lines skipped
+ * @throws std::runtime_error If the file cannot be read
+ */
+inline std::vector<std::string> load_golden_workload(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot read workload " + path);
+    }
+    std::vector<std::string> workload;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            workload.push_back(line);
+        }
+    }
+    return workload;
+}
+
+/**
+ * @brief Synthetic site: anchors on a 5m grid, eight per row
+ */
+inline void add_golden_site(MemoryAnchorSource& site, size_t anchors) {
+    for (size_t i = 0; i < anchors; i++) {
+        site.add(synthetic_mac("901d", i), std::make_tuple(static_cast<float>(i % 8) * 5.0f, static_cast<float>(i / 8) * 5.0f, 2.5f));
+    }
+}
+
+/**
+ * @brief Synthetic workload over the synthetic site: tags heard by 3 to 6 anchors, noisy RSSI,
+ * including weak and dropped-out anchors so health tracking changes state
+ */
+inline std::vector<std::string> synthetic_golden_workload(size_t messages, size_t anchors, unsigned seed = 7) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 3.0f);
+    std::vector<std::string> workload;
+    for (size_t i = 0; i < messages; i++) {
+        size_t tag = rng() % 16;
+        size_t heard = 3 + rng() % 4;
+        size_t first = rng() % anchors;
+        json used_anchors = json::array();
+        json unused_anchors = json::array();
+        for (size_t k = 0; k < heard; k++) {
+            float rssi = -55.0f - 4.0f * k + noise(rng);
+            json entry = {{"mac", synthetic_mac("901d", (first + k * 3) % anchors)}, {"rssi", rssi}};
+            (k < 4 ? used_anchors : unused_anchors).push_back(entry);
+        }
+        json message = {
+            {"location", {{"position", {{"x", static_cast<float>(rng() % 400) / 10.0f},
+                                        {"y", static_cast<float>(rng() % 400) / 10.0f}, {"z", 0.0f},
+                                        {"used_anchors", used_anchors}, {"unused_anchors", unused_anchors}}}}},
+            {"tag", {{"mac", "7a9d" + std::to_string(tag)}}},
+            {"timestamp", 1751374881169.0 + 250.0 * i}
+        };
+        workload.push_back(message.dump());
+    }
+    return workload;
+}
+
+/**
+ * @brief Print a comparison result, with the first divergence if any
+ */
+inline void print_golden_report(const GoldenReport& report, std::ostream& out) {
+    out << "  " << report.engine << ": " << report.messages << " messages, " << report.diverging_messages << " diverging";
+    if (report.first) {
+        const GoldenDivergence& first = *report.first;
+        out << "; first at message " << first.message << " (tag " << first.tag_mac << "), " << first.field
+            << ": expected " << first.expected << ", got " << first.actual;
+    }
+    out << std::endl;
+}
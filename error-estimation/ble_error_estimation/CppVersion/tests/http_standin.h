@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Minimal local HTTP/1.1 server standing in for the Ubudu dongles API in tests
+ *
+ * Listens on 127.0.0.1 on an ephemeral port and answers every request through a
+ * handler, one thread per connection. Replies always close the connection.
+ */
+class HttpStandIn {
+    public:
+        struct Request {
+            std::string method;
+            std::string target;                          // Path and query, e.g. "/api/dongles?macAddress=x"
+            std::map<std::string, std::string> headers;  // Lower-case header names
+        };
+
+        struct Reply {
+            int status = 200;
+            std::string body;
+            std::vector<std::pair<std::string, std::string>> headers;
+            int delay_ms = 0;                            // Wait before answering
+        };
+
+        using Handler = std::function<Reply(const Request&)>;
+
+        explicit HttpStandIn(Handler request_handler) : handler(std::move(request_handler)) {
+            listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, 64) != 0) {
+                close(listen_fd);
+                throw std::runtime_error("HTTP stand-in failed to listen");
+            }
+            socklen_t length = sizeof(address);
+            getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+            listen_port = ntohs(address.sin_port);
+            acceptor = std::thread([this]() { accept_loop(); });
+        }
+
+        ~HttpStandIn() {
+            stopping = true;
+            acceptor.join();
+            close(listen_fd);
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            for (auto& connection : connections) {
+                connection.join();
+            }
+        }
+
+        HttpStandIn(const HttpStandIn&) = delete;
+        HttpStandIn& operator=(const HttpStandIn&) = delete;
+
+        int port() const { return listen_port; }
+
+        std::string url(const std::string& target) const {
+            return "http://127.0.0.1:" + std::to_string(listen_port) + target;
+        }
+
+        size_t requests() const { return request_count.load(); }
+
+    private:
+        Handler handler;
+        int listen_fd = -1;
+        int listen_port = 0;
+        std::atomic<bool> stopping{false};
+        std::atomic<size_t> request_count{0};
+        std::thread acceptor;
+        std::mutex connections_mutex;
+        std::vector<std::thread> connections;
+
+        void accept_loop() {
+            while (!stopping.load()) {
+                pollfd waiting {listen_fd, POLLIN, 0};
+                if (poll(&waiting, 1, 20) <= 0) {
+                    continue;
+                }
+                int client = accept(listen_fd, nullptr, nullptr);
+                if (client < 0) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(connections_mutex);
+                connections.emplace_back([this, client]() { serve(client); });
+            }
+        }
+
+        void serve(int client) {
+            std::string raw;
+            char buffer[4096];
+            while (raw.find("\r\n\r\n") == std::string::npos) {
+                ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+                if (received <= 0) {
+                    close(client);
+                    return;
+                }
+                raw.append(buffer, static_cast<size_t>(received));
+            }
+
+            Request request = parse(raw.substr(0, raw.find("\r\n\r\n")));
+            request_count++;
+            Reply reply = handler(request);
+            if (reply.delay_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(reply.delay_ms));
+            }
+
+            std::string response = "HTTP/1.1 " + std::to_string(reply.status) + " Stand-In\r\n";
+            for (const auto& [name, value] : reply.headers) {
+                response += name + ": " + value + "\r\n";
+            }
+            response += "Content-Length: " + std::to_string(reply.body.size()) + "\r\n";
+            response += "Connection: close\r\n\r\n";
+            if (request.method != "HEAD") {
+                response += reply.body;
+            }
+
+            size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(written);
+            }
+            close(client);
+        }
+
+        static Request parse(const std::string& head) {
+            Request request;
+            size_t line_end = head.find("\r\n");
+            std::string request_line = head.substr(0, line_end);
+            size_t first_space = request_line.find(' ');
+            size_t second_space = request_line.find(' ', first_space + 1);
+            request.method = request_line.substr(0, first_space);
+            request.target = request_line.substr(first_space + 1, second_space - first_space - 1);
+
+            size_t position = line_end == std::string::npos ? head.size() : line_end + 2;
+            while (position < head.size()) {
+                size_t next = head.find("\r\n", position);
+                std::string line = head.substr(position, next == std::string::npos ? std::string::npos : next - position);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string name = line.substr(0, colon);
+                    for (char& c : name) {
+                        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                    }
+                    size_t value_start = line.find_first_not_of(' ', colon + 1);
+                    request.headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
+                }
+                position = next == std::string::npos ? head.size() : next + 2;
+            }
+            return request;
+        }
+};
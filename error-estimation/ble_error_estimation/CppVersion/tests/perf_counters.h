@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Hardware counter totals of one benchmark, scaled for multiplexing
+ */
+struct PerfCounts {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+
+    double ipc() const { return cycles ? static_cast<double>(instructions) / cycles : 0.0; }
+};
+
+/**
+ * @brief perf_event counters (cycles, instructions, cache misses, branch misses) of the calling thread
+ *
+ * Opt-in: counters are only opened when BLE_PERF_COUNTERS=1 is set, and a kernel or VM
+ * without a PMU (or perf_event_paranoid > 2) just makes them unavailable. User-space
+ * only, so the enable/disable syscalls around the measured code are not counted.
+ *
+ * Example:
+ *     PerfCounters counters;
+ *     for (...) { counters.start(); work(); counters.stop(); }
+ *     PerfCounts totals = counters.read();
+ */
+class PerfCounters {
+    public:
+        PerfCounters() {
+            const char* flag = std::getenv("BLE_PERF_COUNTERS");
+            if (!flag || std::string(flag) != "1") {
+                failure = "set BLE_PERF_COUNTERS=1 to enable";
+                return;
+            }
+            const uint64_t configs[COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+            for (int i = 0; i < COUNTERS; i++) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = i == 0;            // The group follows its leader
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+                if (fds[i] < 0) {
+                    failure = std::string("perf_event_open: ") + std::strerror(errno);
+                    close_all();
+                    return;
+                }
+            }
+            reset();
+        }
+
+        ~PerfCounters() {
+            close_all();
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        bool available() const { return fds[0] >= 0; }
+
+        // Why the counters are unavailable
+        const std::string& error() const { return failure; }
+
+        void reset() {
+            if (available()) {
+                ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        void start() {
+            if (available()) {
+                ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        void stop() {
+            if (available()) {
+                ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        // Totals since the last reset; extrapolated if the PMU was shared with other events
+        PerfCounts read() const {
+            PerfCounts counts;
+            struct {
+                uint64_t nr;
+                uint64_t time_enabled;
+                uint64_t time_running;
+                uint64_t values[COUNTERS];
+            } data {};
+            if (!available() || ::read(fds[0], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.time_running == 0) {
+                return counts;
+            }
+            double scale = static_cast<double>(data.time_enabled) / data.time_running;
+            counts.cycles = static_cast<uint64_t>(data.values[0] * scale);
+            counts.instructions = static_cast<uint64_t>(data.values[1] * scale);
+            counts.cache_misses = static_cast<uint64_t>(data.values[2] * scale);
+            counts.branch_misses = static_cast<uint64_t>(data.values[3] * scale);
+            return counts;
+        }
+
+    private:
+        static constexpr int COUNTERS = 4;
+        int fds[COUNTERS] = {-1, -1, -1, -1};
+        std::string failure;
+
+        void close_all() {
+            for (int& fd : fds) {
+                if (fd >= 0) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+        }
+};
+
+/**
+ * @brief Print counter totals per message and per anchor
+ */
+inline void print_perf_counts(const std::string& label, const PerfCounts& counts, size_t messages, size_t anchors) {
+    if (messages == 0 || counts.cycles == 0) {
+        return;
+    }
+    auto per = [](uint64_t total, size_t count) { return count ? static_cast<double>(total) / count : 0.0; };
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  [counters] " << label << ": IPC " << std::setprecision(2) << counts.ipc() << std::setprecision(1)
+              << " | per message: " << per(counts.cycles, messages) << " cycles, "
+              << per(counts.instructions, messages) << " instructions, "
+              << per(counts.cache_misses, messages) << " cache misses, "
+              << per(counts.branch_misses, messages) << " branch misses"
+              << " | per anchor: " << per(counts.cycles, anchors) << " cycles, "
+              << per(counts.instructions, anchors) << " instructions, "
+              << per(counts.cache_misses, anchors) << " cache misses, "
+              << per(counts.branch_misses, anchors) << " branch misses" << std::endl;
+    std::cout.flags(flags);
+}
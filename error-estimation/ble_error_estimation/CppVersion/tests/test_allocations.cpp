@@ -0,0 +1,246 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include "../processing.h"
+#include "../anchor_source.h"
+#include "alloc_tracker.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+/**
+ * @brief Worst-case allocations per message measured in each stage of the steady-state path
+ *
+ * Ratchet: the test reports a stage whose worst case drops below its baseline, and the
+ * baseline is then lowered to the new figure; never raise it to make a change pass. The
+ * goal is zero everywhere. A stage fails only once it exceeds its baseline by more than
+ * BUDGET_MARGIN_PERCENT, which absorbs allocation changes inside nlohmann/json and
+ * libstdc++ releases. BLE_ALLOC_BUDGET=N overrides every budget, e.g. BLE_ALLOC_BUDGET=0
+ * lists what is left to remove.
+ */
+struct StageBudget {
+    const char* stage;
+    size_t baseline;
+};
+
+const StageBudget STAGE_BUDGETS[] = {
+    {"parse", 67},         // JSON document, Tag readings map
+    {"evaluate", 11},      // Anchor list, TagSystem distance and z maps
+    {"update", 27},        // Significant anchors, distance and z maps
+    {"serialize", 195},    // Output JSON document and its dump
+};
+
+const size_t BUDGET_MARGIN_PERCENT = 20;
+
+const StageBudget* stage_baseline(const std::string& stage) {
+    for (const auto& budget : STAGE_BUDGETS) {
+        if (stage == budget.stage) {
+            return &budget;
+        }
+    }
+    return nullptr;
+}
+
+size_t stage_budget(const std::string& stage) {
+    if (const char* override_budget = std::getenv("BLE_ALLOC_BUDGET")) {
+        return std::strtoul(override_budget, nullptr, 10);
+    }
+    const StageBudget* budget = stage_baseline(stage);
+    if (!budget) {
+        return 0;
+    }
+    return budget->baseline + (budget->baseline * BUDGET_MARGIN_PERCENT + 99) / 100;
+}
+
+// Tag position message in the engine's input format
+std::string tag_message(const std::string& tag_mac, const std::vector<std::pair<std::string, float>>& used, float x) {
+    json used_anchors = json::array();
+    for (const auto& [mac, rssi] : used) {
+        used_anchors.push_back({{"mac", mac}, {"rssi", rssi}});
+    }
+    json message = {
+        {"location", {{"position", {{"x", x}, {"y", 2.0f}, {"z", 0.0f},
+                                    {"used_anchors", used_anchors}, {"unused_anchors", json::array()}}}}},
+        {"tag", {{"mac", tag_mac}}},
+        {"timestamp", 1751374881169.0}
+    };
+    return message.dump();
+}
+
+// Anchors of a small site, loaded up front as the runner does
+void load_site(ProcessingContext& context) {
+    MemoryAnchorSource site;
+    site.add("aa01", std::make_tuple(0.0f, 0.0f, 2.5f));
+    site.add("aa02", std::make_tuple(10.0f, 0.0f, 2.5f));
+    site.add("aa03", std::make_tuple(0.0f, 10.0f, 2.5f));
+    site.add("aa04", std::make_tuple(10.0f, 10.0f, 2.5f));
+    site.add("aa05", std::make_tuple(5.0f, 5.0f, 2.5f));
+    site.add("aa06", std::make_tuple(5.0f, 15.0f, 2.5f));
+    site.load(context);
+}
+
+// Keeps the optimizer from eliding an allocation whose result is otherwise unused
+void escape(void* pointer) {
+    asm volatile("" : : "g"(pointer) : "memory");
+}
+
+// Every allocation of the calling thread is counted, and only those
+bool test_tracker_counts() {
+    AllocationScope scope;
+    int* value = new int(7);
+    escape(value);
+    delete value;
+    std::vector<char> buffer;
+    buffer.reserve(1000);
+    escape(buffer.data());
+    void* raw = std::malloc(64);
+    escape(raw);
+    std::free(raw);
+    AllocationCount own = scope.count();
+    ASSERT_EQ(3u, own.allocations);
+    ASSERT_TRUE(own.bytes >= sizeof(int) + 1000 + 64);
+
+    // Spawning a thread costs the parent the same whether or not the thread allocates
+    std::thread([]() {}).join();   // First spawn sets up thread bookkeeping once
+    AllocationScope idle_scope;
+    std::thread([]() {}).join();
+    AllocationCount idle = idle_scope.count();
+    AllocationScope busy_scope;
+    std::thread([]() { std::vector<int> elsewhere(100); escape(elsewhere.data()); }).join();
+    ASSERT_EQ(idle.allocations, busy_scope.count().allocations);
+    return true;
+}
+
+// The steady-state path (parse, evaluate, update, serialize) stays within each stage's budget
+bool test_steady_state_budget() {
+    ProcessingContext context;
+    load_site(context);
+
+    std::vector<std::string> messages;
+    for (int i = 0; i < 8; i++) {
+        messages.push_back(tag_message("tag" + std::to_string(i % 4),
+            {{"aa01", -60.0f - i}, {"aa02", -65.0f}, {"aa03", -70.0f + i}, {"aa04", -72.0f}, {"aa05", -58.0f}}, 3.0f + i));
+    }
+    // Warm-up: first-use allocations (iostream buffers, static tables) are not per message
+    for (const auto& payload : messages) {
+        process_tag_message(context, payload);
+    }
+
+    const char* stages[] = {"parse", "evaluate", "update", "serialize"};
+    AllocationCount worst[4];
+    AllocationCount total[4];
+    const int rounds = 25;
+    for (int round = 0; round < rounds; round++) {
+        for (const auto& payload : messages) {
+            AllocationCount stage_counts[4];
+
+            AllocationScope parse_scope;
+            TagMessage message = parse_tag_message(context, payload);
+            stage_counts[0] = parse_scope.count();
+
+            // Same steps as evaluate_tag_message, measured one by one
+            AllocationScope evaluate_scope;
+            auto guard = context.anchors.read();
+            std::vector<Anchor*> anch_list;
+            for (const auto& [anch_mac, rssi_val] : message.tag.get_rssi_readings()) {
+                if (Anchor* anchor = guard.find(anch_mac)) {
+                    anch_list.push_back(anchor);
+                }
+            }
+            TagSystem message_system(message.tag, context.model);
+            float error_estimate = message_system.error_radius(anch_list);
+            stage_counts[1] = evaluate_scope.count();
+
+            AllocationScope update_scope;
+            update_anchors_from_tag_data(anch_list, message.tag, context.model, message.timestamp,
+                                         Config::DEFAULT_DELTA_R, Config::DEFAULT_T_VIS);
+            stage_counts[2] = update_scope.count();
+
+            AllocationScope serialize_scope;
+            std::string output = create_output_info(message.tag.get_mac_address(), error_estimate, anch_list).dump();
+            stage_counts[3] = serialize_scope.count();
+
+            for (int s = 0; s < 4; s++) {
+                total[s].allocations += stage_counts[s].allocations;
+                total[s].bytes += stage_counts[s].bytes;
+                if (stage_counts[s].allocations > worst[s].allocations) {
+                    worst[s] = stage_counts[s];
+                }
+            }
+        }
+    }
+
+    size_t processed = rounds * messages.size();
+    bool within_budget = true;
+    std::cout << std::endl;
+    for (int s = 0; s < 4; s++) {
+        size_t budget = stage_budget(stages[s]);
+        std::cout << "  " << std::left << std::setw(10) << stages[s] << std::right
+                  << std::setw(6) << total[s].allocations / processed << " allocations, "
+                  << std::setw(7) << total[s].bytes / processed << " bytes per message"
+                  << " (worst " << worst[s].allocations << ", budget " << budget << ")" << std::endl;
+        if (worst[s].allocations > budget) {
+            std::cerr << "  Stage " << stages[s] << " allocates " << worst[s].allocations
+                      << " times per message, over its budget of " << budget << std::endl;
+            within_budget = false;
+        }
+        const StageBudget* baseline = stage_baseline(stages[s]);
+        if (baseline && worst[s].allocations < baseline->baseline) {
+            std::cout << "  Ratchet: lower the " << stages[s] << " baseline from " << baseline->baseline
+                      << " to " << worst[s].allocations << std::endl;
+        }
+    }
+    ASSERT_TRUE(within_budget);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "     ALLOCATION TESTS STARTING    " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_tracker_counts", test_tracker_counts);
+    all_passed &= run_test("test_steady_state_budget", test_steady_state_budget);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ALLOCATION TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ALLOCATION TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,323 @@
+#include <iostream>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../anchor_registry.h"
+#include "../anchor_layout.h"
+#include "../anchor_compactor.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+std::string anchor_mac(size_t i) {
+    char mac[13];
+    snprintf(mac, sizeof(mac), "a0b1c2%06zx", i);
+    return mac;
+}
+
+std::unique_ptr<Anchor> make_anchor(size_t i) {
+    return std::make_unique<Anchor>(anchor_mac(i), std::make_tuple(static_cast<float>(i), 0.0f, 0.0f), 1000.0f);
+}
+
+// Distance in anchors between two anchors of the same block
+long anchor_gap(const Anchor* lhs, const Anchor* rhs) {
+    return std::labs(static_cast<long>(rhs - lhs));
+}
+
+/*TESTS*/
+// One message in sample_every is kept, only the last window samples are returned, oldest first
+bool test_covisibility_log() {
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    for (size_t i = 0; i < 4; i++) {
+        anchors.push_back(make_anchor(i));
+    }
+    CoVisibilityLog log(3, 2);
+    log.record({anchors[0].get()});   // Single anchors carry no co-visibility
+    for (size_t i = 0; i < 10; i++) {
+        log.record({anchors[i % 4].get(), anchors[(i + 1) % 4].get()});
+    }
+    ASSERT_EQ(5u, log.samples());
+
+    std::vector<std::vector<std::string>> recent = log.recent();
+    ASSERT_EQ(3u, recent.size());
+    ASSERT_EQ(anchor_mac(0), recent[0][0]);   // Messages 4, 6 and 8 of the second loop
+    ASSERT_EQ(anchor_mac(2), recent[1][0]);
+    ASSERT_EQ(anchor_mac(0), recent[2][0]);
+    return true;
+}
+
+// Shuffled chain: RCM puts neighbours next to each other
+bool test_reverse_cuthill_mckee_on_chain() {
+    const size_t count = 64;
+    std::vector<size_t> chain;   // chain[k] is the k-th node along the chain
+    for (size_t i = 0; i < count; i++) {
+        chain.push_back((i * 37) % count);
+    }
+    std::vector<std::string> nodes;
+    for (size_t i = 0; i < count; i++) {
+        nodes.push_back(anchor_mac(i));
+    }
+    nodes.push_back(anchor_mac(count));   // Never heard with another anchor
+    std::vector<std::vector<std::string>> observations;
+    for (size_t k = 0; k + 1 < count; k++) {
+        observations.push_back({anchor_mac(chain[k]), anchor_mac(chain[k + 1]), "ffffffffffff"});
+    }
+
+    std::vector<std::vector<size_t>> graph = covisibility_graph(observations, nodes);
+    ASSERT_EQ(1u, graph[chain[0]].size());
+    ASSERT_EQ(2u, graph[chain[1]].size());
+    ASSERT_TRUE(graph[count].empty());
+
+    std::vector<size_t> order = reverse_cuthill_mckee(graph);
+    ASSERT_EQ(count + 1, order.size());
+    ASSERT_EQ(count, order.back());   // Isolated nodes last
+    std::vector<size_t> identity(count + 1), position(count + 1);
+    for (size_t i = 0; i <= count; i++) {
+        identity[i] = i;
+        position[order[i]] = i;
+    }
+    ASSERT_EQ(1.0, mean_edge_span(graph, position));
+    ASSERT_TRUE(mean_edge_span(graph, identity) > 10.0);
+    return true;
+}
+
+// Compaction places anchors contiguously in the given order and keeps their state
+bool test_compact_keeps_state() {
+    AnchorRegistry registry;
+    for (size_t i = 0; i < 10; i++) {
+        registry.insert(make_anchor(i));
+    }
+    {
+        auto guard = registry.read();
+        guard.find(anchor_mac(3))->update_parameters(-70.0f, 5.0f);
+        guard.find(anchor_mac(3))->update_health(2.0f, 1500.0f);
+    }
+    AnchorState before = registry.read().find(anchor_mac(3))->snapshot();
+    KalmanFilter filter_before = registry.read().find(anchor_mac(3))->get_kalman();
+
+    std::vector<std::string> order = {anchor_mac(7), anchor_mac(3), "000000000000", anchor_mac(7), anchor_mac(0)};
+    ASSERT_EQ(10u, registry.compact(order));
+    ASSERT_EQ(10u, registry.size());
+
+    auto guard = registry.read();
+    Anchor* first = guard.find(anchor_mac(7));
+    ASSERT_TRUE(guard.find(anchor_mac(3)) == first + 1);
+    ASSERT_TRUE(guard.find(anchor_mac(0)) == first + 2);
+    for (size_t i = 0; i < 10; i++) {
+        Anchor* anchor = guard.find(anchor_mac(i));
+        ASSERT_TRUE(anchor != nullptr);
+        ASSERT_TRUE(anchor_gap(first, anchor) < 10);
+        ASSERT_EQ(static_cast<float>(i), std::get<0>(anchor->get_coord()));
+    }
+    AnchorState after = guard.find(anchor_mac(3))->snapshot();
+    ASSERT_EQ(before.RSSI_0, after.RSSI_0);
+    ASSERT_EQ(before.n, after.n);
+    ASSERT_EQ(before.ewma, after.ewma);
+    ASSERT_EQ(before.last_seen, after.last_seen);
+    ASSERT_EQ(before.version, after.version);
+    ASSERT_EQ(filter_before.get_Q_00(), guard.find(anchor_mac(3))->get_kalman().get_Q_00());
+    return true;
+}
+
+// Updates through an anchor obtained before the compaction land on the new copy
+bool test_updates_are_forwarded() {
+    AnchorRegistry registry;
+    for (size_t i = 0; i < 4; i++) {
+        registry.insert(make_anchor(i));
+    }
+    auto old_guard = registry.read();
+    Anchor* old_anchor = old_guard.find(anchor_mac(2));
+    uint32_t old_version = old_anchor->get_version();
+
+    registry.compact({});
+    Anchor* new_anchor = registry.read().find(anchor_mac(2));
+    ASSERT_TRUE(new_anchor != old_anchor);
+
+    old_anchor->update_health(3.0f, 2000.0f);
+    old_anchor->update_parameters(-65.0f, 2.0f);
+    old_anchor->restore_calibration(-61.0f, 2.5f, 0.5f, 2001.0f);
+    ASSERT_EQ(old_version, old_anchor->get_version());
+    ASSERT_EQ(old_version + 3, new_anchor->get_version());
+    ASSERT_EQ(-61.0f, new_anchor->get_RSSI_0());
+    ASSERT_EQ(2001.0f, new_anchor->get_last_seen());
+
+    // Relocating through the old anchor starts from the new copy's state
+    std::unique_ptr<Anchor> relocated = old_anchor->relocated(std::make_tuple(9.0f, 9.0f, 0.0f));
+    ASSERT_EQ(old_version + 4, relocated->get_version());
+    ASSERT_EQ(-61.0f, relocated->get_RSSI_0());
+    return true;
+}
+
+// Compacted anchors can still be replaced and removed; blocks are freed with their last anchor
+bool test_compacted_anchors_are_reclaimed() {
+    AnchorRegistry registry;
+    for (size_t i = 0; i < 8; i++) {
+        registry.insert(make_anchor(i));
+    }
+    registry.compact({});
+    registry.compact({anchor_mac(5)});
+
+    std::vector<std::unique_ptr<Anchor>> moved;
+    moved.push_back(registry.read().find(anchor_mac(1))->relocated(std::make_tuple(1.0f, 1.0f, 0.0f)));
+    ASSERT_EQ(1u, registry.replace_all(std::move(moved)));
+    ASSERT_TRUE(registry.remove(anchor_mac(4)));
+    ASSERT_EQ(7u, registry.size());
+    ASSERT_EQ(0u, registry.collect_garbage());
+    ASSERT_EQ(1.0f, std::get<1>(registry.read().find(anchor_mac(1))->get_coord()));
+    ASSERT_EQ(7u, registry.compact({}));
+    return true;
+}
+
+// No update is lost while anchors are moved under running writers
+bool test_concurrent_compaction_loses_no_updates() {
+    const size_t anchors = 32;
+    const size_t writers = 3;
+    const size_t updates = 4000;
+    AnchorRegistry registry;
+    for (size_t i = 0; i < anchors; i++) {
+        registry.insert(make_anchor(i));
+    }
+    uint32_t versions_before = 0;
+    for (size_t i = 0; i < anchors; i++) {
+        versions_before += registry.read().find(anchor_mac(i))->get_version();
+    }
+
+    std::atomic<bool> done{false};
+    std::thread compactor([&]() {
+        size_t rotation = 0;
+        while (!done.load()) {
+            std::vector<std::string> order;
+            for (size_t i = 0; i < anchors; i++) {
+                order.push_back(anchor_mac((i + rotation) % anchors));
+            }
+            registry.compact(order);
+            rotation++;
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; w++) {
+        threads.emplace_back([&, w]() {
+            for (size_t u = 0; u < updates; u++) {
+                auto guard = registry.read();
+                guard.find(anchor_mac((u * 7 + w) % anchors))->update_health(1.0f, 1000.0f + u);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done.store(true);
+    compactor.join();
+
+    uint32_t versions_after = 0;
+    for (size_t i = 0; i < anchors; i++) {
+        versions_after += registry.read().find(anchor_mac(i))->get_version();
+    }
+    ASSERT_EQ(versions_before + writers * updates, versions_after);
+    return true;
+}
+
+// The compactor groups anchors heard together, and leaves a good layout alone
+bool test_compactor_groups_covisible_anchors() {
+    ProcessingContext context;
+    const size_t groups = 16;
+    const size_t group_size = 4;
+    // Inserted round-robin, so the members of a group start far apart
+    for (size_t i = 0; i < groups * group_size; i++) {
+        context.anchors.insert(make_anchor((i % group_size) * groups + i / group_size));
+    }
+    AnchorCompactor compactor(context, 32, 0.2f);
+    ASSERT_TRUE(!compactor.compact());   // No samples yet
+    ASSERT_EQ(0u, compactor.stats().compactions);
+
+    CoVisibilityLog& log = context.covisibility;
+    for (size_t message = 0; message < 512 * Config::COVISIBILITY_SAMPLE_EVERY; message++) {
+        size_t group = (message / Config::COVISIBILITY_SAMPLE_EVERY) % groups;   // Every group gets sampled
+        auto guard = context.anchors.read();
+        std::vector<Anchor*> heard;
+        for (size_t member = 0; member < group_size; member++) {
+            heard.push_back(guard.find(anchor_mac(member * groups + group)));
+        }
+        log.record(heard);
+    }
+
+    ASSERT_TRUE(compactor.compact_async());
+    while (compactor.in_progress()) {
+        std::this_thread::yield();
+    }
+    AnchorCompactionStats stats = compactor.stats();
+    ASSERT_EQ(1u, stats.compactions);
+    ASSERT_EQ(groups * group_size, stats.anchors_moved);
+    ASSERT_TRUE(stats.span_after < stats.span_before);
+
+    auto guard = context.anchors.read();
+    for (size_t group = 0; group < groups; group++) {
+        const Anchor* head = guard.find(anchor_mac(group));
+        for (size_t member = 1; member < group_size; member++) {
+            ASSERT_TRUE(anchor_gap(head, guard.find(anchor_mac(member * groups + group))) < static_cast<long>(group_size));
+        }
+    }
+
+    ASSERT_TRUE(!compactor.compact());   // Already laid out
+    ASSERT_EQ(1u, compactor.stats().compactions);
+    ASSERT_EQ(2u + 1u, compactor.stats().passes);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "    ANCHOR LAYOUT TESTS STARTING  " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_covisibility_log", test_covisibility_log);
+    all_passed &= run_test("test_reverse_cuthill_mckee_on_chain", test_reverse_cuthill_mckee_on_chain);
+    all_passed &= run_test("test_compact_keeps_state", test_compact_keeps_state);
+    all_passed &= run_test("test_updates_are_forwarded", test_updates_are_forwarded);
+    all_passed &= run_test("test_compacted_anchors_are_reclaimed", test_compacted_anchors_are_reclaimed);
+    all_passed &= run_test("test_concurrent_compaction_loses_no_updates", test_concurrent_compaction_loses_no_updates);
+    all_passed &= run_test("test_compactor_groups_covisible_anchors", test_compactor_groups_covisible_anchors);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ANCHOR LAYOUT TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ANCHOR LAYOUT TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
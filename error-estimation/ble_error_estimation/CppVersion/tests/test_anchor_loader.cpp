@@ -0,0 +1,245 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <curl/curl.h>
+#include "../anchor_loader.h"
+#include "../http_client.h"
+#include "http_standin.h"
+#include "test_support.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Dongles [first, last) in the API's format, with the extra fields the real API returns
+std::string dongle_list(size_t first, size_t last) {
+    json list = json::array();
+    for (size_t i = first; i < last; i++) {
+        list.push_back({
+            {"id", i},
+            {"macAddress", synthetic_mac("ce59", i)},
+            {"name", "Dongle " + std::to_string(i)},
+            {"x", static_cast<float>(i % 100)},
+            {"y", static_cast<float>(i / 100)},
+            {"z", 2.5f},
+            {"tags", {{"floor", 1}, {"x", -1}}}
+        });
+    }
+    return list.dump();
+}
+
+// Query parameter of a request target, or -1 if missing
+long query_param(const std::string& target, const std::string& name) {
+    size_t pos = target.find(name + "=");
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    return std::stol(target.substr(pos + name.size() + 1));
+}
+
+// Stand-in for the dongles endpoint serving a site of total dongles, page by page
+HttpStandIn::Reply serve_site(const HttpStandIn::Request& request, size_t total, long failing_page = -1) {
+    HttpStandIn::Reply reply;
+    long page = query_param(request.target, "page");
+    long size = query_param(request.target, "size");
+    if (page < 0 || size <= 0 || request.headers.count("authorization") == 0) {
+        reply.status = 400;
+        return reply;
+    }
+    if (page == failing_page) {
+        reply.status = 503;
+        return reply;
+    }
+    size_t first = std::min(total, static_cast<size_t>(page * size));
+    size_t last = std::min(total, first + static_cast<size_t>(size));
+    reply.body = dongle_list(first, last);
+    return reply;
+}
+
+// Page fetcher going through the reactor's HTTP client, as the runner does at startup
+AnchorPageFetcher http_page_fetcher(HttpClient& http, const HttpStandIn& server, size_t page_size) {
+    return [&http, &server, page_size](size_t page) {
+        HttpResponse response = http.get_blocking(HttpRequest{
+            anchor_list_page_url(server.url("/confv1/api/dongles"), page, page_size), "admin", "secret"});
+        if (!response.ok()) {
+            throw std::runtime_error(response.error);
+        }
+        return response.body;
+    };
+}
+
+// Page parameters are appended to the endpoint, whatever query it already has
+bool test_anchor_list_page_url() {
+    ASSERT_EQ(std::string("https://host/api/dongles?page=2&size=500"),
+              anchor_list_page_url("https://host/api/dongles", 2, 500));
+    ASSERT_EQ(std::string("https://host/api/dongles?site=3&page=0&size=10"),
+              anchor_list_page_url("https://host/api/dongles?site=3", 0, 10));
+    return true;
+}
+
+// Only macAddress and coordinates are kept; incomplete entries are counted and skipped
+bool test_parse_dongle_list() {
+    DongleListPage page = parse_dongle_list(R"([
+        {"macAddress": "aa01", "x": 1, "y": 2.5, "z": 3, "meta": {"x": 99, "macAddress": "nested"}},
+        {"macAddress": "aa02", "x": 4.0, "y": 5.0},
+        {"x": 1, "y": 1, "z": 1},
+        {"name": "aa04", "macAddress": "aa04", "z": -1, "y": 0, "x": 7, "flags": [1, 2, {"z": 5}]}
+    ])");
+    ASSERT_EQ(4u, page.entries);
+    ASSERT_EQ(2u, page.anchors.size());
+    ASSERT_EQ(std::string("aa01"), page.anchors[0]->get_mac_address());
+    ASSERT_EQ(1.0f, std::get<0>(page.anchors[0]->get_coord()));
+    ASSERT_EQ(2.5f, std::get<1>(page.anchors[0]->get_coord()));
+    ASSERT_EQ(std::string("aa04"), page.anchors[1]->get_mac_address());
+    ASSERT_EQ(7.0f, std::get<0>(page.anchors[1]->get_coord()));
+    ASSERT_EQ(-1.0f, std::get<2>(page.anchors[1]->get_coord()));
+
+    ASSERT_EQ(0u, parse_dongle_list("[]").entries);
+
+    for (const char* invalid : {"{\"macAddress\": \"aa01\"}", "[{\"x\": 1", "not json"}) {
+        bool threw = false;
+        try {
+            parse_dongle_list(invalid);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+    }
+    return true;
+}
+
+// A large site loads in a few paginated requests instead of one per anchor
+bool test_bulk_load_large_site() {
+    const size_t total = 25000;
+    const size_t page_size = 1000;
+    HttpStandIn server([total](const HttpStandIn::Request& request) { return serve_site(request, total); });
+    Reactor reactor;
+    HttpClient http(reactor);
+    ProcessingContext context;
+
+    auto start = std::chrono::steady_clock::now();
+    SiteLoadResult result = load_site_anchors(context, http_page_fetcher(http, server, page_size), page_size, 100);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "(" << total << " anchors in " << elapsed_ms << "ms) ";
+
+    ASSERT_TRUE(result.complete);
+    ASSERT_EQ(total, result.entries);
+    ASSERT_EQ(total, result.anchors_added);
+    ASSERT_EQ(26u, result.pages);                 // 25 full pages, then an empty one
+    ASSERT_EQ(26u, server.requests());
+    ASSERT_EQ(total, context.anchors.size());
+    ASSERT_TRUE(context.anchors_initialized.load());
+
+    auto guard = context.anchors.read();
+    Anchor* anchor = guard.find(synthetic_mac("ce59", 12345));
+    ASSERT_TRUE(anchor != nullptr);
+    ASSERT_EQ(45.0f, std::get<0>(anchor->get_coord()));
+    ASSERT_EQ(123.0f, std::get<1>(anchor->get_coord()));
+    return true;
+}
+
+// A short last page ends the load; a server ignoring pagination is read in one request
+bool test_bulk_load_page_boundaries() {
+    HttpStandIn paged([](const HttpStandIn::Request& request) { return serve_site(request, 2500); });
+    HttpStandIn unpaged([](const HttpStandIn::Request&) {
+        HttpStandIn::Reply reply;
+        reply.body = dongle_list(0, 3000);
+        return reply;
+    });
+    Reactor reactor;
+    HttpClient http(reactor);
+
+    ProcessingContext paged_context;
+    SiteLoadResult paged_result = load_site_anchors(paged_context, http_page_fetcher(http, paged, 1000), 1000, 100);
+    ASSERT_TRUE(paged_result.complete);
+    ASSERT_EQ(3u, paged_result.pages);
+    ASSERT_EQ(2500u, paged_context.anchors.size());
+
+    ProcessingContext unpaged_context;
+    SiteLoadResult unpaged_result = load_site_anchors(unpaged_context, http_page_fetcher(http, unpaged, 1000), 1000, 100);
+    ASSERT_TRUE(unpaged_result.complete);
+    ASSERT_EQ(1u, unpaged_result.pages);
+    ASSERT_EQ(3000u, unpaged_context.anchors.size());
+    return true;
+}
+
+// A failed page keeps the anchors loaded so far; the rest fall back to per-MAC requests
+bool test_bulk_load_failure_keeps_loaded_pages() {
+    HttpStandIn server([](const HttpStandIn::Request& request) { return serve_site(request, 5000, 2); });
+    Reactor reactor;
+    HttpClient http(reactor);
+
+    ProcessingContext context;
+    SiteLoadResult result = load_site_anchors(context, http_page_fetcher(http, server, 1000), 1000, 100);
+    ASSERT_TRUE(!result.complete);
+    ASSERT_EQ(std::string("HTTP request failed with status: 503"), result.error);
+    ASSERT_EQ(2u, result.pages);
+    ASSERT_EQ(2000u, context.anchors.size());
+    ASSERT_TRUE(context.anchors_initialized.load());
+
+    // Nothing loaded: the first message still discovers anchors itself
+    ProcessingContext empty_context;
+    SiteLoadResult refused = load_site_anchors(empty_context, [](size_t) -> std::string {
+        throw std::runtime_error("CURL request failed: Couldn't connect to server");
+    });
+    ASSERT_TRUE(!refused.complete);
+    ASSERT_EQ(0u, refused.pages);
+    ASSERT_TRUE(!empty_context.anchors_initialized.load());
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    std::cout << "==================================" << std::endl;
+    std::cout << "   ANCHOR LOADER TESTS STARTING   " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_anchor_list_page_url", test_anchor_list_page_url);
+    all_passed &= run_test("test_parse_dongle_list", test_parse_dongle_list);
+    all_passed &= run_test("test_bulk_load_large_site", test_bulk_load_large_site);
+    all_passed &= run_test("test_bulk_load_page_boundaries", test_bulk_load_page_boundaries);
+    all_passed &= run_test("test_bulk_load_failure_keeps_loaded_pages", test_bulk_load_failure_keeps_loaded_pages);
+
+    curl_global_cleanup();
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ANCHOR LOADER TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ANCHOR LOADER TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
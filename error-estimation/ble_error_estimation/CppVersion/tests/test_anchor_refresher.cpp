@@ -0,0 +1,222 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <functional>
+#include <curl/curl.h>
+#include "../anchor_refresher.h"
+#include "http_standin.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Dongles endpoint with per-page ETags that answers conditional requests with 304
+struct FakeSite {
+    struct Dongle {
+        std::string mac;
+        float x, y, z;
+    };
+
+    std::mutex mutex;
+    std::vector<Dongle> dongles;
+    std::vector<std::string> if_none_match;   // Validators received, one per request ("" when absent)
+    std::vector<std::string> accept_encoding;
+
+    explicit FakeSite(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            dongles.push_back({"d" + std::to_string(i), static_cast<float>(i % 50), static_cast<float>(i / 50), 2.5f});
+        }
+    }
+
+    void move(size_t index, float x, float y) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dongles[index].x = x;
+        dongles[index].y = y;
+    }
+
+    void add(const std::string& mac, float x, float y) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dongles.push_back({mac, x, y, 2.5f});
+    }
+
+    HttpStandIn::Reply serve(const HttpStandIn::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t page = std::stoul(request.target.substr(request.target.find("page=") + 5));
+        size_t size = std::stoul(request.target.substr(request.target.find("size=") + 5));
+
+        json list = json::array();
+        for (size_t i = page * size; i < std::min(dongles.size(), (page + 1) * size); i++) {
+            list.push_back({{"macAddress", dongles[i].mac}, {"x", dongles[i].x}, {"y", dongles[i].y}, {"z", dongles[i].z}});
+        }
+        std::string body = list.dump();
+        std::string etag = "\"" + std::to_string(std::hash<std::string>()(body)) + "\"";
+
+        auto header = [&request](const std::string& name) {
+            auto it = request.headers.find(name);
+            return it == request.headers.end() ? std::string() : it->second;
+        };
+        if_none_match.push_back(header("if-none-match"));
+        accept_encoding.push_back(header("accept-encoding"));
+
+        HttpStandIn::Reply reply;
+        reply.headers = {{"ETag", etag}, {"Last-Modified", "Wed, 01 Oct 2025 08:00:00 GMT"}};
+        if (header("if-none-match") == etag) {
+            reply.status = 304;
+            return reply;
+        }
+        reply.body = body;
+        return reply;
+    }
+};
+
+// Run one refresh pass on the calling thread
+bool refresh_once(Reactor& reactor, AnchorRefresher& refresher) {
+    bool done = false;
+    if (!refresher.refresh([&done]() { done = true; })) {
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        reactor.run_once(10);
+    }
+    return done;
+}
+
+// The first pass downloads everything; later passes cost 304s only
+bool test_unchanged_site_costs_304s() {
+    FakeSite site(2500);
+    HttpStandIn server([&site](const HttpStandIn::Request& request) { return site.serve(request); });
+    Reactor reactor;
+    HttpClient http(reactor);
+    ProcessingContext context;
+    AnchorRefresher refresher(context, http, server.url("/confv1/api/dongles"), "admin", "secret", 1000, 100);
+
+    ASSERT_TRUE(refresh_once(reactor, refresher));
+    ASSERT_EQ(2500u, context.anchors.size());
+    ASSERT_EQ(2500u, refresher.stats().anchors_added);
+    ASSERT_EQ(3u, refresher.stats().pages_requested);
+    ASSERT_TRUE(context.anchors_initialized.load());
+    size_t first_bytes = refresher.stats().bytes_received;
+    ASSERT_TRUE(first_bytes > 0);
+
+    ASSERT_TRUE(refresh_once(reactor, refresher));
+    ASSERT_EQ(6u, refresher.stats().pages_requested);
+    ASSERT_EQ(3u, refresher.stats().pages_not_modified);
+    ASSERT_EQ(first_bytes, refresher.stats().bytes_received);
+    ASSERT_EQ(0u, refresher.stats().anchors_moved);
+
+    std::lock_guard<std::mutex> lock(site.mutex);
+    ASSERT_EQ(6u, site.if_none_match.size());
+    ASSERT_TRUE(site.if_none_match[0].empty());
+    ASSERT_TRUE(!site.if_none_match[3].empty());
+    ASSERT_TRUE(!site.accept_encoding[0].empty());   // Compressed responses requested
+    return true;
+}
+
+// Only changed pages are downloaded; moved dongles are relocated, others untouched
+bool test_changes_applied_as_diffs() {
+    FakeSite site(2500);
+    HttpStandIn server([&site](const HttpStandIn::Request& request) { return site.serve(request); });
+    Reactor reactor;
+    HttpClient http(reactor);
+    ProcessingContext context;
+    AnchorRefresher refresher(context, http, server.url("/confv1/api/dongles"), "admin", "secret", 1000, 100);
+    ASSERT_TRUE(refresh_once(reactor, refresher));
+
+    Anchor* untouched_before = context.anchors.read().find("d10");
+    uint32_t moved_version = context.anchors.read().find("d1234")->get_version();
+    context.anchors.read().find("d1234")->restore_calibration(-61.0f, 2.4f, 9.0f, 100.0f);
+
+    site.move(1234, 40.0f, 41.0f);
+    site.move(1500, 1500 % 50 + 0.001f, 1500 / 50);   // Within tolerance
+    site.add("d_new", 3.0f, 4.0f);
+    ASSERT_TRUE(refresh_once(reactor, refresher));
+
+    ASSERT_EQ(1u, refresher.stats().anchors_moved);
+    ASSERT_EQ(2501u, refresher.stats().anchors_added);
+    ASSERT_EQ(1u, refresher.stats().pages_not_modified);   // Page 0 only
+    ASSERT_EQ(2501u, context.anchors.size());
+
+    auto guard = context.anchors.read();
+    Anchor* moved = guard.find("d1234");
+    ASSERT_EQ(40.0f, std::get<0>(moved->get_coord()));
+    ASSERT_EQ(41.0f, std::get<1>(moved->get_coord()));
+    ASSERT_TRUE(moved->get_version() > moved_version);
+    ASSERT_EQ(-61.0f, moved->get_RSSI_0());                 // Calibration kept
+    ASSERT_EQ(1.0f, moved->get_ewma());                     // Health restarted
+    ASSERT_TRUE(guard.find("d10") == untouched_before);
+    ASSERT_EQ(30.0f, std::get<1>(guard.find("d1500")->get_coord()));
+    ASSERT_TRUE(guard.find("d_new") != nullptr);
+    return true;
+}
+
+// A failed page ends the pass; the next pass starts over
+bool test_failed_pass_is_retried() {
+    Reactor reactor;
+    HttpClient http(reactor);
+    ProcessingContext context;
+    AnchorRefresher refresher(context, http, "http://127.0.0.1:1/confv1/api/dongles", "", "", 1000, 100);
+
+    ASSERT_TRUE(refresh_once(reactor, refresher));
+    ASSERT_EQ(1u, refresher.stats().failures);
+    ASSERT_TRUE(!refresher.in_progress());
+    ASSERT_TRUE(!context.anchors_initialized.load());
+
+    ASSERT_TRUE(refresher.refresh());
+    ASSERT_TRUE(!refresher.refresh());   // Already running
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    std::cout << "==================================" << std::endl;
+    std::cout << "  ANCHOR REFRESHER TESTS STARTING " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_unchanged_site_costs_304s", test_unchanged_site_costs_304s);
+    all_passed &= run_test("test_changes_applied_as_diffs", test_changes_applied_as_diffs);
+    all_passed &= run_test("test_failed_pass_is_retried", test_failed_pass_is_retried);
+
+    curl_global_cleanup();
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ANCHOR REFRESHER TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ANCHOR REFRESHER TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
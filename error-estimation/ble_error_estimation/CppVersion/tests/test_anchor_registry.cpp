@@ -0,0 +1,217 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include "../anchor_registry.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+std::unique_ptr<Anchor> make_anchor(const std::string& mac, float x = 0.0f) {
+    return std::make_unique<Anchor>(mac, std::make_tuple(x, 0.0f, 0.0f), 1000.0f);
+}
+
+// Anchors are found by MAC through a read guard
+bool test_insert_and_find() {
+    AnchorRegistry registry;
+    ASSERT_EQ(0u, registry.size());
+
+    ASSERT_TRUE(registry.insert(make_anchor("ce59ac2d9cc5", 1.0f)));
+    ASSERT_TRUE(registry.insert(make_anchor("e7a7f022204d", 2.0f)));
+    ASSERT_EQ(2u, registry.size());
+
+    auto guard = registry.read();
+    Anchor* anchor = guard.find("e7a7f022204d");
+    ASSERT_TRUE(anchor != nullptr);
+    ASSERT_EQ(2.0f, std::get<0>(anchor->get_coord()));
+    ASSERT_TRUE(guard.find("000000000000") == nullptr);
+    ASSERT_EQ(2u, guard.anchors().size());
+    return true;
+}
+
+// A second anchor with the same MAC is discarded; the first one stays
+bool test_duplicate_insert_keeps_existing() {
+    AnchorRegistry registry;
+    ASSERT_TRUE(registry.insert(make_anchor("aabbccddeeff", 1.0f)));
+    ASSERT_TRUE(!registry.insert(make_anchor("aabbccddeeff", 9.0f)));
+
+    std::vector<std::unique_ptr<Anchor>> batch;
+    batch.push_back(make_anchor("aabbccddeeff", 9.0f));
+    batch.push_back(make_anchor("112233445566", 3.0f));
+    batch.push_back(nullptr);
+    ASSERT_EQ(1u, registry.insert_all(std::move(batch)));
+    ASSERT_EQ(2u, registry.size());
+
+    auto guard = registry.read();
+    ASSERT_EQ(1.0f, std::get<0>(guard.find("aabbccddeeff")->get_coord()));
+    return true;
+}
+
+// A guard keeps seeing the version it pinned while writers publish new ones
+bool test_guard_sees_stable_version() {
+    AnchorRegistry registry;
+    registry.insert(make_anchor("a"));
+
+    auto guard = registry.read();
+    registry.insert(make_anchor("b"));
+    registry.remove("a");
+
+    ASSERT_EQ(1u, guard.size());
+    ASSERT_TRUE(guard.find("a") != nullptr);
+    ASSERT_TRUE(guard.find("b") == nullptr);
+
+    auto fresh = registry.read();
+    ASSERT_TRUE(fresh.find("a") == nullptr);
+    ASSERT_TRUE(fresh.find("b") != nullptr);
+    return true;
+}
+
+// Removed anchors and old versions are freed only after pinned readers leave
+bool test_reclamation_waits_for_readers() {
+    AnchorRegistry registry;
+    registry.insert(make_anchor("a"));
+    registry.collect_garbage();
+    ASSERT_EQ(0u, registry.pending_reclamation());
+
+    {
+        auto guard = registry.read();
+        Anchor* pinned = guard.find("a");
+        ASSERT_TRUE(registry.remove("a"));
+        ASSERT_TRUE(!registry.remove("a"));
+        ASSERT_TRUE(registry.pending_reclamation() > 0);
+        ASSERT_TRUE(registry.collect_garbage() > 0);
+        // Still safe to use
+        ASSERT_EQ(std::string("a"), pinned->get_mac_address());
+    }
+
+    ASSERT_EQ(0u, registry.collect_garbage());
+    ASSERT_EQ(0u, registry.size());
+    return true;
+}
+
+// Replaced anchors take their MAC's place; readers holding the old one keep it until they leave
+bool test_replace_all() {
+    AnchorRegistry registry;
+    registry.insert(make_anchor("a", 1.0f));
+    registry.insert(make_anchor("b", 2.0f));
+
+    auto guard = registry.read();
+    Anchor* old_a = guard.find("a");
+
+    std::vector<std::unique_ptr<Anchor>> batch;
+    batch.push_back(make_anchor("a", 5.0f));
+    batch.push_back(make_anchor("c", 3.0f));
+    batch.push_back(nullptr);
+    ASSERT_EQ(1u, registry.replace_all(std::move(batch)));
+    ASSERT_EQ(3u, registry.size());
+
+    // Still the pinned version, and the old anchor is still valid
+    ASSERT_TRUE(guard.find("a") == old_a);
+    ASSERT_EQ(1.0f, std::get<0>(old_a->get_coord()));
+    ASSERT_TRUE(registry.collect_garbage() > 0);
+
+    auto fresh = registry.read();
+    ASSERT_EQ(5.0f, std::get<0>(fresh.find("a")->get_coord()));
+    ASSERT_EQ(2.0f, std::get<0>(fresh.find("b")->get_coord()));
+    ASSERT_TRUE(fresh.find("c") != nullptr);
+    return true;
+}
+
+// Readers keep resolving anchors while a writer adds a whole site and removes some
+bool test_concurrent_readers_and_writer() {
+    AnchorRegistry registry;
+    registry.insert(make_anchor("stable", 7.0f));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> failures{0};
+    std::atomic<long> lookups{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto guard = registry.read();
+                Anchor* anchor = guard.find("stable");
+                if (!anchor || std::get<0>(anchor->get_coord()) != 7.0f) {
+                    failures++;
+                }
+                for (const auto& [mac, site_anchor] : guard.anchors()) {
+                    if (site_anchor->get_mac_address() != mac) {
+                        failures++;
+                    }
+                }
+                lookups++;
+            }
+        });
+    }
+
+    for (int i = 0; i < 500; i++) {
+        registry.insert(make_anchor("site" + std::to_string(i)));
+        if (i % 3 == 0) {
+            registry.remove("site" + std::to_string(i));
+        }
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQ(0, failures.load());
+    ASSERT_TRUE(lookups.load() > 0);
+    ASSERT_EQ(1u + 500u - 167u, registry.size());
+    ASSERT_EQ(0u, registry.collect_garbage());
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "  ANCHOR REGISTRY TESTS STARTING  " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_insert_and_find", test_insert_and_find);
+    all_passed &= run_test("test_duplicate_insert_keeps_existing", test_duplicate_insert_keeps_existing);
+    all_passed &= run_test("test_guard_sees_stable_version", test_guard_sees_stable_version);
+    all_passed &= run_test("test_reclamation_waits_for_readers", test_reclamation_waits_for_readers);
+    all_passed &= run_test("test_replace_all", test_replace_all);
+    all_passed &= run_test("test_concurrent_readers_and_writer", test_concurrent_readers_and_writer);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ANCHOR REGISTRY TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ANCHOR REGISTRY TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
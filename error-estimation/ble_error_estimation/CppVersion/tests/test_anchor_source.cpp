@@ -0,0 +1,263 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include <curl/curl.h>
+#include "../anchor_source.h"
+#include "http_standin.h"
+
+namespace fs = std::filesystem;
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Per-test file under the temp directory, removed when the test ends
+struct SurveyFile {
+    fs::path path;
+
+    SurveyFile(const std::string& name, const std::string& content)
+        : path(fs::temp_directory_path() / ("ble_survey_test_" + std::to_string(getpid()) + "_" + name)) {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    ~SurveyFile() {
+        std::error_code ignored;
+        fs::remove(path, ignored);
+    }
+};
+
+// MAC address of the i-th dongle of a generated site
+std::string survey_mac(size_t index) {
+    char mac[24];
+    snprintf(mac, sizeof(mac), "c4%010zx", index);
+    return mac;
+}
+
+// CSV rows: header, comments, blank lines, CRLF and quoted fields are tolerated; bad rows are counted and skipped
+bool test_parse_csv_survey() {
+    std::string csv = "mac,x,y,z\r\n"
+                      "# Floor 1\n"
+                      "aa01,1.5,2,3\r\n"
+                      "\n"
+                      " \"aa02\" , -4 , 5.25 , 2.5 ,ignored\n"
+                      "aa03,1,2\n"
+                      "aa04,one,2,3\n"
+                      ",1,2,3\n"
+                      "aa05,0,0,0";
+    DongleListPage page = parse_site_survey(csv.data(), csv.size(), detect_site_survey_format(csv.data(), csv.size()));
+    ASSERT_EQ(6u, page.entries);
+    ASSERT_EQ(3u, page.anchors.size());
+    ASSERT_EQ(std::string("aa01"), page.anchors[0]->get_mac_address());
+    ASSERT_EQ(1.5f, std::get<0>(page.anchors[0]->get_coord()));
+    ASSERT_EQ(std::string("aa02"), page.anchors[1]->get_mac_address());
+    ASSERT_EQ(-4.0f, std::get<0>(page.anchors[1]->get_coord()));
+    ASSERT_EQ(5.25f, std::get<1>(page.anchors[1]->get_coord()));
+    ASSERT_EQ(std::string("aa05"), page.anchors[2]->get_mac_address());
+
+    // Without a header the first row is data
+    std::string headerless = "bb01,1,2,3\n";
+    ASSERT_EQ(1u, parse_site_survey(headerless.data(), headerless.size(), SiteSurveyFormat::Csv).anchors.size());
+    return true;
+}
+
+// The layout is detected from the content, not the file name
+bool test_detect_format_and_load_json() {
+    std::string json_survey = "\n  [{\"macAddress\": \"aa01\", \"x\": 1, \"y\": 2, \"z\": 3, \"name\": \"hall\"}]";
+    ASSERT_TRUE(detect_site_survey_format(json_survey.data(), json_survey.size()) == SiteSurveyFormat::Json);
+    ASSERT_TRUE(detect_site_survey_format("aa01,1,2,3", 10) == SiteSurveyFormat::Csv);
+    ASSERT_TRUE(detect_site_survey_format(SITE_SURVEY_MAGIC, sizeof(SITE_SURVEY_MAGIC)) == SiteSurveyFormat::Binary);
+
+    SurveyFile file("site.txt", json_survey);
+    SiteSurveyFileSource source(file.path.string());
+    ProcessingContext context;
+    SiteLoadResult result = source.load(context);
+    ASSERT_TRUE(result.complete);
+    ASSERT_EQ(1u, result.anchors_added);
+    ASSERT_TRUE(context.anchors_initialized.load());
+    ASSERT_EQ(2.0f, std::get<1>(context.anchors.read().find("aa01")->get_coord()));
+    return true;
+}
+
+// 100k anchors load from a memory-mapped file in milliseconds, binary and CSV alike
+bool test_large_survey_loads_fast() {
+    const size_t total = 100000;
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    std::vector<const Anchor*> views;
+    std::string csv = "mac,x,y,z\n";
+    for (size_t i = 0; i < total; i++) {
+        anchors.push_back(std::make_unique<Anchor>(survey_mac(i), std::make_tuple(static_cast<float>(i % 100),
+                                                   static_cast<float>(i / 100), 2.5f), 0.0f));
+        views.push_back(anchors.back().get());
+        csv += survey_mac(i) + "," + std::to_string(i % 100) + "," + std::to_string(i / 100) + ",2.5\n";
+    }
+
+    SurveyFile binary_file("site.bin", "");
+    write_site_survey(binary_file.path.string(), views);
+    ASSERT_EQ(sizeof(SiteSurveyHeader) + total * sizeof(SiteSurveyRecord), fs::file_size(binary_file.path));
+    SurveyFile csv_file("site.csv", csv);
+
+    for (const SurveyFile* file : {&binary_file, &csv_file}) {
+        SiteSurveyFileSource source(file->path.string());
+        ProcessingContext context;
+        auto start = std::chrono::steady_clock::now();
+        SiteLoadResult result = source.load(context);
+        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "(" << file->path.extension().string() << ": " << total << " anchors in " << elapsed_ms << "ms) ";
+
+        ASSERT_TRUE(result.complete);
+        ASSERT_EQ(total, result.entries);
+        ASSERT_EQ(total, context.anchors.size());
+        ASSERT_TRUE(elapsed_ms < 1000);
+        Anchor* anchor = context.anchors.read().find(survey_mac(54321));
+        ASSERT_TRUE(anchor != nullptr);
+        ASSERT_EQ(21.0f, std::get<0>(anchor->get_coord()));
+        ASSERT_EQ(543.0f, std::get<1>(anchor->get_coord()));
+    }
+    return true;
+}
+
+// Missing, truncated or foreign files fail the load without throwing
+bool test_survey_errors() {
+    ProcessingContext context;
+    SiteSurveyFileSource missing("/nonexistent/site.csv");
+    SiteLoadResult result = missing.load(context);
+    ASSERT_TRUE(!result.complete);
+    ASSERT_TRUE(!result.error.empty());
+    ASSERT_TRUE(!context.anchors_initialized.load());
+
+    std::string truncated(SITE_SURVEY_MAGIC, sizeof(SITE_SURVEY_MAGIC));
+    truncated += std::string("\x01\x00\x00\x00\x05\x00\x00\x00", 8);   // Version 1, 5 records, none present
+    SurveyFile truncated_file("truncated.bin", truncated);
+    SiteLoadResult truncated_result = SiteSurveyFileSource(truncated_file.path.string()).load(context);
+    ASSERT_TRUE(!truncated_result.complete);
+    ASSERT_EQ(0u, context.anchors.size());
+
+    SurveyFile empty_file("empty.csv", "");
+    ASSERT_TRUE(SiteSurveyFileSource(empty_file.path.string()).load(context).complete);
+
+    // A survey knows the whole site: unknown MACs are reported, not fetched
+    std::string error;
+    SiteSurveyFileSource(empty_file.path.string()).fetch("aa99", [&error](std::string, std::string fetch_error) {
+        error = fetch_error;
+    });
+    ASSERT_TRUE(error.find("aa99") != std::string::npos);
+    return true;
+}
+
+// The in-memory source feeds the resolver the same way the API does
+bool test_memory_source_with_resolver() {
+    MemoryAnchorSource source;
+    source.add("aa01", std::make_tuple(1.0f, 2.0f, 3.0f));
+    source.add("aa02", std::make_tuple(4.0f, 5.0f, 6.0f));
+    source.add("aa02", std::make_tuple(7.0f, 8.0f, 9.0f));   // Moved before loading
+
+    ProcessingContext lazy_context;
+    AnchorResolver resolver(lazy_context, source.fetcher());
+    resolver.prefetch({"aa02", "unknown"});
+    ASSERT_EQ(2u, source.fetches());
+    ASSERT_EQ(0u, resolver.in_flight());
+    ASSERT_EQ(1u, lazy_context.anchors.size());
+    ASSERT_EQ(7.0f, std::get<0>(lazy_context.anchors.read().find("aa02")->get_coord()));
+
+    ProcessingContext loaded_context;
+    SiteLoadResult result = source.load(loaded_context);
+    ASSERT_TRUE(result.complete);
+    ASSERT_EQ(2u, result.anchors_added);
+    ASSERT_TRUE(loaded_context.anchors_initialized.load());
+    return true;
+}
+
+// The API source loads the paginated list and fetches single MACs through the reactor
+bool test_http_source() {
+    HttpStandIn server([](const HttpStandIn::Request& request) {
+        HttpStandIn::Reply reply;
+        if (request.target.find("macAddress=") != std::string::npos) {
+            reply.body = R"([{"macAddress": "late01", "x": 9, "y": 8, "z": 7}])";
+        } else if (request.target.find("page=0") != std::string::npos) {
+            reply.body = R"([{"macAddress": "aa01", "x": 1, "y": 2, "z": 3}])";
+        } else {
+            reply.body = "[]";
+        }
+        return reply;
+    });
+    Reactor reactor;
+    HttpClient http(reactor);
+    HttpAnchorSource source(reactor, http, server.url("/confv1/api/dongles?macAddress={}"),
+                            server.url("/confv1/api/dongles"), "admin", "secret", 1, 10);
+    ProcessingContext context;
+
+    SiteLoadResult result = source.load(context);
+    ASSERT_TRUE(result.complete);
+    ASSERT_EQ(2u, result.pages);
+    ASSERT_EQ(1u, context.anchors.size());
+
+    AnchorResolver resolver(context, source.fetcher());
+    resolver.prefetch({"late01"});
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (resolver.in_flight() > 0 && std::chrono::steady_clock::now() < deadline) {
+        reactor.run_once(10);
+    }
+    ASSERT_EQ(0u, resolver.in_flight());
+    ASSERT_EQ(9.0f, std::get<0>(context.anchors.read().find("late01")->get_coord()));
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    std::cout << "==================================" << std::endl;
+    std::cout << "    ANCHOR SOURCE TESTS STARTING  " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_parse_csv_survey", test_parse_csv_survey);
+    all_passed &= run_test("test_detect_format_and_load_json", test_detect_format_and_load_json);
+    all_passed &= run_test("test_large_survey_loads_fast", test_large_survey_loads_fast);
+    all_passed &= run_test("test_survey_errors", test_survey_errors);
+    all_passed &= run_test("test_memory_source_with_resolver", test_memory_source_with_resolver);
+    all_passed &= run_test("test_http_source", test_http_source);
+
+    curl_global_cleanup();
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL ANCHOR SOURCE TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME ANCHOR SOURCE TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,252 @@
+/* Compiled as C99: checks the header from C as well as the library behind it */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../ble_rssi.h"
+
+/* Simple testing framework macros */
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            fprintf(stderr, "FAIL: Expected %g but got %g at line %d\n", \
+                    (double)(expected), (double)(actual), __LINE__); \
+            return 0; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "FAIL: Expected condition to be true at line %d\n", __LINE__); \
+            return 0; \
+        } \
+    } while(0)
+
+/* Simple test runner function */
+static int run_test(const char* test_name, int (*test_func)(void)) {
+    int result;
+    printf("Running %s... ", test_name);
+    fflush(stdout);
+    result = test_func();
+    printf(result ? "PASS\n" : "FAIL\n");
+    return result;
+}
+
+static const ble_rssi_anchor SITE[] = {
+    {"a1", 0.0f, 0.0f, 2.5f},
+    {"a2", 10.0f, 0.0f, 2.5f},
+    {"a3", 10.0f, 8.0f, 2.5f},
+    {"a4", 0.0f, 8.0f, 2.5f}
+};
+#define SITE_SIZE (sizeof(SITE) / sizeof(SITE[0]))
+
+static const ble_rssi_reading READINGS[] = {
+    {"a1", -57.0f},
+    {"a2", -66.0f},
+    {"a3", -70.0f},
+    {"a4", -63.0f}
+};
+
+static ble_rssi_observation observation(const char* tag_mac, float x, double timestamp) {
+    ble_rssi_observation obs;
+    obs.tag_mac = tag_mac;
+    obs.x = x;
+    obs.y = 3.0f;
+    obs.z = 1.2f;
+    obs.timestamp = timestamp;
+    obs.readings = READINGS;
+    obs.reading_count = sizeof(READINGS) / sizeof(READINGS[0]);
+    return obs;
+}
+
+/* Library and header agree on the ABI */
+static int test_abi_version(void) {
+    ASSERT_EQ(BLE_RSSI_ABI_VERSION, ble_rssi_abi_version());
+    ASSERT_TRUE(strcmp(ble_rssi_status_message(BLE_RSSI_OK), "ok") == 0);
+    ASSERT_TRUE(strcmp(ble_rssi_status_message(-1), "unknown status") == 0);
+    return 1;
+}
+
+/* Registered anchors are counted once; invalid entries register nothing */
+static int test_register_anchors(void) {
+    ble_rssi_context* ctx = ble_rssi_create();
+    ble_rssi_anchor bad[2] = {{"b1", 0.0f, 0.0f, 0.0f}, {"0123456789abcdef", 0.0f, 0.0f, 0.0f}};
+    size_t added = 0;
+    ASSERT_TRUE(ctx != NULL);
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(ctx, SITE, SITE_SIZE, &added));
+    ASSERT_EQ(SITE_SIZE, added);
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(ctx, SITE, 2, &added));
+    ASSERT_EQ(0, added);
+    ASSERT_EQ(BLE_RSSI_INVALID_ARGUMENT, ble_rssi_register_anchors(ctx, bad, 2, &added));
+    ASSERT_EQ(SITE_SIZE, ble_rssi_anchor_count(ctx));
+    ASSERT_EQ(BLE_RSSI_INVALID_ARGUMENT, ble_rssi_register_anchors(NULL, SITE, SITE_SIZE, NULL));
+
+    ble_rssi_destroy(ctx);
+    return 1;
+}
+
+/* A batch yields one estimate per observation, and the latest one per tag is kept */
+static int test_submit_batch(void) {
+    ble_rssi_context* ctx = ble_rssi_create();
+    ble_rssi_observation batch[3];
+    ble_rssi_estimate estimates[3];
+    ble_rssi_estimate latest;
+    ble_rssi_anchor_state state;
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(ctx, SITE, SITE_SIZE, NULL));
+    batch[0] = observation("tag1", 4.0f, 1700000000.0);
+    batch[1] = observation("tag2", 6.0f, 1700000000.5);
+    batch[2] = observation("tag1", 4.5f, 1700000001.0);
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(ctx, batch, 3, estimates));
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(BLE_RSSI_OK, estimates[i].status);
+        ASSERT_TRUE(estimates[i].error_estimate > 0.0f);
+        ASSERT_TRUE(estimates[i].error_estimate <= 8.0f);
+        ASSERT_EQ(3, estimates[i].anchor_count);   /* a3 is over 10 dB below a1 */
+    }
+    ASSERT_TRUE(strcmp(estimates[1].tag_mac, "tag2") == 0);
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_estimate(ctx, "tag1", &latest));
+    ASSERT_EQ(estimates[2].error_estimate, latest.error_estimate);
+    ASSERT_EQ(1700000001.0, latest.timestamp);
+    ASSERT_EQ(BLE_RSSI_NOT_FOUND, ble_rssi_get_estimate(ctx, "tag9", &latest));
+
+    /* Every observation updated the anchors' health and calibration */
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_anchor_state(ctx, "a1", &state));
+    ASSERT_TRUE(state.version >= 3);
+    ASSERT_EQ(BLE_RSSI_NOT_FOUND, ble_rssi_get_anchor_state(ctx, "zz", &state));
+
+    ble_rssi_destroy(ctx);
+    return 1;
+}
+
+/* Bad observations get their own status without failing the rest of the batch */
+static int test_observation_status(void) {
+    ble_rssi_context* ctx = ble_rssi_create();
+    ble_rssi_reading unknown[1] = {{"x9", -60.0f}};
+    ble_rssi_observation batch[3];
+    ble_rssi_estimate estimates[3];
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(ctx, SITE, SITE_SIZE, NULL));
+    batch[0] = observation("0123456789abcdef", 4.0f, 1700000000.0);
+    batch[1] = observation("tag1", 4.0f, 1700000000.0);
+    batch[1].readings = unknown;
+    batch[1].reading_count = 1;
+    batch[2] = observation("tag2", 4.0f, 1700000000.0);
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(ctx, batch, 3, estimates));
+
+    ASSERT_EQ(BLE_RSSI_INVALID_ARGUMENT, estimates[0].status);
+    ASSERT_EQ(BLE_RSSI_NO_KNOWN_ANCHORS, estimates[1].status);
+    ASSERT_EQ(BLE_RSSI_OK, estimates[2].status);
+    ASSERT_EQ(BLE_RSSI_INVALID_ARGUMENT, ble_rssi_submit(ctx, NULL, 1, estimates));
+
+    /* Estimates are optional */
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(ctx, batch + 2, 1, NULL));
+
+    ble_rssi_destroy(ctx);
+    return 1;
+}
+
+/* An imported snapshot continues exactly where the exporting context stopped */
+static int test_export_import_state(void) {
+    ble_rssi_context* source = ble_rssi_create();
+    ble_rssi_context* target = ble_rssi_create();
+    ble_rssi_observation obs;
+    ble_rssi_estimate from_source;
+    ble_rssi_estimate from_target;
+    ble_rssi_anchor_state source_state;
+    ble_rssi_anchor_state target_state;
+    size_t size = 0;
+    size_t imported = 0;
+    char* snapshot;
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(source, SITE, SITE_SIZE, NULL));
+    for (int i = 0; i < 20; i++) {
+        obs = observation("tag1", 2.0f + 0.3f * (float)i, 1700000000.0 + i);
+        ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(source, &obs, 1, NULL));
+    }
+
+    ASSERT_EQ(BLE_RSSI_BUFFER_TOO_SMALL, ble_rssi_export_state(source, NULL, 0, &size));
+    ASSERT_TRUE(size > 0);
+    snapshot = (char*)malloc(size);
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_export_state(source, snapshot, size, &size));
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_import_state(target, snapshot, size, &imported));
+    ASSERT_EQ(SITE_SIZE, imported);
+    ASSERT_EQ(SITE_SIZE, ble_rssi_anchor_count(target));
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_anchor_state(source, "a2", &source_state));
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_anchor_state(target, "a2", &target_state));
+    ASSERT_EQ(source_state.rssi_0, target_state.rssi_0);
+    ASSERT_EQ(source_state.n, target_state.n);
+    ASSERT_EQ(source_state.ewma, target_state.ewma);
+    ASSERT_EQ(source_state.version, target_state.version);
+
+    /* The Kalman filters were carried over too: both contexts now evolve identically */
+    for (int i = 0; i < 10; i++) {
+        obs = observation("tag1", 7.0f - 0.4f * (float)i, 1700000100.0 + i);
+        ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(source, &obs, 1, &from_source));
+        ASSERT_EQ(BLE_RSSI_OK, ble_rssi_submit(target, &obs, 1, &from_target));
+        ASSERT_EQ(from_source.error_estimate, from_target.error_estimate);
+    }
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_anchor_state(source, "a3", &source_state));
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_get_anchor_state(target, "a3", &target_state));
+    ASSERT_EQ(source_state.rssi_0, target_state.rssi_0);
+    ASSERT_EQ(source_state.n, target_state.n);
+
+    /* Importing into a context that knows the anchors restores them in place */
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_import_state(target, snapshot, size, &imported));
+    ASSERT_EQ(SITE_SIZE, imported);
+    ASSERT_EQ(SITE_SIZE, ble_rssi_anchor_count(target));
+
+    free(snapshot);
+    ble_rssi_destroy(source);
+    ble_rssi_destroy(target);
+    return 1;
+}
+
+/* Foreign or truncated snapshots are rejected without touching the context */
+static int test_bad_snapshot(void) {
+    ble_rssi_context* source = ble_rssi_create();
+    ble_rssi_context* target = ble_rssi_create();
+    const char garbage[32] = "definitely not a snapshot";
+    char snapshot[4096];
+    size_t size = 0;
+
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_register_anchors(source, SITE, SITE_SIZE, NULL));
+    ASSERT_EQ(BLE_RSSI_OK, ble_rssi_export_state(source, snapshot, sizeof(snapshot), &size));
+
+    ASSERT_EQ(BLE_RSSI_BAD_SNAPSHOT, ble_rssi_import_state(target, garbage, sizeof(garbage), NULL));
+    ASSERT_EQ(BLE_RSSI_BAD_SNAPSHOT, ble_rssi_import_state(target, snapshot, size - 1, NULL));
+    ASSERT_EQ(BLE_RSSI_BAD_SNAPSHOT, ble_rssi_import_state(target, snapshot, 0, NULL));
+    ASSERT_EQ(0, ble_rssi_anchor_count(target));
+
+    ble_rssi_destroy(source);
+    ble_rssi_destroy(target);
+    return 1;
+}
+
+int main(void) {
+    int all_passed = 1;
+
+    printf("==================================\n");
+    printf("      C API TESTS STARTING        \n");
+    printf("==================================\n");
+
+    all_passed &= run_test("test_abi_version", test_abi_version);
+    all_passed &= run_test("test_register_anchors", test_register_anchors);
+    all_passed &= run_test("test_submit_batch", test_submit_batch);
+    all_passed &= run_test("test_observation_status", test_observation_status);
+    all_passed &= run_test("test_export_import_state", test_export_import_state);
+    all_passed &= run_test("test_bad_snapshot", test_bad_snapshot);
+
+    printf("\n==================================\n");
+    if (all_passed) {
+        printf("🎉 ALL C API TESTS PASSED! 🎉\n");
+        return 0;
+    }
+    printf("❌ SOME C API TESTS FAILED ❌\n");
+    return 1;
+}
@@ -0,0 +1,300 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include "../cluster_sync.h"
+#include "../processing.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+const std::vector<std::pair<std::string, PointR3>> SITE = {
+    {"a1", {0.0f, 0.0f, 2.5f}}, {"a2", {10.0f, 0.0f, 2.5f}},
+    {"a3", {10.0f, 8.0f, 2.5f}}, {"a4", {0.0f, 8.0f, 2.5f}}
+};
+
+// One engine instance of a cluster: its own anchors, processing and delta sync
+struct Instance {
+    ProcessingContext context;
+    std::unique_ptr<ClusterSync> sync;
+
+    explicit Instance(const std::string& id) {
+        std::vector<std::unique_ptr<Anchor>> anchors;
+        for (const auto& [mac, coord] : SITE) {
+            anchors.push_back(std::make_unique<Anchor>(mac, coord, 0.0f));
+        }
+        context.anchors.insert_all(std::move(anchors));
+        context.anchors_initialized = true;
+        sync = std::make_unique<ClusterSync>(context.anchors, id);
+    }
+
+    // Collect and confirm, as the runner does when every publish is accepted
+    std::vector<std::string> publish() {
+        std::vector<std::string> messages = sync->collect();
+        for (const std::string& message : messages) {
+            sync->confirm(message);
+        }
+        return messages;
+    }
+
+    // Process one tag position, as a worker would for a message from the shared subscription
+    bool process(int i) {
+        float x = 1.0f + static_cast<float>(i % 9);
+        float y = 1.0f + static_cast<float>(i % 7);
+        PositionProducer::Reading readings[] = {
+            {"a1", -55.0f - x}, {"a2", -60.0f - y * 0.5f}, {"a3", -68.0f + x * 0.3f}, {"a4", -62.0f - y * 0.2f}
+        };
+        PositionRecord record{};
+        PositionProducer::fill_record(record, "tag" + std::to_string(i % 5), x, y, 1.2f, 1700000000.0 + i, readings, 4);
+        return evaluate_tag_message(context, parse_position_record(context, record)).has_value();
+    }
+
+    AnchorState state(const std::string& mac) {
+        auto guard = context.anchors.read();
+        return guard.find(mac)->snapshot();
+    }
+};
+
+// Deliver every instance's pending deltas to every other instance, as the sync topic would
+size_t sync_round(std::vector<std::unique_ptr<Instance>>& cluster) {
+    size_t messages = 0;
+    std::vector<std::vector<std::string>> outgoing;
+    for (auto& instance : cluster) {
+        outgoing.push_back(instance->publish());
+        messages += outgoing.back().size();
+    }
+    for (size_t from = 0; from < cluster.size(); from++) {
+        for (size_t to = 0; to < cluster.size(); to++) {
+            for (const std::string& message : outgoing[from]) {
+                // The broker may echo a sender's own deltas: they must be ignored
+                cluster[to]->sync->apply(message);
+            }
+        }
+    }
+    return messages;
+}
+
+bool test_shared_subscription_topic() {
+    ASSERT_EQ(std::string("$share/ble_rssi/engine/+/positions"), shared_subscription_topic("ble_rssi", "engine/+/positions"));
+    return true;
+}
+
+// Only anchors changed since the previous confirmed send are collected, 40 bytes each
+bool test_collect_sends_changes_only() {
+    Instance a("a");
+    std::vector<std::string> first = a.publish();
+    ASSERT_EQ(1u, first.size());
+    ASSERT_EQ(sizeof(AnchorDeltaHeader) + 1 + SITE.size() * sizeof(AnchorDeltaRecord), first[0].size());
+    ASSERT_TRUE(a.sync->collect().empty());
+
+    {
+        auto guard = a.context.anchors.read();
+        guard.find("a2")->update_health(1.0f, 10.0f);
+    }
+    std::vector<std::string> second = a.publish();
+    ASSERT_EQ(1u, second.size());
+    ASSERT_EQ(sizeof(AnchorDeltaHeader) + 1 + sizeof(AnchorDeltaRecord), second[0].size());
+    ASSERT_EQ(SITE.size() + 1, a.sync->stats().deltas_sent);
+
+    // resync() sends everything again
+    a.sync->resync();
+    ASSERT_EQ(first[0].size(), a.publish()[0].size());
+    return true;
+}
+
+// Deltas the transport did not accept are collected again
+bool test_unconfirmed_deltas_resent() {
+    Instance a("a");
+    a.publish();
+    ASSERT_TRUE(a.process(0));
+
+    std::vector<std::string> lost = a.sync->collect();   // e.g. SYNC disconnected
+    ASSERT_EQ(1u, lost.size());
+    std::vector<std::string> retried = a.sync->collect();
+    ASSERT_EQ(1u, retried.size());
+    ASSERT_EQ(lost[0], retried[0]);
+    a.sync->confirm(retried[0]);
+    ASSERT_TRUE(a.sync->collect().empty());
+    return true;
+}
+
+// An instance joining an idle cluster gets every anchor's state once it sends its own
+bool test_late_joiner_catches_up() {
+    std::vector<std::unique_ptr<Instance>> cluster;
+    cluster.push_back(std::make_unique<Instance>("a"));
+    cluster.push_back(std::make_unique<Instance>("b"));
+    for (int i = 0; i < 50; i++) {
+        ASSERT_TRUE(cluster[static_cast<size_t>(i) % 2]->process(i));
+    }
+    for (int rounds = 0; sync_round(cluster) > 0; rounds++) {
+        ASSERT_TRUE(rounds < 5);
+    }
+
+    // Nothing changes any more; c connects and sends its (initial) full state
+    cluster.push_back(std::make_unique<Instance>("c"));
+    int rounds = 0;
+    while (sync_round(cluster) > 0) {
+        ASSERT_TRUE(++rounds < 5);
+    }
+    for (const auto& [mac, coord] : SITE) {
+        AnchorState reference = cluster[0]->state(mac);
+        AnchorState joined = cluster[2]->state(mac);
+        ASSERT_TRUE(reference.version > 0);
+        ASSERT_EQ(reference.version, joined.version);
+        ASSERT_EQ(reference.RSSI_0, joined.RSSI_0);
+        ASSERT_EQ(reference.ewma, joined.ewma);
+    }
+    return true;
+}
+
+// Newer states are adopted, older or own ones ignored, and adopted ones are not sent back
+bool test_apply_merges_by_version() {
+    Instance a("a");
+    Instance b("b");
+    a.publish();
+    b.publish();
+
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(a.process(i));
+    }
+    AnchorState updated = a.state("a1");
+    std::vector<std::string> deltas = a.publish();
+    ASSERT_EQ(1u, deltas.size());
+
+    ASSERT_EQ(0u, a.sync->apply(deltas[0]));                 // Own message
+    ASSERT_EQ(SITE.size(), b.sync->apply(deltas[0]));
+    AnchorState adopted = b.state("a1");
+    ASSERT_EQ(updated.version, adopted.version);
+    ASSERT_EQ(updated.RSSI_0, adopted.RSSI_0);
+    ASSERT_EQ(updated.n, adopted.n);
+    ASSERT_EQ(updated.ewma, adopted.ewma);
+    ASSERT_TRUE(b.sync->collect().empty());                  // No echo of adopted states
+
+    // Replaying the same deltas changes nothing; b's later updates outrank them
+    ASSERT_EQ(0u, b.sync->apply(deltas[0]));
+    ASSERT_TRUE(b.sync->collect().empty());
+    ASSERT_TRUE(b.process(7));
+    b.publish();
+    ASSERT_EQ(0u, b.sync->apply(deltas[0]));
+    ASSERT_TRUE(b.state("a1").version > updated.version);
+    ASSERT_TRUE(!b.sync->collect().empty());                 // a is behind: b sends its state again
+    return true;
+}
+
+// Anchors unknown to the receiver and malformed payloads are skipped
+bool test_apply_rejects_malformed() {
+    Instance a("a");
+    AnchorRegistry empty;
+    ClusterSync unknown(empty, "c");
+
+    std::vector<std::string> deltas = a.sync->collect();
+    ASSERT_EQ(0u, unknown.apply(deltas[0]));
+    ASSERT_EQ(1u, unknown.stats().messages_received);
+
+    ASSERT_EQ(0u, unknown.apply("BLED"));
+    ASSERT_EQ(0u, unknown.apply(std::string_view(deltas[0]).substr(0, deltas[0].size() - 1)));
+    std::string foreign = deltas[0];
+    foreign[0] = 'X';
+    ASSERT_EQ(0u, unknown.apply(foreign));
+    ASSERT_EQ(3u, unknown.stats().messages_rejected);
+
+    bool threw = false;
+    try {
+        ClusterSync nameless(empty, "");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    return true;
+}
+
+// 2 to 4 instances splitting one stream converge on the same state for every anchor
+bool test_instances_converge() {
+    for (size_t size = 2; size <= 4; size++) {
+        std::vector<std::unique_ptr<Instance>> cluster;
+        for (size_t i = 0; i < size; i++) {
+            cluster.push_back(std::make_unique<Instance>("instance-" + std::to_string(i)));
+        }
+
+        // Round-robin like a shared subscription, syncing every 10 messages
+        for (int i = 0; i < 400; i++) {
+            ASSERT_TRUE(cluster[static_cast<size_t>(i) % size]->process(i));
+            if (i % 10 == 9) {
+                sync_round(cluster);
+            }
+        }
+        int rounds = 0;
+        while (sync_round(cluster) > 0) {
+            ASSERT_TRUE(++rounds < 5);
+        }
+
+        for (const auto& [mac, coord] : SITE) {
+            AnchorState reference = cluster[0]->state(mac);
+            ASSERT_TRUE(reference.version > 0);
+            for (size_t i = 1; i < size; i++) {
+                AnchorState state = cluster[i]->state(mac);
+                ASSERT_EQ(reference.version, state.version);
+                ASSERT_EQ(reference.RSSI_0, state.RSSI_0);
+                ASSERT_EQ(reference.n, state.n);
+                ASSERT_EQ(reference.ewma, state.ewma);
+            }
+        }
+        for (auto& instance : cluster) {
+            ASSERT_TRUE(instance->sync->stats().deltas_adopted > 0);
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "    CLUSTER SYNC TESTS STARTING   " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_shared_subscription_topic", test_shared_subscription_topic);
+    all_passed &= run_test("test_collect_sends_changes_only", test_collect_sends_changes_only);
+    all_passed &= run_test("test_unconfirmed_deltas_resent", test_unconfirmed_deltas_resent);
+    all_passed &= run_test("test_apply_merges_by_version", test_apply_merges_by_version);
+    all_passed &= run_test("test_apply_rejects_malformed", test_apply_rejects_malformed);
+    all_passed &= run_test("test_instances_converge", test_instances_converge);
+    all_passed &= run_test("test_late_joiner_catches_up", test_late_joiner_catches_up);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL CLUSTER SYNC TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME CLUSTER SYNC TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
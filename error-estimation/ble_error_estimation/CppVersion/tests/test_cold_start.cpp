@@ -0,0 +1,271 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "../anchor_source.h"
+#include "../pipeline.h"
+#include "../reactor.h"
+#include "../http_client.h"
+#include "http_standin.h"
+#include "test_support.h"
+
+/**
+ * Cold start: how long after launch the engine publishes its first estimate, and
+ * how long until every anchor of the site is known.
+ *
+ * The anchor API is a local stand-in answering every request after
+ * BLE_STANDIN_LATENCY_MS (default 20ms). Each run starts from nothing (new reactor,
+ * HTTP client and registry), optionally bulk-loads the site as the runner does, then
+ * receives a burst of tag messages covering every anchor of the site, four per
+ * message. Sites go from 10 anchors up to BLE_COLD_START_MAX (default 1000).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+json site_dongle(size_t index) {
+    return {{"id", index}, {"macAddress", synthetic_mac("c01d", index)}, {"name", "Dongle " + std::to_string(index)},
+            {"x", static_cast<float>(index % 100)}, {"y", static_cast<float>(index / 100)}, {"z", 2.5f}};
+}
+
+// Query parameter of a request target, or -1 if missing
+long query_param(const std::string& target, const std::string& name) {
+    size_t pos = target.find(name + "=");
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    return std::stol(target.substr(pos + name.size() + 1));
+}
+
+// Dongles API of a site: paginated list and single-MAC lookups, both after latency_ms
+HttpStandIn::Reply serve_site(const HttpStandIn::Request& request, size_t anchors, int latency_ms) {
+    HttpStandIn::Reply reply;
+    reply.delay_ms = latency_ms;
+    json list = json::array();
+    size_t mac_pos = request.target.find("macAddress=");
+    if (mac_pos != std::string::npos) {
+        std::string mac = request.target.substr(mac_pos + 11);
+        for (size_t i = 0; i < anchors; i++) {
+            if (synthetic_mac("c01d", i) == mac) {
+                list.push_back(site_dongle(i));
+                break;
+            }
+        }
+    } else {
+        long page = query_param(request.target, "page");
+        long size = query_param(request.target, "size");
+        size_t first = std::min(anchors, static_cast<size_t>(std::max(page, 0L) * std::max(size, 0L)));
+        size_t last = std::min(anchors, first + static_cast<size_t>(std::max(size, 0L)));
+        for (size_t i = first; i < last; i++) {
+            list.push_back(site_dongle(i));
+        }
+    }
+    reply.body = list.dump();
+    return reply;
+}
+
+// Message of one tag heard by four consecutive anchors of the site
+std::string covering_message(size_t message_index, size_t anchors) {
+    json used_anchors = json::array();
+    for (size_t k = 0; k < 4; k++) {
+        size_t anchor = (message_index * 4 + k) % anchors;
+        used_anchors.push_back({{"mac", synthetic_mac("c01d", anchor)}, {"rssi", -58.0f - 3.0f * k}});
+    }
+    json message = {
+        {"location", {{"position", {{"x", 5.0f}, {"y", 5.0f}, {"z", 0.0f},
+                                    {"used_anchors", used_anchors}, {"unused_anchors", json::array()}}}}},
+        {"tag", {{"mac", "7a9" + std::to_string(message_index % 64)}}},
+        {"timestamp", 1751374881169.0}
+    };
+    return message.dump();
+}
+
+/*RUN*/
+struct ColdStartResult {
+    size_t anchors = 0;
+    bool bulk = false;
+    double init_ms = 0.0;             // Reactor, HTTP client and registry
+    double bulk_load_ms = 0.0;        // Blocking bulk load before subscribing
+    double first_estimate_ms = -1.0;  // Launch to first estimate ready to publish
+    double full_coverage_ms = -1.0;   // Launch to every anchor known
+    double drained_ms = -1.0;         // Launch to every startup message processed
+    size_t http_requests = 0;
+    size_t estimates = 0;
+};
+
+struct StartupState {
+    Clock::time_point launch;
+    double first_estimate_ms = -1.0;
+    size_t pending = 0;
+    size_t estimates = 0;
+};
+
+Task<void> startup_message(ProcessingContext& context, AnchorResolver& resolver, std::string payload, StartupState& state) {
+    std::optional<json> output = co_await process_tag_message_async(context, resolver, std::move(payload));
+    if (output) {
+        // The runner posts this to the reactor and publishes it
+        std::string published = output->dump();
+        if (state.estimates++ == 0) {
+            state.first_estimate_ms = ms_since(state.launch);
+        }
+    }
+    state.pending--;
+}
+
+// Sends the engine's per-anchor and per-message logging nowhere while a run is measured
+class QuietStreams {
+    public:
+        QuietStreams() : out(std::cout.rdbuf(nullptr)), err(std::cerr.rdbuf(nullptr)) {}
+        ~QuietStreams() {
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+            std::cout.clear();
+            std::cerr.clear();
+        }
+
+    private:
+        std::streambuf* out;
+        std::streambuf* err;
+};
+
+ColdStartResult cold_start(size_t anchors, bool bulk, int latency_ms) {
+    QuietStreams quiet;
+    HttpStandIn server([anchors, latency_ms](const HttpStandIn::Request& request) {
+        return serve_site(request, anchors, latency_ms);
+    });
+
+    ColdStartResult result;
+    result.anchors = anchors;
+    result.bulk = bulk;
+    StartupState state;
+    state.launch = Clock::now();
+
+    Reactor reactor;
+    HttpClient http(reactor);
+    ProcessingContext context;
+    HttpAnchorSource source(reactor, http, server.url("/confv1/api/dongles?macAddress={}"),
+                            server.url("/confv1/api/dongles"), "admin", "secret");
+    AnchorResolver resolver(context, source.fetcher());
+    result.init_ms = ms_since(state.launch);
+
+    auto check_coverage = [&]() {
+        if (result.full_coverage_ms < 0.0 && context.anchors.size() >= anchors) {
+            result.full_coverage_ms = ms_since(state.launch);
+        }
+    };
+
+    if (bulk) {
+        auto load_start = Clock::now();
+        source.load(context);
+        result.bulk_load_ms = ms_since(load_start);
+        check_coverage();
+    }
+
+    // Subscribed: the first messages of the site arrive together
+    size_t messages = (anchors + 3) / 4;
+    state.pending = messages;
+    for (size_t i = 0; i < messages; i++) {
+        spawn(startup_message(context, resolver, covering_message(i, anchors), state));
+    }
+
+    auto deadline = Clock::now() + std::chrono::seconds(60);
+    while ((state.pending > 0 || result.full_coverage_ms < 0.0) && Clock::now() < deadline) {
+        check_coverage();
+        if (state.pending > 0) {
+            reactor.run_once(1);
+        }
+    }
+    if (state.pending == 0) {
+        result.drained_ms = ms_since(state.launch);
+    }
+    result.first_estimate_ms = state.first_estimate_ms;
+    result.estimates = state.estimates;
+    result.http_requests = server.requests();
+    return result;
+}
+
+/*REPORT*/
+std::vector<size_t> site_sizes() {
+    size_t largest = 1000;
+    if (const char* limit = std::getenv("BLE_COLD_START_MAX")) {
+        largest = std::strtoul(limit, nullptr, 10);
+    }
+    std::vector<size_t> sizes;
+    for (size_t size = 10; size <= largest; size *= 10) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+int standin_latency_ms() {
+    const char* latency = std::getenv("BLE_STANDIN_LATENCY_MS");
+    return latency ? std::atoi(latency) : 20;
+}
+
+void print_result(const ColdStartResult& result) {
+    auto cell = [](double ms) {
+        std::ostringstream text;
+        if (ms < 0.0) {
+            text << "-";
+        } else {
+            text << std::fixed << std::setprecision(1) << ms;
+        }
+        return text.str();
+    };
+    std::cout << "  " << std::setw(7) << result.anchors
+              << std::setw(10) << (result.bulk ? "bulk" : "on-demand")
+              << std::setw(9) << cell(result.init_ms)
+              << std::setw(11) << cell(result.bulk ? result.bulk_load_ms : -1.0)
+              << std::setw(16) << cell(result.first_estimate_ms)
+              << std::setw(15) << cell(result.full_coverage_ms)
+              << std::setw(12) << cell(result.drained_ms)
+              << std::setw(10) << result.http_requests << std::endl;
+}
+
+// Main function to run the benchmark
+int main() {
+    auto process_start = Clock::now();
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    double curl_init_ms = ms_since(process_start);
+
+    int latency_ms = standin_latency_ms();
+    std::cout << "==================================" << std::endl;
+    std::cout << "      COLD START BENCHMARK        " << std::endl;
+    std::cout << "==================================" << std::endl;
+    std::cout << "curl_global_init: " << std::fixed << std::setprecision(2) << curl_init_ms << "ms"
+              << ", anchor API latency: " << latency_ms << "ms per request" << std::endl;
+    std::cout << "\n  " << std::setw(7) << "anchors" << std::setw(10) << "mode" << std::setw(9) << "init"
+              << std::setw(11) << "bulk load" << std::setw(16) << "first estimate" << std::setw(15) << "full coverage"
+              << std::setw(12) << "drained" << std::setw(10) << "requests" << "   (ms)" << std::endl;
+
+    bool all_ok = true;
+    for (size_t anchors : site_sizes()) {
+        for (bool bulk : {true, false}) {
+            ColdStartResult result = cold_start(anchors, bulk, latency_ms);
+            print_result(result);
+            all_ok &= result.first_estimate_ms >= 0.0 && result.full_coverage_ms >= 0.0 && result.drained_ms >= 0.0;
+        }
+    }
+
+    curl_global_cleanup();
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_ok) {
+        std::cout << "🎉 COLD START BENCHMARK COMPLETED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME COLD STARTS DID NOT FINISH ❌" << std::endl;
+        return 1;
+    }
+}
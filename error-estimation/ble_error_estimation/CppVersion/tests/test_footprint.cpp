@@ -0,0 +1,245 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../anchor_registry.h"
+#include "../models.h"
+#include "test_support.h"
+
+/**
+ * Memory footprint and lookup latency of the engine's state as a site grows.
+ *
+ * Every size is measured in a forked child, so the RSS growth of one size is not
+ * hidden by heap the previous size left behind. Sizes go from 1k up to
+ * BLE_FOOTPRINT_MAX entities (default 1M).
+ */
+
+// One measured point of a scaling curve
+struct FootprintPoint {
+    size_t entities = 0;
+    size_t rss_bytes = 0;       // Resident memory added by populating
+    double lookup_ns = 0.0;     // Mean latency of a random hit
+    double populate_ms = 0.0;
+    bool ok = false;
+};
+
+// MAC-like key of entity i, spread out so hashing sees realistic keys
+std::string entity_mac(size_t i, uint64_t salt) {
+    uint64_t value = (i + 1) * 0x9E3779B97F4A7C15ull ^ salt;
+    char buffer[13];
+    std::snprintf(buffer, sizeof(buffer), "%012llx", static_cast<unsigned long long>(value & 0xFFFFFFFFFFFFull));
+    return buffer;
+}
+
+// Run measure in a child process and collect its result
+FootprintPoint measure_in_child(FootprintPoint (*measure)(size_t, bool), size_t entities, bool warm) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return FootprintPoint{};
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        FootprintPoint point = measure(entities, warm);
+        ssize_t written = write(fds[1], &point, sizeof(point));
+        _exit(written == static_cast<ssize_t>(sizeof(point)) ? 0 : 1);
+    }
+    close(fds[1]);
+    FootprintPoint point;
+    if (child < 0 || read(fds[0], &point, sizeof(point)) != static_cast<ssize_t>(sizeof(point))) {
+        point = FootprintPoint{};
+    }
+    close(fds[0]);
+    if (child > 0) {
+        waitpid(child, nullptr, 0);
+    }
+    return point;
+}
+
+// Mean latency of looking up every key once, in random order
+template <typename Lookup>
+double mean_lookup_ns(const std::vector<std::string>& keys, Lookup lookup) {
+    std::vector<size_t> order(std::min<size_t>(keys.size(), 1000000));
+    std::mt19937_64 rng(42);
+    for (auto& index : order) {
+        index = rng() % keys.size();
+    }
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t index : order) {
+        found += lookup(keys[index]) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (found != order.size()) {
+        return -1.0;
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / order.size();
+}
+
+/*ANCHORS*/
+// Registry of anchors; warm anchors have full Kalman history buffers, as after a few minutes of traffic
+FootprintPoint measure_anchors(size_t count, bool warm) {
+    std::vector<std::string> macs;
+    macs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        macs.push_back(entity_mac(i, 0xA1));
+    }
+    size_t before = resident_bytes();
+    auto start = std::chrono::steady_clock::now();
+
+    AnchorRegistry registry;
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    anchors.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        float x = static_cast<float>(i % 1000);
+        float y = static_cast<float>(i / 1000);
+        anchors.push_back(std::make_unique<Anchor>(macs[i], std::make_tuple(x, y, 2.5f), 0.0f));
+        if (warm) {
+            for (int sample = 0; sample < 50; sample++) {
+                anchors.back()->update_parameters(-60.0f - (sample % 7), 1.0f + (sample % 5));
+            }
+        }
+    }
+    registry.insert_all(std::move(anchors));
+    anchors.shrink_to_fit();
+
+    FootprintPoint point;
+    point.populate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    point.rss_bytes = resident_bytes() - before;
+    point.entities = registry.size();
+    auto guard = registry.read();
+    point.lookup_ns = mean_lookup_ns(macs, [&guard](const std::string& mac) { return guard.find(mac) != nullptr; });
+    point.ok = point.entities == count && point.lookup_ns >= 0.0;
+    return point;
+}
+
+/*TAGS*/
+// Latest message of every tag, keyed by tag MAC, each with readings from five anchors
+FootprintPoint measure_tags(size_t count, bool) {
+    std::vector<std::string> macs;
+    macs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        macs.push_back(entity_mac(i, 0x7A));
+    }
+    size_t before = resident_bytes();
+    auto start = std::chrono::steady_clock::now();
+
+    std::unordered_map<std::string, Tag> tags;
+    tags.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::unordered_map<std::string, float> readings;
+        for (size_t anchor = 0; anchor < 5; anchor++) {
+            readings[entity_mac((i + anchor) % 1000, 0xA1)] = -60.0f - anchor;
+        }
+        tags.emplace(macs[i], Tag(macs[i], std::make_tuple(1.0f, 2.0f, 0.0f), std::move(readings)));
+    }
+
+    FootprintPoint point;
+    point.populate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    point.rss_bytes = resident_bytes() - before;
+    point.entities = tags.size();
+    point.lookup_ns = mean_lookup_ns(macs, [&tags](const std::string& mac) { return tags.find(mac) != tags.end(); });
+    point.ok = point.entities == count && point.lookup_ns >= 0.0;
+    return point;
+}
+
+/*REPORT*/
+std::vector<size_t> footprint_sizes() {
+    size_t largest = 1000000;
+    if (const char* limit = std::getenv("BLE_FOOTPRINT_MAX")) {
+        largest = std::strtoul(limit, nullptr, 10);
+    }
+    std::vector<size_t> sizes;
+    for (size_t size = 1000; size <= largest; size *= 10) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+// Print one scaling curve; returns the points for the capacity estimate
+std::vector<FootprintPoint> print_curve(const std::string& label, FootprintPoint (*measure)(size_t, bool), bool warm) {
+    std::cout << "\n" << label << std::endl;
+    std::cout << "  " << std::setw(9) << "count" << std::setw(12) << "RSS (MB)" << std::setw(12) << "bytes/each"
+              << std::setw(13) << "lookup (ns)" << std::setw(14) << "populate (ms)" << "  bytes/each" << std::endl;
+    std::vector<FootprintPoint> points;
+    for (size_t size : footprint_sizes()) {
+        points.push_back(measure_in_child(measure, size, warm));
+    }
+    size_t widest = 1;
+    for (const auto& point : points) {
+        if (point.ok && point.entities) {
+            widest = std::max(widest, point.rss_bytes / point.entities);
+        }
+    }
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < points.size(); i++) {
+        const auto& point = points[i];
+        if (!point.ok) {
+            std::cout << "  " << std::setw(9) << footprint_sizes()[i] << "  measurement failed" << std::endl;
+            continue;
+        }
+        size_t per_entity = point.rss_bytes / point.entities;
+        std::cout << "  " << std::setw(9) << point.entities
+                  << std::setw(12) << point.rss_bytes / (1024.0 * 1024.0)
+                  << std::setw(12) << per_entity
+                  << std::setw(13) << point.lookup_ns
+                  << std::setw(14) << point.populate_ms
+                  << "  " << std::string(per_entity * 40 / widest, '#') << std::endl;
+    }
+    return points;
+}
+
+// Entities that fit in one GiB at the per-entity cost of the largest measured size
+void print_capacity(const std::string& label, const std::vector<FootprintPoint>& points) {
+    for (auto it = points.rbegin(); it != points.rend(); ++it) {
+        if (it->ok && it->entities && it->rss_bytes) {
+            size_t per_entity = it->rss_bytes / it->entities;
+            std::cout << "  " << label << ": ~" << (1ull << 30) / std::max<size_t>(per_entity, 1)
+                      << " per GiB (" << per_entity << " bytes each at " << it->entities << ")" << std::endl;
+            return;
+        }
+    }
+}
+
+// Main function to run the benchmark
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "   MEMORY FOOTPRINT BENCHMARK     " << std::endl;
+    std::cout << "==================================" << std::endl;
+    std::cout << "sizeof(Anchor) = " << sizeof(Anchor) << ", sizeof(KalmanFilter) = " << sizeof(KalmanFilter)
+              << ", sizeof(Tag) = " << sizeof(Tag) << std::endl;
+
+    auto cold = print_curve("Anchors, fresh (registry + anchor objects):", measure_anchors, false);
+    auto warm = print_curve("Anchors, warm (Kalman buffers full at 50 samples):", measure_anchors, true);
+    auto tags = print_curve("Tags (latest message per tag, 5 readings each):", measure_tags, false);
+
+    std::cout << "\nCapacity of one process:" << std::endl;
+    print_capacity("fresh anchors", cold);
+    print_capacity("warm anchors", warm);
+    print_capacity("tags", tags);
+
+    bool all_ok = true;
+    for (const auto* curve : {&cold, &warm, &tags}) {
+        for (const auto& point : *curve) {
+            all_ok &= point.ok;
+        }
+    }
+    std::cout << "\n==================================" << std::endl;
+    if (all_ok) {
+        std::cout << "🎉 FOOTPRINT BENCHMARK COMPLETED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME FOOTPRINT MEASUREMENTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
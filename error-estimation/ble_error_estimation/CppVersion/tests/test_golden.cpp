@@ -0,0 +1,276 @@
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../pipeline.h"
+#include "../numeric_kernels.h"
+#include "golden.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Quiets the engine's logging while workloads run
+class QuietStreams {
+    public:
+        QuietStreams() : out(std::cout.rdbuf(nullptr)), err(std::cerr.rdbuf(nullptr)) {}
+        ~QuietStreams() {
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+            std::cout.clear();
+            std::cerr.clear();
+        }
+
+    private:
+        std::streambuf* out;
+        std::streambuf* err;
+};
+
+/*ENGINES*/
+// The runner's path: a coroutine per message, anchors through the resolver
+class CoroutineEngine : public GoldenEngine {
+    public:
+        CoroutineEngine(AnchorSource& site, bool load_site)
+            : resolver(processing, site.fetcher()), load_first(load_site) {}
+
+        std::string name() const override { return load_first ? "coroutine" : "coroutine-lazy-discovery"; }
+
+        bool preload() const override { return load_first; }
+
+        std::optional<json> process(const std::string& payload) override {
+            std::optional<json> output;
+            bool done = false;
+            spawn(run(payload, output, done));
+            if (!done) {
+                throw std::runtime_error("message suspended on an anchor the site does not have");
+            }
+            return output;
+        }
+
+    private:
+        AnchorResolver resolver;
+        bool load_first;
+
+        Task<void> run(std::string payload, std::optional<json>& output, bool& done) {
+            output = co_await process_tag_message_async(processing, resolver, std::move(payload));
+            done = true;
+        }
+};
+
+// Scalar engine with one number changed, to check the harness catches it
+class PerturbedEngine : public ScalarEngine {
+    public:
+        PerturbedEngine(size_t at_message, float estimate_delta, float ewma_delta)
+            : target(at_message), delta(estimate_delta), anchor_delta(ewma_delta) {}
+
+        std::string name() const override { return "perturbed"; }
+
+        std::optional<json> process(const std::string& payload) override {
+            std::optional<json> output = ScalarEngine::process(payload);
+            if (seen++ == target && output) {
+                (*output)["error_estimate"] = (*output)["error_estimate"].get<float>() + delta;
+                if (anchor_delta != 0.0f) {
+                    std::string mac = (*output)["anchors_selected_for_estimation"][0]["mac"].get<std::string>();
+                    Anchor* anchor = processing.anchors.read().find(mac);
+                    AnchorState state = anchor->snapshot();
+                    anchor->restore_calibration(state.RSSI_0, state.n, state.ewma + anchor_delta, state.last_seen);
+                }
+            }
+            return output;
+        }
+
+    private:
+        size_t target;
+        float delta;
+        float anchor_delta;
+        size_t seen = 0;
+};
+
+// Scalar pipeline on one numeric kernel set, selected again before each message
+class KernelSetEngine : public ScalarEngine {
+    public:
+        explicit KernelSetEngine(const std::string& isa) : isa(isa) {}
+
+        std::string name() const override { return "kernels-" + isa; }
+
+        std::optional<json> process(const std::string& payload) override {
+            select_numeric_kernels(isa);
+            return ScalarEngine::process(payload);
+        }
+
+    private:
+        std::string isa;
+};
+
+GoldenReport compare_on_synthetic_site(GoldenEngine& reference, GoldenEngine& candidate, size_t messages,
+                                       GoldenTolerance tolerance = GoldenTolerance()) {
+    QuietStreams quiet;
+    MemoryAnchorSource site;
+    add_golden_site(site, 40);
+    return compare_engines(reference, candidate, site, synthetic_golden_workload(messages, 40), tolerance);
+}
+
+GoldenReport compare_on_synthetic_site(GoldenEngine& candidate, size_t messages) {
+    ScalarEngine reference;
+    return compare_on_synthetic_site(reference, candidate, messages);
+}
+
+/*TESTS*/
+// The reference agrees with itself exactly
+bool test_reference_is_deterministic() {
+    ScalarEngine candidate;
+    GoldenReport report = compare_on_synthetic_site(candidate, 2000);
+    ASSERT_EQ(2000u, report.messages);
+    ASSERT_TRUE(report.equivalent());
+    return true;
+}
+
+// The coroutine path the runner uses gives the scalar results, with the site preloaded or discovered lazily
+bool test_coroutine_engines_match_reference() {
+    MemoryAnchorSource candidate_site;
+    add_golden_site(candidate_site, 40);
+    for (bool load_site : {true, false}) {
+        CoroutineEngine candidate(candidate_site, load_site);
+        GoldenReport report = compare_on_synthetic_site(candidate, 2000);
+        if (!report.equivalent()) {
+            print_golden_report(report, std::cerr);
+        }
+        ASSERT_TRUE(report.equivalent());
+    }
+    return true;
+}
+
+// Every kernel set this CPU runs gives the scalar kernels' results bit for bit
+bool test_kernel_sets_match_scalar() {
+    for (const auto& isa : supported_numeric_isas()) {
+        KernelSetEngine reference("scalar");
+        KernelSetEngine candidate(isa);
+        GoldenReport report = compare_on_synthetic_site(reference, candidate, 2000, GoldenTolerance{0.0, 0.0});
+        if (!report.equivalent()) {
+            print_golden_report(report, std::cerr);
+        }
+        ASSERT_TRUE(report.equivalent());
+    }
+    select_numeric_kernels("auto");
+    return true;
+}
+
+// A changed estimate is reported at the message where it first happens, unless within tolerance
+bool test_reports_first_divergence() {
+    PerturbedEngine candidate(137, 1e-3f, 0.0f);
+    GoldenReport report = compare_on_synthetic_site(candidate, 400);
+    ASSERT_TRUE(report.first.has_value());
+    ASSERT_EQ(137u, report.first->message);
+    ASSERT_EQ(std::string("error_estimate"), report.first->field);
+    ASSERT_EQ(1u, report.diverging_messages);
+
+    MemoryAnchorSource site;
+    add_golden_site(site, 40);
+    ScalarEngine reference;
+    PerturbedEngine tolerated(137, 1e-3f, 0.0f);
+    GoldenTolerance loose;
+    loose.absolute = 1e-2;
+    QuietStreams quiet;
+    ASSERT_TRUE(compare_engines(reference, tolerated, site, synthetic_golden_workload(400, 40), loose).equivalent());
+    return true;
+}
+
+// A changed anchor state is caught even when the estimate is the same, and keeps diverging after
+bool test_reports_anchor_trajectory_divergence() {
+    PerturbedEngine candidate(50, 0.0f, 0.05f);
+    GoldenReport report = compare_on_synthetic_site(candidate, 400);
+    ASSERT_TRUE(report.first.has_value());
+    ASSERT_EQ(50u, report.first->message);
+    ASSERT_TRUE(report.first->field.rfind("anchor ", 0) == 0);
+    ASSERT_TRUE(report.first->field.find("/ewma") != std::string::npos);
+    ASSERT_TRUE(report.diverging_messages > 1);
+    return true;
+}
+
+// BLE_GOLDEN_WORKLOAD (one payload per line) and BLE_GOLDEN_SITE (site-survey file) replay a recording
+bool test_recorded_workload() {
+    const char* workload_path = std::getenv("BLE_GOLDEN_WORKLOAD");
+    const char* site_path = std::getenv("BLE_GOLDEN_SITE");
+    if (!workload_path || !site_path) {
+        std::cout << "(skipped: set BLE_GOLDEN_WORKLOAD and BLE_GOLDEN_SITE) ";
+        return true;
+    }
+    std::vector<std::string> workload = load_golden_workload(workload_path);
+    GoldenTolerance tolerance;
+    if (const char* absolute = std::getenv("BLE_GOLDEN_ABS_TOL")) {
+        tolerance.absolute = std::atof(absolute);
+    }
+    if (const char* relative = std::getenv("BLE_GOLDEN_REL_TOL")) {
+        tolerance.relative = std::atof(relative);
+    }
+
+    SiteSurveyFileSource site(site_path);
+    std::vector<GoldenReport> reports;
+    {
+        QuietStreams quiet;
+        ScalarEngine reference;
+        CoroutineEngine candidate(site, true);
+        reports.push_back(compare_engines(reference, candidate, site, workload, tolerance));
+    }
+    std::cout << std::endl;
+    bool all_equivalent = true;
+    for (const auto& report : reports) {
+        print_golden_report(report, std::cout);
+        all_equivalent &= report.equivalent();
+    }
+    ASSERT_TRUE(all_equivalent);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "      GOLDEN OUTPUT TESTS         " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_reference_is_deterministic", test_reference_is_deterministic);
+    all_passed &= run_test("test_coroutine_engines_match_reference", test_coroutine_engines_match_reference);
+    all_passed &= run_test("test_kernel_sets_match_scalar", test_kernel_sets_match_scalar);
+    all_passed &= run_test("test_reports_first_divergence", test_reports_first_divergence);
+    all_passed &= run_test("test_reports_anchor_trajectory_divergence", test_reports_anchor_trajectory_divergence);
+    all_passed &= run_test("test_recorded_workload", test_recorded_workload);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL GOLDEN OUTPUT TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME GOLDEN OUTPUT TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <atomic>
+#include <thread>
 #include "../models.h"
 
 // Simple testing framework macros
@@ -136,6 +138,107 @@ bool test_anchor_parameter_updates() {
     return true;
 }
 
+// Test Anchor calibration restore (shared-memory store adoption)
+bool test_anchor_restore_calibration() {
+    Anchor anchor("test:mac", std::make_tuple(1.0f, 2.0f, 3.0f), 0.0f);
+    anchor.update_parameters(-50.0f, 3.0f);
+    size_t history = anchor.get_kalman().get_rssi_count();
+    
+    anchor.restore_calibration(-62.5f, 2.7f, 5.0f, 4242.0f);
+    
+    ASSERT_EQ(-62.5f, anchor.get_RSSI_0());
+    ASSERT_EQ(2.7f, anchor.get_n());
+    ASSERT_EQ(5.0f, anchor.get_ewma());
+    ASSERT_EQ(4242.0f, anchor.get_last_seen());
+    assert(anchor.is_warning());
+    
+    // Coordinates and Kalman history are untouched
+    ASSERT_EQ(3.0f, std::get<2>(anchor.get_coord()));
+    assert(anchor.get_kalman().get_rssi_count() == history);
+    
+    return true;
+}
+
+// Test Anchor relocation (dongle moved on site)
+bool test_anchor_relocated() {
+    Anchor anchor("test:mac", std::make_tuple(1.0f, 2.0f, 3.0f), 0.0f);
+    anchor.update_parameters(-50.0f, 3.0f);
+    anchor.restore_calibration(-62.5f, 2.7f, 9.0f, 4242.0f);
+    uint32_t version = anchor.get_version();
+
+    std::unique_ptr<Anchor> moved = anchor.relocated(std::make_tuple(4.0f, 5.0f, 6.0f));
+
+    // New position, same calibration and Kalman history, fresh health, next version
+    ASSERT_STRING_EQ(std::string("test:mac"), moved->get_mac_address());
+    ASSERT_EQ(4.0f, std::get<0>(moved->get_coord()));
+    ASSERT_EQ(6.0f, std::get<2>(moved->get_coord()));
+    ASSERT_EQ(-62.5f, moved->get_RSSI_0());
+    ASSERT_EQ(2.7f, moved->get_n());
+    ASSERT_EQ(1.0f, moved->get_ewma());
+    ASSERT_EQ(4242.0f, moved->get_last_seen());
+    assert(moved->get_version() == version + 1);
+    assert(moved->get_kalman().get_rssi_count() == anchor.get_kalman().get_rssi_count());
+
+    // The original is left as it was
+    ASSERT_EQ(1.0f, std::get<0>(anchor.get_coord()));
+    ASSERT_EQ(9.0f, anchor.get_ewma());
+    assert(anchor.get_version() == version);
+
+    return true;
+}
+
+// Test Anchor snapshots stay consistent under a concurrent writer
+bool test_anchor_snapshot_consistency() {
+    Anchor anchor("test:mac", std::make_tuple(0.0f, 0.0f, 0.0f), 0.0f);
+    AnchorState initial = anchor.snapshot();
+    ASSERT_EQ(-59.0f, initial.RSSI_0);
+    ASSERT_EQ(1.0f, initial.ewma);
+    assert(initial.version == 0);
+
+    // Start from a state that already satisfies the reader's invariant
+    anchor.restore_calibration(-0.5f, 0.5f, 0.5f, 0.5f);
+    
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&]() {
+        uint32_t last_version = 0;
+        while (!stop.load()) {
+            AnchorState state = anchor.snapshot();
+            // The writer always stores equal values, so a mix of two updates shows up as a mismatch
+            if (state.RSSI_0 != -state.n || state.ewma != state.n || state.last_seen != state.n ||
+                state.version < last_version) {
+                torn++;
+            }
+            last_version = state.version;
+        }
+    });
+    
+    for (int i = 1; i <= 100000; i++) {
+        float value = static_cast<float>(i);
+        anchor.restore_calibration(-value, value, value, value);
+    }
+    stop = true;
+    reader.join();
+    
+    assert(torn.load() == 0);
+    assert(anchor.get_version() == 100001);
+    
+    // Every kind of update bumps the version
+    anchor.update_health(1.0f, 1.0f);
+    anchor.update_parameters(-60.0f, 2.0f);
+    assert(anchor.get_version() == 100003);
+    
+    // Copies carry the same hot state and version
+    Anchor copy(anchor);
+    AnchorState copied = copy.snapshot();
+    AnchorState original = anchor.snapshot();
+    ASSERT_EQ(original.RSSI_0, copied.RSSI_0);
+    ASSERT_EQ(original.ewma, copied.ewma);
+    assert(copied.version == original.version);
+    
+    return true;
+}
+
 // Test Tag class constructor and getters
 bool test_tag_constructor_and_getters() {
     // Create test data
@@ -437,6 +540,9 @@ int main() {
     all_passed &= run_test("test_anchor_health_monitoring", test_anchor_health_monitoring);
     all_passed &= run_test("test_anchor_parameter_updates", test_anchor_parameter_updates);
     all_passed &= run_test("test_anchor_kalman_parameter_updates", test_anchor_kalman_parameter_updates);
+    all_passed &= run_test("test_anchor_restore_calibration", test_anchor_restore_calibration);
+    all_passed &= run_test("test_anchor_relocated", test_anchor_relocated);
+    all_passed &= run_test("test_anchor_snapshot_consistency", test_anchor_snapshot_consistency);
     
     // Run Tag class tests
     std::cout << "\nTesting Tag class:" << std::endl;
@@ -16,6 +16,8 @@
 #include "../metrics.h" 
 #include "../utils.h"
 #include "../config.h"
+#include "../processing.h"   // Message helpers shared with the engine
+#include "perf_counters.h"
 
 using json = nlohmann::json;
 
@@ -25,7 +27,7 @@ struct MockMQTTMessage {
     size_t payloadlen;
 };
 
-// Mock user data structure (same as in main.cpp)
+// Mock user data structure (same as in processing.cpp)
 struct MockMQTTUserData {
     std::unordered_map<std::string, std::unique_ptr<Anchor>> anchors;
     bool anchors_initialized = false;
@@ -239,126 +241,6 @@ std::unique_ptr<Anchor> create_mock_anchor(const std::string& anch_mac) {
 
 
 
-// EXACT COPIES of functions from main.cpp for realistic testing
-
-/**
- * @brief Extract all anchor MAC addresses from a tag position message (EXACT COPY from main.cpp)
- */
-std::vector<std::string> extract_anchor_macs_from_message(const json& tag_data) {
-    std::vector<std::string> anchor_macs;
-    json position_data = tag_data["location"]["position"];
-    
-    // Get MACs from used anchors
-    if (position_data.contains("used_anchors")) {
-        json used_anchors = position_data["used_anchors"];
-        for (const auto& anchor_dict : used_anchors) {
-            anchor_macs.push_back(anchor_dict["mac"].get<std::string>());
-        }
-    }
-    
-    // Get MACs from unused anchors
-    if (position_data.contains("unused_anchors")) {
-        json unused_anchors = position_data["unused_anchors"];
-        for (const auto& anchor_dict : unused_anchors) {
-            anchor_macs.push_back(anchor_dict["mac"].get<std::string>());
-        }
-    }
-    
-    // Remove duplicates
-    std::sort(anchor_macs.begin(), anchor_macs.end());
-    anchor_macs.erase(std::unique(anchor_macs.begin(), anchor_macs.end()), anchor_macs.end());
-    
-    return anchor_macs;
-}
-
-/**
- * @brief Create a Tag object from MQTT message data (EXACT COPY from main.cpp)
- */
-Tag create_tag_class(const json& tag_data) {
-    // Get MAC address
-    std::string tag_mac = tag_data["tag"]["mac"].get<std::string>();
-    
-    // Get position
-    json position_data = tag_data["location"]["position"];
-    float x = position_data["x"].get<float>();
-    float y = position_data["y"].get<float>();
-    float z = position_data["z"].get<float>();
-    PointR3 tag_pos = std::make_tuple(x, y, z);
-    
-    // Get RSSI dictionary
-    std::unordered_map<std::string, float> tag_rssi_dict;
-    
-    if (position_data.contains("used_anchors")) {
-        json used_anchors = position_data["used_anchors"];
-        for (const auto& anchor_dict : used_anchors) {
-            std::string amac = anchor_dict["mac"].get<std::string>();
-            float arssi = anchor_dict["rssi"].get<float>();
-            tag_rssi_dict[amac] = arssi;
-        }
-    }
-    
-    return Tag(tag_mac, tag_pos, tag_rssi_dict);
-}
-
-/**
- * @brief Create tag info structure for output message (EXACT COPY from main.cpp)
- */
-json create_tag_info(const std::string& tag_mac, float error_estimate) {
-    return json{
-        {"tag_mac", tag_mac},
-        {"error_estimate", error_estimate}
-    };
-}
-
-/**
- * @brief Create anchors info structure for output message (EXACT COPY from main.cpp)
- */
-json create_anchors_info(const std::vector<Anchor*>& anch_list) {
-    std::vector<std::string> warning_anchors;
-    std::vector<std::string> faulty_anchors;
-    json anchors_info_list = json::array();
-    
-    for (const auto& anchor : anch_list) {
-        json anch_info_dict = {
-            {"mac", anchor->get_mac_address()},
-            {"n_var", anchor->get_n()},
-            {"ewma", anchor->get_ewma()}
-        };
-        
-        anchors_info_list.push_back(anch_info_dict);
-        
-        if (anchor->is_warning()) {
-            warning_anchors.push_back(anchor->get_mac_address());
-        }
-        
-        if (anchor->is_faulty()) {
-            faulty_anchors.push_back(anchor->get_mac_address());
-        }
-    }
-    
-    return json{
-        {"anchors_selected_for_estimation", anchors_info_list},
-        {"warning_anchors", warning_anchors},
-        {"faulty_anchors", faulty_anchors}
-    };
-}
-
-/**
- * @brief Create complete output info combining tag and anchors data (EXACT COPY from main.cpp)
- */
-json create_output_info(const std::string& tag_mac, float error_estimate, const std::vector<Anchor*>& anch_list) {
-    json tag_return = create_tag_info(tag_mac, error_estimate);
-    json anchors_return = create_anchors_info(anch_list);
-    
-    // Merge the two JSON objects
-    json result = tag_return;
-    for (auto& [key, value] : anchors_return.items()) {
-        result[key] = value;
-    }
-    
-    return result;
-}
-
 /**
  * @brief Mock implementation of the core MQTT message processing logic
  * This simulates the processing done in the on_message callback without MQTT dependencies
@@ -367,7 +249,7 @@ std::chrono::microseconds process_mqtt_message_mock(const std::string& payload,
     auto start_time = std::chrono::high_resolution_clock::now();
     
     try {
-        // Parse JSON message (same as in main.cpp)
+        // Parse JSON message (same as in processing.cpp)
         json tag_data = json::parse(payload);
         
         if (debug_mode) {
@@ -386,7 +268,7 @@ std::chrono::microseconds process_mqtt_message_mock(const std::string& payload,
             userdata.anchors_initialized = true;
         }
         
-        // Create Tag object from message (same as in main.cpp)
+        // Create Tag object from message (same as in processing.cpp)
         Tag message_tag = create_tag_class(tag_data);
         float timestamp = tag_data["timestamp"].get<float>();
         
@@ -420,7 +302,7 @@ std::chrono::microseconds process_mqtt_message_mock(const std::string& payload,
             }
         }
         
-        // Core processing (same as in main.cpp)
+        // Core processing (same as in processing.cpp)
         if (!anch_list.empty()) {
             if (debug_mode) {
                 std::cout << "\n=== DEBUG: ANCHOR PROCESSING ===" << std::endl;
@@ -445,9 +327,9 @@ std::chrono::microseconds process_mqtt_message_mock(const std::string& payload,
             }
             
             // Simulate anchor health updates (without actual updates to avoid side effects in testing)
-            // In real code: update_anchors_from_tag_data(anch_list, message_tag, userdata.model, timestamp, Config::DEFAULT_DELTA_R, Config::DEFAULT_T_VIS);
+            // In processing.cpp: update_anchors_from_tag_data(anch_list, message_tag, userdata.model, timestamp, Config::DEFAULT_DELTA_R, Config::DEFAULT_T_VIS);
             
-            // Create output using the actual function from main.cpp
+            // Create output using the actual function from processing.cpp
             json output_msg = create_output_info(message_tag.get_mac_address(), error_estimate, anch_list);
             std::string output_str = output_msg.dump();
             
@@ -476,6 +358,13 @@ std::chrono::microseconds process_mqtt_message_mock(const std::string& payload,
     return std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
 }
 
+/**
+ * @brief Number of anchors with RSSI readings in a message, the unit counters are reported per
+ */
+size_t anchors_in_message(const std::string& payload) {
+    return create_tag_class(json::parse(payload)).get_rssi_readings().size();
+}
+
 /**
  * @brief Test MQTT message processing performance
  */
@@ -484,6 +373,12 @@ bool test_mqtt_processing_performance() {
     
     MockMQTTUserData userdata;
     std::vector<std::chrono::microseconds> processing_times;
+    PerfCounters counters;
+    size_t counted_messages = 0;
+    size_t counted_anchors = 0;
+    if (!counters.available()) {
+        std::cout << "  Hardware counters unavailable (" << counters.error() << ")" << std::endl;
+    }
     
     // Process each sample message multiple times
     const int iterations_per_message = 100;
@@ -501,9 +396,14 @@ bool test_mqtt_processing_performance() {
             std::cout << "========================================" << std::endl;
         }
         
+        size_t anchors = anchors_in_message(sample_mqtt_messages[msg_idx]);
         for (int iter = 0; iter < iterations_per_message; iter++) {
+            counters.start();
             auto processing_time = process_mqtt_message_mock(sample_mqtt_messages[msg_idx], userdata, false);
+            counters.stop();
             processing_times.push_back(processing_time);
+            counted_messages++;
+            counted_anchors += anchors;
         }
     }
     
@@ -536,6 +436,7 @@ bool test_mqtt_processing_performance() {
     std::cout << "Maximum time: " << max_time.count() << "us" << std::endl;
     std::cout << "95th percentile: " << p95_time.count() << "us" << std::endl;
     std::cout << "99th percentile: " << p99_time.count() << "us" << std::endl;
+    print_perf_counts("all messages", counters.read(), counted_messages, counted_anchors);
     
     // Check performance criteria
     int violations = 0;
@@ -576,8 +477,10 @@ bool test_message_size_impact() {
         {"Extra large message (15 used + 6 unused)", sample_mqtt_messages[3]}
     };
     
+    PerfCounters counters;
     for (const auto& [test_name, message_payload] : test_cases) {
         MockMQTTUserData userdata;
+        counters.reset();
         
         const int iterations = 50;
         std::vector<std::chrono::microseconds> times;
@@ -593,7 +496,9 @@ bool test_message_size_impact() {
         }
         
         for (int i = 0; i < iterations; i++) {
+            counters.start();
             auto time = process_mqtt_message_mock(message_payload, userdata, false);
+            counters.stop();
             times.push_back(time);
         }
         
@@ -605,6 +510,7 @@ bool test_message_size_impact() {
         double avg = static_cast<double>(total) / times.size();
         
         std::cout << "  " << test_name << ": " << std::setprecision(1) << avg << "us average" << std::endl;
+        print_perf_counts(test_name, counters.read(), iterations, iterations * anchors_in_message(message_payload));
     }
     
     return true;
@@ -0,0 +1,512 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../reactor.h"
+#include "../mqtt_subscriber.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Run the reactor on the calling thread until the condition holds or the timeout expires
+template <typename Condition>
+bool run_until(Reactor& reactor, Condition done, int timeout_ms = 3000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        reactor.run_once(10);
+    }
+    return true;
+}
+
+/*WIRE HELPERS*/
+std::string remaining_length(size_t length) {
+    std::string out;
+    do {
+        uint8_t byte = length % 128;
+        length /= 128;
+        if (length > 0) {
+            byte |= 0x80;
+        }
+        out.push_back(static_cast<char>(byte));
+    } while (length > 0);
+    return out;
+}
+
+std::string mqtt_string(std::string_view value) {
+    std::string out;
+    out.push_back(static_cast<char>(value.size() >> 8));
+    out.push_back(static_cast<char>(value.size() & 0xFF));
+    out.append(value);
+    return out;
+}
+
+std::string publish_packet(std::string_view topic, std::string_view payload, int qos = 0, uint16_t packet_id = 0) {
+    std::string body = mqtt_string(topic);
+    if (qos > 0) {
+        body.push_back(static_cast<char>(packet_id >> 8));
+        body.push_back(static_cast<char>(packet_id & 0xFF));
+    }
+    body.append(payload);
+    std::string out(1, static_cast<char>(0x30 | (qos << 1)));
+    return out + remaining_length(body.size()) + body;
+}
+
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+bool read_exact(int fd, char* out, size_t length, int timeout_ms) {
+    size_t done = 0;
+    while (done < length) {
+        pollfd waiting{fd, POLLIN, 0};
+        if (poll(&waiting, 1, timeout_ms) <= 0) {
+            return false;
+        }
+        ssize_t received = recv(fd, out + done, length - done, 0);
+        if (received <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(received);
+    }
+    return true;
+}
+
+// Blocking read of one control packet
+bool read_packet(int fd, uint8_t& header, std::string& body, int timeout_ms = 3000) {
+    char byte = 0;
+    if (!read_exact(fd, &byte, 1, timeout_ms)) {
+        return false;
+    }
+    header = static_cast<uint8_t>(byte);
+    size_t length = 0;
+    size_t multiplier = 1;
+    do {
+        if (!read_exact(fd, &byte, 1, timeout_ms)) {
+            return false;
+        }
+        length += (static_cast<uint8_t>(byte) & 0x7F) * multiplier;
+        multiplier *= 128;
+    } while (static_cast<uint8_t>(byte) & 0x80);
+    body.assign(length, '\0');
+    return length == 0 || read_exact(fd, body.data(), length, timeout_ms);
+}
+
+/**
+ * @brief Broker stand-in on 127.0.0.1: accepts connections and runs a script on each
+ *
+ * The script runs on the broker thread with blocking I/O while the test drives the
+ * subscriber's reactor; handshake() answers CONNECT and SUBSCRIBE like a real broker.
+ */
+class FakeBroker {
+    public:
+        using Script = std::function<void(FakeBroker&, int fd)>;
+
+        explicit FakeBroker(Script connection_script, int connections = 1) : script(std::move(connection_script)) {
+            listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            listen(listen_fd, 4);
+            socklen_t length = sizeof(address);
+            getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+            listen_port = ntohs(address.sin_port);
+            worker = std::thread([this, connections]() {
+                for (int i = 0; i < connections; i++) {
+                    pollfd waiting{listen_fd, POLLIN, 0};
+                    if (poll(&waiting, 1, 5000) <= 0) {
+                        return;
+                    }
+                    int fd = accept(listen_fd, nullptr, nullptr);
+                    int enable = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                    script(*this, fd);
+                    close(fd);
+                }
+            });
+        }
+
+        ~FakeBroker() {
+            worker.join();
+            close(listen_fd);
+        }
+
+        int port() const { return listen_port; }
+
+        // Answer CONNECT and SUBSCRIBE; records what the client sent
+        bool handshake(int fd) {
+            uint8_t header = 0;
+            std::string body;
+            if (!read_packet(fd, header, body) || header != 0x10) {
+                return false;
+            }
+            connect_body = body;
+            if (!write_all(fd, std::string("\x20\x02\x00\x00", 4))) {
+                return false;
+            }
+            if (!read_packet(fd, header, body) || header != 0x82) {
+                return false;
+            }
+            subscribe_body = body;
+            std::string suback("\x90\x03", 2);
+            suback.append(body, 0, 2);                     // Same packet id
+            suback.push_back(body.back());                 // Granted QoS = requested QoS
+            return write_all(fd, suback);
+        }
+
+        // Wait until the client closes the connection
+        void wait_for_close(int fd) {
+            char byte = 0;
+            read_exact(fd, &byte, 1, 5000);
+        }
+
+        std::string connect_body;
+        std::string subscribe_body;
+        std::atomic<bool> ok{true};
+
+    private:
+        Script script;
+        int listen_fd = -1;
+        int listen_port = 0;
+        std::thread worker;
+};
+
+struct Received {
+    std::vector<std::string> topics;
+    std::vector<std::string> payloads;
+};
+
+MqttSubscriber::MessageHandler recorder(Received& received) {
+    return [&received](std::string_view topic, std::string_view payload) {
+        received.topics.emplace_back(topic);
+        received.payloads.emplace_back(payload);
+    };
+}
+
+/*TESTS*/
+// CONNECT carries the 3.1.1 protocol, keepalive and client id; SUBSCRIBE the filter and QoS
+bool test_connect_and_subscribe() {
+    FakeBroker broker([](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received));
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 30, "engine/+/positions", 1));
+    ASSERT_TRUE(run_until(reactor, [&]() { return subscriber.is_subscribed(); }));
+    subscriber.disconnect();
+
+    std::string expected_connect = mqtt_string("MQTT") + std::string("\x04\x02\x00\x1e", 4) + mqtt_string("sub-test");
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_TRUE(broker.connect_body == expected_connect);
+    ASSERT_TRUE(broker.subscribe_body.substr(2) == mqtt_string("engine/+/positions") + std::string(1, '\x01'));
+    ASSERT_EQ(1, static_cast<int>(subscriber.stats().connects));
+    ASSERT_TRUE(!subscriber.is_subscribed());
+    return true;
+}
+
+// A burst written at once is decoded from few reads, in order, without losing a message
+bool test_publish_burst() {
+    const int count = 500;
+    FakeBroker broker([count](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        std::string burst;
+        for (int i = 0; i < count; i++) {
+            burst += publish_packet("engine/a/positions", "{\"seq\":" + std::to_string(i) + "}");
+        }
+        self.ok = self.ok && write_all(fd, burst);
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received));
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 0, "engine/+/positions", 0));
+    ASSERT_TRUE(run_until(reactor, [&]() { return received.payloads.size() == count; }));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(received.topics[i] == "engine/a/positions");
+        ASSERT_TRUE(received.payloads[i] == "{\"seq\":" + std::to_string(i) + "}");
+    }
+    const MqttSubscriberStats& stats = subscriber.stats();
+    ASSERT_EQ(static_cast<size_t>(count), stats.messages);
+    ASSERT_TRUE(stats.reads < stats.messages);
+    ASSERT_TRUE(stats.max_batch > 1);
+    return true;
+}
+
+// Packets arriving a few bytes at a time, fixed header included, are reassembled
+bool test_packets_split_across_reads() {
+    FakeBroker broker([](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        std::string bytes = publish_packet("t", std::string(300, 'x')) + publish_packet("t", "second") +
+                            publish_packet("t", std::string(200, 'y'));
+        for (size_t offset = 0; offset < bytes.size(); offset += 7) {
+            self.ok = self.ok && write_all(fd, std::string_view(bytes).substr(offset, 7));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    // A buffer smaller than the first packet also forces the partial packet to the front
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received), 128);
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 0, "t", 0));
+    ASSERT_TRUE(run_until(reactor, [&]() { return received.payloads.size() == 3; }));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_TRUE(received.payloads[0] == std::string(300, 'x'));
+    ASSERT_TRUE(received.payloads[1] == "second");
+    ASSERT_TRUE(received.payloads[2] == std::string(200, 'y'));
+    ASSERT_EQ(0, static_cast<int>(subscriber.stats().errors));
+    return true;
+}
+
+// Payloads larger than the buffer grow it; packets over the limit drop the connection
+bool test_large_payloads() {
+    std::string large(200 * 1024, 'L');
+    for (size_t i = 0; i < large.size(); i++) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+    FakeBroker broker([&large](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        self.ok = self.ok && write_all(fd, publish_packet("t", large));
+        self.ok = self.ok && write_all(fd, publish_packet("t", std::string(600 * 1024, 'z')));
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received), 1024, 512 * 1024, 60000);
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 0, "t", 0));
+    ASSERT_TRUE(run_until(reactor, [&]() { return subscriber.stats().errors == 1; }));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_EQ(1, static_cast<int>(received.payloads.size()));
+    ASSERT_TRUE(received.payloads[0] == large);
+    return true;
+}
+
+// Every QoS 1 PUBLISH is acknowledged with its packet id, after the handler saw it
+bool test_qos1_acknowledged() {
+    const int count = 64;
+    std::vector<uint16_t> acked;
+    std::atomic<bool> acks_read{false};
+    FakeBroker broker([&acked, &acks_read, count](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        std::string burst;
+        for (int i = 0; i < count; i++) {
+            burst += publish_packet("t", "m" + std::to_string(i), 1, static_cast<uint16_t>(1000 + i));
+        }
+        self.ok = self.ok && write_all(fd, burst);
+        for (int i = 0; i < count && self.ok; i++) {
+            uint8_t header = 0;
+            std::string body;
+            self.ok = read_packet(fd, header, body) && header == 0x40 && body.size() == 2;
+            if (self.ok) {
+                acked.push_back(static_cast<uint16_t>((static_cast<uint8_t>(body[0]) << 8) | static_cast<uint8_t>(body[1])));
+            }
+        }
+        acks_read = true;
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received));
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 0, "t", 1));
+    ASSERT_TRUE(run_until(reactor, [&]() { return acks_read.load(); }));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_EQ(static_cast<size_t>(count), acked.size());
+    for (int i = 0; i < count; i++) {
+        ASSERT_EQ(1000 + i, static_cast<int>(acked[i]));
+        ASSERT_TRUE(received.payloads[i] == "m" + std::to_string(i));
+    }
+    return true;
+}
+
+// An idle connection sends PINGREQ within the keepalive and survives on PINGRESP
+bool test_keepalive_ping() {
+    std::atomic<int> pings{0};
+    FakeBroker broker([&pings](FakeBroker& self, int fd) {
+        self.ok = self.handshake(fd);
+        uint8_t header = 0;
+        std::string body;
+        while (self.ok && pings < 2 && read_packet(fd, header, body, 5000)) {
+            if (header == 0xC0) {
+                pings++;
+                self.ok = write_all(fd, std::string("\xD0\x00", 2));
+            }
+        }
+        self.ok = self.ok && write_all(fd, publish_packet("t", "after pings"));
+        self.wait_for_close(fd);
+    });
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received));
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 1, "t", 0));
+    ASSERT_TRUE(run_until(reactor, [&]() { return received.payloads.size() == 1; }, 6000));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_EQ(2, pings.load());
+    ASSERT_TRUE(subscriber.stats().pings >= 2);
+    ASSERT_EQ(0, static_cast<int>(subscriber.stats().errors));
+    return true;
+}
+
+// A dropped connection is re-established and the subscription renewed
+bool test_reconnects_after_drop() {
+    std::atomic<int> connection{0};
+    FakeBroker broker([&connection](FakeBroker& self, int fd) {
+        int current = connection++;
+        self.ok = self.ok && self.handshake(fd);
+        self.ok = self.ok && write_all(fd, publish_packet("t", "connection " + std::to_string(current)));
+        if (current == 1) {
+            self.wait_for_close(fd);
+        }
+    }, 2);
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test", "TEST", recorder(received), 1024, 4096, 50);
+    ASSERT_TRUE(subscriber.connect("127.0.0.1", broker.port(), 0, "t", 0));
+    ASSERT_TRUE(run_until(reactor, [&]() { return received.payloads.size() == 2 && subscriber.is_subscribed(); }));
+    subscriber.disconnect();
+
+    ASSERT_TRUE(broker.ok.load());
+    ASSERT_TRUE(received.payloads[0] == "connection 0");
+    ASSERT_TRUE(received.payloads[1] == "connection 1");
+    ASSERT_EQ(2, static_cast<int>(subscriber.stats().connects));
+    ASSERT_EQ(1, static_cast<int>(subscriber.stats().errors));
+    return true;
+}
+
+// Optional: against a real broker named by BLE_MQTT_TEST_BROKER=host[:port]
+bool test_against_real_broker() {
+    const char* configured = std::getenv("BLE_MQTT_TEST_BROKER");
+    if (configured == nullptr) {
+        std::cout << "(skipped, BLE_MQTT_TEST_BROKER not set) ";
+        return true;
+    }
+    std::string host = configured;
+    std::string port = "1883";
+    if (size_t colon = host.rfind(':'); colon != std::string::npos) {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+    std::string topic = "ble-engine-test/" + std::to_string(getpid()) + "/positions";
+
+    Reactor reactor;
+    Received received;
+    MqttSubscriber subscriber(reactor, "sub-test-" + std::to_string(getpid()), "TEST", recorder(received));
+    ASSERT_TRUE(subscriber.connect(host, std::stoi(port), 10, topic, 1));
+    ASSERT_TRUE(run_until(reactor, [&]() { return subscriber.is_subscribed(); }));
+
+    // Raw blocking publisher: CONNECT, CONNACK, QoS 0 PUBLISHes, DISCONNECT
+    addrinfo hints{};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* address = nullptr;
+    ASSERT_EQ(0, getaddrinfo(host.c_str(), port.c_str(), &hints, &address));
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    bool connected = ::connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+    freeaddrinfo(address);
+    ASSERT_TRUE(connected);
+    std::string connect_body = mqtt_string("MQTT") + std::string("\x04\x02\x00\x0a", 4) + mqtt_string("pub-test-" + std::to_string(getpid()));
+    ASSERT_TRUE(write_all(fd, std::string(1, '\x10') + remaining_length(connect_body.size()) + connect_body));
+    uint8_t header = 0;
+    std::string body;
+    ASSERT_TRUE(read_packet(fd, header, body));
+    ASSERT_EQ(0x20, static_cast<int>(header));
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(write_all(fd, publish_packet(topic, "message " + std::to_string(i))));
+    }
+    write_all(fd, std::string("\xE0\x00", 2));
+    close(fd);
+
+    ASSERT_TRUE(run_until(reactor, [&]() { return received.payloads.size() == 100; }, 5000));
+    subscriber.disconnect();
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(received.payloads[i] == "message " + std::to_string(i));
+    }
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << " MQTT SUBSCRIBER TESTS STARTING   " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_connect_and_subscribe", test_connect_and_subscribe);
+    all_passed &= run_test("test_publish_burst", test_publish_burst);
+    all_passed &= run_test("test_packets_split_across_reads", test_packets_split_across_reads);
+    all_passed &= run_test("test_large_payloads", test_large_payloads);
+    all_passed &= run_test("test_qos1_acknowledged", test_qos1_acknowledged);
+    all_passed &= run_test("test_keepalive_ping", test_keepalive_ping);
+    all_passed &= run_test("test_reconnects_after_drop", test_reconnects_after_drop);
+    all_passed &= run_test("test_against_real_broker", test_against_real_broker);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL MQTT SUBSCRIBER TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME MQTT SUBSCRIBER TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
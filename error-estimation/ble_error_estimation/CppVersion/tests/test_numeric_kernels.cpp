@@ -0,0 +1,254 @@
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../numeric_kernels.h"
+#include "../models.h"
+#include "../utils.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Same bits, so -0.0 vs 0.0 or a different NaN would count as a difference
+bool same_bits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Inputs shaped like real messages, plus edge cases (anchor at the tag, huge z)
+struct KernelInputs {
+    std::vector<float> ax, ay, az, rssi, rssi_0, n, ewma, z;
+    float tx = 3.7f, ty = 12.1f, tz = 0.0f;
+};
+
+KernelInputs kernel_inputs(size_t count) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> coord(0.0f, 60.0f);
+    std::uniform_real_distribution<float> signal(-95.0f, -40.0f);
+    std::uniform_real_distribution<float> exponent(1.5f, 4.0f);
+    std::uniform_real_distribution<float> health(0.0f, 10.0f);
+    std::normal_distribution<float> zs(0.0f, 3.0f);
+    KernelInputs in;
+    for (size_t i = 0; i < count; i++) {
+        in.ax.push_back(coord(rng));
+        in.ay.push_back(coord(rng));
+        in.az.push_back(2.5f);
+        in.rssi.push_back(signal(rng));
+        in.rssi_0.push_back(-59.0f + zs(rng));
+        in.n.push_back(exponent(rng));
+        in.ewma.push_back(health(rng));
+        in.z.push_back(zs(rng));
+    }
+    in.ax[0] = in.tx;
+    in.ay[0] = in.ty;
+    in.az[0] = in.tz;
+    in.z[1] = 1e4f;
+    in.z[2] = -0.0f;
+    return in;
+}
+
+// Every kernel set gives exactly the scalar helpers' results
+bool test_kernels_match_scalar_helpers() {
+    const size_t count = 1000;
+    KernelInputs in = kernel_inputs(count);
+    PathLossModel model;
+    std::vector<std::string> isas = supported_numeric_isas();
+    ASSERT_EQ(std::string("scalar"), isas.front());
+
+    for (const auto& isa : isas) {
+        ASSERT_TRUE(select_numeric_kernels(isa));
+        const NumericKernels& kernels = numeric_kernels();
+        ASSERT_EQ(isa, std::string(kernels.isa));
+
+        std::vector<float> dist(count), z(count), logpdf(count), weight(count);
+        kernels.distances(in.ax.data(), in.ay.data(), in.az.data(), count, in.tx, in.ty, in.tz, dist.data());
+        kernels.path_loss_z(in.rssi.data(), in.rssi_0.data(), in.n.data(), dist.data(), count,
+                            model.get_d_0(), model.get_sigma(), z.data());
+        kernels.student_t_logpdf(in.z.data(), count, 5, logpdf.data());
+        kernels.confidence_weights(in.z.data(), in.ewma.data(), count, weight.data());
+
+        for (size_t i = 0; i < count; i++) {
+            PointR3 anchor = std::make_tuple(in.ax[i], in.ay[i], in.az[i]);
+            float expected_dist = R3_distance(anchor, std::make_tuple(in.tx, in.ty, in.tz));
+            float expected_weight = 1.0f / (1.0f + in.ewma[i] + std::pow(in.z[i], 2));
+            if (!same_bits(expected_dist, dist[i]) ||
+                !same_bits(model.z(in.rssi[i], in.rssi_0[i], in.n[i], expected_dist), z[i]) ||
+                !same_bits(logpdf_student_t(in.z[i], 5), logpdf[i]) ||
+                !same_bits(expected_weight, weight[i])) {
+                std::cerr << isa << " differs from the scalar helpers at entry " << i << std::endl;
+                return false;
+            }
+        }
+    }
+    ASSERT_TRUE(select_numeric_kernels("auto"));
+    return true;
+}
+
+// Same bits in the hot state and the whole Kalman filter state
+bool same_anchor_state(Anchor& a, Anchor& b) {
+    AnchorState state_a, state_b;
+    KalmanState kalman_a, kalman_b;
+    a.save_state(state_a, kalman_a);
+    b.save_state(state_b, kalman_b);
+    return same_bits(state_a.RSSI_0, state_b.RSSI_0) && same_bits(state_a.n, state_b.n) &&
+           same_bits(state_a.ewma, state_b.ewma) && same_bits(state_a.last_seen, state_b.last_seen) &&
+           state_a.version == state_b.version &&
+           std::memcmp(&kalman_a, &kalman_b, sizeof(KalmanState)) == 0;
+}
+
+// Batched Kalman and health updates leave every anchor exactly as update_parameters/update_health do
+bool test_batched_updates_match_sequential() {
+    // More than one batch, and enough rounds for the adaptive sigma and Q to kick in
+    const size_t count = 40;
+    const int rounds = 12;
+    KernelInputs in = kernel_inputs(count * rounds);
+
+    for (const auto& isa : supported_numeric_isas()) {
+        ASSERT_TRUE(select_numeric_kernels(isa));
+        std::vector<std::unique_ptr<Anchor>> sequential, batched;
+        std::vector<Anchor*> batch;
+        for (size_t i = 0; i < count; i++) {
+            PointR3 coord = std::make_tuple(in.ax[i], in.ay[i], in.az[i]);
+            sequential.push_back(std::make_unique<Anchor>("a" + std::to_string(i), coord, 0.0f));
+            batched.push_back(std::make_unique<Anchor>("a" + std::to_string(i), coord, 0.0f));
+            batch.push_back(batched.back().get());
+        }
+
+        for (int round = 0; round < rounds; round++) {
+            const float* rssi = &in.rssi[round * count];
+            const float* z = &in.z[round * count];
+            std::vector<float> dist(in.ax.begin() + round * count, in.ax.begin() + (round + 1) * count);
+            dist[round % count] = 0.0f;  // anchor at the tag: clamped distance
+            float now = 1000.0f + round;
+            for (size_t i = 0; i < count; i++) {
+                sequential[i]->update_parameters(rssi[i], dist[i]);
+            }
+            Anchor::update_parameters_batch(batch.data(), rssi, dist.data(), count);
+            for (size_t i = 0; i < count; i++) {
+                sequential[i]->update_health(z[i], now);
+            }
+            Anchor::update_health_batch(batch.data(), z, count, now);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (!same_anchor_state(*sequential[i], *batched[i])) {
+                std::cerr << isa << " batch differs from the sequential updates at anchor " << i << std::endl;
+                return false;
+            }
+        }
+    }
+    ASSERT_TRUE(select_numeric_kernels("auto"));
+    return true;
+}
+
+// A batch naming an anchor twice, or an anchor moved by compaction, still updates like the sequential path
+bool test_batched_updates_duplicates_and_forwarded() {
+    PointR3 coord = std::make_tuple(1.0f, 2.0f, 2.5f);
+    Anchor sequential("a0", coord, 0.0f);
+    Anchor original("a0", coord, 0.0f);
+    Anchor* twice[2] = {&original, &original};
+    float rssi[2] = {-61.0f, -64.0f};
+    float dist[2] = {2.0f, 3.5f};
+    float z[2] = {1.5f, -0.5f};
+
+    sequential.update_parameters(rssi[0], dist[0]);
+    sequential.update_parameters(rssi[1], dist[1]);
+    sequential.update_health(z[0], 5.0f);
+    sequential.update_health(z[1], 5.0f);
+    Anchor::update_parameters_batch(twice, rssi, dist, 2);
+    Anchor::update_health_batch(twice, z, 2, 5.0f);
+    ASSERT_TRUE(same_anchor_state(sequential, original));
+
+    alignas(Anchor) unsigned char storage[sizeof(Anchor)];
+    Anchor* moved = original.move_into(storage);
+    Anchor* stale[1] = {&original};
+    sequential.update_parameters(rssi[0], dist[0]);
+    sequential.update_health(z[0], 6.0f);
+    Anchor::update_parameters_batch(stale, rssi, dist, 1);
+    Anchor::update_health_batch(stale, z, 1, 6.0f);
+    ASSERT_TRUE(same_anchor_state(sequential, *moved));
+
+    // Old and new copy in one batch are the same anchor
+    Anchor* both[2] = {&original, moved};
+    sequential.update_parameters(rssi[0], dist[0]);
+    sequential.update_parameters(rssi[1], dist[1]);
+    Anchor::update_parameters_batch(both, rssi, dist, 2);
+    ASSERT_TRUE(same_anchor_state(sequential, *moved));
+    moved->~Anchor();
+    return true;
+}
+
+// Unknown or unsupported names leave the selection alone; "" and "auto" pick the best
+bool test_selection() {
+    std::vector<std::string> isas = supported_numeric_isas();
+    ASSERT_TRUE(select_numeric_kernels("scalar"));
+    ASSERT_EQ(std::string("scalar"), std::string(numeric_kernels().isa));
+    ASSERT_TRUE(!select_numeric_kernels("sse9"));
+    ASSERT_EQ(std::string("scalar"), std::string(numeric_kernels().isa));
+    ASSERT_TRUE(select_numeric_kernels(""));
+    ASSERT_EQ(isas.back(), std::string(numeric_kernels().isa));
+    ASSERT_TRUE(select_numeric_kernels("scalar"));
+    ASSERT_TRUE(select_numeric_kernels("auto"));
+    ASSERT_EQ(isas.back(), std::string(numeric_kernels().isa));
+    if (isas.size() < 3) {
+        ASSERT_TRUE(!select_numeric_kernels("avx512"));
+    }
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "    NUMERIC KERNEL TESTS STARTING " << std::endl;
+    std::cout << "==================================" << std::endl;
+    std::cout << "Supported:";
+    for (const auto& isa : supported_numeric_isas()) {
+        std::cout << " " << isa;
+    }
+    std::cout << " (selected: " << numeric_kernels().isa << ")" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_kernels_match_scalar_helpers", test_kernels_match_scalar_helpers);
+    all_passed &= run_test("test_batched_updates_match_sequential", test_batched_updates_match_sequential);
+    all_passed &= run_test("test_batched_updates_duplicates_and_forwarded", test_batched_updates_duplicates_and_forwarded);
+    all_passed &= run_test("test_selection", test_selection);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL NUMERIC KERNEL TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME NUMERIC KERNEL TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
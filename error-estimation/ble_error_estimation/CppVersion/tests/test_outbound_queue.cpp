@@ -0,0 +1,404 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <optional>
+#include <unistd.h>
+#include "../outbound_queue.h"
+
+namespace fs = std::filesystem;
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Fresh, empty spill directory per test
+std::string make_spill_dir(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / ("ble_spill_test_" + std::to_string(getpid()) + "_" + name);
+    fs::remove_all(dir);
+    return dir.string();
+}
+
+size_t count_segments(const std::string& dir) {
+    size_t count = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        (void)entry;
+        count++;
+    }
+    return count;
+}
+
+OutboundMessage make_message(int i) {
+    return OutboundMessage{"test/topic", "payload_" + std::to_string(i)};
+}
+
+// Publishing sink recording everything it accepts; a message's id is its index in payloads
+struct RecordingSink {
+    std::vector<std::string> payloads;
+    bool accept = true;
+
+    OutboundQueue::PublishFn fn() {
+        return [this](const OutboundMessage& message) -> std::optional<int> {
+            if (!accept) {
+                return std::nullopt;
+            }
+            payloads.push_back(message.payload);
+            return static_cast<int>(payloads.size() - 1);
+        };
+    }
+};
+
+bool payloads_in_order(const std::vector<std::string>& payloads, int count) {
+    if (payloads.size() != static_cast<size_t>(count)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (payloads[i] != "payload_" + std::to_string(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Connected and under capacity: messages stay in memory and never touch the disk
+bool test_memory_only_path() {
+    std::string dir = make_spill_dir("memory");
+    OutboundQueue queue(dir, 100, 1024, 1000);
+    queue.set_connected(true);
+
+    for (int i = 0; i < 50; i++) {
+        queue.push(make_message(i));
+    }
+    OutboundQueueStats before = queue.stats();
+    ASSERT_EQ(50u, before.memory_messages);
+    ASSERT_EQ(0u, before.spilled);
+    ASSERT_EQ(0u, count_segments(dir));
+
+    RecordingSink sink;
+    ASSERT_EQ(50u, queue.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 50));
+    ASSERT_EQ(50u, queue.stats().published);
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Disconnected: everything spills to disk and drains in order after reconnect
+bool test_spill_while_disconnected() {
+    std::string dir = make_spill_dir("disconnected");
+    OutboundQueue queue(dir, 10, 1024, 1000);
+
+    RecordingSink sink;
+    for (int i = 0; i < 200; i++) {
+        queue.push(make_message(i));
+    }
+    ASSERT_EQ(0u, queue.drain(sink.fn()));
+
+    OutboundQueueStats spilled = queue.stats();
+    ASSERT_EQ(200u, spilled.spilled);
+    ASSERT_EQ(200u, spilled.disk_messages);
+    ASSERT_EQ(0u, spilled.memory_messages);
+    ASSERT_TRUE(spilled.disk_segments > 1);
+
+    queue.set_connected(true);
+    ASSERT_EQ(200u, queue.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 200));
+
+    // Fully drained: segments are deleted and memory is used again
+    OutboundQueueStats drained = queue.stats();
+    ASSERT_EQ(200u, drained.drained_from_disk);
+    ASSERT_EQ(0u, drained.disk_segments);
+    ASSERT_EQ(0u, count_segments(dir));
+
+    queue.push(make_message(200));
+    ASSERT_EQ(1u, queue.stats().memory_messages);
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Memory full: overflow goes to disk behind memory and order is preserved
+bool test_spill_when_memory_full() {
+    std::string dir = make_spill_dir("full");
+    OutboundQueue queue(dir, 20, 256, 1000);
+    queue.set_connected(true);
+
+    for (int i = 0; i < 100; i++) {
+        queue.push(make_message(i));
+    }
+    OutboundQueueStats stats = queue.stats();
+    ASSERT_EQ(20u, stats.memory_messages);
+    ASSERT_EQ(80u, stats.disk_messages);
+
+    RecordingSink sink;
+    ASSERT_EQ(100u, queue.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 100));
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Pushes interleaved with partial drains keep FIFO order across memory and disk
+bool test_interleaved_push_and_drain() {
+    std::string dir = make_spill_dir("interleaved");
+    OutboundQueue queue(dir, 8, 128, 1000);
+    queue.set_connected(true);
+
+    RecordingSink sink;
+    int next = 0;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 7; i++) {
+            queue.push(make_message(next++));
+        }
+        queue.drain(sink.fn(), 3);
+    }
+    queue.drain(sink.fn());
+    ASSERT_TRUE(payloads_in_order(sink.payloads, next));
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// A rejected publish keeps the message at the head of the queue
+bool test_publish_failure_keeps_message() {
+    std::string dir = make_spill_dir("failure");
+    OutboundQueue queue(dir, 10, 1024, 1000);
+    queue.set_connected(true);
+
+    for (int i = 0; i < 5; i++) {
+        queue.push(make_message(i));
+    }
+
+    RecordingSink sink;
+    sink.accept = false;
+    ASSERT_EQ(0u, queue.drain(sink.fn()));
+    ASSERT_EQ(1u, queue.stats().publish_failures);
+
+    sink.accept = true;
+    ASSERT_EQ(5u, queue.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 5));
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// In-flight limit bounds what is handed to the client until acknowledgements arrive
+bool test_inflight_limit() {
+    std::string dir = make_spill_dir("inflight");
+    OutboundQueue queue(dir, 100, 1024, 4);
+    queue.set_connected(true);
+
+    for (int i = 0; i < 10; i++) {
+        queue.push(make_message(i));
+    }
+
+    RecordingSink sink;
+    ASSERT_EQ(4u, queue.drain(sink.fn()));
+    ASSERT_EQ(4u, queue.stats().inflight);
+
+    // Acknowledgements may come out of order
+    queue.on_published(2);
+    queue.on_published(0);
+    ASSERT_EQ(2u, queue.drain(sink.fn()));
+
+    // The client resends its unacknowledged messages after a reconnect: they still count
+    queue.set_connected(false);
+    ASSERT_EQ(4u, queue.stats().inflight);
+    queue.set_connected(true);
+    ASSERT_EQ(0u, queue.drain(sink.fn()));
+
+    for (int id : {1, 3, 4, 5}) {
+        queue.on_published(id);
+    }
+    ASSERT_EQ(4u, queue.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 10));
+
+    // Repeated and unknown acknowledgements are ignored
+    for (int id : {1, 6, 7, 8, 9, 9, 42}) {
+        queue.on_published(id);
+    }
+    ASSERT_EQ(0u, queue.stats().inflight);
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Messages still in RAM on shutdown are delivered first by the next process, before the disk tail
+bool test_flush_to_disk_on_shutdown() {
+    std::string dir = make_spill_dir("flush");
+    {
+        // Memory only
+        OutboundQueue queue(dir, 100, 1024, 1000);
+        queue.set_connected(true);
+        for (int i = 0; i < 5; i++) {
+            queue.push(make_message(i));
+        }
+        ASSERT_EQ(5u, queue.flush_to_disk());
+        ASSERT_EQ(0u, queue.stats().memory_messages);
+    }
+    {
+        OutboundQueue next(dir, 100, 1024, 1000);
+        ASSERT_EQ(5u, next.stats().disk_messages);
+        next.set_connected(true);
+        RecordingSink sink;
+        ASSERT_EQ(5u, next.drain(sink.fn()));
+        ASSERT_TRUE(payloads_in_order(sink.payloads, 5));
+    }
+
+    // Memory refilled from a partly read head segment, with more segments behind it
+    {
+        OutboundQueue queue(dir, 10, 200, 1000);
+        for (int i = 0; i < 50; i++) {
+            queue.push(make_message(i));
+        }
+        queue.set_connected(true);
+        RecordingSink sink;
+        ASSERT_EQ(7u, queue.drain(sink.fn(), 7));
+        for (int id = 0; id < 7; id++) {
+            queue.on_published(id);
+        }
+        ASSERT_TRUE(queue.stats().memory_messages > 0);
+        size_t in_memory = queue.stats().memory_messages;
+        ASSERT_EQ(in_memory, queue.flush_to_disk());
+        ASSERT_EQ(43u, queue.stats().disk_messages);
+    }
+    {
+        OutboundQueue next(dir, 10, 200, 1000);
+        ASSERT_EQ(43u, next.stats().disk_messages);
+        next.set_connected(true);
+        RecordingSink sink;
+        ASSERT_EQ(43u, next.drain(sink.fn()));
+        for (int i = 0; i < 43; i++) {
+            ASSERT_EQ("payload_" + std::to_string(i + 7), sink.payloads[static_cast<size_t>(i)]);
+        }
+    }
+    ASSERT_EQ(0u, count_segments(dir));
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Published messages still unacknowledged on shutdown are written first, in publishing order
+bool test_flush_keeps_unacknowledged() {
+    std::string dir = make_spill_dir("unacknowledged");
+    {
+        OutboundQueue queue(dir, 100, 1024, 1000);
+        queue.set_connected(true);
+        for (int i = 0; i < 10; i++) {
+            queue.push(make_message(i));
+        }
+        RecordingSink sink;
+        ASSERT_EQ(6u, queue.drain(sink.fn(), 6));
+        queue.on_published(1);   // The only acknowledgement received
+        ASSERT_EQ(5u, queue.stats().inflight);
+
+        ASSERT_EQ(9u, queue.flush_to_disk());
+        ASSERT_EQ(0u, queue.stats().inflight);
+        queue.on_published(3);   // Too late: already on disk
+    }
+    OutboundQueue next(dir, 100, 1024, 1000);
+    ASSERT_EQ(9u, next.stats().disk_messages);
+    next.set_connected(true);
+    RecordingSink sink;
+    ASSERT_EQ(9u, next.drain(sink.fn()));
+    std::vector<std::string> expected;
+    for (int i = 0; i < 10; i++) {
+        if (i != 1) {
+            expected.push_back("payload_" + std::to_string(i));
+        }
+    }
+    ASSERT_TRUE(sink.payloads == expected);
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Segments left by a previous process are recovered and delivered first
+bool test_recovery_after_restart() {
+    std::string dir = make_spill_dir("recovery");
+    {
+        OutboundQueue queue(dir, 10, 200, 1000);
+        for (int i = 0; i < 50; i++) {
+            queue.push(make_message(i));
+        }
+    }
+
+    // Simulate a crash in the middle of a record
+    {
+        std::ofstream partial(fs::path(dir) / "spill_999999999999.log", std::ios::binary);
+        uint32_t topic_len = 10;
+        partial.write(reinterpret_cast<const char*>(&topic_len), sizeof(topic_len));
+    }
+
+    // Foreign files are left alone, whatever their name
+    std::ofstream(fs::path(dir) / "spill_12\xc3\xa9.log") << "not a segment";
+    std::ofstream(fs::path(dir) / "spill_.log") << "not a segment";
+
+    OutboundQueue recovered(dir, 10, 200, 1000);
+    ASSERT_EQ(50u, recovered.stats().disk_messages);
+
+    recovered.set_connected(true);
+    recovered.push(make_message(50));
+
+    RecordingSink sink;
+    ASSERT_EQ(51u, recovered.drain(sink.fn()));
+    ASSERT_TRUE(payloads_in_order(sink.payloads, 51));
+    ASSERT_EQ(2u, count_segments(dir));
+
+    fs::remove_all(dir);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "  OUTBOUND QUEUE TESTS STARTING   " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_memory_only_path", test_memory_only_path);
+    all_passed &= run_test("test_spill_while_disconnected", test_spill_while_disconnected);
+    all_passed &= run_test("test_spill_when_memory_full", test_spill_when_memory_full);
+    all_passed &= run_test("test_interleaved_push_and_drain", test_interleaved_push_and_drain);
+    all_passed &= run_test("test_publish_failure_keeps_message", test_publish_failure_keeps_message);
+    all_passed &= run_test("test_inflight_limit", test_inflight_limit);
+    all_passed &= run_test("test_flush_to_disk_on_shutdown", test_flush_to_disk_on_shutdown);
+    all_passed &= run_test("test_flush_keeps_unacknowledged", test_flush_keeps_unacknowledged);
+    all_passed &= run_test("test_recovery_after_restart", test_recovery_after_restart);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL OUTBOUND QUEUE TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME OUTBOUND QUEUE TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,449 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "../position_ring.h"
+#include "../processing.h"
+#include "../pipeline.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Unique segment name per test so runs never collide
+std::string segment_name(const std::string& test) {
+    std::string name = "/ble_ring_test_" + std::to_string(getpid()) + "_" + test;
+    PositionRing::unlink(name);
+    return name;
+}
+
+PositionRecord make_record(const std::string& tag_mac, float x, double timestamp) {
+    PositionRecord record{};
+    std::copy(tag_mac.begin(), tag_mac.end(), record.tag_mac);
+    record.x = x;
+    record.timestamp = timestamp;
+    return record;
+}
+
+// The layout producers compile against, and the views over its fixed-size strings
+bool test_record_layout() {
+    ASSERT_EQ(static_cast<size_t>(0), offsetof(PositionRecord, tag_mac));
+    ASSERT_EQ(static_cast<size_t>(16), offsetof(PositionRecord, x));
+    ASSERT_EQ(static_cast<size_t>(28), offsetof(PositionRecord, reading_count));
+    ASSERT_EQ(static_cast<size_t>(32), offsetof(PositionRecord, timestamp));
+    ASSERT_EQ(static_cast<size_t>(40), offsetof(PositionRecord, readings));
+    ASSERT_EQ(static_cast<size_t>(20), sizeof(PositionReading));
+
+    PositionRecord record = make_record("c00fbe457cd3", 0.0f, 0.0);
+    std::string full_mac(15, 'f');
+    std::copy(full_mac.begin(), full_mac.end(), record.readings[0].mac);
+    ASSERT_TRUE(record.tag() == "c00fbe457cd3");
+    ASSERT_TRUE(record.anchor(0) == full_mac);
+    return true;
+}
+
+// Records come out in push order; a full ring rejects pushes and counts them
+bool test_push_pop_in_order() {
+    std::string name = segment_name("order");
+    {
+        PositionRing ring(name, 5);
+        ASSERT_TRUE(ring.is_creator());
+        ASSERT_EQ(8u, ring.capacity());
+
+        for (int lap = 0; lap < 3; lap++) {
+            for (int i = 0; i < 8; i++) {
+                ASSERT_TRUE(ring.push(make_record("tag", static_cast<float>(i), lap)));
+            }
+            ASSERT_TRUE(!ring.push(make_record("tag", 99.0f, lap)));
+            ASSERT_EQ(static_cast<size_t>(8), ring.size());
+
+            PositionRecord out{};
+            for (int i = 0; i < 8; i++) {
+                ASSERT_TRUE(ring.pop(out));
+                ASSERT_EQ(static_cast<float>(i), out.x);
+                ASSERT_EQ(static_cast<double>(lap), out.timestamp);
+            }
+            ASSERT_TRUE(!ring.pop(out));
+            ASSERT_EQ(static_cast<size_t>(0), ring.size());
+        }
+        ASSERT_EQ(static_cast<uint64_t>(3), ring.dropped());
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// A second mapping attaches to the same ring instead of creating one
+bool test_attach_shares_ring() {
+    std::string name = segment_name("attach");
+    {
+        PositionRing consumer(name, 16);
+        PositionRing producer(name, 1024);
+        ASSERT_TRUE(!producer.is_creator());
+        ASSERT_EQ(16u, producer.capacity());
+
+        ASSERT_TRUE(producer.push(make_record("shared", 7.0f, 1.0)));
+        PositionRecord out{};
+        ASSERT_TRUE(consumer.pop(out));
+        ASSERT_TRUE(out.tag() == "shared");
+        ASSERT_EQ(7.0f, out.x);
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// Start of the segment header as position_ring.cpp lays it out, up to the enqueue position
+struct RingHeaderPrefix {
+    uint32_t magic;
+    uint32_t layout_version;
+    uint32_t capacity;
+    uint32_t record_bytes;
+    alignas(64) std::atomic<uint64_t> enqueue_position;
+};
+
+// Claim the next slot the way push() does and never publish it, like a producer killed mid-push
+bool claim_like_dead_producer(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0660);
+    if (fd < 0) {
+        return false;
+    }
+    void* base = mmap(nullptr, sizeof(RingHeaderPrefix), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    static_cast<RingHeaderPrefix*>(base)->enqueue_position.fetch_add(1);
+    munmap(base, sizeof(RingHeaderPrefix));
+    return true;
+}
+
+// A slot claimed by a producer that never publishes is skipped after the stall timeout, not waited on forever
+bool test_dead_producer_slot_skipped() {
+    std::string name = segment_name("stall");
+    {
+        PositionRing ring(name, 4, 50);
+        PositionRecord out{};
+        ASSERT_TRUE(ring.push(make_record("before", 1.0f, 1.0)));
+        ASSERT_TRUE(claim_like_dead_producer(name));
+        ASSERT_TRUE(ring.push(make_record("after", 2.0f, 2.0)));
+
+        ASSERT_TRUE(ring.pop(out));
+        ASSERT_TRUE(out.tag() == "before");
+        // Within the timeout the producer might still publish
+        ASSERT_TRUE(!ring.pop(out));
+        ASSERT_TRUE(!ring.pop(out));
+        ASSERT_EQ(static_cast<uint64_t>(0), ring.dropped());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        ASSERT_TRUE(ring.pop(out));
+        ASSERT_TRUE(out.tag() == "after");
+        ASSERT_EQ(static_cast<uint64_t>(1), ring.dropped());
+        ASSERT_EQ(static_cast<size_t>(0), ring.size());
+
+        // The skipped slot went back to the producers: a full lap still fits
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.push(make_record("lap", static_cast<float>(i), 3.0)));
+        }
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(ring.pop(out));
+            ASSERT_EQ(static_cast<float>(i), out.x);
+        }
+        ASSERT_TRUE(!ring.pop(out));
+        ASSERT_EQ(static_cast<uint64_t>(1), ring.dropped());
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// Concurrent producers lose nothing and each producer's records stay in order
+bool test_concurrent_producers() {
+    std::string name = segment_name("mpsc");
+    const int producers = 4;
+    const int per_producer = 20000;
+    {
+        PositionRing ring(name, 256);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&name, p]() {
+                PositionRing mapping(name, 256);
+                for (int i = 0; i < per_producer; i++) {
+                    PositionRecord record = make_record("tag" + std::to_string(p), static_cast<float>(p), i);
+                    while (!mapping.push(record)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<double> last(producers, -1.0);
+        int received = 0;
+        PositionRecord out{};
+        while (received < producers * per_producer) {
+            if (!ring.pop(out)) {
+                ring.wait(10);
+                continue;
+            }
+            int p = static_cast<int>(out.x);
+            ASSERT_TRUE(out.timestamp > last[p]);
+            ASSERT_TRUE(out.tag() == "tag" + std::to_string(p));
+            last[p] = out.timestamp;
+            received++;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (int p = 0; p < producers; p++) {
+            ASSERT_EQ(static_cast<double>(per_producer - 1), last[p]);
+        }
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// A producer process wakes a consumer sleeping in another process
+bool test_producer_process_wakes_consumer() {
+    std::string name = segment_name("process");
+    const int count = 1000;
+    {
+        PositionRing ring(name, 64);
+        pid_t child = fork();
+        if (child == 0) {
+            PositionProducer producer(name);
+            for (int i = 0; i < count; i++) {
+                while (!producer.publish("c00fbe457cd3", static_cast<float>(i), 2.0f, 0.0f, i,
+                                         {{"ce59ac2d9cc5", -60.0f}, {"d39d76bbc21b", -70.0f}})) {
+                    usleep(100);
+                }
+            }
+            _exit(0);
+        }
+
+        int received = 0;
+        int waits = 0;
+        PositionRecord out{};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (received < count && std::chrono::steady_clock::now() < deadline) {
+            if (!ring.pop(out)) {
+                ring.wait(1000);
+                waits++;
+                continue;
+            }
+            ASSERT_EQ(static_cast<float>(received), out.x);
+            ASSERT_EQ(2u, out.reading_count);
+            ASSERT_TRUE(out.anchor(1) == "d39d76bbc21b");
+            received++;
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        ASSERT_EQ(count, received);
+        ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// wait() returns as soon as a record is pushed, and on wake() without one
+bool test_wait_wakes_on_push() {
+    std::string name = segment_name("wait");
+    {
+        PositionRing ring(name, 16);
+        ASSERT_TRUE(!ring.wait(1));
+
+        std::thread producer([&name]() {
+            PositionRing mapping(name, 16);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            mapping.push(make_record("tag", 1.0f, 1.0));
+        });
+        auto start = std::chrono::steady_clock::now();
+        bool ready = ring.wait(5000);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        producer.join();
+        ASSERT_TRUE(ready);
+        ASSERT_TRUE(elapsed < std::chrono::seconds(2));
+
+        PositionRecord out{};
+        ASSERT_TRUE(ring.pop(out));
+        std::thread waker([&ring]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            ring.wake();
+        });
+        start = std::chrono::steady_clock::now();
+        ready = ring.wait(5000);
+        elapsed = std::chrono::steady_clock::now() - start;
+        waker.join();
+        ASSERT_TRUE(!ready);
+        ASSERT_TRUE(elapsed < std::chrono::seconds(2));
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// Readings the engine would drop are left out, then too many keep the strongest in their order;
+// over-long MACs are refused
+bool test_producer_keeps_strongest() {
+    std::string name = segment_name("strongest");
+    {
+        PositionProducer producer(name, 16);
+        std::vector<std::string> macs;
+        std::vector<PositionProducer::Reading> readings;
+        for (int i = 0; i < 22; i++) {
+            macs.push_back("anchor" + std::to_string(i));
+        }
+        for (int i = 0; i < 22; i++) {
+            // Readings 0, 5, 10, 15 and 20 are outside the window; 17 remain, reading 21 is the weakest
+            readings.push_back({macs[i], i % 5 == 0 ? -95.0f : -60.0f - 0.25f * i});
+        }
+        ASSERT_TRUE(producer.publish("tag", 1.0f, 2.0f, 3.0f, 10.0, readings.data(), readings.size()));
+
+        PositionRecord out{};
+        ASSERT_TRUE(producer.ring().pop(out));
+        ASSERT_EQ(static_cast<uint32_t>(PositionRecord::MAX_READINGS), out.reading_count);
+        std::vector<std::string> kept;
+        for (size_t i = 0; i < out.reading_count; i++) {
+            kept.emplace_back(out.anchor(i));
+        }
+        std::vector<std::string> expected;
+        for (int i = 0; i < 21; i++) {
+            if (i % 5 != 0) {
+                expected.push_back(macs[i]);
+            }
+        }
+        ASSERT_TRUE(kept == expected);
+
+        // Few readings: only the window cut applies
+        ASSERT_TRUE(producer.publish("tag", 1.0f, 2.0f, 3.0f, 11.0, {{"a1", -57.0f}, {"a2", -70.0f}, {"a3", -66.0f}}));
+        ASSERT_TRUE(producer.ring().pop(out));
+        ASSERT_EQ(2u, out.reading_count);
+        ASSERT_TRUE(out.anchor(0) == "a1" && out.anchor(1) == "a3");
+
+        ASSERT_TRUE(!producer.publish("tag", 0.0f, 0.0f, 0.0f, 0.0, {{"0123456789abcdef", -60.0f}}));
+        ASSERT_TRUE(!producer.publish("0123456789abcdef", 0.0f, 0.0f, 0.0f, 0.0, {}));
+        ASSERT_EQ(static_cast<size_t>(0), producer.ring().size());
+    }
+    PositionRing::unlink(name);
+    return true;
+}
+
+// A record gives the same estimate and anchor updates as the equivalent JSON message
+bool test_record_matches_json_message() {
+    std::map<std::string, std::tuple<float, float, float>> site = {
+        {"ce59ac2d9cc5", {0.0f, 0.0f, 2.5f}}, {"d39d76bbc21b", {10.0f, 0.0f, 2.5f}},
+        {"e1c2d3a4b5f6", {0.0f, 8.0f, 2.5f}}, {"f7a8b9c0d1e2", {10.0f, 8.0f, 2.5f}},
+    };
+    auto attach = [&site](ProcessingContext& context) {
+        context.fetch_anchor = [&site](const std::string& mac) {
+            auto [x, y, z] = site.at(mac);
+            return json::array({{{"macAddress", mac}, {"x", x}, {"y", y}, {"z", z}}}).dump();
+        };
+    };
+    ProcessingContext from_json;
+    ProcessingContext from_record;
+    attach(from_json);
+    attach(from_record);
+
+    for (int i = 0; i < 50; i++) {
+        float x = 2.0f + 0.1f * i;
+        float y = 3.0f - 0.05f * i;
+        double timestamp = 1751374881.0 + i;
+        std::vector<std::pair<std::string, float>> used = {
+            {"ce59ac2d9cc5", -58.0f - i % 7}, {"d39d76bbc21b", -66.0f + i % 5},
+            {"e1c2d3a4b5f6", -71.0f - i % 3}, {"f7a8b9c0d1e2", -75.0f + i % 4},
+        };
+
+        json used_anchors = json::array();
+        std::vector<PositionProducer::Reading> readings;
+        for (const auto& [mac, rssi] : used) {
+            used_anchors.push_back({{"mac", mac}, {"rssi", rssi}});
+            readings.push_back({mac, rssi});
+        }
+        json message = {
+            {"location", {{"position", {{"x", x}, {"y", y}, {"z", 1.0f}, {"used_anchors", used_anchors}}}}},
+            {"tag", {{"mac", "c00fbe457cd3"}}},
+            {"timestamp", timestamp}
+        };
+
+        PositionRecord record = make_record("c00fbe457cd3", x, timestamp);
+        record.y = y;
+        record.z = 1.0f;
+        record.reading_count = static_cast<uint32_t>(readings.size());
+        for (size_t r = 0; r < readings.size(); r++) {
+            std::copy(readings[r].mac.begin(), readings[r].mac.end(), record.readings[r].mac);
+            record.readings[r].rssi = readings[r].rssi;
+        }
+
+        std::optional<json> expected = process_tag_message(from_json, message.dump());
+
+        TagMessage parsed = parse_position_record(from_record, record);
+        for (const auto& mac : parsed.unresolved_anchors) {
+            from_record.anchors.insert(create_anchor_class(from_record, mac));
+        }
+        std::optional<json> actual = evaluate_tag_message(from_record, parsed);
+
+        ASSERT_EQ(expected.has_value(), actual.has_value());
+        if (expected) {
+            ASSERT_EQ(expected->dump(), actual->dump());
+        }
+    }
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "   POSITION RING TESTS STARTING   " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_record_layout", test_record_layout);
+    all_passed &= run_test("test_push_pop_in_order", test_push_pop_in_order);
+    all_passed &= run_test("test_attach_shares_ring", test_attach_shares_ring);
+    all_passed &= run_test("test_concurrent_producers", test_concurrent_producers);
+    all_passed &= run_test("test_dead_producer_slot_skipped", test_dead_producer_slot_skipped);
+    all_passed &= run_test("test_producer_process_wakes_consumer", test_producer_process_wakes_consumer);
+    all_passed &= run_test("test_wait_wakes_on_push", test_wait_wakes_on_push);
+    all_passed &= run_test("test_producer_keeps_strongest", test_producer_keeps_strongest);
+    all_passed &= run_test("test_record_matches_json_message", test_record_matches_json_message);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL POSITION RING TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME POSITION RING TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,359 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include "../processing.h"
+#include "../pipeline.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Tag position message in the engine's input format
+std::string tag_message(const std::string& tag_mac, const std::vector<std::pair<std::string, float>>& used,
+                        const std::vector<std::string>& unused = {}) {
+    json used_anchors = json::array();
+    for (const auto& [mac, rssi] : used) {
+        used_anchors.push_back({{"mac", mac}, {"rssi", rssi}});
+    }
+    json unused_anchors = json::array();
+    for (const auto& mac : unused) {
+        unused_anchors.push_back({{"mac", mac}, {"rssi", -80.0f}});
+    }
+    json message = {
+        {"location", {{"position", {{"x", 5.0f}, {"y", 2.0f}, {"z", 0.0f},
+                                    {"used_anchors", used_anchors}, {"unused_anchors", unused_anchors}}}}},
+        {"tag", {{"mac", tag_mac}}},
+        {"timestamp", 1751374881169.0}
+    };
+    return message.dump();
+}
+
+// Context whose fetcher answers from a fixed table, like the dongles API
+struct FakeApi {
+    std::map<std::string, std::tuple<float, float, float>> positions;
+    std::map<std::string, int> calls;
+
+    void attach(ProcessingContext& context) {
+        context.fetch_anchor = [this](const std::string& mac) {
+            calls[mac]++;
+            auto it = positions.find(mac);
+            if (it == positions.end()) {
+                return std::string("[]");
+            }
+            auto [x, y, z] = it->second;
+            return json::array({{{"macAddress", mac}, {"x", x}, {"y", y}, {"z", z}}}).dump();
+        };
+    }
+};
+
+// Asynchronous fetcher whose requests stay pending until the test answers them
+struct PendingApi {
+    std::map<std::string, std::tuple<float, float, float>> positions;
+    std::vector<std::pair<std::string, std::function<void(std::string, std::string)>>> pending;
+
+    AsyncAnchorFetcher fetcher() {
+        return [this](const std::string& mac, std::function<void(std::string, std::string)> done) {
+            pending.emplace_back(mac, std::move(done));
+        };
+    }
+
+    // Answer every pending request, as the reactor would when responses arrive
+    void answer_all() {
+        auto requests = std::move(pending);
+        pending.clear();
+        for (auto& [mac, done] : requests) {
+            auto it = positions.find(mac);
+            if (it == positions.end()) {
+                done("", "HTTP 404");
+                continue;
+            }
+            auto [x, y, z] = it->second;
+            done(json::array({{{"macAddress", mac}, {"x", x}, {"y", y}, {"z", z}}}).dump(), "");
+        }
+    }
+};
+
+// Runs a message coroutine and stores its result once it finishes
+struct AsyncResult {
+    bool done = false;
+    std::optional<json> output;
+};
+
+Task<void> run_async(ProcessingContext& context, AnchorResolver& resolver, std::string payload, AsyncResult& result) {
+    result.output = co_await process_tag_message_async(context, resolver, std::move(payload));
+    result.done = true;
+}
+
+// The {} placeholder is replaced by the MAC address
+bool test_anchor_api_url() {
+    ASSERT_EQ(std::string("https://host/api/dongles?macAddress=aabb"),
+              anchor_api_url("https://host/api/dongles?macAddress={}", "aabb"));
+    ASSERT_EQ(std::string("https://host/static"), anchor_api_url("https://host/static", "aabb"));
+    return true;
+}
+
+// API responses become anchors; empty responses are errors
+bool test_anchor_from_api_response() {
+    auto anchor = anchor_from_api_response("ce59ac2d9cc5", R"([{"x": 1.5, "y": 2.5, "z": 3.0}])");
+    ASSERT_EQ(std::string("ce59ac2d9cc5"), anchor->get_mac_address());
+    ASSERT_EQ(1.5f, std::get<0>(anchor->get_coord()));
+    ASSERT_EQ(3.0f, std::get<2>(anchor->get_coord()));
+
+    bool threw = false;
+    try {
+        anchor_from_api_response("ce59ac2d9cc5", "[]");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    return true;
+}
+
+// The first message discovers used and unused anchors; the output lists evaluated anchors
+bool test_first_message_discovers_anchors() {
+    ProcessingContext context;
+    FakeApi api;
+    api.positions = {{"a1", {0.0f, 0.0f, 2.5f}}, {"a2", {10.0f, 0.0f, 2.5f}}, {"a3", {10.0f, 8.0f, 2.5f}}};
+    api.attach(context);
+
+    auto output = process_tag_message(context, tag_message("tag1", {{"a1", -57.0f}, {"a2", -60.0f}}, {"a3"}));
+    ASSERT_TRUE(output.has_value());
+    ASSERT_EQ(std::string("tag1"), (*output)["tag_mac"].get<std::string>());
+    ASSERT_TRUE((*output)["error_estimate"].get<float>() > 0.0f);
+    ASSERT_EQ(2u, (*output)["anchors_selected_for_estimation"].size());
+    ASSERT_TRUE((*output).contains("warning_anchors"));
+    ASSERT_TRUE((*output).contains("faulty_anchors"));
+
+    ASSERT_EQ(3u, context.anchors.size());
+    ASSERT_EQ(1, api.calls["a3"]);
+    return true;
+}
+
+// Only readings within the selection window of the strongest survive parsing, in any input order
+bool test_weak_readings_dropped_at_parse() {
+    std::vector<std::pair<std::string, float>> used;
+    for (int i = 0; i < 25; i++) {
+        int rank = (i * 7) % 25;   // Shuffled: rank 0 is the strongest, 1 dB apart
+        used.push_back({"a" + std::to_string(rank), -50.0f - rank});
+    }
+    json message = json::parse(tag_message("tag1", used));
+
+    Tag tag = create_tag_class(message);
+    const auto& readings = tag.get_rssi_readings();
+    ASSERT_EQ(11u, readings.size());   // -50 to -60 dBm
+    for (int rank = 0; rank <= 10; rank++) {
+        ASSERT_EQ(-50.0f - rank, readings.at("a" + std::to_string(rank)));
+    }
+
+    // A repeated MAC keeps its last reading within the window
+    json repeated = json::parse(tag_message("tag1", {{"c1", -70.0f}, {"c2", -65.0f}, {"c1", -55.0f}}));
+    Tag repeated_tag = create_tag_class(repeated);
+    ASSERT_EQ(-55.0f, repeated_tag.get_rssi_readings().at("c1"));
+    ASSERT_EQ(-65.0f, repeated_tag.get_rssi_readings().at("c2"));
+    return true;
+}
+
+// Faulty anchors do not count towards the parse-time cut: healthy anchors in the window stay selectable
+bool test_strong_faulty_anchors_keep_selectable() {
+    std::vector<std::pair<std::string, float>> used;
+    for (int i = 0; i < 10; i++) {
+        used.push_back({"f" + std::to_string(i), -50.0f - 0.5f * i});
+    }
+    used.push_back({"h0", -56.0f});
+    used.push_back({"h1", -57.0f});
+    used.push_back({"w0", -75.0f});   // Below the window
+    json message = json::parse(tag_message("tag1", used));
+
+    ProcessingContext context;
+    std::vector<std::unique_ptr<Anchor>> anchors;
+    for (const auto& [mac, rssi] : used) {
+        anchors.push_back(std::make_unique<Anchor>(mac, std::make_tuple(1.0f, 1.0f, 2.5f), 0.0f));
+        if (mac[0] == 'f') {
+            anchors.back()->restore_calibration(-59.0f, 2.0f, 9.0f, 0.0f);
+        }
+    }
+    context.anchors.insert_all(std::move(anchors));
+    context.anchors_initialized = true;
+
+    Tag tag = create_tag_class(message);
+    ASSERT_EQ(used.size() - 1, tag.get_rssi_readings().size());
+    ASSERT_EQ(0u, tag.get_rssi_readings().count("w0"));
+
+    // Both healthy anchors are selected for estimation, as with every reading kept
+    std::vector<Anchor*> anch_list;
+    {
+        auto guard = context.anchors.read();
+        for (const auto& [mac, rssi] : tag.get_rssi_readings()) {
+            anch_list.push_back(guard.find(mac));
+        }
+    }
+    TagSystem system(tag, context.model);
+    std::vector<Anchor*> significant = system.get_significant_anchors(anch_list);
+    ASSERT_EQ(2u, significant.size());
+    ASSERT_EQ(std::string("h0"), significant[0]->get_mac_address());
+    ASSERT_EQ(std::string("h1"), significant[1]->get_mac_address());
+
+    TagMessage parsed{json(), tag, 1751374881169.0f, {}, false};
+    std::optional<json> output = evaluate_tag_message(context, parsed);
+    ASSERT_TRUE(output.has_value());
+    ASSERT_EQ(used.size() - 1, (*output)["anchors_selected_for_estimation"].size());
+    ASSERT_EQ(10u, (*output)["faulty_anchors"].size());
+    return true;
+}
+
+// Anchors seen later are fetched once; unknown anchors are skipped
+bool test_new_anchors_fetched_once() {
+    ProcessingContext context;
+    FakeApi api;
+    api.positions = {{"a1", {0.0f, 0.0f, 2.5f}}, {"a2", {10.0f, 0.0f, 2.5f}}};
+    api.attach(context);
+
+    ASSERT_TRUE(process_tag_message(context, tag_message("tag1", {{"a1", -57.0f}})).has_value());
+    for (int i = 0; i < 3; i++) {
+        auto output = process_tag_message(context, tag_message("tag1", {{"a1", -57.0f}, {"a2", -61.0f}, {"ghost", -65.0f}}));
+        ASSERT_TRUE(output.has_value());
+        ASSERT_EQ(2u, (*output)["anchors_selected_for_estimation"].size());
+    }
+    ASSERT_EQ(1, api.calls["a1"]);
+    ASSERT_EQ(1, api.calls["a2"]);
+    ASSERT_EQ(3, api.calls["ghost"]);   // Still unknown, retried on each message
+    ASSERT_EQ(2u, context.anchors.size());
+    return true;
+}
+
+// No known anchors gives no output; malformed messages throw
+bool test_unresolvable_and_malformed_messages() {
+    ProcessingContext context;
+    FakeApi api;
+    api.attach(context);
+
+    ASSERT_TRUE(!process_tag_message(context, tag_message("tag1", {{"ghost", -70.0f}})).has_value());
+
+    bool threw = false;
+    try {
+        process_tag_message(context, "{not json");
+    } catch (const json::exception&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    return true;
+}
+
+// Messages needing an unknown anchor suspend and share one request per MAC address
+bool test_async_messages_share_lookup() {
+    ProcessingContext context;
+    PendingApi api;
+    api.positions = {{"a1", {0.0f, 0.0f, 2.5f}}, {"a2", {10.0f, 0.0f, 2.5f}}};
+    AnchorResolver resolver(context, api.fetcher());
+
+    AsyncResult first;
+    spawn(run_async(context, resolver, tag_message("tag1", {{"a1", -57.0f}}), first));
+    ASSERT_TRUE(!first.done);
+    ASSERT_EQ(1u, api.pending.size());
+    api.answer_all();
+    ASSERT_TRUE(first.done);
+    ASSERT_TRUE(first.output.has_value());
+
+    // Three messages of different tags wait on the same new anchor
+    std::vector<AsyncResult> results(3);
+    for (size_t i = 0; i < results.size(); i++) {
+        spawn(run_async(context, resolver, tag_message("tag" + std::to_string(i), {{"a1", -57.0f}, {"a2", -61.0f}}), results[i]));
+        ASSERT_TRUE(!results[i].done);
+    }
+    ASSERT_EQ(1u, api.pending.size());
+    ASSERT_EQ(1u, resolver.in_flight());
+
+    // A message whose anchors are all known does not wait
+    AsyncResult known;
+    spawn(run_async(context, resolver, tag_message("tag9", {{"a1", -57.0f}}), known));
+    ASSERT_TRUE(known.done);
+
+    api.answer_all();
+    for (const auto& result : results) {
+        ASSERT_TRUE(result.done);
+        ASSERT_EQ(2u, (*result.output)["anchors_selected_for_estimation"].size());
+    }
+    ASSERT_EQ(0u, resolver.in_flight());
+    ASSERT_EQ(2u, resolver.lookups_started());
+    return true;
+}
+
+// Failed lookups resume their waiters without the anchor and are retried by later messages
+bool test_async_failed_lookup_retried() {
+    ProcessingContext context;
+    PendingApi api;
+    api.positions = {{"a1", {0.0f, 0.0f, 2.5f}}};
+    AnchorResolver resolver(context, api.fetcher());
+
+    AsyncResult first;
+    spawn(run_async(context, resolver, tag_message("tag1", {{"a1", -57.0f}, {"ghost", -70.0f}}), first));
+    ASSERT_EQ(2u, api.pending.size());
+    api.answer_all();
+    ASSERT_TRUE(first.done);
+    ASSERT_EQ(1u, (*first.output)["anchors_selected_for_estimation"].size());
+
+    AsyncResult second;
+    spawn(run_async(context, resolver, tag_message("tag1", {{"ghost", -70.0f}}), second));
+    ASSERT_EQ(1u, api.pending.size());
+    api.answer_all();
+    ASSERT_TRUE(second.done);
+    ASSERT_TRUE(!second.output.has_value());
+    ASSERT_EQ(3u, resolver.lookups_started());
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "     PROCESSING TESTS STARTING    " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_anchor_api_url", test_anchor_api_url);
+    all_passed &= run_test("test_anchor_from_api_response", test_anchor_from_api_response);
+    all_passed &= run_test("test_first_message_discovers_anchors", test_first_message_discovers_anchors);
+    all_passed &= run_test("test_weak_readings_dropped_at_parse", test_weak_readings_dropped_at_parse);
+    all_passed &= run_test("test_strong_faulty_anchors_keep_selectable", test_strong_faulty_anchors_keep_selectable);
+    all_passed &= run_test("test_new_anchors_fetched_once", test_new_anchors_fetched_once);
+    all_passed &= run_test("test_unresolvable_and_malformed_messages", test_unresolvable_and_malformed_messages);
+    all_passed &= run_test("test_async_messages_share_lookup", test_async_messages_share_lookup);
+    all_passed &= run_test("test_async_failed_lookup_retried", test_async_failed_lookup_retried);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL PROCESSING TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME PROCESSING TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
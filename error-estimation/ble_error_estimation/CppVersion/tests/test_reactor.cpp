@@ -0,0 +1,277 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <curl/curl.h>
+#include "../reactor.h"
+#include "../worker_pool.h"
+#include "../http_client.h"
+#include "http_standin.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Run the reactor on the calling thread until the condition holds or the timeout expires
+template <typename Condition>
+bool run_until(Reactor& reactor, Condition done, int timeout_ms = 2000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        reactor.run_once(10);
+    }
+    return true;
+}
+
+// One-shot timers fire in expiry order; periodic timers repeat until cancelled
+bool test_timers_fire_in_order() {
+    Reactor reactor(5, 8);
+    std::vector<int> fired;
+    reactor.add_timer(60, [&]() { fired.push_back(3); });   // Longer than one wheel revolution (40ms)
+    reactor.add_timer(20, [&]() { fired.push_back(2); });
+    reactor.add_timer(1, [&]() { fired.push_back(1); });
+    Reactor::TimerId cancelled = reactor.add_timer(10, [&]() { fired.push_back(99); });
+    ASSERT_TRUE(reactor.cancel_timer(cancelled));
+
+    int ticks = 0;
+    Reactor::TimerId periodic = 0;
+    periodic = reactor.add_periodic(5, [&]() {
+        if (++ticks == 3) {
+            reactor.cancel_timer(periodic);
+        }
+    });
+
+    ASSERT_TRUE(run_until(reactor, [&]() { return fired.size() == 3 && ticks >= 3; }));
+    ASSERT_EQ(1, fired[0]);
+    ASSERT_EQ(2, fired[1]);
+    ASSERT_EQ(3, fired[2]);
+
+    // Nothing else fires afterwards
+    for (int i = 0; i < 5; i++) {
+        reactor.run_once(10);
+    }
+    ASSERT_EQ(3, ticks);
+    ASSERT_EQ(3u, fired.size());
+    return true;
+}
+
+// Callbacks posted from other threads run on the reactor thread; stop() ends run()
+bool test_post_and_stop_from_other_threads() {
+    Reactor reactor;
+    std::atomic<int> ran{0};
+    std::atomic<bool> on_reactor{true};
+    std::thread loop([&]() { reactor.run(); });
+
+    std::vector<std::thread> posters;
+    for (int t = 0; t < 4; t++) {
+        posters.emplace_back([&]() {
+            for (int i = 0; i < 250; i++) {
+                reactor.post([&]() {
+                    if (!reactor.in_reactor_thread()) {
+                        on_reactor = false;
+                    }
+                    ran++;
+                });
+            }
+        });
+    }
+    for (auto& poster : posters) {
+        poster.join();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (ran.load() < 1000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    reactor.stop();
+    loop.join();
+
+    ASSERT_EQ(1000, ran.load());
+    ASSERT_TRUE(on_reactor.load());
+    return true;
+}
+
+// Readable descriptors dispatch their callback, which may unregister itself
+bool test_fd_readiness() {
+    Reactor reactor;
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+
+    std::string received;
+    uint32_t ready_events = 0;
+    reactor.add_fd(fds[0], EPOLLIN, [&](uint32_t events) {
+        ready_events = events;
+        char buffer[16];
+        ssize_t count = read(fds[0], buffer, sizeof(buffer));
+        received.append(buffer, static_cast<size_t>(count));
+        reactor.remove_fd(fds[0]);
+    });
+    ASSERT_TRUE(reactor.has_fd(fds[0]));
+
+    ASSERT_EQ(4, static_cast<int>(write(fds[1], "ping", 4)));
+    ASSERT_TRUE(run_until(reactor, [&]() { return !received.empty(); }));
+    ASSERT_EQ(std::string("ping"), received);
+    ASSERT_TRUE(ready_events & EPOLLIN);
+    ASSERT_TRUE(!reactor.has_fd(fds[0]));
+
+    close(fds[0]);
+    close(fds[1]);
+    return true;
+}
+
+// Tasks with the same key run in submission order; stop() runs everything queued
+bool test_worker_pool_orders_per_key() {
+    std::mutex results_mutex;
+    std::vector<std::vector<int>> per_key(4);
+    {
+        WorkerPool pool(3);
+        ASSERT_EQ(3u, pool.size());
+        for (int i = 0; i < 400; i++) {
+            size_t key = static_cast<size_t>(i % 4);
+            pool.submit(key, [&, key, i]() {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                per_key[key].push_back(i);
+            });
+        }
+        pool.stop();
+        pool.submit(0, [&]() { per_key[0].push_back(-1); });   // Dropped after stop
+    }
+
+    for (size_t key = 0; key < per_key.size(); key++) {
+        ASSERT_EQ(100u, per_key[key].size());
+        for (size_t i = 1; i < per_key[key].size(); i++) {
+            ASSERT_TRUE(per_key[key][i - 1] < per_key[key][i]);
+        }
+    }
+    return true;
+}
+
+// Slow requests run concurrently on one reactor thread; errors are reported, not thrown
+bool test_http_client_concurrent_requests() {
+    HttpStandIn server([](const HttpStandIn::Request& request) {
+        HttpStandIn::Reply reply;
+        if (request.target == "/missing") {
+            reply.status = 404;
+            return reply;
+        }
+        reply.body = "echo " + request.target + " " + request.headers.at("authorization");
+        reply.delay_ms = 200;
+        return reply;
+    });
+
+    Reactor reactor;
+    HttpClient http(reactor);
+    std::vector<HttpResponse> responses;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; i++) {
+        http.get(HttpRequest{server.url("/anchor/" + std::to_string(i)), "admin", "secret"},
+                 [&](HttpResponse response) { responses.push_back(response); });
+    }
+    HttpResponse missing;
+    http.get(HttpRequest{server.url("/missing"), "", ""}, [&](HttpResponse response) { missing = response; });
+    ASSERT_EQ(6u, http.active());
+
+    ASSERT_TRUE(run_until(reactor, [&]() { return http.active() == 0; }, 3000));
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_TRUE(elapsed_ms < 900);   // Serial requests would take 1000ms
+
+    ASSERT_EQ(5u, responses.size());
+    for (const auto& response : responses) {
+        ASSERT_TRUE(response.ok());
+        ASSERT_EQ(200, response.status);
+        ASSERT_TRUE(response.body.find("echo /anchor/") == 0);
+        ASSERT_TRUE(response.body.find("Basic ") != std::string::npos);
+    }
+    ASSERT_TRUE(!missing.ok());
+    ASSERT_EQ(404, missing.status);
+    ASSERT_EQ(std::string("HTTP request failed with status: 404"), missing.error);
+    return true;
+}
+
+// Workers wait on fetch() while the reactor runs on its own thread
+bool test_http_fetch_from_worker_thread() {
+    HttpStandIn server([](const HttpStandIn::Request& request) {
+        HttpStandIn::Reply reply;
+        reply.body = "[" + request.target + "]";
+        return reply;
+    });
+
+    Reactor reactor;
+    HttpClient http(reactor);
+    std::thread loop([&]() { reactor.run(); });
+
+    HttpResponse response = http.fetch(HttpRequest{server.url("/dongles"), "", ""}).get();
+    HttpResponse refused = http.fetch(HttpRequest{"http://127.0.0.1:1/", "", ""}).get();
+
+    reactor.stop();
+    loop.join();
+
+    ASSERT_TRUE(response.ok());
+    ASSERT_EQ(std::string("[/dongles]"), response.body);
+    ASSERT_TRUE(!refused.ok());
+    ASSERT_EQ(0, static_cast<int>(refused.status));
+    ASSERT_TRUE(refused.error.find("CURL request failed") == 0);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    std::cout << "==================================" << std::endl;
+    std::cout << "      REACTOR TESTS STARTING      " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_timers_fire_in_order", test_timers_fire_in_order);
+    all_passed &= run_test("test_post_and_stop_from_other_threads", test_post_and_stop_from_other_threads);
+    all_passed &= run_test("test_fd_readiness", test_fd_readiness);
+    all_passed &= run_test("test_worker_pool_orders_per_key", test_worker_pool_orders_per_key);
+    all_passed &= run_test("test_http_client_concurrent_requests", test_http_client_concurrent_requests);
+    all_passed &= run_test("test_http_fetch_from_worker_thread", test_http_fetch_from_worker_thread);
+
+    curl_global_cleanup();
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL REACTOR TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME REACTOR TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
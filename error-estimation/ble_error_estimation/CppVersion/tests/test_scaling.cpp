@@ -0,0 +1,219 @@
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../processing.h"
+#include "../anchor_source.h"
+#include "../worker_pool.h"
+#include "test_support.h"
+
+/**
+ * Multi-core scalability of the processing core.
+ *
+ * Replays one fixed workload through a WorkerPool at 1, 2, 4 ... N threads (N =
+ * BLE_SCALING_MAX_THREADS, default the hardware thread count), keyed by tag as the
+ * runner does. The overlap ratio is the share of a message's anchors taken from a
+ * small set every tag hears (the rest are the tag's own), so it sets how often
+ * workers update the same anchors. Results are CSV on stdout, and also written to
+ * BLE_SCALING_CSV when set.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+const size_t TAGS = 64;
+const size_t ANCHORS_PER_MESSAGE = 4;
+const size_t SHARED_ANCHORS = 4;
+
+// Anchors private to each tag, plus the shared set
+void load_scaling_site(ProcessingContext& context) {
+    MemoryAnchorSource site;
+    for (size_t i = 0; i < TAGS * ANCHORS_PER_MESSAGE; i++) {
+        site.add(synthetic_mac("0a11", i), std::make_tuple(static_cast<float>(i % 16), static_cast<float>(i / 16), 2.5f));
+    }
+    for (size_t i = 0; i < SHARED_ANCHORS; i++) {
+        site.add(synthetic_mac("05a5", i), std::make_tuple(8.0f + i, 8.0f, 2.5f));
+    }
+    site.load(context);
+}
+
+struct ScalingMessage {
+    size_t tag;
+    std::string payload;
+};
+
+// The same messages for every thread count of one overlap ratio
+std::vector<ScalingMessage> scaling_workload(size_t messages, double overlap) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<ScalingMessage> workload;
+    workload.reserve(messages);
+    for (size_t i = 0; i < messages; i++) {
+        size_t tag = i % TAGS;
+        json used_anchors = json::array();
+        for (size_t k = 0; k < ANCHORS_PER_MESSAGE; k++) {
+            std::string mac = coin(rng) < overlap ? synthetic_mac("05a5", k % SHARED_ANCHORS)
+                                                  : synthetic_mac("0a11", tag * ANCHORS_PER_MESSAGE + k);
+            used_anchors.push_back({{"mac", mac}, {"rssi", -58.0f - 3.0f * k - static_cast<float>(i % 5)}});
+        }
+        json message = {
+            {"location", {{"position", {{"x", 4.0f}, {"y", 4.0f}, {"z", 0.0f},
+                                        {"used_anchors", used_anchors}, {"unused_anchors", json::array()}}}}},
+            {"tag", {{"mac", synthetic_mac("7a90", tag)}}},
+            {"timestamp", 1751374881169.0 + 100.0 * i}
+        };
+        workload.push_back(ScalingMessage{tag, message.dump()});
+    }
+    return workload;
+}
+
+struct ScalingResult {
+    size_t threads = 0;
+    double overlap = 0.0;
+    size_t messages = 0;
+    double seconds = 0.0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double p999_us = 0.0;
+    size_t estimates = 0;
+
+    double throughput() const { return seconds > 0.0 ? messages / seconds : 0.0; }
+};
+
+double percentile_us(std::vector<double>& sorted_ns, double fraction) {
+    if (sorted_ns.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted_ns.size() - 1, static_cast<size_t>(fraction * sorted_ns.size()));
+    return sorted_ns[index] / 1000.0;
+}
+
+// Replay the workload on a fresh site; latency is each message's processing time on its worker
+ScalingResult replay(const std::vector<ScalingMessage>& workload, size_t threads, double overlap) {
+    ProcessingContext context;
+    load_scaling_site(context);
+    std::vector<double> service_ns(workload.size());
+    std::atomic<size_t> estimates{0};
+    std::mutex done_mutex;
+    std::condition_variable all_done;
+    size_t remaining = workload.size();
+
+    auto start = Clock::now();
+    {
+        WorkerPool pool(threads);
+        for (size_t i = 0; i < workload.size(); i++) {
+            pool.submit(workload[i].tag, [&, i]() {
+                auto begin = Clock::now();
+                if (process_tag_message(context, workload[i].payload)) {
+                    estimates++;
+                }
+                service_ns[i] = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (--remaining == 0) {
+                    all_done.notify_one();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lock(done_mutex);
+        all_done.wait(lock, [&]() { return remaining == 0; });
+    }
+
+    ScalingResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.threads = threads;
+    result.overlap = overlap;
+    result.messages = workload.size();
+    result.estimates = estimates.load();
+    std::sort(service_ns.begin(), service_ns.end());
+    result.p50_us = percentile_us(service_ns, 0.50);
+    result.p99_us = percentile_us(service_ns, 0.99);
+    result.p999_us = percentile_us(service_ns, 0.999);
+    return result;
+}
+
+/*REPORT*/
+size_t env_size(const char* name, size_t fallback) {
+    const char* value = std::getenv(name);
+    return value ? std::strtoul(value, nullptr, 10) : fallback;
+}
+
+std::vector<size_t> thread_counts() {
+    size_t largest = env_size("BLE_SCALING_MAX_THREADS", std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<size_t> counts;
+    for (size_t count = 1; count <= largest; count *= 2) {
+        counts.push_back(count);
+    }
+    if (counts.back() != largest) {
+        counts.push_back(largest);
+    }
+    return counts;
+}
+
+// Quiets the engine's logging while a run is measured
+class QuietStreams {
+    public:
+        QuietStreams() : out(std::cout.rdbuf(nullptr)), err(std::cerr.rdbuf(nullptr)) {}
+        ~QuietStreams() {
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+            std::cout.clear();
+            std::cerr.clear();
+        }
+
+    private:
+        std::streambuf* out;
+        std::streambuf* err;
+};
+
+// Main function to run the benchmark
+int main() {
+    size_t messages = env_size("BLE_SCALING_MESSAGES", 20000);
+    std::vector<size_t> threads = thread_counts();
+    const double overlaps[] = {0.0, 0.25, 0.5, 1.0};
+
+    std::ostringstream csv;
+    csv << "threads,overlap,messages,seconds,throughput_msg_per_s,p50_us,p99_us,p999_us,speedup,efficiency\n";
+    csv << std::fixed;
+    bool all_ok = true;
+    for (double overlap : overlaps) {
+        std::vector<ScalingMessage> workload = scaling_workload(messages, overlap);
+        double single_thread = 0.0;
+        for (size_t count : threads) {
+            ScalingResult result;
+            {
+                QuietStreams quiet;
+                result = replay(workload, count, overlap);
+            }
+            all_ok &= result.estimates == result.messages;
+            if (count == 1) {
+                single_thread = result.throughput();
+            }
+            double speedup = single_thread > 0.0 ? result.throughput() / single_thread : 0.0;
+            csv << result.threads << "," << std::setprecision(2) << result.overlap << "," << result.messages << ","
+                << std::setprecision(4) << result.seconds << "," << std::setprecision(0) << result.throughput() << ","
+                << std::setprecision(2) << result.p50_us << "," << result.p99_us << "," << result.p999_us << ","
+                << std::setprecision(3) << speedup << "," << speedup / result.threads << "\n";
+        }
+    }
+
+    std::cout << csv.str();
+    if (const char* path = std::getenv("BLE_SCALING_CSV")) {
+        std::ofstream(path) << csv.str();
+    }
+    if (!all_ok) {
+        std::cerr << "Some messages produced no estimate" << std::endl;
+        return 1;
+    }
+    return 0;
+}
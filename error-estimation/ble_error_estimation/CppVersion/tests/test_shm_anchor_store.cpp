@@ -0,0 +1,239 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../shm_anchor_store.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+// Unique segment name per test so runs never collide
+std::string segment_name(const std::string& test) {
+    std::string name = "/ble_shm_test_" + std::to_string(getpid()) + "_" + test;
+    ShmAnchorStore::unlink(name);
+    return name;
+}
+
+ShmAnchorState make_state(float value) {
+    ShmAnchorState state;
+    state.x = value;
+    state.y = value;
+    state.z = value;
+    state.RSSI_0 = -59.0f + value;
+    state.n = 2.0f + value;
+    state.ewma = value;
+    state.last_seen = 1000.0f + value;
+    return state;
+}
+
+// Slots are appended and found again by MAC
+bool test_insert_and_find() {
+    std::string name = segment_name("insert");
+    ShmAnchorStore store(name, 16);
+    ASSERT_TRUE(store.is_creator());
+    ASSERT_EQ(16u, store.capacity());
+    ASSERT_EQ(0u, store.size());
+
+    ASSERT_EQ(-1, store.find("ce59ac2d9cc5"));
+    int32_t a = store.find_or_insert("ce59ac2d9cc5");
+    int32_t b = store.find_or_insert("e7a7f022204d");
+    ASSERT_EQ(0, a);
+    ASSERT_EQ(1, b);
+    ASSERT_EQ(a, store.find_or_insert("ce59ac2d9cc5"));
+    ASSERT_EQ(b, store.find("e7a7f022204d"));
+    ASSERT_EQ(2u, store.size());
+    ASSERT_EQ(std::string("e7a7f022204d"), store.mac_at(1));
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// New slots have version 0; each write bumps the version
+bool test_read_write_versions() {
+    std::string name = segment_name("versions");
+    ShmAnchorStore store(name, 8);
+    uint32_t slot = static_cast<uint32_t>(store.find_or_insert("aabbccddeeff"));
+
+    ShmAnchorState state;
+    ASSERT_TRUE(store.read(slot, state));
+    ASSERT_EQ(0u, state.version);
+
+    ASSERT_EQ(1u, store.write(slot, make_state(1.0f)));
+    ASSERT_EQ(2u, store.write(slot, make_state(2.0f)));
+    ASSERT_TRUE(store.read(slot, state));
+    ASSERT_EQ(2u, state.version);
+    ASSERT_EQ(2.0f, state.x);
+    ASSERT_EQ(-57.0f, state.RSSI_0);
+    ASSERT_EQ(1002.0f, state.last_seen);
+
+    // Out of range slots are rejected
+    ASSERT_TRUE(!store.read(5, state));
+    ASSERT_EQ(0u, store.write(5, make_state(1.0f)));
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// Full store and over-long MACs are refused
+bool test_capacity_and_mac_limits() {
+    std::string name = segment_name("capacity");
+    ShmAnchorStore store(name, 2);
+    ASSERT_TRUE(store.find_or_insert("a") >= 0);
+    ASSERT_TRUE(store.find_or_insert("b") >= 0);
+    ASSERT_EQ(-1, store.find_or_insert("c"));
+    ASSERT_EQ(-1, store.find_or_insert("0123456789abcdef0123"));
+    ASSERT_EQ(2u, store.size());
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// A second handle attaches to the existing segment and sees its contents
+bool test_attach_existing_segment() {
+    std::string name = segment_name("attach");
+    ShmAnchorStore creator(name, 32);
+    uint32_t slot = static_cast<uint32_t>(creator.find_or_insert("c00fbe457cd3"));
+    creator.write(slot, make_state(3.0f));
+
+    ShmAnchorStore attached(name, 1);   // Capacity is taken from the existing segment
+    ASSERT_TRUE(!attached.is_creator());
+    ASSERT_EQ(32u, attached.capacity());
+    ASSERT_EQ(static_cast<int32_t>(slot), attached.find("c00fbe457cd3"));
+
+    ShmAnchorState state;
+    ASSERT_TRUE(attached.read(slot, state));
+    ASSERT_EQ(3.0f, state.x);
+
+    attached.write(slot, make_state(4.0f));
+    ASSERT_TRUE(creator.read(slot, state));
+    ASSERT_EQ(4.0f, state.y);
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// Anchors written by another process are visible without any copy
+bool test_cross_process_sharing() {
+    std::string name = segment_name("fork");
+    ShmAnchorStore store(name, 64);
+
+    pid_t child = fork();
+    if (child == 0) {
+        ShmAnchorStore child_store(name, 64);
+        for (int i = 0; i < 20; i++) {
+            int32_t slot = child_store.find_or_insert("child" + std::to_string(i));
+            child_store.write(static_cast<uint32_t>(slot), make_state(static_cast<float>(i)));
+        }
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ASSERT_EQ(20u, store.size());
+
+    ShmAnchorState state;
+    int32_t slot = store.find("child7");
+    ASSERT_TRUE(slot >= 0);
+    ASSERT_TRUE(store.read(static_cast<uint32_t>(slot), state));
+    ASSERT_EQ(7.0f, state.z);
+    ASSERT_EQ(1u, state.version);
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// Lock-free readers never observe a half-written slot
+bool test_concurrent_readers_see_consistent_snapshots() {
+    std::string name = segment_name("seqlock");
+    ShmAnchorStore store(name, 4);
+    uint32_t slot = static_cast<uint32_t>(store.find_or_insert("hot"));
+    store.write(slot, make_state(0.0f));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            ShmAnchorState state;
+            while (!stop.load()) {
+                store.read(slot, state);
+                if (state.x != state.y || state.y != state.z || state.ewma != state.x ||
+                    state.last_seen != 1000.0f + state.x) {
+                    torn++;
+                }
+            }
+        });
+    }
+
+    for (int i = 1; i <= 200000; i++) {
+        store.write(slot, make_state(static_cast<float>(i)));
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQ(0, torn.load());
+    ShmAnchorState final_state;
+    store.read(slot, final_state);
+    ASSERT_EQ(200001u, final_state.version);
+
+    ShmAnchorStore::unlink(name);
+    return true;
+}
+
+// Main function to run all tests
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << " SHM ANCHOR STORE TESTS STARTING  " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_insert_and_find", test_insert_and_find);
+    all_passed &= run_test("test_read_write_versions", test_read_write_versions);
+    all_passed &= run_test("test_capacity_and_mac_limits", test_capacity_and_mac_limits);
+    all_passed &= run_test("test_attach_existing_segment", test_attach_existing_segment);
+    all_passed &= run_test("test_cross_process_sharing", test_cross_process_sharing);
+    all_passed &= run_test("test_concurrent_readers_see_consistent_snapshots", test_concurrent_readers_see_consistent_snapshots);
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL SHM ANCHOR STORE TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME SHM ANCHOR STORE TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
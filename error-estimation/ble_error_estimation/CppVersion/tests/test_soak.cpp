@@ -0,0 +1,272 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../processing.h"
+#include "../anchor_source.h"
+#include "test_support.h"
+
+/**
+ * Soak: months of operation compressed into minutes.
+ *
+ * A synthetic site (64 anchors, 32 tags reporting every BLE_SOAK_INTERVAL_S virtual
+ * seconds, 4 tags replaced by new ones every virtual hour, one anchor moved every 6
+ * virtual hours) is driven through the processing core for BLE_SOAK_HOURS virtual
+ * hours (default 72). Time only exists in the message timestamps, so the engine's
+ * health and visibility logic sees the full span. Every virtual hour RSS, anchor and
+ * tag counts and the latency distribution are sampled.
+ *
+ * Fails when, after warm-up, RSS or the anchor count grows in (almost) every sample
+ * beyond BLE_SOAK_RSS_SLACK_KB (default 2048), or when p99 latency of the last third
+ * exceeds the first third's by more than BLE_SOAK_P99_DRIFT (default 1.5x).
+ */
+
+using Clock = std::chrono::steady_clock;
+
+const size_t SITE_ANCHORS = 64;
+const size_t ACTIVE_TAGS = 32;
+const size_t TAGS_REPLACED_PER_HOUR = 4;
+const int RELOCATION_EVERY_HOURS = 6;
+const double START_MS = 1751374881169.0;
+
+double env_number(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    return value ? std::atof(value) : fallback;
+}
+
+PointR3 site_position(size_t anchor) {
+    return std::make_tuple(static_cast<float>(anchor % 8) * 5.0f, static_cast<float>(anchor / 8) * 5.0f, 2.5f);
+}
+
+// A tag walks slowly across the site and is heard by the four anchors around it
+std::string soak_message(size_t tag_id, double timestamp_ms) {
+    size_t cell = (tag_id * 7 + static_cast<size_t>(timestamp_ms / 60000.0)) % (SITE_ANCHORS - 9);
+    const size_t around[] = {cell, cell + 1, cell + 8, cell + 9};
+    json used_anchors = json::array();
+    for (size_t k = 0; k < 4; k++) {
+        used_anchors.push_back({{"mac", synthetic_mac("50a4", around[k])},
+                                {"rssi", -58.0f - 3.0f * k - static_cast<float>(tag_id % 3)}});
+    }
+    float x = std::get<0>(site_position(cell)) + 2.5f;
+    float y = std::get<1>(site_position(cell)) + 2.5f;
+    json message = {
+        {"location", {{"position", {{"x", x}, {"y", y}, {"z", 0.0f},
+                                    {"used_anchors", used_anchors}, {"unused_anchors", json::array()}}}}},
+        {"tag", {{"mac", synthetic_mac("7a95", tag_id)}}},
+        {"timestamp", timestamp_ms}
+    };
+    return message.dump();
+}
+
+/*SAMPLES*/
+const double HISTOGRAM_BOUNDS_US[] = {16, 32, 64, 128, 256, 512, 1024};
+const size_t HISTOGRAM_BUCKETS = sizeof(HISTOGRAM_BOUNDS_US) / sizeof(HISTOGRAM_BOUNDS_US[0]) + 1;
+
+struct SoakSample {
+    int hour = 0;
+    size_t rss_bytes = 0;
+    size_t anchors = 0;
+    size_t pending_reclamation = 0;
+    size_t active_tags = 0;
+    size_t tags_seen = 0;
+    size_t messages = 0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+    std::array<size_t, HISTOGRAM_BUCKETS> histogram{};
+};
+
+SoakSample summarize(int hour, std::vector<double>& latencies_us) {
+    SoakSample sample;
+    sample.hour = hour;
+    sample.messages = latencies_us.size();
+    if (latencies_us.empty()) {
+        return sample;
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    sample.p50_us = latencies_us[latencies_us.size() / 2];
+    sample.p99_us = latencies_us[std::min(latencies_us.size() - 1, latencies_us.size() * 99 / 100)];
+    sample.max_us = latencies_us.back();
+    for (double latency : latencies_us) {
+        size_t bucket = 0;
+        while (bucket < HISTOGRAM_BUCKETS - 1 && latency >= HISTOGRAM_BOUNDS_US[bucket]) {
+            bucket++;
+        }
+        sample.histogram[bucket]++;
+    }
+    return sample;
+}
+
+void print_sample(const SoakSample& sample) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << std::setw(5) << sample.hour
+              << std::setw(9) << sample.rss_bytes / (1024.0 * 1024.0)
+              << std::setw(8) << sample.anchors
+              << std::setw(8) << sample.pending_reclamation
+              << std::setw(7) << sample.active_tags
+              << std::setw(7) << sample.tags_seen
+              << std::setw(8) << sample.p50_us
+              << std::setw(8) << sample.p99_us
+              << std::setw(9) << sample.max_us << "  ";
+    for (size_t count : sample.histogram) {
+        std::cout << std::setw(6) << count;
+    }
+    std::cout << std::endl;
+}
+
+/*CHECKS*/
+// A series grows monotonically if nearly every step goes up and the total exceeds slack
+bool grows_monotonically(const std::vector<double>& series, double slack) {
+    if (series.size() < 4) {
+        return false;
+    }
+    size_t rising = 0;
+    for (size_t i = 1; i < series.size(); i++) {
+        rising += series[i] > series[i - 1] ? 1 : 0;
+    }
+    return rising * 10 >= (series.size() - 1) * 9 && series.back() - series.front() > slack;
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// Main function to run the soak
+int main() {
+    int hours = static_cast<int>(env_number("BLE_SOAK_HOURS", 72));
+    double interval_ms = env_number("BLE_SOAK_INTERVAL_S", 5) * 1000.0;
+    double rss_slack = env_number("BLE_SOAK_RSS_SLACK_KB", 2048) * 1024.0;
+    double p99_drift = env_number("BLE_SOAK_P99_DRIFT", 1.5);
+
+    std::cout << "==================================" << std::endl;
+    std::cout << "           SOAK HARNESS           " << std::endl;
+    std::cout << "==================================" << std::endl;
+    std::cout << hours << " virtual hours, " << ACTIVE_TAGS << " tags every " << interval_ms / 1000.0
+              << "s, " << SITE_ANCHORS << " anchors" << std::endl;
+
+    ProcessingContext context;
+    {
+        MemoryAnchorSource site;
+        for (size_t i = 0; i < SITE_ANCHORS; i++) {
+            site.add(synthetic_mac("50a4", i), site_position(i));
+        }
+        std::streambuf* out = std::cout.rdbuf(nullptr);
+        site.load(context);
+        std::cout.rdbuf(out);
+    }
+
+    std::cout << "\n  " << std::setw(5) << "hour" << std::setw(9) << "RSS MB" << std::setw(8) << "anchors"
+              << std::setw(8) << "retired" << std::setw(7) << "tags" << std::setw(7) << "seen"
+              << std::setw(8) << "p50 us" << std::setw(8) << "p99 us" << std::setw(9) << "max us" << "  latency histogram (<";
+    for (double bound : HISTOGRAM_BOUNDS_US) {
+        std::cout << bound << " ";
+    }
+    std::cout << "us, more)" << std::endl;
+
+    std::vector<SoakSample> samples;
+    std::unordered_set<size_t> tags_seen;
+    size_t first_tag = 0;     // Active tags are [first_tag, first_tag + ACTIVE_TAGS)
+    size_t failed_messages = 0;
+    auto wall_start = Clock::now();
+    const double ticks_per_hour = 3600.0 * 1000.0 / interval_ms;
+
+    for (int hour = 0; hour < hours; hour++) {
+        std::vector<double> latencies_us;
+        latencies_us.reserve(static_cast<size_t>(ticks_per_hour) * ACTIVE_TAGS);
+        for (size_t tick = 0; tick < static_cast<size_t>(ticks_per_hour); tick++) {
+            double now_ms = START_MS + hour * 3600000.0 + tick * interval_ms;
+            for (size_t t = 0; t < ACTIVE_TAGS; t++) {
+                size_t tag_id = first_tag + t;
+                std::string payload = soak_message(tag_id, now_ms + t * (interval_ms / ACTIVE_TAGS));
+                auto begin = Clock::now();
+                bool estimated = process_tag_message(context, payload).has_value();
+                latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+                failed_messages += estimated ? 0 : 1;
+                tags_seen.insert(tag_id);
+            }
+        }
+
+        // Dongle moved on site: the refresher would publish its relocated copy
+        if ((hour + 1) % RELOCATION_EVERY_HOURS == 0) {
+            size_t moved = static_cast<size_t>(hour / RELOCATION_EVERY_HOURS) % SITE_ANCHORS;
+            std::vector<std::unique_ptr<Anchor>> changes;
+            {
+                auto guard = context.anchors.read();
+                if (Anchor* anchor = guard.find(synthetic_mac("50a4", moved))) {
+                    PointR3 from = anchor->get_coord();
+                    float shift = std::get<2>(from) > 2.5f ? -0.5f : 0.5f;
+                    changes.push_back(anchor->relocated(std::make_tuple(std::get<0>(from), std::get<1>(from), std::get<2>(from) + shift)));
+                }
+            }
+            context.anchors.replace_all(std::move(changes));
+        }
+        context.anchors.collect_garbage();
+        first_tag += TAGS_REPLACED_PER_HOUR;
+
+        SoakSample sample = summarize(hour + 1, latencies_us);
+        sample.rss_bytes = resident_bytes();
+        sample.anchors = context.anchors.size();
+        sample.pending_reclamation = context.anchors.pending_reclamation();
+        sample.active_tags = ACTIVE_TAGS;
+        sample.tags_seen = tags_seen.size();
+        print_sample(sample);
+        samples.push_back(sample);
+    }
+    double wall_s = std::chrono::duration<double>(Clock::now() - wall_start).count();
+
+    // Checks skip the first quarter: allocator pools, hash tables and Kalman windows fill up there
+    size_t warm = samples.size() / 4;
+    std::vector<double> rss, anchors, p99s;
+    for (size_t i = warm; i < samples.size(); i++) {
+        rss.push_back(static_cast<double>(samples[i].rss_bytes));
+        anchors.push_back(static_cast<double>(samples[i].anchors + samples[i].pending_reclamation));
+        p99s.push_back(samples[i].p99_us);
+    }
+    size_t third = p99s.size() / 3;
+    double early_p99 = median(std::vector<double>(p99s.begin(), p99s.begin() + third));
+    double late_p99 = median(std::vector<double>(p99s.end() - third, p99s.end()));
+
+    std::cout << "\nSimulated " << hours << "h in " << std::setprecision(1) << wall_s << "s ("
+              << std::setprecision(0) << hours * 3600.0 / std::max(wall_s, 1e-9) << "x)" << std::endl;
+    std::cout << std::setprecision(2) << "p99 early " << early_p99 << "us, late " << late_p99 << "us" << std::endl;
+
+    bool passed = true;
+    if (failed_messages > 0) {
+        std::cout << "FAIL: " << failed_messages << " messages produced no estimate" << std::endl;
+        passed = false;
+    }
+    if (grows_monotonically(rss, rss_slack)) {
+        std::cout << "FAIL: RSS grows steadily (" << (rss.back() - rss.front()) / 1024.0 << " KB after warm-up)" << std::endl;
+        passed = false;
+    }
+    if (grows_monotonically(anchors, 0.0)) {
+        std::cout << "FAIL: anchors (live and awaiting reclamation) grow steadily" << std::endl;
+        passed = false;
+    }
+    if (third > 0 && late_p99 > early_p99 * p99_drift) {
+        std::cout << "FAIL: p99 latency drifted from " << early_p99 << "us to " << late_p99 << "us" << std::endl;
+        passed = false;
+    }
+
+    std::cout << "\n==================================" << std::endl;
+    if (passed) {
+        std::cout << "🎉 SOAK PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOAK FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,376 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../state_handoff.h"
+#include "../state_snapshot.h"
+#include "../processing.h"
+
+// Simple testing framework macros
+#define ASSERT_EQ(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            std::cerr << "FAIL: Expected " << (expected) << " but got " << (actual) \
+                      << " at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "FAIL: Expected condition to be true at line " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while(0)
+
+// Simple test runner function
+bool run_test(const char* test_name, bool (*test_func)()) {
+    std::cout << "Running " << test_name << "... ";
+    bool result = test_func();
+    if (result) {
+        std::cout << "PASS" << std::endl;
+    } else {
+        std::cout << "FAIL" << std::endl;
+    }
+    return result;
+}
+
+const std::vector<std::pair<std::string, PointR3>> SITE = {
+    {"a1", {0.0f, 0.0f, 2.5f}}, {"a2", {10.0f, 0.0f, 2.5f}},
+    {"a3", {10.0f, 8.0f, 2.5f}}, {"a4", {0.0f, 8.0f, 2.5f}}
+};
+
+std::string socket_path() {
+    return "/tmp/ble_handoff_test_" + std::to_string(getpid()) + ".sock";
+}
+
+// A calibrated engine: the site's anchors after a run of tag messages
+struct Engine {
+    ProcessingContext context;
+
+    explicit Engine(int messages) {
+        std::vector<std::unique_ptr<Anchor>> anchors;
+        for (const auto& [mac, coord] : SITE) {
+            anchors.push_back(std::make_unique<Anchor>(mac, coord, 0.0f));
+        }
+        context.anchors.insert_all(std::move(anchors));
+        context.anchors_initialized = true;
+        for (int i = 0; i < messages; i++) {
+            float x = 1.0f + static_cast<float>(i % 9);
+            float y = 1.0f + static_cast<float>(i % 7);
+            PositionProducer::Reading readings[] = {
+                {"a1", -55.0f - x}, {"a2", -60.0f - y * 0.5f}, {"a3", -68.0f + x * 0.3f}, {"a4", -62.0f - y * 0.2f}
+            };
+            PositionRecord record{};
+            PositionProducer::fill_record(record, "tag" + std::to_string(i % 5), x, y, 1.2f, 1700000000.0 + i, readings, 4);
+            evaluate_tag_message(context, parse_position_record(context, record));
+        }
+    }
+};
+
+// Every anchor of expected exists in actual with the same calibration, health, version and filter
+bool same_state(AnchorRegistry& expected, AnchorRegistry& actual) {
+    auto expected_guard = expected.read();
+    auto actual_guard = actual.read();
+    ASSERT_EQ(expected_guard.size(), actual_guard.size());
+    for (const auto& [mac, anchor] : expected_guard.anchors()) {
+        Anchor* other = actual_guard.find(mac);
+        ASSERT_TRUE(other != nullptr);
+        AnchorState state, other_state;
+        KalmanState filter, other_filter;
+        anchor->save_state(state, filter);
+        other->save_state(other_state, other_filter);
+        ASSERT_EQ(state.version, other_state.version);
+        ASSERT_EQ(state.RSSI_0, other_state.RSSI_0);
+        ASSERT_EQ(state.n, other_state.n);
+        ASSERT_EQ(state.ewma, other_state.ewma);
+        ASSERT_EQ(state.last_seen, other_state.last_seen);
+        ASSERT_EQ(filter.sigma, other_filter.sigma);
+        ASSERT_EQ(filter.residual_count, other_filter.residual_count);
+        ASSERT_TRUE(std::memcmp(filter.residuals, other_filter.residuals, sizeof(filter.residuals)) == 0);
+        ASSERT_TRUE(anchor->get_coord() == other->get_coord());
+    }
+    return true;
+}
+
+// Old engine on a reactor thread: on request, drain briefly, send the snapshot and stop
+struct OldEngine {
+    Engine engine;
+    Reactor reactor;
+    std::unique_ptr<HandoffServer> server;
+    bool sent = false;
+    std::thread loop;
+
+    OldEngine(int messages, const std::string& path) : engine(messages) {
+        server = std::make_unique<HandoffServer>(reactor, path, [this]() {
+            reactor.add_timer(20, [this]() {
+                sent = server->send(export_state_snapshot(engine.context.anchors));
+                reactor.stop();
+            });
+        });
+        loop = std::thread([this]() { reactor.run(); });
+    }
+
+    ~OldEngine() {
+        reactor.stop();
+        if (loop.joinable()) {
+            loop.join();
+        }
+    }
+};
+
+bool test_no_engine_is_cold_start() {
+    std::string path = socket_path();
+    unlink(path.c_str());
+    ASSERT_TRUE(!request_handoff(path, 100).has_value());
+
+    // A socket file left behind by a crashed engine: nobody listens
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(0, bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)));
+    close(fd);
+    ASSERT_TRUE(!request_handoff(path, 100).has_value());
+
+    // and is replaced by the next engine
+    Reactor reactor;
+    HandoffServer server(reactor, path, []() {});
+    return true;
+}
+
+// The new engine's registry matches the old one exactly, Kalman filters included
+bool test_handoff_round_trip() {
+    std::string path = socket_path();
+    OldEngine old(200, path);
+
+    std::optional<std::string> snapshot = request_handoff(path, 2000);
+    ASSERT_TRUE(snapshot.has_value());
+    old.loop.join();
+    ASSERT_TRUE(old.sent);
+
+    AnchorRegistry taken_over;
+    StateSnapshotImport imported = import_state_snapshot(taken_over, snapshot->data(), snapshot->size());
+    ASSERT_EQ(SITE.size(), imported.added);
+    ASSERT_TRUE(same_state(old.engine.context.anchors, taken_over));
+    {
+        auto guard = old.engine.context.anchors.read();
+        ASSERT_TRUE(guard.find("a1")->snapshot().version > 0);
+    }
+    return true;
+}
+
+// The new engine listens on the same path while the old one shuts down
+bool test_path_is_handed_over() {
+    std::string path = socket_path();
+    auto old = std::make_unique<OldEngine>(10, path);
+    ASSERT_TRUE(request_handoff(path, 2000).has_value());
+
+    Reactor reactor;
+    HandoffServer next(reactor, path, []() {});
+    old.reset();   // Must not unlink the new engine's socket
+
+    struct stat bound {};
+    ASSERT_TRUE(stat(path.c_str(), &bound) == 0);
+    ASSERT_TRUE(S_ISSOCK(bound.st_mode));
+    return true;
+}
+
+// A client that does not speak the handoff protocol is dropped; the engine keeps listening
+bool test_foreign_client_ignored() {
+    std::string path = socket_path();
+    OldEngine old(10, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(0, connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)));
+    ASSERT_EQ(8, static_cast<int>(write(fd, "GET / HT", 8)));
+    char byte;
+    ASSERT_EQ(0, static_cast<int>(read(fd, &byte, 1)));   // Closed without an answer
+    close(fd);
+    ASSERT_TRUE(!old.sent);
+
+    ASSERT_TRUE(request_handoff(path, 2000).has_value());
+    return true;
+}
+
+// An engine that never finishes draining makes the request time out
+bool test_request_times_out() {
+    std::string path = socket_path();
+    Reactor reactor;
+    HandoffServer server(reactor, path, []() {});
+    std::thread loop([&reactor]() { reactor.run(); });
+
+    bool threw = false;
+    try {
+        request_handoff(path, 100);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    reactor.stop();
+    loop.join();
+    ASSERT_TRUE(threw);
+    ASSERT_TRUE(server.requested());
+    return true;
+}
+
+// Only the engine's user may connect: mode 0600, and SO_PEERCRED for anyone who gets past it
+bool test_other_users_rejected() {
+    std::string path = socket_path();
+    OldEngine old(10, path);
+
+    struct stat bound {};
+    ASSERT_TRUE(stat(path.c_str(), &bound) == 0);
+    ASSERT_EQ(static_cast<mode_t>(0600), bound.st_mode & 0777);
+
+    if (geteuid() == 0) {
+        // Open the path up, so only the peer credential check stands in the way
+        ASSERT_EQ(0, chmod(path.c_str(), 0666));
+        pid_t child = fork();
+        if (child == 0) {
+            if (setuid(65534) != 0) {
+                _exit(2);
+            }
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                _exit(3);
+            }
+            // The engine may already have hung up: ignore the write, expect no answer
+            ssize_t written = send(fd, HANDOFF_MAGIC, sizeof(HANDOFF_MAGIC), MSG_NOSIGNAL);
+            (void)written;
+            char byte;
+            _exit(read(fd, &byte, 1) <= 0 ? 0 : 1);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(0, WEXITSTATUS(status));
+        ASSERT_TRUE(!old.sent);
+    }
+
+    ASSERT_TRUE(request_handoff(path, 2000).has_value());
+    return true;
+}
+
+// An answer announcing an absurd snapshot length is refused before anything is allocated
+bool test_oversized_snapshot_refused() {
+    std::string path = socket_path();
+    unlink(path.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(0, bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)));
+    ASSERT_EQ(0, listen(listener, 1));
+
+    std::thread bogus([listener]() {
+        int fd = accept(listener, nullptr, nullptr);
+        char request[sizeof(HANDOFF_MAGIC)];
+        ssize_t received = read(fd, request, sizeof(request));
+        (void)received;
+        HandoffHeader header;
+        std::memcpy(header.magic, HANDOFF_MAGIC, sizeof(header.magic));
+        header.length = uint64_t(1) << 40;
+        ssize_t written = write(fd, &header, sizeof(header));
+        (void)written;
+        char byte;
+        received = read(fd, &byte, 1);   // Until the client hangs up
+        close(fd);
+    });
+
+    bool refused = false;
+    try {
+        request_handoff(path, 2000);
+    } catch (const std::runtime_error& e) {
+        refused = std::string(e.what()).find("announced") != std::string::npos;
+    }
+    bogus.join();
+    close(listener);
+    unlink(path.c_str());
+    ASSERT_TRUE(refused);
+    return true;
+}
+
+// Old and new engines as separate processes, as in an upgrade
+bool test_cross_process_handoff() {
+    std::string path = socket_path();
+    unlink(path.c_str());
+    int ready[2];
+    ASSERT_EQ(0, pipe(ready));
+
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        Engine engine(300);
+        Reactor reactor;
+        HandoffServer server(reactor, path, [&]() {
+            server.send(export_state_snapshot(engine.context.anchors));
+            reactor.stop();
+        });
+        ssize_t written = write(ready[1], "r", 1);
+        (void)written;
+        reactor.run();
+        _exit(0);
+    }
+    close(ready[1]);
+    char byte;
+    ASSERT_EQ(1, static_cast<int>(read(ready[0], &byte, 1)));
+    close(ready[0]);
+
+    std::optional<std::string> snapshot = request_handoff(path, 5000);
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(snapshot.has_value());
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // The child's engine saw the same messages as this reference
+    Engine reference(300);
+    AnchorRegistry taken_over;
+    import_state_snapshot(taken_over, snapshot->data(), snapshot->size());
+    ASSERT_TRUE(same_state(reference.context.anchors, taken_over));
+
+    struct stat left {};
+    ASSERT_TRUE(stat(path.c_str(), &left) != 0);   // Unlinked by the exiting engine
+    return true;
+}
+
+int main() {
+    std::cout << "==================================" << std::endl;
+    std::cout << "    STATE HANDOFF TESTS STARTING  " << std::endl;
+    std::cout << "==================================" << std::endl;
+
+    bool all_passed = true;
+
+    all_passed &= run_test("test_no_engine_is_cold_start", test_no_engine_is_cold_start);
+    all_passed &= run_test("test_handoff_round_trip", test_handoff_round_trip);
+    all_passed &= run_test("test_path_is_handed_over", test_path_is_handed_over);
+    all_passed &= run_test("test_foreign_client_ignored", test_foreign_client_ignored);
+    all_passed &= run_test("test_request_times_out", test_request_times_out);
+    all_passed &= run_test("test_other_users_rejected", test_other_users_rejected);
+    all_passed &= run_test("test_oversized_snapshot_refused", test_oversized_snapshot_refused);
+    all_passed &= run_test("test_cross_process_handoff", test_cross_process_handoff);
+
+    unlink(socket_path().c_str());
+
+    std::cout << "\n==================================" << std::endl;
+    if (all_passed) {
+        std::cout << "🎉 ALL STATE HANDOFF TESTS PASSED! 🎉" << std::endl;
+        return 0;
+    } else {
+        std::cout << "❌ SOME STATE HANDOFF TESTS FAILED ❌" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+/**
+ * @brief MAC address of the index-th synthetic anchor or tag: prefix followed by 8 hex digits
+ *
+ * Each test picks its own prefix so sites of different tests never share a MAC address.
+ *
+ * @param prefix Leading hex digits, e.g. "c01d"
+ * @param index Position of the device in the synthetic site
+ * @return std::string MAC address without separators
+ */
+inline std::string synthetic_mac(const char* prefix, size_t index) {
+    char mac[24];
+    std::snprintf(mac, sizeof(mac), "%s%08zx", prefix, index);
+    return mac;
+}
+
+/**
+ * @brief Resident memory of this process, from /proc/self/statm
+ * @return size_t Resident set size in bytes, 0 if it cannot be read
+ */
+inline size_t resident_bytes() {
+    long pages = 0;
+    long resident = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) {
+        return 0;
+    }
+    if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    std::fclose(statm);
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
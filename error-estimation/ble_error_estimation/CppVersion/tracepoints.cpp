@@ -0,0 +1,19 @@
+#include "tracepoints.h"
+
+#ifdef BLE_RSSI_TRACEPOINTS
+
+// One semaphore per probe, in the section tracers look them up in
+#define BLE_RSSI_SEMAPHORE(probe) \
+    unsigned short ble_rssi_##probe##_semaphore __attribute__((section(".probes"))) = 0
+
+extern "C" {
+    BLE_RSSI_SEMAPHORE(message_received);
+    BLE_RSSI_SEMAPHORE(message_parsed);
+    BLE_RSSI_SEMAPHORE(anchor_resolved);
+    BLE_RSSI_SEMAPHORE(message_evaluated);
+    BLE_RSSI_SEMAPHORE(anchor_updated);
+    BLE_RSSI_SEMAPHORE(message_done);
+    BLE_RSSI_SEMAPHORE(message_published);
+}
+
+#endif
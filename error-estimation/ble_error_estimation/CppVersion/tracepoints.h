@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @brief USDT static probes of the processing path (provider "ble_rssi")
+ *
+ * Each probe is a single nop in the binary until a tracer (bpftrace, perf, SystemTap)
+ * attaches to it, so they stay compiled into production builds. Probes whose
+ * arguments cost something to compute are guarded by TRACE_ENABLED(), which reads
+ * the probe's semaphore: the tracer raises it while attached, otherwise it is 0.
+ *
+ * Fractional values are passed as integers (meters as millimeters, calibration and
+ * health scaled by 1000) because tracers read probe arguments as integers.
+ *
+ * Probes, with their arguments:
+ *     message_received  (ordering key, payload bytes)                     reactor thread
+ *     message_parsed    (tag MAC, anchors with readings, unknown anchors)
+ *     anchor_resolved   (anchor MAC, 1 if resolved else 0)
+ *     message_evaluated (tag MAC, anchors evaluated, error estimate in mm)
+ *     anchor_updated    (anchor MAC, old RSSI_0, n, ewma, new RSSI_0, n, ewma; all x1000)
+ *     message_done      (ordering key, processing time in us including anchor waits)
+ *     message_published (payload bytes, topic)                            reactor thread
+ *
+ * Built in when <sys/sdt.h> is available (systemtap-sdt-dev / systemtap-sdt-devel);
+ * define BLE_RSSI_NO_TRACEPOINTS to compile them out.
+ *
+ * Example:
+ *     bpftrace -e 'usdt:./ble_rssi_runner:ble_rssi:message_done { @us = hist(arg1); }'
+ */
+
+#if !defined(BLE_RSSI_NO_TRACEPOINTS) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define BLE_RSSI_TRACEPOINTS 1
+#endif
+#endif
+
+#ifdef BLE_RSSI_TRACEPOINTS
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// Raised by the tracer while a probe is attached; defined in tracepoints.cpp
+extern "C" {
+    extern unsigned short ble_rssi_message_received_semaphore;
+    extern unsigned short ble_rssi_message_parsed_semaphore;
+    extern unsigned short ble_rssi_anchor_resolved_semaphore;
+    extern unsigned short ble_rssi_message_evaluated_semaphore;
+    extern unsigned short ble_rssi_anchor_updated_semaphore;
+    extern unsigned short ble_rssi_message_done_semaphore;
+    extern unsigned short ble_rssi_message_published_semaphore;
+}
+
+#define TRACE_ENABLED(probe) __builtin_expect(ble_rssi_##probe##_semaphore != 0, 0)
+
+#define TRACE_MESSAGE_RECEIVED(key, bytes) \
+    STAP_PROBE2(ble_rssi, message_received, key, bytes)
+#define TRACE_MESSAGE_PARSED(tag_mac, anchors, unknown) \
+    STAP_PROBE3(ble_rssi, message_parsed, tag_mac, anchors, unknown)
+#define TRACE_ANCHOR_RESOLVED(anch_mac, resolved) \
+    STAP_PROBE2(ble_rssi, anchor_resolved, anch_mac, resolved)
+#define TRACE_MESSAGE_EVALUATED(tag_mac, anchors, error_mm) \
+    STAP_PROBE3(ble_rssi, message_evaluated, tag_mac, anchors, error_mm)
+#define TRACE_ANCHOR_UPDATED(anch_mac, old_rssi0, old_n, old_ewma, new_rssi0, new_n, new_ewma) \
+    STAP_PROBE7(ble_rssi, anchor_updated, anch_mac, old_rssi0, old_n, old_ewma, new_rssi0, new_n, new_ewma)
+#define TRACE_MESSAGE_DONE(key, elapsed_us) \
+    STAP_PROBE2(ble_rssi, message_done, key, elapsed_us)
+#define TRACE_MESSAGE_PUBLISHED(bytes, topic) \
+    STAP_PROBE2(ble_rssi, message_published, bytes, topic)
+
+#else
+
+#define TRACE_ENABLED(probe) false
+
+#define TRACE_MESSAGE_RECEIVED(key, bytes) do {} while (0)
+#define TRACE_MESSAGE_PARSED(tag_mac, anchors, unknown) do {} while (0)
+#define TRACE_ANCHOR_RESOLVED(anch_mac, resolved) do {} while (0)
+#define TRACE_MESSAGE_EVALUATED(tag_mac, anchors, error_mm) do {} while (0)
+#define TRACE_ANCHOR_UPDATED(anch_mac, old_rssi0, old_n, old_ewma, new_rssi0, new_n, new_ewma) do {} while (0)
+#define TRACE_MESSAGE_DONE(key, elapsed_us) do {} while (0)
+#define TRACE_MESSAGE_PUBLISHED(bytes, topic) do {} while (0)
+
+#endif
+
+/**
+ * @brief Scale a value for a probe argument, e.g. meters to millimeters
+ */
+inline long trace_milli(float value) {
+    return static_cast<long>(value * 1000.0f);
+}
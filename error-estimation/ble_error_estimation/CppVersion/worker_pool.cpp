@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include "worker_pool.h"
+
+/*WORKERPOOL*/
+//constructor:
+WorkerPool::WorkerPool(size_t threads) {
+    size_t count = std::max<size_t>(1, threads);
+    for (size_t i = 0; i < count; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : workers) {
+        worker->thread = std::thread(work, std::ref(*worker));
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+//methods:
+void WorkerPool::submit(size_t key, Task task) {
+    Worker& worker = *workers[key % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.stopping) {
+            return;
+        }
+        worker.tasks.push_back(std::move(task));
+    }
+    worker.ready.notify_one();
+}
+
+void WorkerPool::stop() {
+    for (auto& worker : workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->stopping = true;
+        }
+        worker->ready.notify_one();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+size_t WorkerPool::size() const {
+    return workers.size();
+}
+
+size_t WorkerPool::pending() const {
+    size_t total = 0;
+    for (const auto& worker : workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        total += worker->tasks.size();
+    }
+    return total;
+}
+
+//helpers:
+void WorkerPool::work(Worker& worker) {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.ready.wait(lock, [&worker]() { return worker.stopping || !worker.tasks.empty(); });
+            if (worker.tasks.empty()) {
+                return; // Stopping and drained
+            }
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed pool of processing threads with per-key ordering
+ *
+ * Each worker owns its queue. Tasks submitted with the same key always run on the
+ * same worker, in submission order, so messages of one tag are never reordered
+ * while different tags are processed in parallel.
+ */
+class WorkerPool {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief Start the worker threads
+         * @param threads Number of workers, at least one
+         */
+        explicit WorkerPool(size_t threads);
+
+        /**
+         * @brief Run every queued task, then join the workers
+         */
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /**
+         * @brief Queue a task (thread-safe)
+         * @param key Ordering key, e.g. a hash of the tag MAC
+         * @param task Work to run on the worker owning the key
+         */
+        void submit(size_t key, Task task);
+
+        /**
+         * @brief Finish queued tasks and join the workers; later submits are dropped
+         */
+        void stop();
+
+        /**
+         * @brief Gets the number of workers
+         */
+        size_t size() const;
+
+        /**
+         * @brief Gets the number of tasks waiting in all queues
+         */
+        size_t pending() const;
+
+    private:
+        struct Worker {
+            mutable std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<Task> tasks;
+            bool stopping = false;
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        static void work(Worker& worker);
+};